@@ -1,6 +1,8 @@
 #ifndef DebuggingLoggerUtilityClass_HeaderPlusPlus
 #define DebuggingLoggerUtilityClass_HeaderPlusPlus
 
+#include "util/Allocations.hpp"
+
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -52,6 +54,7 @@ class LogUtil //replaces std::clog, std::cerr, std::cout with file streams
         //Applies timestamps and flushes buffer
         bool timestamp_and_flush()
         {
+            chesspp::util::Allocations::Scope tag {chesspp::util::Allocations::Subsystem::Log};
             std::stringstream out;
             for(char *p = pbase(), *e = pptr(); p != e; ++p)
             {
@@ -124,8 +127,21 @@ class LogUtil //replaces std::clog, std::cerr, std::cout with file streams
 public:
     static void enableRedirection() noexcept
     {
+        chesspp::util::Allocations::Scope tag {chesspp::util::Allocations::Subsystem::Log};
         static LogUtil lu;
     }
+    //Drops everything written to std::clog, for headless tools where per-move logging is too costly
+    static void discardLog() noexcept
+    {
+        static class : public std::streambuf
+        {
+            int_type overflow(int_type ch) override
+            {
+                return traits_type::not_eof(ch);
+            }
+        } discard;
+        std::clog.rdbuf(&discard);
+    }
     ~LogUtil()
     {
         std::clog.rdbuf(clogbuf), clogbuf = nullptr;
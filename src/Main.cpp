@@ -2,13 +2,21 @@
 #include <fstream>
 #include <streambuf>
 #include <typeinfo>
+#include <string>
+#include <memory>
 
 #include "app/Application.hpp"
 #include "app/StartMenuState.hpp"
 #include "Debug.hpp"
 #include "Exception.hpp"
+#if defined(__linux__)
+#include "net/MetricsExporter.hpp"
+#endif
 
-int main()
+//Usage: chesspp [--spectate unix:<path>|tcp:<port>] [--engine <suit>]...
+//               [--metrics unix:<path>|tcp:<port>] [--metrics-file path]
+//               [--record-events path] [--replay-events path [--headless]]
+int main(int argc, char const *const *argv)
 {
     LogUtil::enableRedirection();
 
@@ -18,9 +26,67 @@ int main()
         {
             sf::VideoMode(640, 640),
             "ChessPlusPlus",
-            sf::Style::Close
+            sf::Style::Default //resizable, the board can be zoomed and panned
         };
         chesspp::app::Application app {disp};
+        //the engine is expected next to this executable
+        std::string self = argv[0];
+        std::string engine = self.substr(0, self.find_last_of('/') + 1) + "chesspp-engine";
+#if defined(__linux__)
+        chesspp::net::MetricsExporter::Options metrics {"", "", std::chrono::seconds(10)};
+#endif
+        std::string replay;
+        bool headless = false;
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if(arg == "--spectate" && has_value)
+            {
+                app.broadcastTo(argv[++i]);
+            }
+            else if(arg == "--engine" && has_value)
+            {
+                app.playByEngine(argv[++i], engine);
+            }
+            else if(arg == "--record-events" && has_value)
+            {
+                app.recordEvents(argv[++i]);
+            }
+            else if(arg == "--replay-events" && has_value)
+            {
+                replay = argv[++i];
+            }
+            else if(arg == "--headless")
+            {
+                headless = true;
+            }
+#if defined(__linux__)
+            else if(arg == "--metrics" && has_value)
+            {
+                metrics.endpoint = argv[++i];
+            }
+            else if(arg == "--metrics-file" && has_value)
+            {
+                metrics.file = argv[++i];
+            }
+#endif
+        }
+        if(!replay.empty())
+        {
+            app.replayEvents(replay, headless);
+        }
+        else if(headless)
+        {
+            std::clog << "--headless only applies to --replay-events" << std::endl;
+        }
+#if defined(__linux__)
+        std::unique_ptr<chesspp::net::MetricsExporter> exporter;
+        if(!metrics.endpoint.empty() || !metrics.file.empty())
+        {
+            exporter.reset(new chesspp::net::MetricsExporter{chesspp::util::Metrics::global(), metrics});
+        }
+#endif
         app.changeState<chesspp::app::StartMenuState>(std::ref(app), std::ref(disp));
         return app.execute();
     }
@@ -0,0 +1,114 @@
+#include "Evaluator.hpp"
+
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        constexpr Score_t Evaluator::ShareTotal;
+
+        Score_t Evaluator::reach(board::Board const &b, board::Board::Suit const &s)
+        {
+            Score_t tiles = 0;
+            for(auto const &t : b.pieceTrajectories())
+            {
+                if((*t.first)->suit == s)
+                {
+                    ++tiles;
+                }
+            }
+            for(auto const &c : b.pieceCapturings())
+            {
+                if((*c.first)->suit == s)
+                {
+                    ++tiles;
+                }
+            }
+            return tiles;
+        }
+
+        Score_t Evaluator::closeness(board::Board const &b, board::Board::Suit const &s, board::DistanceMaps &maps) const
+        {
+            std::size_t const moves = config.tropismMoves();
+            Score_t sum = 0;
+            for(auto const &target : b)
+            {
+                if(target->suit == s || target->pclass != config.tropismTarget())
+                {
+                    continue;
+                }
+                for(auto const &p : b)
+                {
+                    if(p->suit != s)
+                    {
+                        continue;
+                    }
+                    //one map per kind of piece and target, not per piece
+                    auto d = maps.toward(b, *p, target->pos, moves);
+                    if(d && d->at(p->pos) != board::DistanceMap::Unreachable)
+                    {
+                        sum += static_cast<Score_t>(moves + 1 - d->at(p->pos));
+                    }
+                }
+            }
+            return sum;
+        }
+
+        Score_t Evaluator::suitScore(board::Board const &b, board::Board::Suit const &s, board::DistanceMaps &maps) const
+        {
+            Score_t score = 0;
+            std::size_t const width = b.config.boardWidth();
+            for(auto const &p : b)
+            {
+                if(p->suit == s)
+                {
+                    score += config.pieceValue(p->pclass) + config.squareValue(s, p->pclass, p->pos.y*width + p->pos.x);
+                }
+            }
+            score += reach(b, s)*config.mobility();
+            if(config.tropism())
+            {
+                score += closeness(b, s, maps)*config.tropism();
+            }
+            return score;
+        }
+
+        Score_t Evaluator::evaluate(board::Board const &b, board::Board::Suit const &s, Players_t const &players, board::DistanceMaps &maps) const
+        {
+            Score_t best_opponent = std::numeric_limits<Score_t>::min();
+            for(auto const &p : players)
+            {
+                if(p != s)
+                {
+                    best_opponent = std::max(best_opponent, suitScore(b, p, maps));
+                }
+            }
+            if(best_opponent == std::numeric_limits<Score_t>::min())
+            {
+                best_opponent = 0;
+            }
+            return suitScore(b, s, maps) - best_opponent;
+        }
+
+        void Evaluator::shares(board::Board const &b, Players_t const &players, board::DistanceMaps &maps, std::vector<Score_t> &out) const
+        {
+            out.resize(players.size());
+            std::int64_t total = 0;
+            for(Players_t::size_type i = 0; i < players.size(); ++i)
+            {
+                out[i] = std::max<Score_t>(suitScore(b, players[i], maps), 0);
+                total += out[i];
+            }
+            for(auto &share : out)
+            {
+                share = total? static_cast<Score_t>(ShareTotal*static_cast<std::int64_t>(share)/total)
+                             : ShareTotal/static_cast<Score_t>(out.size());
+            }
+        }
+    }
+}
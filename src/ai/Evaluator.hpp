@@ -0,0 +1,52 @@
+#ifndef ChessPlusPlus_Ai_StaticPositionEvaluatorClass_HeaderPlusPlus
+#define ChessPlusPlus_Ai_StaticPositionEvaluatorClass_HeaderPlusPlus
+
+#include "config/EvaluationConfig.hpp"
+#include "board/Board.hpp"
+#include "board/DistanceMap.hpp"
+
+#include <vector>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        using Score_t = config::EvaluationConfig::Score_t;
+        using Players_t = std::vector<board::Board::Suit>;
+
+        //Judges a position by material, where pieces stand, mobility and how close pieces are to enemy targets such as Kings
+        class Evaluator
+        {
+            config::EvaluationConfig const &config;
+
+        public:
+            //What the shares of all players add up to
+            static constexpr Score_t ShareTotal = 1000000;
+
+            Evaluator(config::EvaluationConfig const &conf)
+            : config(conf) //can't use {}
+            {
+            }
+
+            //The tiles the pieces of a suit can move to or capture on, counted once per piece, which mobility() weights
+            static Score_t reach(board::Board const &b, board::Board::Suit const &s);
+            //How few moves the pieces of a suit need to reach the enemy's targets, which tropism() weights, maps must be for b
+            Score_t closeness(board::Board const &b, board::Board::Suit const &s, board::DistanceMaps &maps) const;
+            //Material, piece-square values, mobility and tropism of one suit, maps must be for b
+            Score_t suitScore(board::Board const &b, board::Board::Suit const &s, board::DistanceMaps &maps) const;
+            //The score of a suit relative to its strongest opponent among the players, maps must be for b
+            Score_t evaluate(board::Board const &b, board::Board::Suit const &s, Players_t const &players, board::DistanceMaps &maps) const;
+            //Each player's part of ShareTotal in proportion to their suitScore(), for
+            //searches that need scores which never go below 0 and add up to the same
+            void shares(board::Board const &b, Players_t const &players, board::DistanceMaps &maps, std::vector<Score_t> &out) const;
+            //Same as evaluate() above, working out distances from scratch
+            Score_t evaluate(board::Board const &b, board::Board::Suit const &s, Players_t const &players) const
+            {
+                board::DistanceMaps maps;
+                return evaluate(b, s, players, maps);
+            }
+        };
+    }
+}
+
+#endif
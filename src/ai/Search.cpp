@@ -0,0 +1,448 @@
+#include "Search.hpp"
+
+#include "piece/Piece.hpp"
+#include "util/Allocations.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        constexpr Score_t Search::Infinity;
+        constexpr std::size_t Search::MaxShares;
+        constexpr std::size_t Search::KnownTable::LockCount;
+
+        Search::KnownTable::KnownTable(std::size_t capacity)
+        {
+            std::size_t size = 1;
+            while(size < capacity)
+            {
+                size <<= 1;
+            }
+            slots.resize(size);
+        }
+        bool Search::KnownTable::find(KnownKey const &k, Known &out)
+        {
+            std::size_t const i = slotOf(k);
+            std::lock_guard<std::mutex> lock {locks[i % LockCount]};
+            Slot const &s = slots[i];
+            if(s.generation != generation || !(s.key == k))
+            {
+                return false;
+            }
+            out = s.known;
+            return true;
+        }
+        void Search::KnownTable::insert(KnownKey const &k, Known const &known)
+        {
+            std::size_t const i = slotOf(k);
+            std::lock_guard<std::mutex> lock {locks[i % LockCount]};
+            Slot &s = slots[i];
+            //a deeper entry saved more work, unless it is from an earlier run or about the same position
+            if(s.generation == generation && !(s.key == k) && s.known.depth > known.depth)
+            {
+                return;
+            }
+            s.key = k;
+            s.generation = generation;
+            s.known = known;
+        }
+        void Search::KnownTable::clear() noexcept
+        {
+            if(++generation == 0)
+            {
+                for(auto &s : slots)
+                {
+                    s.generation = 0;
+                }
+                generation = 1;
+            }
+        }
+
+        bool Search::outOfBudget()
+        {
+            std::uint64_t const n = nodes.load(std::memory_order_relaxed);
+            if(limits.max_nodes && n >= limits.max_nodes)
+            {
+                aborted = true;
+            }
+            //reading the clock is cheap next to a node, but not free
+            else if((n & 15) == 0 && (Clock::now() >= limits.deadline || (cancelled && cancelled())))
+            {
+                aborted = true;
+            }
+            return aborted;
+        }
+
+        void Search::findTurnings(board::Board const &b)
+        {
+            turnings.clear();
+            auto const &symmetries = b.symmetries();
+            for(std::size_t i = 0; i < symmetries.size(); ++i)
+            {
+                Turning t {i, {}};
+                for(auto const &p : players)
+                {
+                    auto it = std::find(players.begin(), players.end(), symmetries[i](p));
+                    if(it == players.end())
+                    {
+                        break;
+                    }
+                    t.turns.push_back(static_cast<Turn_t>(it - players.begin()));
+                }
+                bool usable = t.turns.size() == players.size();
+                for(Turn_t j = 0; usable && j < players.size(); ++j)
+                {
+                    usable = t.turns[(j + 1) % players.size()] == (t.turns[j] + 1) % players.size();
+                }
+                //with more than two players, Paranoid plays everyone against the root, which has to stay put
+                if(usable && (search_mode == Mode::MaxN || players.size() <= 2 || t.turns[root] == root))
+                {
+                    turnings.push_back(std::move(t));
+                }
+            }
+        }
+
+        auto Search::keyOf(board::Board const &b, Turn_t turn, std::size_t &turning) const noexcept
+        -> KnownKey
+        {
+            KnownKey key {b.hash(), turn};
+            turning = 0;
+            for(std::size_t i = 1; i < turnings.size(); ++i)
+            {
+                KnownKey const k {b.hash(turnings[i].symmetry), turnings[i].turns[turn]};
+                if(k.position < key.position || (k.position == key.position && k.turn < key.turn))
+                {
+                    key = k;
+                    turning = i;
+                }
+            }
+            return key;
+        }
+
+        board::Board::MoveList_t Search::ordered(board::Board const &b, board::Board::Suit const &s, board::Move const *first)
+        {
+            auto moves = b.legalMoves(s);
+            std::stable_partition(moves.begin(), moves.end(), [&](board::Move const &m)
+            {
+                return b.occupied(m.to);
+            });
+            if(first)
+            {
+                auto it = std::find(moves.begin(), moves.end(), *first);
+                if(it != moves.end())
+                {
+                    std::rotate(moves.begin(), it, it + 1);
+                }
+            }
+            return moves;
+        }
+
+        Score_t Search::paranoid(Worker &w, board::Board const &b, Turn_t turn, unsigned depth, Score_t alpha, Score_t beta, board::Board::MoveList_t &pv)
+        {
+            ++nodes;
+            pv.clear();
+            auto const &suit = players[turn];
+            auto leaf = [&]
+            {
+                w.distances.clear();
+                Score_t score = eval.evaluate(b, players[root], players, w.distances);
+                return ally(turn)? score : -score;
+            };
+            if(depth == 0 || outOfBudget())
+            {
+                return leaf();
+            }
+            std::size_t turning;
+            KnownKey const key = keyOf(b, turn, turning);
+            Known k;
+            bool const hit = known.find(key, k);
+            k.best = turned(b, turning, k.best);
+            if(hit && k.depth >= depth)
+            {
+                if(k.bound == Known::Bound::Exact
+                || (k.bound == Known::Bound::Lower && k.score >= beta)
+                || (k.bound == Known::Bound::Upper && k.score <= alpha))
+                {
+                    pv.assign(1, k.best);
+                    return k.score;
+                }
+            }
+            auto moves = ordered(b, suit, hit? &k.best : nullptr);
+            if(moves.empty())
+            {
+                return leaf();
+            }
+            Score_t const original_alpha = alpha;
+            Score_t best = -Infinity;
+            board::Board::MoveList_t line;
+            Turn_t const next = (turn + 1) % players.size();
+            for(auto const &m : moves)
+            {
+                board::Board child {b};
+                child.moveTo(child.find(m.from), m.to);
+                //the coalition against the root is one side, so only a change of side flips the score
+                Score_t score = ally(next) == ally(turn)
+                              ?  paranoid(w, child, next, depth - 1,  alpha,  beta, line)
+                              : -paranoid(w, child, next, depth - 1, -beta, -alpha, line);
+                if(aborted)
+                {
+                    return best == -Infinity? score : best;
+                }
+                if(score > best)
+                {
+                    best = score;
+                    pv.assign(1, m);
+                    pv.insert(pv.end(), line.begin(), line.end());
+                }
+                if(best > alpha)
+                {
+                    alpha = best;
+                }
+                if(alpha >= beta)
+                {
+                    break;
+                }
+            }
+            k.bound = best <= original_alpha? Known::Bound::Upper
+                    : best >= beta?           Known::Bound::Lower
+                    :                         Known::Bound::Exact;
+            k.depth = depth;
+            k.score = best;
+            k.best = turned(b, turning, pv.front());
+            known.insert(key, k);
+            return best;
+        }
+
+        void Search::maxn(Worker &w, board::Board const &b, Turn_t turn, unsigned depth, Score_t bound, std::vector<Score_t> &shares, board::Board::MoveList_t &pv)
+        {
+            ++nodes;
+            pv.clear();
+            if(depth == 0 || outOfBudget())
+            {
+                w.distances.clear();
+                eval.shares(b, players, w.distances, shares);
+                return;
+            }
+            std::size_t turning;
+            KnownKey const key = keyOf(b, turn, turning);
+            auto const &turns = turnings[turning].turns;
+            bool const remember = turns.size() <= MaxShares;
+            Known k;
+            bool const hit = remember && known.find(key, k);
+            k.best = turned(b, turning, k.best);
+            if(hit && k.depth >= depth && k.bound == Known::Bound::Exact)
+            {
+                shares.resize(turns.size());
+                for(Turn_t i = 0; i < turns.size(); ++i)
+                {
+                    shares[i] = k.shares[turns[i]];
+                }
+                pv.assign(1, k.best);
+                return;
+            }
+            auto moves = ordered(b, players[turn], hit? &k.best : nullptr);
+            if(moves.empty())
+            {
+                w.distances.clear();
+                eval.shares(b, players, w.distances, shares);
+                return;
+            }
+            bool first = true, cut = false;
+            std::vector<Score_t> child_shares;
+            board::Board::MoveList_t line;
+            Turn_t const next = (turn + 1) % players.size();
+            for(auto const &m : moves)
+            {
+                board::Board child {b};
+                child.moveTo(child.find(m.from), m.to);
+                maxn(w, child, next, depth - 1, first? -1 : shares[turn], child_shares, line);
+                if(aborted)
+                {
+                    if(first)
+                    {
+                        shares = std::move(child_shares);
+                    }
+                    return;
+                }
+                if(first || child_shares[turn] > shares[turn])
+                {
+                    shares = child_shares;
+                    pv.assign(1, m);
+                    pv.insert(pv.end(), line.begin(), line.end());
+                    first = false;
+                }
+                //shares add up to at most ShareTotal, so the player before can get no more than bound here
+                if(shares[turn] >= Evaluator::ShareTotal - bound)
+                {
+                    cut = true;
+                    break;
+                }
+            }
+            if(!remember)
+            {
+                return;
+            }
+            k.bound = cut? Known::Bound::Lower : Known::Bound::Exact;
+            k.depth = depth;
+            k.score = shares[turn];
+            for(Turn_t i = 0; i < turns.size(); ++i)
+            {
+                k.shares[turns[i]] = shares[i];
+            }
+            k.best = turned(b, turning, pv.front());
+            known.insert(key, k);
+        }
+
+        auto Search::run(board::Board const &b, board::Board::Suit const &turn, Limits const &l)
+        -> Result
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Engine};
+            limits = l;
+            nodes = 0;
+            aborted = false;
+            known.clear();
+            Result result;
+
+            root = static_cast<Turn_t>(std::find(players.begin(), players.end(), turn) - players.begin());
+            if(root == players.size())
+            {
+                return result;
+            }
+            findTurnings(b);
+            auto moves = ordered(b, turn);
+            if(moves.empty())
+            {
+                return result;
+            }
+            result.found = true;
+            result.best = moves.front();
+            result.pv.assign(1, result.best);
+
+            unsigned const threads = std::min<std::size_t>
+            (
+                thread_count? thread_count : std::max(1u, std::thread::hardware_concurrency()),
+                moves.size()
+            );
+            std::vector<std::unique_ptr<Worker>> workers;
+            for(unsigned i = 0; i < threads; ++i)
+            {
+                workers.emplace_back(new Worker);
+            }
+            Turn_t const next = (root + 1) % players.size();
+
+            for(unsigned depth = 1; depth <= limits.depth && !aborted; ++depth)
+            {
+                //search the previous best move first so cut-offs come sooner
+                std::stable_partition(moves.begin(), moves.end(), [&](board::Move const &m)
+                {
+                    return m == result.best;
+                });
+
+                std::mutex mutex;
+                Score_t best_score = -Infinity;
+                std::size_t best_index = moves.size();
+                board::Board::MoveList_t best;
+                std::atomic<std::size_t> claimed {1};
+                auto search = [&](Worker &w, std::size_t i)
+                {
+                    Score_t bound;
+                    {
+                        std::lock_guard<std::mutex> lock {mutex};
+                        bound = best_score;
+                    }
+                    board::Board child {b};
+                    child.moveTo(child.find(moves[i].from), moves[i].to);
+                    board::Board::MoveList_t line;
+                    Score_t score;
+                    if(search_mode == Mode::MaxN)
+                    {
+                        maxn(w, child, next, depth - 1, bound == -Infinity? -1 : bound, w.shares, line);
+                        score = w.shares[root];
+                    }
+                    else if(ally(next))
+                    {
+                        score = paranoid(w, child, next, depth - 1, bound, Infinity, line);
+                    }
+                    else
+                    {
+                        score = -paranoid(w, child, next, depth - 1, -Infinity, -bound, line);
+                    }
+                    if(aborted)
+                    {
+                        return;
+                    }
+                    std::lock_guard<std::mutex> lock {mutex};
+                    //a score no better than the bound it was searched with is only a bound itself,
+                    //so only exact scores can win a tie, which goes to the earlier move
+                    if(score > best_score || (score == best_score && score > bound && i < best_index))
+                    {
+                        best_score = score;
+                        best_index = i;
+                        best.assign(1, moves[i]);
+                        best.insert(best.end(), line.begin(), line.end());
+                    }
+                };
+                auto share = [&](Worker &w)
+                {
+                    util::Allocations::Scope tag {util::Allocations::Subsystem::Engine};
+                    for(std::size_t i; !aborted && (i = claimed++) < moves.size(); )
+                    {
+                        search(w, i);
+                    }
+                };
+
+                //the first move alone sets a bound for the rest to be searched against
+                search(*workers[0], 0);
+                std::vector<std::thread> helpers;
+                for(unsigned i = 1; i < threads; ++i)
+                {
+                    helpers.emplace_back(share, std::ref(*workers[i]));
+                }
+                share(*workers[0]);
+                for(auto &h : helpers)
+                {
+                    h.join();
+                }
+
+                if(aborted)
+                {
+                    break;
+                }
+                result.best = best.front();
+                result.pv = std::move(best);
+                result.score = best_score;
+                result.depth = depth;
+                if(progress)
+                {
+                    result.nodes = nodes;
+                    progress(result);
+                }
+            }
+            result.nodes = nodes;
+            result.exhausted = aborted;
+            return result;
+        }
+
+        bool Search::modeNamed(std::string const &name, Mode &m) noexcept
+        {
+            if(name == "paranoid")
+            {
+                m = Mode::Paranoid;
+            }
+            else if(name == "maxn")
+            {
+                m = Mode::MaxN;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+    }
+}
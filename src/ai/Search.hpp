@@ -0,0 +1,246 @@
+#ifndef ChessPlusPlus_Ai_AlphaBetaSearchClass_HeaderPlusPlus
+#define ChessPlusPlus_Ai_AlphaBetaSearchClass_HeaderPlusPlus
+
+#include "ai/Evaluator.hpp"
+#include "board/Board.hpp"
+#include "board/DistanceMap.hpp"
+#include "board/Move.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        /**
+         * Iterative deepening search for any number of players. Each node works
+         * on its own copy of the board, so the position searched from is never
+         * modified and any number of searches may share one.
+         *
+         * The moves at the root are shared out among threads once the first
+         * has been searched, and positions are remembered by hash for the
+         * rest of the run so transpositions and later iterations are cheaper.
+         * Positions the board's symmetries turn into each other are
+         * remembered as one.
+         */
+        class Search
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Limits
+            {
+            public:
+                unsigned depth;          //plies
+                std::uint64_t max_nodes; //0 for no limit
+                Clock::time_point deadline;
+
+                //Without a deadline unless given one
+                Limits(unsigned depth_ = 0, std::uint64_t max_nodes_ = 0, Clock::time_point deadline_ = Clock::time_point::max()) noexcept
+                : depth{depth_}
+                , max_nodes{max_nodes_}
+                , deadline{deadline_}
+                {
+                }
+            };
+            class Result
+            {
+            public:
+                bool found = false; //false if the suit has no legal moves
+                board::Move best;
+                board::Board::MoveList_t pv; //expected line of play, starting with best
+                Score_t score = 0; //for MaxN, the suit's part of Evaluator::ShareTotal
+                unsigned depth = 0; //of the deepest completed iteration
+                std::uint64_t nodes = 0;
+                bool exhausted = false; //stopped by the node limit or deadline rather than the depth
+            };
+            enum class Mode
+            {
+                Paranoid, //everyone else plays against the suit at the root, so alpha-beta applies
+                MaxN      //each suit makes the most of its own share, with shallow pruning
+            };
+
+            using Progress_t = std::function<void (Result const &)>;
+            using Cancel_t = std::function<bool ()>;
+
+        private:
+            static constexpr Score_t Infinity = 1000000000;
+            static constexpr std::size_t MaxShares = 8; //MaxN only remembers positions with at most this many turns
+            using Turn_t = Players_t::size_type;
+
+            //What is remembered about a searched position
+            class Known
+            {
+            public:
+                enum class Bound
+                {
+                    Exact,
+                    Lower, //the score is at least this
+                    Upper  //the score is at most this
+                } bound = Bound::Exact;
+                unsigned depth = 0;
+                Score_t score = 0;           //for the player to move
+                std::array<Score_t, MaxShares> shares {}; //MaxN only, by turn
+                board::Move best;
+            };
+            class KnownKey
+            {
+            public:
+                std::uint64_t position;
+                Turn_t turn;
+                friend bool operator==(KnownKey const &a, KnownKey const &b) noexcept
+                {
+                    return a.position == b.position && a.turn == b.turn;
+                }
+            };
+            class KnownKeyHash
+            {
+            public:
+                std::size_t operator()(KnownKey const &k) const noexcept
+                {
+                    return static_cast<std::size_t>(k.position ^ (k.turn * 0x9E3779B97F4A7C15ULL));
+                }
+            };
+        public:
+            /**
+             * Remembered positions in a table allocated once, one entry per
+             * slot. A slot keeps the deeper of two positions that land on it,
+             * and everything from an earlier run counts as empty, so clearing
+             * costs nothing. Slots are guarded by a fixed set of locks.
+             *
+             * Searches make their own unless given one, which lets e.g. a
+             * thread that runs one search after another keep the same table.
+             */
+            class KnownTable
+            {
+                class Slot
+                {
+                public:
+                    KnownKey key {0, 0};
+                    unsigned generation = 0; //of the run that filled it, 0 for never
+                    Known known;
+                };
+                static constexpr std::size_t LockCount = 64;
+                std::vector<Slot> slots; //a power of two of them
+                std::array<std::mutex, LockCount> locks; //slot i is guarded by locks[i % LockCount]
+                unsigned generation = 1;
+
+                std::size_t slotOf(KnownKey const &k) const noexcept
+                {
+                    return KnownKeyHash{}(k) & (slots.size() - 1);
+                }
+
+            public:
+                explicit KnownTable(std::size_t capacity);
+
+                //Copies the entry into out, if present
+                bool find(KnownKey const &k, Known &out);
+                void insert(KnownKey const &k, Known const &known);
+                //Not thread-safe, call between runs only
+                void clear() noexcept;
+            };
+        private:
+            //A symmetry of the board that changes nothing about the search, and the turn it gives each turn
+            class Turning
+            {
+            public:
+                std::size_t symmetry;
+                std::vector<Turn_t> turns;
+            };
+            //State of one search thread
+            class Worker
+            {
+            public:
+                board::DistanceMaps distances; //cleared for each position evaluated
+                std::vector<Score_t> shares;
+            };
+
+            Evaluator const &eval;
+            Players_t const &players;
+            Mode search_mode = Mode::Paranoid;
+            unsigned thread_count = 1;
+            std::unique_ptr<KnownTable> owned; //unless given a table
+            KnownTable &known;
+            std::vector<Turning> turnings; //the identity first
+            Limits limits;
+            Turn_t root = 0;
+            std::atomic<std::uint64_t> nodes {0};
+            std::atomic<bool> aborted {false};
+            Progress_t progress;
+            Cancel_t cancelled;
+
+            bool outOfBudget();
+            //Whether a turn is played by the suit at the root, for Paranoid
+            bool ally(Turn_t turn) const noexcept
+            {
+                return players[turn] == players[root];
+            }
+            //Finds the turnings usable from the root of this run
+            void findTurnings(board::Board const &b);
+            //The key of the position turned the way that gives the least key, and which turning that is
+            KnownKey keyOf(board::Board const &b, Turn_t turn, std::size_t &turning) const noexcept;
+            //Turns a move by a turning, which also turns it back
+            board::Move turned(board::Board const &b, std::size_t turning, board::Move const &m) const noexcept
+            {
+                return turning? b.symmetries()[turnings[turning].symmetry](m) : m;
+            }
+            //The score for the player to move, Paranoid
+            Score_t paranoid(Worker &w, board::Board const &b, Turn_t turn, unsigned depth, Score_t alpha, Score_t beta, board::Board::MoveList_t &pv);
+            //Every player's share, MaxN; bound is the best share of the player before, -1 if none yet
+            void maxn(Worker &w, board::Board const &b, Turn_t turn, unsigned depth, Score_t bound, std::vector<Score_t> &shares, board::Board::MoveList_t &pv);
+            //Captures first, otherwise keeps the order of legalMoves(), except that first goes before all
+            static board::Board::MoveList_t ordered(board::Board const &b, board::Board::Suit const &s, board::Move const *first = nullptr);
+
+        public:
+            Search(Evaluator const &e, Players_t const &p, std::size_t known_positions = 1 << 16)
+            : eval(e)    //can't use {}
+            , players(p) //can't use {}
+            , owned{new KnownTable{known_positions}}
+            , known(*owned) //can't use {}
+            {
+            }
+            //Remembers positions in a table that outlives the search and no other search uses meanwhile
+            Search(Evaluator const &e, Players_t const &p, KnownTable &table)
+            : eval(e)      //can't use {}
+            , players(p)   //can't use {}
+            , known(table) //can't use {}
+            {
+            }
+
+            //Paranoid by default
+            void mode(Mode m) noexcept
+            {
+                search_mode = m;
+            }
+            //Threads to search with, 0 for one per core; 1 by default
+            void threads(unsigned n) noexcept
+            {
+                thread_count = n;
+            }
+            //Called after each completed iteration with the result so far
+            void onProgress(Progress_t p)
+            {
+                progress = std::move(p);
+            }
+            //Polled along with the deadline from any of the search threads, the
+            //search stops as if out of time once it returns true
+            void cancelWhen(Cancel_t c)
+            {
+                cancelled = std::move(c);
+            }
+
+            Result run(board::Board const &b, board::Board::Suit const &turn, Limits const &l);
+
+            //Reads "paranoid" or "maxn", for command lines
+            static bool modeNamed(std::string const &name, Mode &m) noexcept;
+        };
+    }
+}
+
+#endif
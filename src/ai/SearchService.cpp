@@ -0,0 +1,207 @@
+#include "SearchService.hpp"
+
+#include "util/Allocations.hpp"
+
+#include <functional>
+#include <string>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        namespace
+        {
+            static std::uint64_t microsecondsBetween(SearchService::Clock::time_point a, SearchService::Clock::time_point b) noexcept
+            {
+                return b > a? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(b - a).count()) : 0;
+            }
+            //FNV-1a over the names, each ended by a 0 so the same letters split differently differ
+            static std::uint64_t hashPlayers(Players_t const &players) noexcept
+            {
+                std::uint64_t h = 14695981039346656037ULL;
+                for(auto const &p : players)
+                {
+                    for(char c : p)
+                    {
+                        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+                    }
+                    h *= 1099511628211ULL;
+                }
+                return h;
+            }
+        }
+
+        SearchService::SearchService(std::size_t worker_count, std::size_t max_queue_, std::size_t cache_entries, std::string const &eval_file) noexcept(false)
+        : eval_config{eval_file}
+        , evaluator{eval_config}
+        , max_queue{max_queue_}
+        , cache{cache_entries}
+        {
+            if(worker_count == 0)
+            {
+                throw Exception("The search service needs at least one worker");
+            }
+            for(std::size_t i = 0; i < worker_count; ++i)
+            {
+                workers.emplace_back(&SearchService::work, this);
+            }
+        }
+
+        auto SearchService::keyOf(SearchRequest const &r, std::size_t &symmetry) noexcept
+        -> CacheKey
+        {
+            return CacheKey{r.position->config.fingerprint(), hashPlayers(r.players), r.position->canonicalHash(r.turn, symmetry), r.mode};
+        }
+        Search::Result SearchService::turned(Search::Result r, board::Board const &b, std::size_t symmetry)
+        {
+            if(symmetry)
+            {
+                auto const &s = b.symmetries()[symmetry];
+                r.best = s(r.best);
+                for(auto &m : r.pv)
+                {
+                    m = s(m);
+                }
+            }
+            return r;
+        }
+
+        bool SearchService::submit(SearchRequest r)
+        {
+            auto const now = Clock::now();
+            SearchResult result;
+
+            Search::Result hit;
+            std::size_t symmetry;
+            if(cache.find(keyOf(r, symmetry), hit) && sufficient(hit, r))
+            {
+                static_cast<Search::Result &>(result) = turned(hit, *r.position, symmetry);
+                result.status = SearchResult::Status::Cached;
+                ++cached;
+                r.done(result);
+                return true;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock {mutex};
+                queue_depths.record(queue.size());
+                //assume everything ahead takes as long as searches have on average
+                auto const ahead = queue.size()/workers.size();
+                auto const expected = std::chrono::microseconds{static_cast<std::chrono::microseconds::rep>(ahead*search_times.mean())};
+                if(!stopping && queue.size() < max_queue && now + expected < r.deadline)
+                {
+                    queue.push(Queued{std::move(r), now, next_sequence++});
+                    lock.unlock();
+                    wake.notify_one();
+                    return true;
+                }
+            }
+            ++rejected;
+            r.done(result);
+            return false;
+        }
+
+        void SearchService::work()
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Engine};
+            //kept from one search to the next rather than allocated for each
+            Search::KnownTable known {1 << 16};
+            for(;;)
+            {
+                std::unique_lock<std::mutex> lock {mutex};
+                wake.wait(lock, [this]{ return stopping || !queue.empty(); });
+                if(stopping)
+                {
+                    return;
+                }
+                Queued q = std::move(const_cast<Queued &>(queue.top()));
+                queue.pop();
+                lock.unlock();
+
+                auto const start = Clock::now();
+                wait_times.record(microsecondsBetween(q.submitted, start));
+                SearchResult result;
+                if(start >= q.request.deadline)
+                {
+                    result.status = SearchResult::Status::Expired;
+                    ++expired;
+                    q.request.done(result);
+                    continue;
+                }
+
+                std::size_t symmetry;
+                auto const key = keyOf(q.request, symmetry);
+                Search::Result hit;
+                bool const known = cache.find(key, hit);
+                //an identical request may have been searched while this one waited
+                if(known && sufficient(hit, q.request))
+                {
+                    static_cast<Search::Result &>(result) = turned(hit, *q.request.position, symmetry);
+                    result.status = SearchResult::Status::Cached;
+                    ++cached;
+                }
+                else
+                {
+                    Search s {evaluator, q.request.players, known};
+                    s.mode(q.request.mode);
+                    static_cast<Search::Result &>(result) = s.run(*q.request.position, q.request.turn, Search::Limits{q.request.depth, q.request.max_nodes, q.request.deadline});
+                    search_times.record(microsecondsBetween(start, Clock::now()));
+                    result.status = SearchResult::Status::Searched;
+                    ++searched;
+                    //keep a deeper result than one cut short by this request's deadline
+                    if(result.found && (!known || result.depth > hit.depth))
+                    {
+                        cache.insert(key, turned(result, *q.request.position, symmetry));
+                    }
+                }
+                q.request.done(result);
+            }
+        }
+
+        void SearchService::stop()
+        {
+            std::priority_queue<Queued> dropped;
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                if(stopping)
+                {
+                    return;
+                }
+                stopping = true;
+                std::swap(dropped, queue);
+            }
+            wake.notify_all();
+            for(auto &w : workers)
+            {
+                w.join();
+            }
+            SearchResult result;
+            result.status = SearchResult::Status::Expired;
+            for(; !dropped.empty(); dropped.pop())
+            {
+                ++expired;
+                dropped.top().request.done(result);
+            }
+        }
+
+        std::size_t SearchService::queueDepth()
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            return queue.size();
+        }
+
+        void SearchService::report(std::ostream &os)
+        {
+            os << "searches: " << searched << " searched, " << cached << " cached, "
+               << expired << " expired, " << rejected << " rejected, queue " << queueDepth() << '/' << max_queue << std::endl;
+            os << "cache: " << cache.size() << " entries, " << cache.hits() << " hits, " << cache.misses() << " misses" << std::endl;
+            os << "queue depth: ";
+            queue_depths.report(os);
+            os << std::endl << "wait time: ";
+            wait_times.report(os, "us");
+            os << std::endl << "search time: ";
+            search_times.report(os, "us");
+            os << std::endl;
+        }
+    }
+}
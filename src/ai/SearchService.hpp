@@ -0,0 +1,164 @@
+#ifndef ChessPlusPlus_Ai_PooledSearchServiceClass_HeaderPlusPlus
+#define ChessPlusPlus_Ai_PooledSearchServiceClass_HeaderPlusPlus
+
+#include "ai/Search.hpp"
+#include "ai/Evaluator.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "util/Histogram.hpp"
+#include "util/LruCache.hpp"
+
+#include <memory>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace chesspp
+{
+    namespace ai
+    {
+        class SearchResult : public Search::Result
+        {
+        public:
+            enum class Status
+            {
+                Searched,
+                Cached,   //answered from an earlier search of the same position
+                Expired,  //the deadline passed while waiting for a worker
+                Rejected  //not admitted, see SearchService::submit
+            } status = Status::Rejected;
+        };
+
+        //What to search; the position is shared, not copied, and must not change afterwards
+        class SearchRequest
+        {
+        public:
+            std::shared_ptr<board::Board const> position;
+            Players_t players; //in turn order
+            board::Board::Suit turn;
+            Search::Clock::time_point deadline;
+            unsigned depth = 4;
+            std::uint64_t max_nodes = 0;
+            Search::Mode mode = Search::Mode::Paranoid;
+            //Called once from a worker thread, or from submit() if rejected
+            std::function<void (SearchResult const &)> done;
+        };
+
+        /**
+         * Runs searches for many games on a fixed number of worker threads.
+         * Requests wait in a queue ordered by deadline and are turned away up
+         * front when the queue is full or would not get to them in time.
+         * Results are remembered by variant, players and position so repeated
+         * positions are free, as are positions the board's symmetries turn
+         * into each other.
+         * Each search runs on one thread; the workers search different games.
+         */
+        class SearchService
+        {
+        public:
+            using Clock = Search::Clock;
+        private:
+            class Queued
+            {
+            public:
+                SearchRequest request;
+                Clock::time_point submitted;
+                std::uint64_t sequence; //keeps equal deadlines first come first served
+
+                friend bool operator<(Queued const &a, Queued const &b) noexcept
+                {
+                    //std::priority_queue puts the greatest on top
+                    return a.request.deadline > b.request.deadline
+                       || (a.request.deadline == b.request.deadline && a.sequence > b.sequence);
+                }
+            };
+            class CacheKey
+            {
+            public:
+                std::uint64_t variant;  //the layout's fingerprint
+                std::uint64_t players;  //of the names in turn order
+                std::uint64_t position; //with the suit to move, see Board::canonicalHash
+                Search::Mode mode;
+                friend bool operator==(CacheKey const &a, CacheKey const &b) noexcept
+                {
+                    return a.variant == b.variant && a.players == b.players && a.position == b.position && a.mode == b.mode;
+                }
+            };
+            class CacheKeyHash
+            {
+            public:
+                std::size_t operator()(CacheKey const &k) const noexcept
+                {
+                    return static_cast<std::size_t>(k.position ^ ((k.variant ^ k.players ^ static_cast<std::uint64_t>(k.mode)) * 0x9E3779B97F4A7C15ULL));
+                }
+            };
+
+            config::EvaluationConfig const eval_config;
+            Evaluator const evaluator;
+            std::size_t const max_queue;
+            util::LruCache<CacheKey, Search::Result, CacheKeyHash> cache;
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::priority_queue<Queued> queue;
+            std::uint64_t next_sequence = 0;
+            bool stopping = false;
+            std::vector<std::thread> workers;
+
+            std::atomic<std::uint64_t> rejected {0}, expired {0}, searched {0}, cached {0};
+            util::Histogram queue_depths;
+            util::Histogram wait_times;   //microseconds
+            util::Histogram search_times; //microseconds
+
+            void work();
+            //Sets symmetry to the one that turns the request's position into the one the cache keeps
+            static CacheKey keyOf(SearchRequest const &r, std::size_t &symmetry) noexcept;
+            //The result with its moves turned by one of the symmetries of a position
+            static Search::Result turned(Search::Result r, board::Board const &b, std::size_t symmetry);
+            //Whether a cached result is as good as searching again would be; one cut short by
+            //its deadline or node limit isn't, as this request may have more time for it
+            static bool sufficient(Search::Result const &cached, SearchRequest const &r) noexcept
+            {
+                return cached.depth >= r.depth;
+            }
+
+        public:
+            SearchService(std::size_t worker_count, std::size_t max_queue, std::size_t cache_entries, std::string const &eval_file = "config/chesspp/evaluation.json") noexcept(false);
+            ~SearchService()
+            {
+                stop();
+            }
+            SearchService(SearchService const &) = delete;
+            SearchService &operator=(SearchService const &) = delete;
+
+            /**
+             * Queues a search, or answers it right away from the cache.
+             * Rejects the request, calling done with Status::Rejected before
+             * returning false, if the service is stopping, the queue is full
+             * or the expected wait would already pass the deadline.
+             */
+            bool submit(SearchRequest r);
+            //Finishes the searches in progress and drops the queued ones, marking them Expired
+            void stop();
+
+            std::size_t workerCount() const noexcept
+            {
+                return workers.size();
+            }
+            std::size_t queueDepth();
+            util::Histogram const &queueDepths() const noexcept { return queue_depths; }
+            util::Histogram const &waitTimes()   const noexcept { return wait_times;   }
+            util::Histogram const &searchTimes() const noexcept { return search_times; }
+
+            //Counters and histograms, one per line
+            void report(std::ostream &os);
+        };
+    }
+}
+
+#endif
@@ -6,6 +6,10 @@
 
 namespace chesspp
 {
+    namespace board
+    {
+        class Board;
+    }
     namespace app
     {
         //Pure virtual abstract base class for game state management
@@ -19,6 +23,12 @@ namespace chesspp
 
             virtual void onRender() = 0;
 
+            //The board the state shows, if any, for the performance overlay
+            virtual board::Board const *shownBoard() const noexcept
+            {
+                return nullptr;
+            }
+
         protected:
             sf::RenderWindow &display;
         };
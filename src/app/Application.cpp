@@ -1,26 +1,92 @@
 #include "Application.hpp"
 
+#include "gfx/DrawCalls.hpp"
+#include "util/Allocations.hpp"
+
+#include <iostream>
+
 namespace chesspp
 {
     namespace app
     {
         int Application::execute()
         {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::App};
             running = true;
             sf::Event event;
-            while(running)
+            if(headless)
+            {
+                display.setVisible(false);
+                display.setVerticalSyncEnabled(false);
+            }
+            auto const began = PerformanceOverlay::Clock::now();
+            auto last = began;
+            PerformanceOverlay::Clock::duration rendering {0};
+            std::size_t frame = 0;
+            for(; running; ++frame)
             {
                 while(display.pollEvent(event))
                 {
-                    onEvent(event);
+                    //a replay only takes the recorded events, anything else would change the session
+                    if(!replay)
+                    {
+                        handle(frame, event);
+                    }
+                }
+                while(replay && running && replay->poll(frame, event))
+                {
+                    if(event.type == sf::Event::Resized)
+                    {
+                        display.setSize(sf::Vector2u(event.size.width, event.size.height));
+                    }
+                    handle(frame, event);
                 }
 
+                auto const start = PerformanceOverlay::Clock::now();
                 state->onRender();
-                display.display();
+                auto const rendered = PerformanceOverlay::Clock::now() - start;
+                rendering += rendered;
+                overlay.frame(start - last, rendered, gfx::DrawCalls::take());
+                last = start;
+                if(overlay.visible())
+                {
+                    overlay.draw(display, state->shownBoard(), res_config.resources());
+                }
+                if(!headless)
+                {
+                    display.display();
+                }
+                if(replay && replay->finished())
+                {
+                    running = false;
+                }
             }
 
+            if(replay || recorder)
+            {
+                using ms = std::chrono::duration<double, std::milli>;
+                std::cout << frame << " frames in " << ms(PerformanceOverlay::Clock::now() - began).count() << " ms, "
+                          << ms(rendering).count() << " ms rendering";
+                if(replay)
+                {
+                    std::cout << ", recorded in " << ms(replay->now()).count() << " ms";
+                }
+                std::cout << std::endl;
+                latencies.report(std::cout);
+            }
             return 0;
         }
+
+        void Application::handle(std::size_t frame, sf::Event &e)
+        {
+            if(recorder)
+            {
+                recorder->record(frame, e);
+            }
+            auto const start = EventLog::Clock::now();
+            onEvent(e);
+            latencies.add(e.type, EventLog::Clock::now() - start);
+        }
         
         void Application::stop() noexcept
         {
@@ -59,6 +125,15 @@ namespace chesspp
                 }
             case sf::Event::KeyPressed:
                 {
+                    //F3 shows or hides the performance overlay, F12 writes the heap allocation counts to the log
+                    if(e.key.code == sf::Keyboard::F3)
+                    {
+                        overlay.toggle();
+                    }
+                    else if(e.key.code == sf::Keyboard::F12)
+                    {
+                        util::Allocations::dump(std::clog);
+                    }
                     state->onKeyPressed(e.key.code, e.key.alt, e.key.control, e.key.shift, e.key.system);
                     break;
                 }
@@ -2,10 +2,16 @@
 #define ChessPlusPlus_App_ApplicationManagementClass_HeaderPlusPlus
 
 #include "AppState.hpp"
+#include "EventLog.hpp"
+#include "PerformanceOverlay.hpp"
 #include "config/ResourcesConfig.hpp"
+#include "res/SfmlFileResource.hpp"
+#include "Exception.hpp"
 
 #include <memory>
 #include <utility>
+#include <set>
+#include <string>
 
 namespace chesspp
 {
@@ -15,14 +21,25 @@ namespace chesspp
         {
             config::ResourcesConfig res_config;
             sf::RenderWindow &display;
+            PerformanceOverlay overlay;
             bool running = false;
             std::unique_ptr<AppState> state;
+            std::string spectator_endpoint;
+            std::set<std::string> engine_suits;
+            std::string engine_path;
+            std::unique_ptr<EventLog::Recorder> recorder;
+            std::unique_ptr<EventLog::Replay> replay;
+            bool headless = false;
+            EventLog::Latencies latencies;
 
             void onEvent(sf::Event &e);
+            //Handles and times an event, recording it if asked to
+            void handle(std::size_t frame, sf::Event &e);
 
         public:
             Application(sf::RenderWindow &disp)
             : display(disp) //can't use {}
+            , overlay{res_config.resources().from_config<res::SfmlFileResource<sf::Font>>("hud", "font")}
             {
                 display.setVerticalSyncEnabled(true);
             }
@@ -44,6 +61,59 @@ namespace chesspp
             {
                 return res_config;
             }
+
+            //Where games should be broadcast to spectators, empty if they shouldn't be
+            std::string const &spectatorEndpoint() const noexcept
+            {
+                return spectator_endpoint;
+            }
+            void broadcastTo(std::string const &endpoint)
+            {
+                spectator_endpoint = endpoint;
+            }
+
+            //Suits played by the engine process instead of by clicking
+            std::set<std::string> const &engineSuits() const noexcept
+            {
+                return engine_suits;
+            }
+            std::string const &enginePath() const noexcept
+            {
+                return engine_path;
+            }
+            void playByEngine(std::string const &suit, std::string const &path) noexcept(false)
+            {
+                if(replay)
+                {
+                    throw Exception("Engine players can't be combined with replaying events");
+                }
+                engine_suits.insert(suit);
+                engine_path = path;
+            }
+
+            //Writes the window events handled to a file, for replayEvents
+            void recordEvents(std::string const &path) noexcept(false)
+            {
+                recorder.reset(new EventLog::Recorder{path});
+            }
+            /**
+             * Handles the events from a recording instead of the window's,
+             * each in the frame it was handled in, then stops. Headless, the
+             * window is hidden, frames are still rendered but never displayed
+             * nor held back by vertical sync, so sessions time the same from
+             * one build to the next. Engine moves arrive whenever the engine
+             * is done thinking rather than in any given frame, so replays
+             * refuse engine players.
+             */
+            void replayEvents(std::string const &path, bool headless_) noexcept(false)
+            {
+                if(!engine_suits.empty())
+                {
+                    throw Exception("Replaying events can't be combined with engine players");
+                }
+                replay.reset(new EventLog::Replay{path});
+                headless = headless_;
+            }
         };
     }
 }
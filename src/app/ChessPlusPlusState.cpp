@@ -1,7 +1,5 @@
 #include "ChessPlusPlusState.hpp"
 
-#include "util/Utilities.hpp"
-
 #include <iostream>
 #include <algorithm>
 
@@ -16,17 +14,62 @@ namespace chesspp
         , board_config{res_config}
         , graphics{display, res_config, board_config}
         , board{board_config}
-        , players{util::KeyIter<config::BoardConfig::Textures_t>
-                               (board_config.texturePaths().cbegin()),
-                  util::KeyIter<config::BoardConfig::Textures_t>
-                               (board_config.texturePaths().cend())}
+        , players{board_config.suits()}
         , turn{players.find(board_config.metadata("first turn"))}
         {
             std::clog << "Number of players: " << players.size() << std::endl;
+            board.addListener([this](board::Move const &m, board::Board::Position_t const *captured)
+            {
+                distances.moved(m, captured);
+            });
             if(turn == players.end())
             {
                 turn = players.begin();
             }
+            if(!app.spectatorEndpoint().empty())
+            {
+#if defined(__linux__)
+                try
+                {
+                    spectators.reset(new net::SpectatorBroadcaster(net::Endpoint(app.spectatorEndpoint())));
+                    spectators->attach(board);
+                }
+                catch(std::exception &e)
+                {
+                    std::cerr << "Unable to broadcast to spectators: " << e.what() << std::endl;
+                }
+#else
+                std::cerr << "Broadcasting to spectators is not supported on this platform" << std::endl;
+#endif
+            }
+            if(!app.engineSuits().empty())
+            {
+#if defined(__linux__)
+                try
+                {
+                    engine.reset(new ipc::EngineProcess(app.enginePath(), board_config.path(), {players.begin(), players.end()}));
+                    board.addListener([this](board::Move const &m, board::Board::Position_t const *)
+                    {
+                        //the engine would go on searching a position the board has left behind
+                        if(engine && !engine->record(m))
+                        {
+                            std::cerr << "The engine can't follow games longer than " << ipc::EngineChannel::MaxHistory
+                                      << " moves, its suits are played by clicking from now on" << std::endl;
+                            engine.reset();
+                            engine_request = 0;
+                        }
+                    });
+                    think();
+                }
+                catch(std::exception &e)
+                {
+                    std::cerr << "Unable to start the engine: " << e.what() << std::endl;
+                    engine.reset();
+                }
+#else
+                std::cerr << "Engine players are not supported on this platform" << std::endl;
+#endif
+            }
         }
 
         void ChessPlusPlusState::nextTurn()
@@ -37,43 +80,157 @@ namespace chesspp
             }
         }
 
-        board::Board::Pieces_t::iterator ChessPlusPlusState::find(board::Board::Position_t const &pos) const
+        bool ChessPlusPlusState::engineTurn() const
         {
-            return std::find_if(board.begin(), board.end(),
-            [&](std::unique_ptr<piece::Piece> const &up) -> bool
+#if defined(__linux__)
+            return engine && app.engineSuits().count(*turn);
+#else
+            return false;
+#endif
+        }
+
+        void ChessPlusPlusState::think()
+        {
+#if defined(__linux__)
+            if(engineTurn())
             {
-                return up->pos == pos;
-            });
+                auto index = static_cast<std::size_t>(std::distance(players.cbegin(), turn));
+                engine_request = engine->search(index, engine_depth, engine_time);
+            }
+#endif
+        }
+
+        void ChessPlusPlusState::pollEngine()
+        {
+#if defined(__linux__)
+            if(!engine || !engine_request)
+            {
+                return;
+            }
+            try
+            {
+                engine->restartIfDead();
+            }
+            catch(std::exception &e)
+            {
+                std::cerr << "Unable to restart the engine: " << e.what() << std::endl;
+                engine.reset();
+                return;
+            }
+            ipc::EngineProcess::Info info;
+            if(!engine->poll(info) || info.request != engine_request)
+            {
+                return;
+            }
+            std::clog << *turn << " engine depth " << info.depth << " score " << info.score
+                      << " nodes " << info.nodes << " (" << info.nps << "/s)" << std::endl;
+            if(!info.final)
+            {
+                return;
+            }
+            engine_request = 0;
+            if(!info.found || info.pv.empty())
+            {
+                std::clog << *turn << " has no legal moves" << std::endl;
+                return;
+            }
+            auto source = board.find(info.pv.front().from);
+            if(source != board.end() && legal_moves.legal(board, *turn, info.pv.front()) && board.moveTo(source, info.pv.front().to))
+            {
+                nextTurn();
+                think();
+            }
+            else
+            {
+                std::cerr << "Engine suggested an illegal move " << info.pv.front() << std::endl;
+            }
+#endif
+        }
+
+        board::Board::Pieces_t::iterator ChessPlusPlusState::find(board::Board::Position_t const &pos) const
+        {
+            return board.find(pos);
         }
 
         void ChessPlusPlusState::onRender()
         {
+            pollEngine();
             graphics.drawBoard(board);
             if(selected != board.end())
             {
-                graphics.drawTrajectory(**selected);
+                graphics.drawMoves(**selected, legal_moves.legalMoves(board, (*selected)->suit));
             }
             if(board.valid(p))
             {
                 auto piece = find(p);
                 if(piece != board.end())
                 {
-                    graphics.drawTrajectory(**piece, (*piece)->suit != *turn);
+                    if(reach_moves)
+                    {
+                        if(auto d = distances.from(board, **piece, reach_moves))
+                        {
+                            graphics.drawDistances(*d, reach_moves);
+                        }
+                    }
+                    graphics.drawMoves(**piece, legal_moves.legalMoves(board, (*piece)->suit), (*piece)->suit != *turn);
                 }
             }
         }
 
+        void ChessPlusPlusState::onResized(uint w, uint h)
+        {
+            graphics.resize(w, h);
+        }
+        void ChessPlusPlusState::onKeyPressed(sf::Keyboard::Key key, bool alt, bool control, bool shift, bool system)
+        {
+            sf::Vector2i center {int(display.getSize().x/2), int(display.getSize().y/2)};
+            int const step = 64; //window pixels per key press
+            switch(key)
+            {
+            case sf::Keyboard::Add:      graphics.zoom(0.8f,  center);              break;
+            case sf::Keyboard::Subtract: graphics.zoom(1.25f, center);              break;
+            case sf::Keyboard::Left:     graphics.pan(sf::Vector2i( step,     0)); break;
+            case sf::Keyboard::Right:    graphics.pan(sf::Vector2i(-step,     0)); break;
+            case sf::Keyboard::Up:       graphics.pan(sf::Vector2i(    0,  step)); break;
+            case sf::Keyboard::Down:     graphics.pan(sf::Vector2i(    0, -step)); break;
+            default:
+                //number keys show where the piece under the mouse can get to in that many moves
+                if(key >= sf::Keyboard::Num0 && key <= sf::Keyboard::Num9)
+                {
+                    reach_moves = static_cast<std::size_t>(key - sf::Keyboard::Num0);
+                }
+                break;
+            }
+        }
+        void ChessPlusPlusState::onMouseWheelMoved(int delta, int x, int y)
+        {
+            graphics.zoom(delta > 0 ? 0.8f : 1.25f, sf::Vector2i(x, y));
+            p = graphics.cellAt(sf::Vector2i(x, y));
+        }
         void ChessPlusPlusState::onMouseMoved(int x, int y)
         {
-            p.x = static_cast<board::Board::Position_t::value_type>(x/board.config.cellWidth());
-            p.y = static_cast<board::Board::Position_t::value_type>(y/board.config.cellHeight());
+            if(dragging)
+            {
+                graphics.pan(sf::Vector2i(x - drag_from.x, y - drag_from.y));
+                drag_from = sf::Vector2i(x, y);
+            }
+            p = graphics.cellAt(sf::Vector2i(x, y));
+        }
+        void ChessPlusPlusState::onRButtonPressed(int x, int y)
+        {
+            dragging = true;
+            drag_from = sf::Vector2i(x, y);
+        }
+        void ChessPlusPlusState::onRButtonReleased(int x, int y)
+        {
+            dragging = false;
         }
         void ChessPlusPlusState::onLButtonPressed(int x, int y)
         {
         }
         void ChessPlusPlusState::onLButtonReleased(int x, int y)
         {
-            if(!board.valid(p)) return;
+            if(!board.valid(p) || engineTurn()) return;
             if(selected == board.end())
             {
                 selected = find(p); //doesn't matter if board.end(), selected won't change then
@@ -84,46 +241,11 @@ namespace chesspp
             }
             else
             {
-                if(find(p) == board.end() || (*find(p))->suit != (*selected)->suit)[&]
+                if(legal_moves.legal(board, *turn, board::Move((*selected)->pos, p)) && board.moveTo(selected, p))
                 {
-                    {
-                        auto it = std::find_if(board.pieceCapturings().begin(),
-                                               board.pieceCapturings().end(),
-                                               [&](board::Board::Movements_t::value_type const &m)
-                                               {
-                                                   return m.first == selected && m.second == p;
-                                               });
-                        if(it != board.pieceCapturings().end())
-                        {
-                            for(auto jt = board.pieceCapturables().begin(); jt != board.pieceCapturables().end(); ++jt)
-                            {
-                                if(jt->second == p)
-                                {
-                                    if(board.capture(selected, it, jt))
-                                    {
-                                        nextTurn();
-                                        return;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    {
-                        auto it = std::find_if(board.pieceTrajectories().begin(),
-                                               board.pieceTrajectories().end(),
-                                               [&](board::Board::Movements_t::value_type const &m)
-                                               {
-                                                   return m.first == selected && m.second == p;
-                                               });
-                        if(it != board.pieceTrajectories().end())
-                        {
-                            if(board.move(selected, it))
-                            {
-                                nextTurn();
-                            }
-                        }
-                    }
-                }();
+                    nextTurn();
+                    think();
+                }
                 selected = board.end(); //deselect
             }
         }
@@ -3,11 +3,20 @@
 
 #include "gfx/Graphics.hpp"
 #include "board/Board.hpp"
+#include "board/DistanceMap.hpp"
+#include "board/MoveCache.hpp"
+#if defined(__linux__)
+#include "net/SpectatorBroadcaster.hpp"
+#include "ipc/EngineProcess.hpp"
+#endif
 
 #include "AppState.hpp"
 #include "Application.hpp"
 
 #include <set>
+#include <memory>
+#include <chrono>
+#include <cstdint>
 
 namespace chesspp
 {
@@ -20,23 +29,48 @@ namespace chesspp
             config::BoardConfig board_config;
             gfx::GraphicsHandler graphics;
             board::Board board;
+            board::DistanceMaps distances;
+            std::size_t reach_moves = 0; //shown for the piece under the mouse, 0 for none
+            board::MoveCache legal_moves {256, 1}; //asked every frame while hovering
 
             board::Board::Pieces_t::iterator selected = board.end();
             board::Board::Position_t p;
+            bool dragging = false; //panning with the right mouse button
+            sf::Vector2i drag_from;
             using Players_t = std::set<board::Board::Suit>;
             Players_t players;
             Players_t::const_iterator turn;
+#if defined(__linux__)
+            std::unique_ptr<net::SpectatorBroadcaster> spectators;
+            std::unique_ptr<ipc::EngineProcess> engine;
+            std::uint32_t engine_request = 0; //0 while the engine is not thinking
+            unsigned const engine_depth = 4;
+            std::chrono::milliseconds const engine_time {2000}; //per move
+#endif
             void nextTurn();
+            bool engineTurn() const;
+            //Asks the engine for a move if it is its turn
+            void think();
+            void pollEngine();
             board::Board::Pieces_t::iterator find(board::Board::Position_t const &pos) const;
 
         public:
             ChessPlusPlusState(Application &app, sf::RenderWindow &display);
 
             virtual void onRender() override;
+            virtual board::Board const *shownBoard() const noexcept override
+            {
+                return &board;
+            }
 
+            virtual void onResized(uint w, uint h) override;
+            virtual void onKeyPressed(sf::Keyboard::Key key, bool alt, bool control, bool shift, bool system) override;
+            virtual void onMouseWheelMoved(int delta, int x, int y) override;
             virtual void onMouseMoved(int x, int y) override;
             virtual void onLButtonPressed(int x, int y) override;
             virtual void onLButtonReleased(int x, int y) override;
+            virtual void onRButtonPressed(int x, int y) override;
+            virtual void onRButtonReleased(int x, int y) override;
         };
     }
 }
@@ -0,0 +1,241 @@
+#include "EventLog.hpp"
+
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace chesspp
+{
+    namespace app
+    {
+        namespace
+        {
+            static std::pair<sf::Event::EventType, char const *> const types[]
+            {
+                {sf::Event::Closed,                 "Closed"},
+                {sf::Event::Resized,                "Resized"},
+                {sf::Event::LostFocus,              "LostFocus"},
+                {sf::Event::GainedFocus,            "GainedFocus"},
+                {sf::Event::TextEntered,            "TextEntered"},
+                {sf::Event::KeyPressed,             "KeyPressed"},
+                {sf::Event::KeyReleased,            "KeyReleased"},
+                {sf::Event::MouseWheelMoved,        "MouseWheelMoved"},
+                {sf::Event::MouseButtonPressed,     "MouseButtonPressed"},
+                {sf::Event::MouseButtonReleased,    "MouseButtonReleased"},
+                {sf::Event::MouseMoved,             "MouseMoved"},
+                {sf::Event::MouseEntered,           "MouseEntered"},
+                {sf::Event::MouseLeft,              "MouseLeft"},
+                {sf::Event::JoystickButtonPressed,  "JoystickButtonPressed"},
+                {sf::Event::JoystickButtonReleased, "JoystickButtonReleased"},
+                {sf::Event::JoystickMoved,          "JoystickMoved"},
+                {sf::Event::JoystickConnected,      "JoystickConnected"},
+                {sf::Event::JoystickDisconnected,   "JoystickDisconnected"}
+            };
+
+            static double microseconds(EventLog::Clock::duration d) noexcept
+            {
+                return std::chrono::duration<double, std::micro>(d).count();
+            }
+        }
+
+        char const *EventLog::name(sf::Event::EventType type) noexcept
+        {
+            for(auto const &t : types)
+            {
+                if(t.first == type)
+                {
+                    return t.second;
+                }
+            }
+            return nullptr;
+        }
+
+        bool EventLog::write(std::ostream &os, Entry const &e)
+        {
+            auto const *n = name(e.event.type);
+            if(!n)
+            {
+                return false;
+            }
+            os << e.frame << " " << e.at.count() << " " << n;
+            auto const &ev = e.event;
+            switch(ev.type)
+            {
+            case sf::Event::Resized:
+                os << " " << ev.size.width << " " << ev.size.height;
+                break;
+            case sf::Event::TextEntered:
+                os << " " << ev.text.unicode;
+                break;
+            case sf::Event::KeyPressed:
+            case sf::Event::KeyReleased:
+                os << " " << ev.key.code << " " << ev.key.alt << " " << ev.key.control << " " << ev.key.shift << " " << ev.key.system;
+                break;
+            case sf::Event::MouseWheelMoved:
+                os << " " << ev.mouseWheel.delta << " " << ev.mouseWheel.x << " " << ev.mouseWheel.y;
+                break;
+            case sf::Event::MouseButtonPressed:
+            case sf::Event::MouseButtonReleased:
+                os << " " << ev.mouseButton.button << " " << ev.mouseButton.x << " " << ev.mouseButton.y;
+                break;
+            case sf::Event::MouseMoved:
+                os << " " << ev.mouseMove.x << " " << ev.mouseMove.y;
+                break;
+            case sf::Event::JoystickButtonPressed:
+            case sf::Event::JoystickButtonReleased:
+                os << " " << ev.joystickButton.joystickId << " " << ev.joystickButton.button;
+                break;
+            case sf::Event::JoystickMoved:
+                os << " " << ev.joystickMove.joystickId << " " << ev.joystickMove.axis << " " << std::setprecision(9) << ev.joystickMove.position;
+                break;
+            case sf::Event::JoystickConnected:
+            case sf::Event::JoystickDisconnected:
+                os << " " << ev.joystickConnect.joystickId;
+                break;
+            default: break;
+            }
+            os << "\n";
+            return true;
+        }
+
+        EventLog::Entry EventLog::read(std::string const &line) noexcept(false)
+        {
+            std::istringstream is {line};
+            is.imbue(std::locale::classic());
+            Entry e {};
+            long long at = 0;
+            std::string type;
+            is >> e.frame >> at >> type;
+            e.at = std::chrono::microseconds(at);
+            auto t = std::find_if(std::begin(types), std::end(types), [&](std::pair<sf::Event::EventType, char const *> const &p)
+            {
+                return type == p.second;
+            });
+            if(!is || t == std::end(types))
+            {
+                throw Exception("Malformed event: " + line);
+            }
+            auto &ev = e.event;
+            ev.type = t->first;
+            int code = 0;
+            switch(ev.type)
+            {
+            case sf::Event::Resized:
+                is >> ev.size.width >> ev.size.height;
+                break;
+            case sf::Event::TextEntered:
+                is >> ev.text.unicode;
+                break;
+            case sf::Event::KeyPressed:
+            case sf::Event::KeyReleased:
+                is >> code >> ev.key.alt >> ev.key.control >> ev.key.shift >> ev.key.system;
+                ev.key.code = static_cast<sf::Keyboard::Key>(code);
+                break;
+            case sf::Event::MouseWheelMoved:
+                is >> ev.mouseWheel.delta >> ev.mouseWheel.x >> ev.mouseWheel.y;
+                break;
+            case sf::Event::MouseButtonPressed:
+            case sf::Event::MouseButtonReleased:
+                is >> code >> ev.mouseButton.x >> ev.mouseButton.y;
+                ev.mouseButton.button = static_cast<sf::Mouse::Button>(code);
+                break;
+            case sf::Event::MouseMoved:
+                is >> ev.mouseMove.x >> ev.mouseMove.y;
+                break;
+            case sf::Event::JoystickButtonPressed:
+            case sf::Event::JoystickButtonReleased:
+                is >> ev.joystickButton.joystickId >> ev.joystickButton.button;
+                break;
+            case sf::Event::JoystickMoved:
+                is >> ev.joystickMove.joystickId >> code >> ev.joystickMove.position;
+                ev.joystickMove.axis = static_cast<sf::Joystick::Axis>(code);
+                break;
+            case sf::Event::JoystickConnected:
+            case sf::Event::JoystickDisconnected:
+                is >> ev.joystickConnect.joystickId;
+                break;
+            default: break;
+            }
+            if(is.fail())
+            {
+                throw Exception("Malformed event: " + line);
+            }
+            return e;
+        }
+
+        EventLog::Recorder::Recorder(std::string const &path) noexcept(false)
+        : out{path, std::ios::trunc}
+        , start{Clock::now()}
+        {
+            if(!out)
+            {
+                throw Exception("Unable to record events to " + path);
+            }
+            out.imbue(std::locale::classic());
+        }
+        void EventLog::Recorder::record(std::size_t frame, sf::Event const &e)
+        {
+            //flushed as it goes, so a crash keeps the session that led up to it
+            if(write(out, Entry{frame, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start), e}))
+            {
+                out.flush();
+            }
+        }
+
+        EventLog::Replay::Replay(std::string const &path) noexcept(false)
+        {
+            std::ifstream in {path};
+            if(!in)
+            {
+                throw Exception("Unable to replay events from " + path);
+            }
+            for(std::string line; std::getline(in, line); )
+            {
+                if(!line.empty())
+                {
+                    entries.push_back(read(line));
+                }
+            }
+        }
+        bool EventLog::Replay::poll(std::size_t frame, sf::Event &e) noexcept
+        {
+            if(next == entries.size() || entries[next].frame > frame)
+            {
+                return false;
+            }
+            e = entries[next++].event;
+            return true;
+        }
+
+        void EventLog::Latencies::report(std::ostream &os)
+        {
+            os << std::left << std::setw(24) << "event" << std::right
+               << std::setw(8) << "count" << std::setw(10) << "mean us" << std::setw(10) << "p50 us"
+               << std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::endl;
+            os << std::fixed << std::setprecision(1);
+            for(auto const &t : types)
+            {
+                auto &d = by_type[t.first];
+                if(d.empty())
+                {
+                    continue;
+                }
+                std::sort(d.begin(), d.end());
+                Clock::duration total {0};
+                for(auto const &x : d)
+                {
+                    total += x;
+                }
+                os << std::left << std::setw(24) << t.second << std::right
+                   << std::setw(8) << d.size()
+                   << std::setw(10) << microseconds(total)/d.size()
+                   << std::setw(10) << microseconds(d[(d.size() - 1)*50/100])
+                   << std::setw(10) << microseconds(d[(d.size() - 1)*99/100])
+                   << std::setw(10) << microseconds(d.back()) << std::endl;
+            }
+        }
+    }
+}
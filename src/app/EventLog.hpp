@@ -0,0 +1,101 @@
+#ifndef ChessPlusPlus_App_EventLogClasses_HeaderPlusPlus
+#define ChessPlusPlus_App_EventLogClasses_HeaderPlusPlus
+
+#include "SFML.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace app
+    {
+        /**
+         * Window events as the Application received them, one per line:
+         *
+         *     <frame> <microseconds since the first frame> <event type> <fields...>
+         *
+         * Events are replayed by frame rather than by time: frame n of the
+         * replay handles exactly the events frame n of the recording did, no
+         * matter how long either took. The recorded times are the virtual
+         * clock the replay reports against. Event types are written by name,
+         * since SFML renumbers them between versions.
+         */
+        class EventLog
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            class Entry
+            {
+            public:
+                std::size_t frame;
+                std::chrono::microseconds at;
+                sf::Event event;
+            };
+
+            //Only the events the Application handles, false for the rest
+            static bool write(std::ostream &os, Entry const &e);
+            //Throws on a malformed line
+            static Entry read(std::string const &line) noexcept(false);
+            static char const *name(sf::Event::EventType type) noexcept;
+
+            class Recorder
+            {
+                std::ofstream out;
+                Clock::time_point const start;
+
+            public:
+                Recorder(std::string const &path) noexcept(false);
+
+                void record(std::size_t frame, sf::Event const &e);
+            };
+
+            class Replay
+            {
+                std::vector<Entry> entries;
+                std::size_t next = 0;
+
+            public:
+                Replay(std::string const &path) noexcept(false);
+
+                //The next event to handle in the given frame, false once the frame has none left
+                bool poll(std::size_t frame, sf::Event &e) noexcept;
+                bool finished() const noexcept
+                {
+                    return next == entries.size();
+                }
+                //When the recording got to the events handled so far
+                std::chrono::microseconds now() const noexcept
+                {
+                    return next? entries[next - 1].at : std::chrono::microseconds::zero();
+                }
+            };
+
+            //How long handling each type of event took
+            class Latencies
+            {
+                std::array<std::vector<Clock::duration>, sf::Event::Count> by_type;
+
+            public:
+                void add(sf::Event::EventType type, Clock::duration d)
+                {
+                    if(type < sf::Event::Count)
+                    {
+                        by_type[type].push_back(d);
+                    }
+                }
+
+                //Count, mean, p50, p99 and max per event type, in microseconds
+                void report(std::ostream &os);
+            };
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "PerformanceOverlay.hpp"
+
+#include "board/Board.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace app
+    {
+        namespace
+        {
+            //Window pixels
+            static constexpr float Margin = 8.0f, Width = 320.0f, GraphHeight = 80.0f, Height = 220.0f;
+            static constexpr float FrameMs60 = 1000.0f/60.0f;
+            static constexpr std::chrono::milliseconds LayOutEvery {250};
+
+            float milliseconds(PerformanceOverlay::Clock::duration d) noexcept
+            {
+                return std::chrono::duration<float, std::milli>(d).count();
+            }
+        }
+
+        PerformanceOverlay::PerformanceOverlay(sf::Font const &font)
+        : panel{sf::Vector2f(Width, Height)}
+        , text{"", font, 12}
+        {
+            panel.setPosition(Margin, Margin);
+            panel.setFillColor(sf::Color(0, 0, 0, 176));
+            text.setPosition(2*Margin, 3*Margin + GraphHeight);
+            text.setColor(sf::Color::White);
+        }
+
+        void PerformanceOverlay::frame(Clock::duration frame_time, Clock::duration render_time, std::size_t draws) noexcept
+        {
+            frame_ms[next] = milliseconds(frame_time);
+            next = (next + 1) % Frames;
+            frames = std::min(frames + 1, Frames);
+            render_ms = milliseconds(render_time);
+            draw_calls = draws;
+        }
+
+        void PerformanceOverlay::layOut(board::Board const *b, res::ResourceManager const &res)
+        {
+            auto percentile = [this](std::size_t p)
+            {
+                return frames? sorted[(frames - 1)*p/100] : 0.0f;
+            };
+            float const last = frames? frame_ms[(next + Frames - 1) % Frames] : 0.0f;
+            std::ostringstream os;
+            os << std::fixed << std::setprecision(1)
+               << "frame " << last << " ms (" << (last > 0.0f? 1000.0f/last : 0.0f) << " fps), render " << render_ms << " ms" << std::endl
+               << "p50 " << percentile(50) << "  p90 " << percentile(90) << "  p99 " << percentile(99) << "  max " << percentile(100) << " ms" << std::endl
+               << "draw calls " << draw_calls << std::endl;
+            if(b)
+            {
+                os << std::setprecision(3) << "last move update " << milliseconds(b->lastUpdate()) << " ms" << std::endl
+                   << "trajectories " << b->pieceTrajectories().size() << ", capturings " << b->pieceCapturings().size()
+                   << ", capturables " << b->pieceCapturables().size() << std::endl;
+            }
+            else
+            {
+                os << "no board" << std::endl << std::endl;
+            }
+            os << "resources " << res.size() << std::endl
+               << std::setprecision(3) << "overlay " << overlay_ms << " ms";
+            text.setString(os.str());
+        }
+
+        void PerformanceOverlay::draw(sf::RenderWindow &display, board::Board const *b, res::ResourceManager const &res)
+        {
+            auto const start = Clock::now();
+            sf::View const view = display.getView();
+            display.setView(sf::View(sf::FloatRect(0, 0, display.getSize().x, display.getSize().y)));
+
+            std::copy(frame_ms.begin(), frame_ms.begin() + frames, sorted.begin());
+            std::sort(sorted.begin(), sorted.begin() + frames);
+            if(start - laid_out >= LayOutEvery)
+            {
+                layOut(b, res);
+                laid_out = start;
+            }
+
+            //the slowest frame or two frames at 60 per second, whichever is higher, at the top
+            float const top = std::max(2*FrameMs60, frames? sorted[frames - 1] : 0.0f);
+            float const left = 2*Margin, bottom = 2*Margin + GraphHeight, width = Width - 2*Margin;
+            auto y = [&](float ms)
+            {
+                return bottom - GraphHeight*ms/top;
+            };
+            curve.resize(frames);
+            for(std::size_t i = 0; i < frames; ++i)
+            {
+                float const x = left + (frames > 1? width*i/(frames - 1) : 0.0f);
+                curve[i] = sf::Vertex(sf::Vector2f(x, y(sorted[i])), sf::Color::Green);
+            }
+            guide.resize(2);
+            guide[0] = sf::Vertex(sf::Vector2f(left,         y(FrameMs60)), sf::Color(255, 255, 255, 96));
+            guide[1] = sf::Vertex(sf::Vector2f(left + width, y(FrameMs60)), sf::Color(255, 255, 255, 96));
+
+            //not counted as draw calls, those are the state's
+            display.draw(panel);
+            display.draw(guide);
+            display.draw(curve);
+            display.draw(text);
+            display.setView(view);
+            overlay_ms = milliseconds(Clock::now() - start);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ChessPlusPlus_App_PerformanceOverlayClass_HeaderPlusPlus
+#define ChessPlusPlus_App_PerformanceOverlayClass_HeaderPlusPlus
+
+#include "SFML.hpp"
+#include "res/ResourceManager.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace chesspp
+{
+    namespace board
+    {
+        class Board;
+    }
+    namespace app
+    {
+        /**
+         * Frame times, draw calls, the time the last move took to update the
+         * board and the sizes of its movement maps and of the resource cache,
+         * drawn by the Application over whatever state is showing.
+         *
+         * The times of the last Frames frames are plotted sorted, so the
+         * curve reads as their percentiles, under a line at 60 frames per
+         * second. Laying out text is what costs, so it is only redone a few
+         * times a second.
+         */
+        class PerformanceOverlay
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            static constexpr std::size_t Frames = 240;
+
+        private:
+            bool shown = false;
+            std::array<float, Frames> frame_ms, sorted; //milliseconds
+            std::size_t frames = 0;                     //recorded, up to Frames
+            std::size_t next = 0;
+            float render_ms = 0.0f, overlay_ms = 0.0f;
+            std::size_t draw_calls = 0;
+            Clock::time_point laid_out;
+            sf::RectangleShape panel;
+            sf::VertexArray curve {sf::LinesStrip}, guide {sf::Lines};
+            sf::Text text;
+
+            void layOut(board::Board const *b, res::ResourceManager const &res);
+
+        public:
+            PerformanceOverlay(sf::Font const &font);
+
+            void toggle() noexcept
+            {
+                shown = !shown;
+            }
+            bool visible() const noexcept
+            {
+                return shown;
+            }
+
+            //Records a frame: the time since the one before, how long the state took to render and its draw calls
+            void frame(Clock::duration frame_time, Clock::duration render_time, std::size_t draws) noexcept;
+
+            //Draws over the state in window pixels, leaving the view as it was
+            void draw(sf::RenderWindow &display, board::Board const *b, res::ResourceManager const &res);
+        };
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "ChessPlusPlusState.hpp"
 #include "res/SfmlFileResource.hpp"
+#include "gfx/DrawCalls.hpp"
 
 #include <iostream>
 
@@ -36,10 +37,10 @@ namespace chesspp
         void StartMenuState::onRender()
         {
             display.clear();
-            display.draw(menu_background);
-            display.draw(logo);
-            display.draw(start_text);
-            display.draw(quit_text);
+            gfx::DrawCalls::draw(display, menu_background);
+            gfx::DrawCalls::draw(display, logo);
+            gfx::DrawCalls::draw(display, start_text);
+            gfx::DrawCalls::draw(display, quit_text);
         }
 
         void StartMenuState::onLButtonReleased(int x, int y)
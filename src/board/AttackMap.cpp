@@ -0,0 +1,146 @@
+#include "AttackMap.hpp"
+
+#include <algorithm>
+
+namespace chesspp
+{
+    namespace board
+    {
+        AttackMap::AttackMap(config::BoardConfig const &conf, util::BitKernels const &k)
+        : width{conf.boardWidth()}
+        , height{conf.boardHeight()}
+        , steps{width, height, k}
+        , empty{width, height}
+        , none{width, height}
+        {
+        }
+
+        auto AttackMap::group(piece::Piece const &p)
+        -> Group &
+        {
+            for(auto &g : groups)
+            {
+                if(g.suit == p.suit && g.pattern.leaps == pattern.leaps && g.pattern.slides == pattern.slides)
+                {
+                    return g;
+                }
+            }
+            groups.push_back(Group{p.suit, pattern, Bitboard{width, height}});
+            return groups.back();
+        }
+
+        Bitboard &AttackMap::bitboard(std::map<Offset_t, Bitboard> &m, Offset_t const &o)
+        {
+            auto it = m.find(o);
+            if(it == m.end())
+            {
+                it = m.emplace(o, Bitboard{width, height}).first;
+            }
+            return it->second;
+        }
+
+        void AttackMap::compute(Board const &b)
+        {
+            empty.fill();
+            for(auto &g : groups)
+            {
+                g.pieces.clear();
+            }
+            for(auto &src : sources)
+            {
+                for(auto &l : src.second.leaps)
+                {
+                    l.second.clear();
+                }
+                for(auto &l : src.second.slides)
+                {
+                    l.second.clear();
+                }
+            }
+            for(auto &a : attacks)
+            {
+                a.second.clear();
+            }
+
+            std::vector<piece::Piece const *> undescribed;
+            for(auto const &p : b)
+            {
+                empty.reset(p->pos);
+                pattern.leaps.clear();
+                pattern.slides.clear();
+                if(p->attackPattern(pattern))
+                {
+                    group(*p).pieces.set(p->pos);
+                }
+                else
+                {
+                    undescribed.push_back(p.get());
+                    if(attacks.find(p->suit) == attacks.end())
+                    {
+                        attacks.emplace(p->suit, Bitboard{width, height});
+                    }
+                }
+            }
+
+            for(auto const &g : groups)
+            {
+                if(g.pieces.empty())
+                {
+                    continue;
+                }
+                auto &src = sources[g.suit];
+                for(auto const &o : g.pattern.leaps)
+                {
+                    auto &bb = bitboard(src.leaps, o);
+                    steps.kernels().orInto(bb.data(), g.pieces.data(), bb.words());
+                }
+                for(auto const &o : g.pattern.slides)
+                {
+                    auto &bb = bitboard(src.slides, o);
+                    steps.kernels().orInto(bb.data(), g.pieces.data(), bb.words());
+                }
+            }
+            for(auto const &src : sources)
+            {
+                auto it = attacks.find(src.first);
+                if(it == attacks.end())
+                {
+                    it = attacks.emplace(src.first, Bitboard{width, height}).first;
+                }
+                auto &out = it->second;
+                for(auto const &l : src.second.leaps)
+                {
+                    if(!l.second.empty())
+                    {
+                        steps.leap(out, l.second, l.first);
+                    }
+                }
+                for(auto const &l : src.second.slides)
+                {
+                    if(!l.second.empty())
+                    {
+                        steps.slide(out, l.second, l.first, empty);
+                    }
+                }
+            }
+
+            if(!undescribed.empty())
+            {
+                std::sort(undescribed.begin(), undescribed.end());
+                for(auto const &c : b.pieceCapturings())
+                {
+                    if(std::binary_search(undescribed.begin(), undescribed.end(), c.first->get()))
+                    {
+                        attacks.at((*c.first)->suit).set(c.second);
+                    }
+                }
+            }
+        }
+
+        Bitboard const &AttackMap::of(Board::Suit const &s) const
+        {
+            auto it = attacks.find(s);
+            return it == attacks.end() ? none : it->second;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef ChessPlusPlus_Board_BitboardAttackMapClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_BitboardAttackMapClass_HeaderPlusPlus
+
+#include "board/Board.hpp"
+#include "board/Bitboard.hpp"
+#include "board/Steps.hpp"
+#include "piece/Piece.hpp"
+#include "util/BitKernels.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * The cells each suit could capture at, as bitboards, computed from
+         * the pieces' attack patterns with whole-board bitset operations
+         * rather than piece by piece. Pieces attacking with the same leap or
+         * slide are moved together with Steps.
+         *
+         * The result is the same as collecting every piece's capturings from
+         * the board. Pieces without an attack pattern are handled that way.
+         * Keep one AttackMap per board size and reuse it, it caches masks and
+         * buffers between calls.
+         */
+        class AttackMap
+        {
+        public:
+            using Offset_t = Steps::Offset_t;
+
+        private:
+            std::size_t const width, height;
+            Steps steps;
+            Bitboard empty;
+            Bitboard const none;
+
+            //Pieces of one suit with the same pattern
+            class Group
+            {
+            public:
+                Board::Suit suit;
+                piece::Piece::Pattern pattern;
+                Bitboard pieces;
+            };
+            std::vector<Group> groups;
+            //Pieces of one suit by the offsets they attack with, so each offset is stepped once
+            class Sources
+            {
+            public:
+                std::map<Offset_t, Bitboard> leaps, slides;
+            };
+            std::map<Board::Suit, Sources> sources;
+            std::map<Board::Suit, Bitboard> attacks;
+            piece::Piece::Pattern pattern; //reused for each piece
+
+            Group &group(piece::Piece const &p);
+            Bitboard &bitboard(std::map<Offset_t, Bitboard> &m, Offset_t const &o);
+
+        public:
+            AttackMap(config::BoardConfig const &conf, util::BitKernels const &k = util::BitKernels::best());
+
+            //Recomputes every suit's attacked cells for the board as it is now
+            void compute(Board const &b);
+
+            //The cells a suit attacks, empty for suits with no pieces
+            Bitboard const &of(Board::Suit const &s) const;
+            bool attacked(Board::Suit const &s, Board::Position_t const &p) const
+            {
+                return of(s).test(p);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef ChessPlusPlus_Board_BoardBitsetClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_BoardBitsetClass_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+#include "util/BitKernels.hpp"
+#include "util/Bits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * One bit per cell of a board of any size, row by row, so cell (x, y)
+         * is bit y*width + x. Bits past the last cell are always 0.
+         */
+        class Bitboard
+        {
+        public:
+            using Position_t = config::BoardConfig::Position_t;
+            using Word_t = util::BitKernels::Word_t;
+
+        private:
+            std::size_t w, h;
+            std::vector<Word_t> bits;
+
+        public:
+            Bitboard(std::size_t width, std::size_t height)
+            : w{width}
+            , h{height}
+            , bits((width*height + 63)/64)
+            {
+            }
+
+            std::size_t width() const noexcept { return w; }
+            std::size_t height() const noexcept { return h; }
+            std::size_t words() const noexcept { return bits.size(); }
+            Word_t       *data()       noexcept { return bits.data(); }
+            Word_t const *data() const noexcept { return bits.data(); }
+
+            bool test(Position_t const &p) const noexcept
+            {
+                std::size_t i = p.y*w + p.x;
+                return bits[i/64] >> (i%64) & 1;
+            }
+            void set(Position_t const &p) noexcept
+            {
+                std::size_t i = p.y*w + p.x;
+                bits[i/64] |= Word_t(1) << (i%64);
+            }
+            void reset(Position_t const &p) noexcept
+            {
+                std::size_t i = p.y*w + p.x;
+                bits[i/64] &= ~(Word_t(1) << (i%64));
+            }
+            void clear() noexcept
+            {
+                std::fill(bits.begin(), bits.end(), Word_t(0));
+            }
+            //Sets every cell
+            void fill() noexcept
+            {
+                std::fill(bits.begin(), bits.end(), ~Word_t(0));
+                if((w*h)%64)
+                {
+                    bits.back() = (Word_t(1) << ((w*h)%64)) - 1;
+                }
+            }
+
+            std::size_t count() const noexcept
+            {
+                std::size_t n = 0;
+                for(Word_t v : bits)
+                {
+                    n += util::popCount(v);
+                }
+                return n;
+            }
+            bool empty() const noexcept
+            {
+                for(Word_t v : bits)
+                {
+                    if(v) return false;
+                }
+                return true;
+            }
+
+            //Calls f with the position of every set cell
+            template<typename Func>
+            void forEach(Func f) const
+            {
+                for(std::size_t i = 0; i < bits.size(); ++i)
+                {
+                    for(Word_t v = bits[i]; v; v &= v - 1)
+                    {
+                        std::size_t cell = i*64 + util::lowestBit(v);
+                        f(Position_t(static_cast<Position_t::value_type>(cell%w), static_cast<Position_t::value_type>(cell/w)));
+                    }
+                }
+            }
+
+            friend bool operator==(Bitboard const &a, Bitboard const &b) noexcept
+            {
+                return a.w == b.w && a.h == b.h && a.bits == b.bits;
+            }
+        };
+    }
+}
+
+#endif
@@ -1,41 +1,173 @@
 #include "Board.hpp"
 
 #include "piece/Piece.hpp"
+#include "util/Allocations.hpp"
+#include "util/Metrics.hpp"
 
+#include <initializer_list>
 #include <iostream>
+#include <map>
 
 namespace chesspp
 {
     namespace board
     {
+        namespace
+        {
+            //FNV-1a, unlike std::hash it is the same in every process
+            static std::uint64_t hashString(std::string const &s) noexcept
+            {
+                std::uint64_t h = 14695981039346656037ULL;
+                for(char c : s)
+                {
+                    h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+                }
+                return h;
+            }
+            //splitmix64 finalizer
+            static std::uint64_t mix(std::uint64_t h) noexcept
+            {
+                h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+                return h ^ (h >> 31);
+            }
+
+            struct BoardMetrics
+            {
+                util::Metrics::Counter &moves;
+                util::Metrics::Histogram &update_ns;
+            };
+            //Registered on first use, so tools that never move don't export them
+            static BoardMetrics &metrics()
+            {
+                static BoardMetrics m
+                {
+                    util::Metrics::global().counter("chesspp_board_moves_total", "Moves made on boards other than copies made to search"),
+                    util::Metrics::global().histogram("chesspp_board_update_seconds", "Time Board::update took after a move", util::Metrics::exponential(1000, 2, 16), 1e-9)
+                };
+                return m;
+            }
+        }
+
         Board::Board(config::BoardConfig const &conf)
         : config(conf) //can't use {}
+        , occupancy{conf.boardWidth(), conf.boardHeight(), Occupancy_t::choose(conf.boardWidth(), conf.boardHeight(), conf.initialLayout().size())}
+        , passing{conf.boardWidth(), conf.boardHeight(), Passing_t::choose(conf.boardWidth(), conf.boardHeight(), conf.initialLayout().size())}
+        , no_attacks{conf.boardWidth(), conf.boardHeight()}
         {
-            for(auto const &slot : conf.initialLayout())
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+            place(conf.initialLayout());
+            symmetric = std::make_shared<std::vector<Symmetry> const>(Symmetry::of(*this));
+            keys.assign(symmetric->size(), 0);
+            for(auto const &p : pieces)
             {
-                pieces.emplace(factory().at(slot.second.first)(*this, slot.first, slot.second.second));
+                toggle(*p);
             }
+        }
 
+        Board::Board(Board const &like, config::BoardConfig::Layout_t const &layout)
+        : config(like.config) //can't use {}
+        , occupancy{like.config.boardWidth(), like.config.boardHeight(), Occupancy_t::choose(like.config.boardWidth(), like.config.boardHeight(), layout.size())}
+        , passing{like.config.boardWidth(), like.config.boardHeight(), Passing_t::choose(like.config.boardWidth(), like.config.boardHeight(), layout.size())}
+        , no_attacks{like.config.boardWidth(), like.config.boardHeight()}
+        , symmetric{like.symmetric}
+        , log_moves{false}
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            gen = like.gen;
+#endif
+            place(layout);
+            keys.assign(symmetric->size(), 0);
             for(auto const &p : pieces)
             {
-                p->makeTrajectory();
+                toggle(*p);
             }
         }
 
-        bool Board::occupied(Position_t const &pos) const noexcept
+        Board::Board(Board const &other)
+        : config(other.config) //can't use {}
+        , occupancy{other.config.boardWidth(), other.config.boardHeight(), other.occupancy.storage()}
+        , passing{other.config.boardWidth(), other.config.boardHeight(), other.passing.storage()}
+        , no_attacks{other.config.boardWidth(), other.config.boardHeight()}
+        , symmetric{other.symmetric}
+        , keys(other.keys) //can't use {}
+        , log_moves{false}
         {
-            for(auto const &p : *this)
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            gen = other.gen;
+#endif
+            for(auto const &p : other.pieces)
             {
-                if(p->pos == pos)
-                {
-                    return true;
-                }
+                util::Allocations::Scope piece_tag {util::Allocations::Subsystem::Piece};
+                auto it = pieces.emplace(p->clone(*this)).first;
+                occupancy.insert(p->pos, it);
             }
-            return false;
+
+            for(auto const &p : pieces)
+            {
+                calculate(*p);
+            }
+        }
+
+        void Board::place(config::BoardConfig::Layout_t const &layout)
+        {
+            for(auto const &slot : layout)
+            {
+                util::Allocations::Scope piece_tag {util::Allocations::Subsystem::Piece};
+                auto it = pieces.emplace(factory().at(slot.second.first)(*this, slot.first, slot.second.second)).first;
+                occupancy.insert(slot.first, it);
+            }
+
+            for(auto const &p : pieces)
+            {
+                calculate(*p);
+            }
+        }
+
+        void Board::calculate(piece::Piece &p)
+        {
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            if(gen == Generation::Reference)
+            {
+                p.addCapturable(p.pos);
+                p.calcReference();
+                return;
+            }
+#endif
+            p.makeTrajectory();
+        }
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+        void Board::generation(Generation g)
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+            gen = g;
+            trajectories.clear();
+            capturings.clear();
+            capturables.clear();
+            attacks.clear();
+            passing.clear();
+            for(auto const &p : pieces)
+            {
+                calculate(*p);
+            }
+        }
+#endif
+
+        bool Board::occupied(Position_t const &pos) const noexcept
+        {
+            return occupancy.find(pos) != nullptr;
         }
         auto Board::find(piece::Piece const &p) const noexcept
         -> Pieces_t::const_iterator
         {
+            //a piece on this board is indexed at its position
+            auto it = occupancy.find(p.pos);
+            if(it && (*it)->get() == std::addressof(p))
+            {
+                return *it;
+            }
             return std::find_if
             (
                 std::begin(pieces),
@@ -47,6 +179,18 @@ namespace chesspp
             );
         }
 
+        auto Board::find(Position_t const &pos) const noexcept
+        -> Pieces_t::const_iterator
+        {
+            auto it = occupancy.find(pos);
+            return it ? *it : pieces.cend();
+        }
+        bool Board::nearestBlocker(Position_t const &from, util::Direction d, Position_t &blocker) const noexcept
+        {
+            auto step = util::Offset(d);
+            return occupancy.ray(from, step.first, step.second, blocker);
+        }
+
         void Board::Movements::add(piece::Piece const &p, Position_t const &tile)
         {
             if(b.valid(tile))
@@ -55,6 +199,11 @@ namespace chesspp
                 if(it != b.end())
                 {
                     m.insert(Movements_t::value_type(it, tile));
+                    b.pass(p, tile, true);
+                    if(&m == &b.capturings)
+                    {
+                        b.attack(p.suit, tile, true);
+                    }
                 }
             }
         }
@@ -68,6 +217,11 @@ namespace chesspp
                 {
                     if(jt->second == tile)
                     {
+                        if(&m == &b.capturings)
+                        {
+                            b.attack(p.suit, tile, false);
+                        }
+                        b.pass(p, tile, false);
                         jt = m.erase(jt);
                     }
                     else ++jt;
@@ -94,15 +248,179 @@ namespace chesspp
             return {{range.first, range.second}};
         }
 
-        void Board::update(Position_t const &pos)
+        std::size_t Board::attackers(Suit const &s, Position_t const &pos) const noexcept
         {
-            trajectories.clear();
-            capturings.clear();
-            capturables.clear();
-            for(auto &p : pieces)
+            auto it = attacks.find(s);
+            if(it == attacks.end() || !valid(pos))
+            {
+                return 0;
+            }
+            return it->second.counts[pos.y*config.boardWidth() + pos.x];
+        }
+        Bitboard const &Board::attacked(Suit const &s) const noexcept
+        {
+            auto it = attacks.find(s);
+            return it == attacks.end() ? no_attacks : it->second.cells;
+        }
+
+        std::uint64_t Board::key(piece::Piece const &p, std::size_t symmetry, std::uint64_t hash_state) const noexcept
+        {
+            //pieces that have moved more than once behave the same from then on
+            std::uint64_t const moved = std::min<std::uint64_t>(p.moves, 2) << 16;
+            auto const &s = (*symmetric)[symmetry];
+            Position_t const pos = s(p.pos);
+            std::uint64_t state = pos.x | (pos.y << 8) | moved | (hash_state << 18);
+            return mix(hashString(s(p.suit)) ^ mix(hashString(p.pclass) ^ mix(state)));
+        }
+        void Board::toggle(piece::Piece const &p) noexcept
+        {
+            for(std::size_t i = 0; i < keys.size(); ++i)
+            {
+                keys[i] ^= key(p, i, p.hashState());
+            }
+        }
+        void Board::tick(piece::Piece &p, Position_t const &to) noexcept
+        {
+            std::uint64_t const before = p.hashState();
+            p.tick(to);
+            std::uint64_t const after = p.hashState();
+            if(after != before)
             {
-                p->tick(pos);
-                p->makeTrajectory();
+                for(std::size_t i = 0; i < keys.size(); ++i)
+                {
+                    keys[i] ^= key(p, i, before) ^ key(p, i, after);
+                }
+            }
+        }
+        std::uint64_t Board::rehash(std::size_t symmetry) const noexcept
+        {
+            std::uint64_t h = 0;
+            for(auto const &p : pieces)
+            {
+                h ^= key(*p, symmetry, p->hashState());
+            }
+            return h;
+        }
+
+        void Board::attack(Suit const &s, Position_t const &tile, bool add)
+        {
+            auto it = attacks.find(s);
+            if(it == attacks.end())
+            {
+                std::size_t w = config.boardWidth(), h = config.boardHeight();
+                it = attacks.emplace(s, Attacks{std::vector<std::uint16_t>(w*h), Bitboard{w, h}}).first;
+            }
+            auto &count = it->second.counts[tile.y*config.boardWidth() + tile.x];
+            if(add)
+            {
+                if(count++ == 0)
+                {
+                    it->second.cells.set(tile);
+                }
+            }
+            else if(count && --count == 0)
+            {
+                it->second.cells.reset(tile);
+            }
+        }
+
+        void Board::pass(piece::Piece const &p, Position_t const &tile, bool add)
+        {
+            auto *through = passing.find(tile);
+            if(add)
+            {
+                if(through)
+                {
+                    through->push_back(&p);
+                }
+                else
+                {
+                    passing.insert(tile, {&p});
+                }
+                return;
+            }
+            if(!through)
+            {
+                return;
+            }
+            auto it = std::find(through->begin(), through->end(), &p);
+            if(it != through->end())
+            {
+                *it = through->back();
+                through->pop_back();
+            }
+            if(through->empty())
+            {
+                passing.erase(tile);
+            }
+        }
+
+        void Board::forget(Pieces_t::const_iterator it)
+        {
+            auto range = capturings.equal_range(it);
+            for(auto jt = range.first; jt != range.second; ++jt)
+            {
+                attack((*it)->suit, jt->second, false);
+            }
+            for(auto *m : {&trajectories, &capturings, &capturables})
+            {
+                auto r = m->equal_range(it);
+                for(auto jt = r.first; jt != r.second; ++jt)
+                {
+                    pass(**it, jt->second, false);
+                }
+                m->erase(r.first, r.second);
+            }
+        }
+
+        void Board::update(Pieces_t::const_iterator moved, Position_t const &from, Position_t const *captured)
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+            //only the cells the move emptied or filled changed, so only pieces with
+            //movements at one of them can be affected, unless they say otherwise
+            Position_t const &to = (*moved)->pos;
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            if(gen == Generation::Reference)
+            {
+                //as before movements were updated incrementally
+                trajectories.clear();
+                capturings.clear();
+                capturables.clear();
+                attacks.clear();
+                passing.clear();
+                for(auto const &p : pieces)
+                {
+                    tick(*p, to);
+                    calculate(*p);
+                }
+                return;
+            }
+#endif
+            std::vector<piece::Piece const *> touched;
+            for(auto const *tile : {&from, &to, captured})
+            {
+                auto const *through = tile? passing.find(*tile) : nullptr;
+                if(through)
+                {
+                    touched.insert(touched.end(), through->begin(), through->end());
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+
+            std::vector<Pieces_t::const_iterator> outdated;
+            for(auto it = pieces.cbegin(); it != pieces.cend(); ++it)
+            {
+                auto &p = **it;
+                if(it == moved || p.outdated(std::binary_search(touched.begin(), touched.end(), &p)))
+                {
+                    outdated.push_back(it);
+                }
+                tick(p, to);
+            }
+            for(auto it : outdated)
+            {
+                forget(it);
+                calculate(**it);
             }
         }
 
@@ -123,11 +441,23 @@ namespace chesspp
                 std::cerr << "capturable may not be captured at target" << std::endl;
             }
 
-            pieces.erase(capturable->first);
-            std::clog << "Capture: ";
-            return move(source, target); //re-use existing code
+            auto victim = capturable->first;
+            Position_t captured = (*victim)->pos; //differs from the target for en passant
+            occupancy.erase(captured);
+            toggle(**victim);
+            forget(victim);
+            pieces.erase(victim);
+            if(log_moves)
+            {
+                std::clog << "Capture: ";
+            }
+            return move(source, target, &captured); //re-use existing code
         }
         bool Board::move(Pieces_t::iterator source, Movements_t::const_iterator target)
+        {
+            return move(source, target, nullptr);
+        }
+        bool Board::move(Pieces_t::iterator source, Movements_t::const_iterator target, Position_t const *captured)
         {
             if(source == pieces.end())
             {
@@ -157,12 +487,145 @@ namespace chesspp
                 return false;
             }
 
-            std::clog << "Moved piece at " << (*source)->pos << std::flush;
-            auto t = target->second;
-            (*source)->move(t);
-            update(t);
-            std::clog << " to " << t << std::endl;
+            Move m {(*source)->pos, target->second};
+            occupancy.erase(m.from);
+            occupancy.insert(m.to, source);
+            toggle(**source);
+            (*source)->move(m.to);
+            toggle(**source);
+            if(log_moves)
+            {
+                //copies made to search don't log their moves, so they aren't timed either
+                auto const start = std::chrono::steady_clock::now();
+                update(source, m.from, captured);
+                update_time = std::chrono::steady_clock::now() - start;
+                auto &stats = metrics();
+                stats.moves.add();
+                stats.update_ns.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(update_time).count()));
+                std::clog << "Moved piece at " << m.from << " to " << m.to << std::endl;
+            }
+            else
+            {
+                update(source, m.from, captured);
+            }
+            for(auto const &l : listeners)
+            {
+                l(m, captured);
+            }
             return true;
         }
+        bool Board::moveTo(Pieces_t::iterator source, Position_t const &tile)
+        {
+            if(source == pieces.end())
+            {
+                std::cerr << "source iterator of piece to move is invalid" << std::endl;
+                return false;
+            }
+            auto occupant = find(tile);
+            if(occupant != pieces.end() && (*occupant)->suit == (*source)->suit)
+            {
+                return false; //can't capture own pieces
+            }
+            {
+                auto it = std::find_if(capturings.cbegin(), capturings.cend(),
+                                       [&](Movements_t::value_type const &m)
+                                       {
+                                           return m.first == source && m.second == tile;
+                                       });
+                if(it != capturings.cend())
+                {
+                    //a piece on the tile is the one captured, even if another can be captured there en passant
+                    auto victims = std::make_pair(capturables.cbegin(), capturables.cend());
+                    if(occupant != pieces.end())
+                    {
+                        victims = capturables.equal_range(occupant);
+                    }
+                    for(auto jt = victims.first; jt != victims.second; ++jt)
+                    {
+                        if(jt->second == tile && (*jt->first)->suit != (*source)->suit)
+                        {
+                            return capture(source, it, jt);
+                        }
+                    }
+                }
+            }
+            {
+                auto it = std::find_if(trajectories.cbegin(), trajectories.cend(),
+                                       [&](Movements_t::value_type const &m)
+                                       {
+                                           return m.first == source && m.second == tile;
+                                       });
+                if(it != trajectories.cend())
+                {
+                    return move(source, it);
+                }
+            }
+            return false;
+        }
+
+        auto Board::legalMoves(Suit const &s) const
+        -> MoveList_t
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Board};
+            std::set<Position_t> enemy_capturable;
+            for(auto const &c : capturables)
+            {
+                if((*c.first)->suit != s)
+                {
+                    enemy_capturable.insert(c.second);
+                }
+            }
+
+            MoveList_t moves;
+            for(auto const &t : trajectories)
+            {
+                if((*t.first)->suit == s && !occupied(t.second))
+                {
+                    moves.emplace_back((*t.first)->pos, t.second);
+                }
+            }
+            for(auto const &c : capturings)
+            {
+                if((*c.first)->suit != s || !enemy_capturable.count(c.second))
+                {
+                    continue;
+                }
+                //a piece on the cell must itself be capturable there
+                auto occupant = occupancy.find(c.second);
+                if(!occupant)
+                {
+                    moves.emplace_back((*c.first)->pos, c.second);
+                }
+                else if((**occupant)->suit != s)
+                {
+                    auto range = capturables.equal_range(*occupant);
+                    if(std::any_of(range.first, range.second, [&](Movements_t::value_type const &v)
+                    {
+                        return v.second == c.second;
+                    }))
+                    {
+                        moves.emplace_back((*c.first)->pos, c.second);
+                    }
+                }
+            }
+            std::sort(moves.begin(), moves.end());
+            moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+            return moves;
+        }
+
+        std::uint64_t Board::canonicalHash(Suit const &turn, std::size_t &symmetry) const noexcept
+        {
+            std::uint64_t best = 0;
+            for(std::size_t i = 0; i < keys.size(); ++i)
+            {
+                std::uint64_t key = keys[i] ^ mix(hashString((*symmetric)[i](turn)) + 1);
+                if(i == 0 || key < best)
+                {
+                    best = key;
+                    symmetry = i;
+                }
+            }
+            return best;
+        }
     }
 }
@@ -2,14 +2,22 @@
 #define ChessPlusPlus_Board_GeneralizedChessBoardClass_HeaderPlusPlus
 
 #include "config/BoardConfig.hpp"
+#include "board/Bitboard.hpp"
+#include "board/Move.hpp"
+#include "board/Occupancy.hpp"
+#include "board/Symmetry.hpp"
 #include "util/Utilities.hpp"
+#include "util/Position.hpp"
 
 #include <map>
 #include <set>
+#include <vector>
 #include <memory>
 #include <functional>
 #include <typeinfo>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 namespace chesspp
 {
@@ -37,13 +45,48 @@ namespace chesspp
         public:
             using Movements_t = std::multimap<Pieces_t::const_iterator, Position_t, Pieces_t_const_iterator_compare>;
             using Factory_t = std::map<config::BoardConfig::PieceClass_t, std::function<Pieces_t::value_type (Board &, Position_t const &, Suit const &)>>; //Used to create new pieces
+            using Listener_t = std::function<void (Move const &m, Position_t const *captured)>; //Notified of each move
 
             config::BoardConfig const &config;
         private:
             Pieces_t pieces;
+            using Occupancy_t = Occupancy<Pieces_t::const_iterator>;
+            Occupancy_t occupancy;    //pieces by position
             Movements_t trajectories; //where pieces can go
             Movements_t capturings;   //where pieces can capture
             Movements_t capturables;  //where pieces can be captured
+            //How many capturings each suit has at each cell, kept in step with the capturings
+            class Attacks
+            {
+            public:
+                std::vector<std::uint16_t> counts; //cell y*width + x
+                Bitboard cells;                    //cells with a nonzero count
+            };
+            std::map<Suit, Attacks> attacks;
+            //The pieces with movements at each cell, once per movement, kept in step with the movements
+            using Passing_t = Occupancy<std::vector<piece::Piece const *>>;
+            Passing_t passing;
+            Bitboard const no_attacks;
+            std::vector<Listener_t> listeners;
+            std::shared_ptr<std::vector<Symmetry> const> symmetric; //found from the starting position, shared by copies
+            std::vector<std::uint64_t> keys; //hash() of the position turned by each symmetry
+            bool log_moves = true;
+            std::chrono::steady_clock::duration update_time {};
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+        public:
+            //How movements are kept up to date as pieces move
+            enum class Generation
+            {
+                Optimized, //only the pieces a move may have changed, with each piece's calcTrajectory()
+                Reference  //every piece after every move, with each piece's calcReference()
+            };
+        private:
+            Generation gen = Generation::Optimized;
+#endif
+            //Creates the pieces of a layout and works out their trajectories
+            void place(config::BoardConfig::Layout_t const &layout);
+            //Works out the movements of a piece the way the board's generation does
+            void calculate(piece::Piece &p);
             static Factory_t &factory()
             {
                 static Factory_t f;
@@ -52,15 +95,62 @@ namespace chesspp
 
         public:
             Board(config::BoardConfig const &conf);
+            //Sets up the pieces of a layout on a board of the same variant as another, sharing its
+            //symmetries, e.g. for a position read back from elsewhere. Pieces have made no moves,
+            //but pawns off their suit's starting cells count as having moved. Does not log moves.
+            Board(Board const &like, config::BoardConfig::Layout_t const &layout);
+            //Copies the pieces and their state but not the listeners, e.g. for analysis.
+            //Copies do not log their moves.
+            Board(Board const &other);
+            Board &operator=(Board const &) = delete;
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            //Switches how movements are kept up to date, working out every piece's again the new way.
+            //Copies and boards set up like this one generate the same way.
+            void generation(Generation g);
+            Generation generation() const noexcept
+            {
+                return gen;
+            }
+#endif
 
             static auto registerPieceClass(Factory_t::key_type const &type, Factory_t::mapped_type ctor)
             -> Factory_t::iterator
             {
                 return factory().insert({type, ctor}).first;
             }
+            //The names of every registered piece class, sorted
+            static std::vector<Factory_t::key_type> pieceClasses()
+            {
+                std::vector<Factory_t::key_type> names;
+                for(auto const &c : factory())
+                {
+                    names.push_back(c.first);
+                }
+                return names;
+            }
 
             bool occupied(Position_t const &pos) const noexcept;
             auto find(piece::Piece const &p) const noexcept -> Pieces_t::const_iterator;
+            //Find the piece at a position, or end() if there is none
+            auto find(Position_t const &pos) const noexcept -> Pieces_t::const_iterator;
+
+            //Calls f with every piece in the rectangle between two corners, inclusive.
+            //On chunked boards empty stretches are skipped a tile at a time.
+            template<typename Func>
+            void within(Position_t const &first, Position_t const &last, Func f) const
+            {
+                occupancy.within(first, last, [&](Position_t const &, Pieces_t::const_iterator const &it)
+                {
+                    f(**it);
+                });
+            }
+            //Finds the nearest piece from a position in a direction, false if there is none before the edge
+            bool nearestBlocker(Position_t const &from, util::Direction d, Position_t &blocker) const noexcept;
+            //Whether this board uses chunked storage, chosen from its size and number of pieces
+            bool chunked() const noexcept
+            {
+                return occupancy.storage() == Occupancy_t::Layout::Chunked;
+            }
 
             auto begin() const noexcept
             -> Pieces_t::const_iterator
@@ -97,6 +187,10 @@ namespace chesspp
                 {
                     return m.cend();
                 }
+                std::size_t size() const noexcept
+                {
+                    return m.size();
+                }
 
                 void add(piece::Piece const &p, Position_t const &tile);
                 void remove(piece::Piece const &p, Position_t const &tile);
@@ -117,18 +211,83 @@ namespace chesspp
             MovementsRange pieceCapturing(piece::Piece const &p) noexcept;
             MovementsRange pieceCapturable(piece::Piece const &p) noexcept;
 
+            //How many of the pieces of a suit can capture at a cell, in constant time
+            std::size_t attackers(Suit const &s, Position_t const &pos) const noexcept;
+            //The cells the pieces of a suit can capture at
+            Bitboard const &attacked(Suit const &s) const noexcept;
+
         private:
-            void update(Position_t const &pos);
+            //What a piece adds to the key of the position turned by a symmetry, given its hashState()
+            std::uint64_t key(piece::Piece const &p, std::size_t symmetry, std::uint64_t hash_state) const noexcept;
+            //Adds a piece to the keys, or takes it out again
+            void toggle(piece::Piece const &p) noexcept;
+            //Tells a piece another has moved, changing the keys along with its hashState()
+            void tick(piece::Piece &p, Position_t const &to) noexcept;
+            void attack(Suit const &s, Position_t const &tile, bool add);
+            void pass(piece::Piece const &p, Position_t const &tile, bool add);
+            //Removes all movements of a piece
+            void forget(Pieces_t::const_iterator it);
+            //Recalculates the movements of the moved piece and of those the move may have changed
+            void update(Pieces_t::const_iterator moved, Position_t const &from, Position_t const *captured);
+            bool move(Pieces_t::iterator source, Movements_t::const_iterator target, Position_t const *captured);
         public:
+            //Calls the listener after every move, with the position of the captured piece if it was a capture
+            void addListener(Listener_t l)
+            {
+                listeners.push_back(std::move(l));
+            }
+
             //Capture a capturable piece
             bool capture(Pieces_t::iterator source, Movements_t::const_iterator target, Movements_t::const_iterator capturable);
             //Move a piece without capturing
             bool move(Pieces_t::iterator source, Movements_t::const_iterator target);
+            //Capture or move with a piece to a tile, whichever its movements allow
+            bool moveTo(Pieces_t::iterator source, Position_t const &tile);
+
+            using MoveList_t = std::vector<Move>;
+            //Every move moveTo() would accept for the pieces of a suit, sorted
+            MoveList_t legalMoves(Suit const &s) const;
+            //Whether moves are logged, timed and counted in the metrics; boards set up from a
+            //config do, others don't
+            void logMoves(bool on) noexcept
+            {
+                log_moves = on;
+            }
+            //How long updating the movements took after the last move, on boards that log their moves
+            std::chrono::steady_clock::duration lastUpdate() const noexcept
+            {
+                return update_time;
+            }
+
+            //Identifies the arrangement of pieces, the same across processes
+            std::uint64_t hash() const noexcept
+            {
+                return keys.front();
+            }
+            //The symmetries of the layout the board started from, the identity first
+            std::vector<Symmetry> const &symmetries() const noexcept
+            {
+                return *symmetric;
+            }
+            //hash() of the position turned by one of the symmetries(), kept up to date move by move
+            std::uint64_t hash(std::size_t symmetry) const noexcept
+            {
+                return keys[symmetry];
+            }
+            //hash(symmetry) worked out again from every piece, to check the one kept move by move
+            std::uint64_t rehash(std::size_t symmetry) const noexcept;
+            /**
+             * Identifies the position together with the suit to move, the same
+             * for every position the symmetries turn it into. Sets symmetry to
+             * the one that turns this position into the canonical one, e.g. to
+             * turn moves to and from what a cache keeps for the canonical one.
+             */
+            std::uint64_t canonicalHash(Suit const &turn, std::size_t &symmetry) const noexcept;
 
             //Check if a position is a valid position that exists on the board
             bool valid(Position_t const &pos) const noexcept
             {
-                return pos.isWithin(Position_t::Origin(), {config.boardWidth(), config.boardHeight()});
+                return pos.isWithin(Position_t::Origin(), {static_cast<BoardSize_t>(config.boardWidth()-1), static_cast<BoardSize_t>(config.boardHeight()-1)});
             }
         };
     }
@@ -0,0 +1,261 @@
+#include "DistanceMap.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace chesspp
+{
+    namespace board
+    {
+        constexpr DistanceMap::Distance_t DistanceMap::Unreachable;
+
+        Bitboard DistanceMap::reachable(std::size_t n) const
+        {
+            Bitboard cells = rings[0];
+            for(std::size_t i = 1; i <= n && i <= moves; ++i)
+            {
+                for(std::size_t w = 0; w < cells.words(); ++w)
+                {
+                    cells.data()[w] |= rings[i].data()[w];
+                }
+            }
+            return cells;
+        }
+
+        namespace
+        {
+            static piece::Piece::Pattern reversed(piece::Piece::Pattern p)
+            {
+                for(auto *offsets : {&p.leaps, &p.slides})
+                {
+                    for(auto &o : *offsets)
+                    {
+                        o = {-o.first, -o.second};
+                    }
+                }
+                return p;
+            }
+        }
+
+        DistanceMaps::DistanceMaps(std::size_t max_maps, util::BitKernels const &k)
+        : capacity{std::max<std::size_t>(max_maps, 1)}
+        , kernels(k) //can't use {}
+        {
+        }
+
+        void DistanceMaps::fit(Board const &b)
+        {
+            if(!work || width != b.config.boardWidth() || height != b.config.boardHeight())
+            {
+                width = b.config.boardWidth();
+                height = b.config.boardHeight();
+                work.reset(new Work(width, height, kernels));
+                entries.clear();
+            }
+            if(!work->current)
+            {
+                work->empty.fill();
+                work->occupied.clear();
+                for(auto const &p : b)
+                {
+                    work->empty.reset(p->pos);
+                    work->occupied.set(p->pos);
+                }
+                work->current = true;
+            }
+        }
+
+        bool DistanceMaps::kindOf(piece::Piece const &p, std::size_t &kind)
+        {
+            moves.leaps.clear();
+            moves.slides.clear();
+            attacks.leaps.clear();
+            attacks.slides.clear();
+            if(!p.movePattern(moves))
+            {
+                return false;
+            }
+            if(!p.attackPattern(attacks))
+            {
+                attacks = moves; //captures where it moves
+            }
+            for(kind = 0; kind < kinds.size(); ++kind)
+            {
+                if(kinds[kind].moves == moves && kinds[kind].attacks == attacks)
+                {
+                    return true;
+                }
+            }
+            kinds.push_back(Kind{moves, attacks, reversed(moves), reversed(attacks)});
+            return true;
+        }
+
+        DistanceMap const &DistanceMaps::lookup(std::size_t kind, Position_t const &cell, bool toward, std::size_t depth)
+        {
+            depth = std::min<std::size_t>(depth, DistanceMap::Unreachable - 1);
+            for(auto &e : entries)
+            {
+                if(e.valid && e.kind == kind && e.cell == cell && e.toward == toward && e.depth == depth)
+                {
+                    e.used = ++uses;
+                    return e.map;
+                }
+            }
+
+            //reuse a dropped map, else make a new one, else replace the least recently used
+            auto slot = std::find_if(entries.begin(), entries.end(), [](Entry const &e)
+            {
+                return !e.valid;
+            });
+            if(slot == entries.end())
+            {
+                if(entries.size() < capacity)
+                {
+                    entries.push_back(Entry{kind, cell, toward, depth, false, 0, DistanceMap{width, height}});
+                    slot = entries.end() - 1;
+                }
+                else
+                {
+                    slot = std::min_element(entries.begin(), entries.end(), [](Entry const &a, Entry const &b)
+                    {
+                        return a.used < b.used;
+                    });
+                }
+            }
+            slot->kind = kind;
+            slot->cell = cell;
+            slot->toward = toward;
+            slot->depth = depth;
+            slot->valid = true;
+            slot->used = ++uses;
+            compute(*slot);
+            return slot->map;
+        }
+
+        void DistanceMaps::compute(Entry &e)
+        {
+            auto &w = *work;
+            auto const &k = kinds[e.kind];
+            auto &m = e.map;
+            std::size_t words = w.empty.words();
+            auto copy = [&](Bitboard &dst, Bitboard const &src)
+            {
+                std::copy(src.data(), src.data() + words, dst.data());
+            };
+
+            m.moves = e.depth;
+            std::fill(m.distances.begin(), m.distances.end(), DistanceMap::Unreachable);
+            while(m.rings.size() <= e.depth)
+            {
+                m.rings.emplace_back(width, height);
+            }
+            for(std::size_t n = 0; n <= e.depth; ++n)
+            {
+                m.rings[n].clear();
+            }
+            m.rings[0].set(e.cell);
+            m.distances[e.cell.y*width + e.cell.x] = 0;
+            copy(m.seen, m.rings[0]);
+            copy(w.visited, m.rings[0]);
+
+            for(std::size_t n = 1; n <= e.depth; ++n)
+            {
+                //only the start and empty cells are moved on from
+                copy(w.expand, m.rings[n - 1]);
+                if(n > 1)
+                {
+                    kernels.andInto(w.expand.data(), w.empty.data(), words);
+                }
+                if(w.expand.empty())
+                {
+                    break;
+                }
+
+                auto &next = m.rings[n];
+                w.reach.clear();
+                if(e.toward)
+                {
+                    //backwards from the target: the last move onto it is a capture if it is occupied
+                    bool capture = n == 1 && w.occupied.test(e.cell);
+                    w.steps.reach(w.reach, w.expand, capture ? k.back_attacks : k.back_moves, w.empty);
+                    copy(next, w.reach);
+                }
+                else
+                {
+                    w.steps.reach(w.reach, w.expand, k.moves, w.empty);
+                    if(k.attacks == k.moves)
+                    {
+                        copy(next, w.reach);
+                    }
+                    else
+                    {
+                        //moves only go to empty cells, captures only to occupied ones
+                        copy(next, w.reach);
+                        kernels.andInto(next.data(), w.empty.data(), words);
+                        w.capture.clear();
+                        w.steps.reach(w.capture, w.expand, k.attacks, w.empty);
+                        kernels.orInto(w.reach.data(), w.capture.data(), words);
+                        kernels.andInto(w.capture.data(), w.occupied.data(), words);
+                        kernels.orInto(next.data(), w.capture.data(), words);
+                    }
+                }
+                kernels.orInto(m.seen.data(), w.reach.data(), words);
+                kernels.andNotInto(next.data(), w.visited.data(), words);
+                kernels.orInto(w.visited.data(), next.data(), words);
+                auto d = static_cast<DistanceMap::Distance_t>(n);
+                next.forEach([&](Position_t const &p)
+                {
+                    m.distances[p.y*width + p.x] = d;
+                });
+            }
+        }
+
+        DistanceMap const *DistanceMaps::from(Board const &b, piece::Piece const &p, std::size_t depth)
+        {
+            std::size_t kind;
+            if(!kindOf(p, kind))
+            {
+                return nullptr;
+            }
+            fit(b);
+            return &lookup(kind, p.pos, false, depth);
+        }
+        DistanceMap const *DistanceMaps::toward(Board const &b, piece::Piece const &p, Position_t const &target, std::size_t depth)
+        {
+            std::size_t kind;
+            if(!kindOf(p, kind) || !b.valid(target))
+            {
+                return nullptr;
+            }
+            fit(b);
+            return &lookup(kind, target, true, depth);
+        }
+
+        void DistanceMaps::moved(Move const &m, Position_t const *captured)
+        {
+            if(!work)
+            {
+                return;
+            }
+            work->current = false;
+            for(auto &e : entries)
+            {
+                if(e.valid && (e.map.seen.test(m.from) || e.map.seen.test(m.to) || (captured && e.map.seen.test(*captured))))
+                {
+                    e.valid = false;
+                }
+            }
+        }
+        void DistanceMaps::clear()
+        {
+            if(work)
+            {
+                work->current = false;
+            }
+            for(auto &e : entries)
+            {
+                e.valid = false;
+            }
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef ChessPlusPlus_Board_PieceDistanceMapClasses_HeaderPlusPlus
+#define ChessPlusPlus_Board_PieceDistanceMapClasses_HeaderPlusPlus
+
+#include "board/Board.hpp"
+#include "board/Bitboard.hpp"
+#include "board/Move.hpp"
+#include "board/Steps.hpp"
+#include "piece/Piece.hpp"
+#include "util/BitKernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * How many moves a piece needs to get to each cell if nothing else
+         * moves, up to some number of moves. A move either goes to an empty
+         * cell by the piece's move pattern or captures on an occupied cell
+         * by its attack pattern. Slides stop at the first piece in the way,
+         * and nothing goes on from a cell reached by capturing.
+         */
+        class DistanceMap
+        {
+        public:
+            using Position_t = Board::Position_t;
+            using Distance_t = std::uint8_t;
+            static constexpr Distance_t Unreachable = 255;
+
+        private:
+            friend class DistanceMaps;
+            std::size_t width, moves = 0;
+            std::vector<Distance_t> distances; //cell y*width + x
+            std::vector<Bitboard> rings;       //cells first reached after each number of moves
+            Bitboard seen;                     //cells whose occupancy the distances depend on
+
+        public:
+            DistanceMap(std::size_t w, std::size_t h)
+            : width{w}
+            , distances(w*h, Unreachable)
+            , seen{w, h}
+            {
+            }
+
+            //The number of moves looked ahead
+            std::size_t depth() const noexcept
+            {
+                return moves;
+            }
+            //Moves to a cell, Unreachable if it takes more than depth()
+            Distance_t at(Position_t const &p) const noexcept
+            {
+                return distances[p.y*width + p.x];
+            }
+            //The cells exactly n moves away, for n up to depth()
+            Bitboard const &ring(std::size_t n) const noexcept
+            {
+                return rings[n];
+            }
+            //The cells at most n moves away, including the starting cell
+            Bitboard reachable(std::size_t n) const;
+        };
+
+        /**
+         * Computes distance maps for pieces by breadth-first search, one whole
+         * ring of cells at a time with Steps, and keeps them until a move
+         * changes a cell they depend on. Maps are shared by pieces with the
+         * same patterns, so there is one per kind of piece rather than one
+         * per piece.
+         *
+         * The maps belong to one board: pass its moves to moved(), e.g. from
+         * a listener, or clear() them before using another position.
+         */
+        class DistanceMaps
+        {
+        public:
+            using Position_t = Board::Position_t;
+
+        private:
+            std::size_t const capacity;
+            util::BitKernels const &kernels;
+            std::size_t width = 0, height = 0;
+
+            //Buffers sized for the board
+            class Work
+            {
+            public:
+                Steps steps;
+                Bitboard empty, occupied, visited, expand, reach, capture;
+                bool current = false; //whether empty and occupied match the board
+                Work(std::size_t w, std::size_t h, util::BitKernels const &k)
+                : steps{w, h, k}
+                , empty{w, h}
+                , occupied{w, h}
+                , visited{w, h}
+                , expand{w, h}
+                , reach{w, h}
+                , capture{w, h}
+                {
+                }
+            };
+            std::unique_ptr<Work> work;
+
+            //The patterns of one kind of piece, also reversed for distances toward a cell
+            class Kind
+            {
+            public:
+                piece::Piece::Pattern moves, attacks, back_moves, back_attacks;
+            };
+            std::vector<Kind> kinds;
+            piece::Piece::Pattern moves, attacks; //reused for each lookup
+
+            class Entry
+            {
+            public:
+                std::size_t kind;
+                Position_t cell;
+                bool toward;
+                std::size_t depth;
+                bool valid;
+                std::uint64_t used;
+                DistanceMap map;
+            };
+            std::vector<Entry> entries;
+            std::uint64_t uses = 0;
+
+            void fit(Board const &b);
+            //The index in kinds of a piece's patterns, or false if it has no move pattern
+            bool kindOf(piece::Piece const &p, std::size_t &kind);
+            DistanceMap const &lookup(std::size_t kind, Position_t const &cell, bool toward, std::size_t depth);
+            void compute(Entry &e);
+
+        public:
+            DistanceMaps(std::size_t max_maps = 64, util::BitKernels const &k = util::BitKernels::best());
+
+            //The moves a piece needs to get to each cell from where it is, nullptr if it has no move pattern
+            DistanceMap const *from(Board const &b, piece::Piece const &p, std::size_t depth);
+            //The moves a piece like p standing on each cell would need to capture on, or move to,
+            //a target cell; nullptr if it has no move pattern
+            DistanceMap const *toward(Board const &b, piece::Piece const &p, Position_t const &target, std::size_t depth);
+
+            //Drops the maps a move changes, has the signature of a Board listener
+            void moved(Move const &m, Position_t const *captured);
+            //Drops every map, e.g. before using another board
+            void clear();
+        };
+    }
+}
+
+#endif
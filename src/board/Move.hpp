@@ -0,0 +1,59 @@
+#ifndef ChessPlusPlus_Board_PackedMoveClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_PackedMoveClass_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+
+#include <cstdint>
+#include <ostream>
+
+namespace chesspp
+{
+    namespace board
+    {
+        //A move from one tile to another, packable into 32 bits for logs and the wire
+        class Move
+        {
+        public:
+            using Position_t = config::BoardConfig::Position_t;
+            using Packed_t = std::uint32_t;
+            static_assert(sizeof(Position_t::value_type) == 1, "Packed moves assume single byte coordinates");
+
+            Position_t from, to; //intentionally public
+
+            Move(Position_t const &from_ = Position_t(), Position_t const &to_ = Position_t()) noexcept
+            : from{from_}
+            , to{to_}
+            {
+            }
+            explicit Move(Packed_t packed) noexcept
+            : from{static_cast<Position_t::value_type>(packed      ), static_cast<Position_t::value_type>(packed >>  8)}
+            , to  {static_cast<Position_t::value_type>(packed >> 16), static_cast<Position_t::value_type>(packed >> 24)}
+            {
+            }
+
+            Packed_t pack() const noexcept
+            {
+                return  static_cast<Packed_t>(from.x)
+                     | (static_cast<Packed_t>(from.y) <<  8)
+                     | (static_cast<Packed_t>(to.x)   << 16)
+                     | (static_cast<Packed_t>(to.y)   << 24);
+            }
+
+            friend bool operator==(Move const &a, Move const &b) noexcept
+            {
+                return a.from == b.from && a.to == b.to;
+            }
+            friend bool operator<(Move const &a, Move const &b) noexcept
+            {
+                return a.from < b.from || (a.from == b.from && a.to < b.to);
+            }
+
+            friend std::ostream &operator<<(std::ostream &os, Move const &m)
+            {
+                return os << m.from << " -> " << m.to;
+            }
+        };
+    }
+}
+
+#endif
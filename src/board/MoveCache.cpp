@@ -0,0 +1,66 @@
+#include "MoveCache.hpp"
+
+#include <algorithm>
+
+namespace chesspp
+{
+    namespace board
+    {
+        auto MoveCache::canonical(Board const &b, Board::Suit const &s, std::size_t &symmetry)
+        -> std::shared_ptr<Packed_t const>
+        {
+            Key const key {b.config.fingerprint(), b.canonicalHash(s, symmetry)};
+            std::shared_ptr<Packed_t const> found;
+            if(cache.find(key, found))
+            {
+                return found;
+            }
+            auto const &turn = b.symmetries()[symmetry];
+            auto moves = b.legalMoves(s);
+            for(auto &m : moves)
+            {
+                m = turn(m);
+            }
+            std::sort(moves.begin(), moves.end());
+            auto packed = std::make_shared<Packed_t>();
+            packed->reserve(moves.size());
+            for(auto const &m : moves)
+            {
+                packed->push_back(m.pack());
+            }
+            cache.insert(key, packed);
+            return packed;
+        }
+
+        auto MoveCache::legalMoves(Board const &b, Board::Suit const &s)
+        -> Board::MoveList_t
+        {
+            std::size_t symmetry;
+            auto packed = canonical(b, s, symmetry);
+            auto const &turn = b.symmetries()[symmetry];
+            Board::MoveList_t moves;
+            moves.reserve(packed->size());
+            for(auto m : *packed)
+            {
+                moves.push_back(turn(Move(m)));
+            }
+            //turning changes the order, and legalMoves() is sorted
+            if(symmetry)
+            {
+                std::sort(moves.begin(), moves.end());
+            }
+            return moves;
+        }
+
+        bool MoveCache::legal(Board const &b, Board::Suit const &s, Move const &m)
+        {
+            std::size_t symmetry;
+            auto packed = canonical(b, s, symmetry);
+            return std::binary_search(packed->begin(), packed->end(), b.symmetries()[symmetry](m).pack(),
+                                      [](Move::Packed_t x, Move::Packed_t y)
+                                      {
+                                          return Move(x) < Move(y);
+                                      });
+        }
+    }
+}
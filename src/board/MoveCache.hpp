@@ -0,0 +1,74 @@
+#ifndef ChessPlusPlus_Board_LegalMoveCacheClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_LegalMoveCacheClass_HeaderPlusPlus
+
+#include "board/Board.hpp"
+#include "board/Move.hpp"
+#include "util/LruCache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * Remembers the legal moves of positions so that asking again, e.g.
+         * every frame while hovering or for every move a server checks, is a
+         * lookup instead of a scan of every piece's movements. Entries are
+         * keyed by the layout's fingerprint and the canonical hash of the
+         * position, so boards of different variants never collide and
+         * positions that mirror each other share one entry.
+         *
+         * Safe to use from any number of threads.
+         */
+        class MoveCache
+        {
+        public:
+            using Packed_t = std::vector<Move::Packed_t>;
+
+        private:
+            class Key
+            {
+            public:
+                std::uint64_t variant, position;
+                friend bool operator==(Key const &a, Key const &b) noexcept
+                {
+                    return a.variant == b.variant && a.position == b.position;
+                }
+            };
+            class KeyHash
+            {
+            public:
+                std::size_t operator()(Key const &k) const noexcept
+                {
+                    return static_cast<std::size_t>(k.position ^ (k.variant * 0x9E3779B97F4A7C15ULL));
+                }
+            };
+            //in the canonical frame, sorted as Moves
+            util::LruCache<Key, std::shared_ptr<Packed_t const>, KeyHash> cache;
+
+            //The packed moves of a suit in the canonical frame, generated if not known
+            std::shared_ptr<Packed_t const> canonical(Board const &b, Board::Suit const &s, std::size_t &symmetry);
+
+        public:
+            MoveCache(std::size_t positions = 1 << 14, std::size_t shards = 16)
+            : cache{positions, shards}
+            {
+            }
+
+            //The same as b.legalMoves(s)
+            Board::MoveList_t legalMoves(Board const &b, Board::Suit const &s);
+            //Whether b.legalMoves(s) has m
+            bool legal(Board const &b, Board::Suit const &s, Move const &m);
+
+            std::size_t size()                    { return cache.size();   }
+            std::uint64_t hits()   const noexcept { return cache.hits();   }
+            std::uint64_t misses() const noexcept { return cache.misses(); }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef ChessPlusPlus_Board_SpatialOccupancyIndexClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_SpatialOccupancyIndexClass_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+#include "util/Bits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * Maps the occupied cells of a board to a value, e.g. the piece there.
+         *
+         * Dense storage keeps one slot per cell, which is simplest and
+         * fastest for ordinary boards. Chunked storage splits the board into
+         * 8x8 tiles holding a 64-bit occupancy mask and the values of the
+         * occupied cells only, and allocates a tile only while something is
+         * on it. Very large sparse boards then take little memory, and
+         * region and ray queries skip whole empty tiles at a time.
+         * \tparam T the value kept for each occupied cell, must be default constructible.
+         */
+        template<typename T>
+        class Occupancy
+        {
+        public:
+            using Position_t = config::BoardConfig::Position_t;
+            enum class Layout
+            {
+                Dense,
+                Chunked
+            };
+
+            //Chunked storage for boards of at least 64x64 cells with at most one piece per 16 of them
+            static Layout choose(std::size_t width, std::size_t height, std::size_t pieces) noexcept
+            {
+                std::size_t area = width*height;
+                return area >= 64*64 && pieces*16 <= area ? Layout::Chunked : Layout::Dense;
+            }
+
+        private:
+            static constexpr unsigned TileShift = 3;
+            static constexpr unsigned TileSize = 1u << TileShift;
+            class Tile
+            {
+            public:
+                std::uint64_t bits = 0; //bit y*8 + x of the tile's cells
+                std::vector<T> values;  //one per set bit, in bit order
+            };
+
+            std::size_t const width, height;
+            Layout const layout;
+            std::size_t count = 0;
+
+            //Dense
+            std::vector<T> cells;
+            std::vector<bool> filled;
+
+            //Chunked, null for tiles with nothing on them
+            std::size_t const tiles_across;
+            std::vector<std::unique_ptr<Tile>> tiles;
+
+            static unsigned bit(std::size_t x, std::size_t y) noexcept
+            {
+                return static_cast<unsigned>((y & (TileSize - 1))*TileSize + (x & (TileSize - 1)));
+            }
+            Tile *tileAt(std::size_t x, std::size_t y) const noexcept
+            {
+                return tiles[(y >> TileShift)*tiles_across + (x >> TileShift)].get();
+            }
+            //Index into Tile::values of a set bit
+            static std::size_t rank(Tile const &t, unsigned b) noexcept
+            {
+                return util::popCount(t.bits & ((std::uint64_t(1) << b) - 1));
+            }
+            bool inside(long x, long y) const noexcept
+            {
+                return x >= 0 && y >= 0 && static_cast<std::size_t>(x) < width && static_cast<std::size_t>(y) < height;
+            }
+
+        public:
+            Occupancy(std::size_t w, std::size_t h, Layout l)
+            : width{w}
+            , height{h}
+            , layout{l}
+            , tiles_across{(w + TileSize - 1) >> TileShift}
+            {
+                if(layout == Layout::Dense)
+                {
+                    cells.resize(width*height);
+                    filled.resize(width*height);
+                }
+                else
+                {
+                    tiles.resize(tiles_across*((h + TileSize - 1) >> TileShift));
+                }
+            }
+
+            Layout storage() const noexcept
+            {
+                return layout;
+            }
+            std::size_t size() const noexcept
+            {
+                return count;
+            }
+
+            //The value at a position, or nullptr if it is empty or off the board
+            T const *find(Position_t const &pos) const noexcept
+            {
+                if(pos.x >= width || pos.y >= height)
+                {
+                    return nullptr;
+                }
+                if(layout == Layout::Dense)
+                {
+                    std::size_t i = pos.y*width + pos.x;
+                    return filled[i] ? &cells[i] : nullptr;
+                }
+                Tile const *t = tileAt(pos.x, pos.y);
+                unsigned b = bit(pos.x, pos.y);
+                if(!t || !(t->bits >> b & 1))
+                {
+                    return nullptr;
+                }
+                return &t->values[rank(*t, b)];
+            }
+            T *find(Position_t const &pos) noexcept
+            {
+                return const_cast<T *>(static_cast<Occupancy const &>(*this).find(pos));
+            }
+
+            //Sets the value at a position, replacing any there
+            void insert(Position_t const &pos, T const &value)
+            {
+                if(pos.x >= width || pos.y >= height)
+                {
+                    return;
+                }
+                if(layout == Layout::Dense)
+                {
+                    std::size_t i = pos.y*width + pos.x;
+                    count += filled[i] ? 0 : 1;
+                    filled[i] = true;
+                    cells[i] = value;
+                    return;
+                }
+                auto &t = tiles[(pos.y >> TileShift)*tiles_across + (pos.x >> TileShift)];
+                if(!t)
+                {
+                    t.reset(new Tile);
+                }
+                unsigned b = bit(pos.x, pos.y);
+                auto at = t->values.begin() + static_cast<std::ptrdiff_t>(rank(*t, b));
+                if(t->bits >> b & 1)
+                {
+                    *at = value;
+                    return;
+                }
+                t->values.insert(at, value);
+                t->bits |= std::uint64_t(1) << b;
+                ++count;
+            }
+
+            //Empties a position
+            void erase(Position_t const &pos)
+            {
+                if(pos.x >= width || pos.y >= height)
+                {
+                    return;
+                }
+                if(layout == Layout::Dense)
+                {
+                    std::size_t i = pos.y*width + pos.x;
+                    count -= filled[i] ? 1 : 0;
+                    filled[i] = false;
+                    return;
+                }
+                auto &t = tiles[(pos.y >> TileShift)*tiles_across + (pos.x >> TileShift)];
+                unsigned b = bit(pos.x, pos.y);
+                if(!t || !(t->bits >> b & 1))
+                {
+                    return;
+                }
+                t->values.erase(t->values.begin() + static_cast<std::ptrdiff_t>(rank(*t, b)));
+                t->bits &= ~(std::uint64_t(1) << b);
+                --count;
+                if(!t->bits)
+                {
+                    t.reset();
+                }
+            }
+
+            //Empties every position
+            void clear()
+            {
+                count = 0;
+                std::fill(filled.begin(), filled.end(), false);
+                for(auto &t : tiles)
+                {
+                    t.reset();
+                }
+            }
+
+            //Calls f(position, value) for every occupied cell in the rectangle between two corners, inclusive
+            template<typename Func>
+            void within(Position_t const &first, Position_t const &last, Func f) const
+            {
+                std::size_t x0 = first.x, y0 = first.y;
+                std::size_t x1 = std::min<std::size_t>(last.x, width - 1), y1 = std::min<std::size_t>(last.y, height - 1);
+                if(x0 > x1 || y0 > y1)
+                {
+                    return;
+                }
+                if(layout == Layout::Dense)
+                {
+                    for(std::size_t y = y0; y <= y1; ++y)
+                    {
+                        for(std::size_t x = x0; x <= x1; ++x)
+                        {
+                            if(filled[y*width + x])
+                            {
+                                f(Position_t(static_cast<Position_t::value_type>(x), static_cast<Position_t::value_type>(y)), cells[y*width + x]);
+                            }
+                        }
+                    }
+                    return;
+                }
+                for(std::size_t ty = y0 >> TileShift; ty <= y1 >> TileShift; ++ty)
+                {
+                    for(std::size_t tx = x0 >> TileShift; tx <= x1 >> TileShift; ++tx)
+                    {
+                        Tile const *t = tiles[ty*tiles_across + tx].get();
+                        if(!t)
+                        {
+                            continue;
+                        }
+                        //clip the tile's mask to the rectangle
+                        std::size_t left = tx << TileShift, top = ty << TileShift;
+                        unsigned cx0 = static_cast<unsigned>(std::max(x0, left) - left), cx1 = static_cast<unsigned>(std::min(x1, left + TileSize - 1) - left);
+                        unsigned cy0 = static_cast<unsigned>(std::max(y0, top)  - top),  cy1 = static_cast<unsigned>(std::min(y1, top  + TileSize - 1) - top);
+                        std::uint64_t row = util::bitRange(cx0, cx1), mask = 0;
+                        for(unsigned y = cy0; y <= cy1; ++y)
+                        {
+                            mask |= row << (y*TileSize);
+                        }
+                        for(std::uint64_t m = t->bits & mask; m; m &= m - 1)
+                        {
+                            unsigned b = util::lowestBit(m);
+                            f(Position_t(static_cast<Position_t::value_type>(left + (b & (TileSize - 1))), static_cast<Position_t::value_type>(top + (b >> TileShift))), t->values[rank(*t, b)]);
+                        }
+                    }
+                }
+            }
+
+            //Finds the first occupied cell stepping (dx, dy) at a time from a position, not counting the position itself.
+            //Returns false if the edge of the board comes first.
+            bool ray(Position_t const &from, int dx, int dy, Position_t &hit) const noexcept
+            {
+                if(dx == 0 && dy == 0)
+                {
+                    return false;
+                }
+                long x = long(from.x) + dx, y = long(from.y) + dy;
+                while(inside(x, y))
+                {
+                    bool occupied;
+                    if(layout == Layout::Dense)
+                    {
+                        occupied = filled[static_cast<std::size_t>(y)*width + static_cast<std::size_t>(x)];
+                    }
+                    else
+                    {
+                        Tile const *t = tileAt(static_cast<std::size_t>(x), static_cast<std::size_t>(y));
+                        if(!t)
+                        {
+                            //jump to the first step outside this empty tile
+                            long left = x & ~long(TileSize - 1), top = y & ~long(TileSize - 1);
+                            long steps = 1L << 30;
+                            if(dx > 0)
+                            {
+                                steps = std::min(steps, (left + TileSize - x + dx - 1)/dx);
+                            }
+                            if(dx < 0)
+                            {
+                                steps = std::min(steps, (x - left)/-dx + 1);
+                            }
+                            if(dy > 0)
+                            {
+                                steps = std::min(steps, (top + TileSize - y + dy - 1)/dy);
+                            }
+                            if(dy < 0)
+                            {
+                                steps = std::min(steps, (y - top)/-dy + 1);
+                            }
+                            x += steps*dx;
+                            y += steps*dy;
+                            continue;
+                        }
+                        occupied = t->bits >> bit(static_cast<std::size_t>(x), static_cast<std::size_t>(y)) & 1;
+                    }
+                    if(occupied)
+                    {
+                        hit = Position_t(static_cast<Position_t::value_type>(x), static_cast<Position_t::value_type>(y));
+                        return true;
+                    }
+                    x += dx;
+                    y += dy;
+                }
+                return false;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "PositionBatch.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace chesspp
+{
+    namespace board
+    {
+        std::size_t PositionBatch::gapFor(config::BoardConfig const &conf)
+        {
+            Board b {conf};
+            std::size_t gap = 0;
+            for(auto const &p : b)
+            {
+                Pattern m, a;
+                p->movePattern(m);
+                p->attackPattern(a);
+                for(auto const *offsets : {&m.leaps, &m.slides, &a.leaps, &a.slides})
+                {
+                    for(auto const &o : *offsets)
+                    {
+                        gap = std::max<std::size_t>(gap, std::abs(o.second));
+                    }
+                }
+            }
+            return gap;
+        }
+        std::size_t PositionBatch::rowsFor(std::size_t w, std::size_t h, std::size_t gap) noexcept
+        {
+            std::size_t r = h + gap;
+            while((r*w) % 64)
+            {
+                ++r;
+            }
+            return r;
+        }
+
+        PositionBatch::PositionBatch(config::BoardConfig const &conf, std::size_t capacity_, util::BitKernels const &k)
+        : width{conf.boardWidth()}
+        , height{conf.boardHeight()}
+        , capacity{capacity_}
+        , gap{gapFor(conf)}
+        , rows{rowsFor(width, height, gap)}
+        , stride{rows*width/64}
+        , suits(conf.suits().begin(), conf.suits().end()) //can't use {}
+        , move_sources(suits.size())
+        , attack_sources(suits.size())
+        , occupied(suits.size(), Bitboard{width, rows*capacity})
+        , turns(suits.size(), Bitboard{width, rows*capacity})
+        , cells{width, rows*capacity}
+        , all{width, rows*capacity}
+        , empty{width, rows*capacity}
+        , enemy{width, rows*capacity}
+        , reach{width, rows*capacity}
+        , targets{width, rows*capacity}
+        , attacks{width, rows*capacity}
+        , steps{width, rows*capacity, k, std::max(width, height)}
+        {
+            for(std::size_t i = 0; i < capacity; ++i)
+            {
+                for(std::size_t c = 0; c < width*height; ++c)
+                {
+                    std::size_t const bit = i*stride*64 + c;
+                    cells.data()[bit/64] |= Word_t(1) << (bit%64);
+                }
+            }
+        }
+
+        std::size_t PositionBatch::kindOf(std::size_t suit)
+        {
+            for(std::size_t i = 0; i < kinds.size(); ++i)
+            {
+                if(kinds[i].suit == suit && kinds[i].moves == moves && kinds[i].attacks == attacked)
+                {
+                    return i;
+                }
+            }
+            kinds.push_back(Kind{suit, moves, attacked, Bitboard{width, rows*capacity}});
+            return kinds.size() - 1;
+        }
+
+        Bitboard &PositionBatch::sources(std::map<Offset_t, Bitboard> &m, Offset_t const &o)
+        {
+            auto it = m.find(o);
+            if(it == m.end())
+            {
+                it = m.emplace(o, Bitboard{width, rows*capacity}).first;
+            }
+            return it->second;
+        }
+
+        bool PositionBatch::add(Board const &b, Board::Suit const &turn)
+        {
+            if(count == capacity || b.config.boardWidth() != width || b.config.boardHeight() != height)
+            {
+                return false;
+            }
+            auto suitIndex = [&](Board::Suit const &s)
+            {
+                return static_cast<std::size_t>(std::find(suits.begin(), suits.end(), s) - suits.begin());
+            };
+            std::size_t const t = suitIndex(turn);
+            if(t == suits.size())
+            {
+                return false;
+            }
+            //check every piece before changing anything
+            placed.clear();
+            for(auto const &p : b)
+            {
+                std::size_t const s = suitIndex(p->suit);
+                moves.leaps.clear();
+                moves.slides.clear();
+                attacked.leaps.clear();
+                attacked.slides.clear();
+                if(s == suits.size() || !p->movePattern(moves) || !p->attackPattern(attacked))
+                {
+                    return false;
+                }
+                for(auto const *offsets : {&moves.leaps, &moves.slides, &attacked.leaps, &attacked.slides})
+                {
+                    for(auto const &o : *offsets)
+                    {
+                        if(static_cast<std::size_t>(std::abs(o.second)) > gap)
+                        {
+                            return false;
+                        }
+                    }
+                }
+                placed.emplace_back(kindOf(s), p->pos);
+            }
+            for(auto const &p : placed)
+            {
+                setBit(kinds[p.first].pieces, count, p.second);
+                setBit(occupied[kinds[p.first].suit], count, p.second);
+            }
+            std::fill(turns[t].data() + count*stride, turns[t].data() + (count + 1)*stride, ~Word_t(0));
+            ++count;
+            return true;
+        }
+
+        void PositionBatch::clear()
+        {
+            for(auto &k : kinds)
+            {
+                k.pieces.clear();
+            }
+            for(std::size_t s = 0; s < suits.size(); ++s)
+            {
+                occupied[s].clear();
+                turns[s].clear();
+            }
+            count = 0;
+        }
+
+        void PositionBatch::collect(Offset_t const &o, bool slide)
+        {
+            std::size_t const words = count*stride;
+            for(std::size_t w = 0; w < words; ++w)
+            {
+                for(Word_t v = targets.data()[w]; v; v &= v - 1)
+                {
+                    std::size_t const bit = w*64 + util::lowestBit(v);
+                    std::size_t const position = bit/(stride*64), cell = bit%(stride*64);
+                    signed x = static_cast<signed>(cell%width), y = static_cast<signed>(cell/width);
+                    signed fx = x - o.first, fy = y - o.second;
+                    auto occupiedAt = [&](signed cx, signed cy)
+                    {
+                        std::size_t const i = (position*rows + cy)*width + cx;
+                        return (all.data()[i/64] >> (i%64) & 1) != 0;
+                    };
+                    //a slide came from the first piece behind the cell it reached
+                    while(slide && !occupiedAt(fx, fy))
+                    {
+                        fx -= o.first;
+                        fy -= o.second;
+                    }
+                    Move const m
+                    {
+                        Position_t(static_cast<Position_t::value_type>(fx), static_cast<Position_t::value_type>(fy)),
+                        Position_t(static_cast<Position_t::value_type>(x),  static_cast<Position_t::value_type>(y))
+                    };
+                    found.emplace_back(position, m.pack());
+                }
+            }
+        }
+
+        void PositionBatch::generate(BatchMoves &out)
+        {
+            auto const &k = steps.kernels();
+            std::size_t const words = all.words();
+            out.positions = count;
+            out.words = (width*height + 63)/64;
+            out.attacks.assign(suits.size()*count*out.words, Word_t(0));
+            found.clear();
+
+            all.clear();
+            for(auto const &o : occupied)
+            {
+                k.orInto(all.data(), o.data(), words);
+            }
+            std::copy(cells.data(), cells.data() + words, empty.data());
+            k.andNotInto(empty.data(), all.data(), words);
+
+            for(auto *sources : {&move_sources, &attack_sources})
+            {
+                for(auto &s : *sources)
+                {
+                    for(auto *m : {&s.leaps, &s.slides})
+                    {
+                        for(auto &b : *m)
+                        {
+                            b.second.clear();
+                        }
+                    }
+                }
+            }
+            for(auto const &kind : kinds)
+            {
+                for(auto const &o : kind.moves.leaps)    k.orInto(sources(move_sources[kind.suit].leaps, o).data(),     kind.pieces.data(), words);
+                for(auto const &o : kind.moves.slides)   k.orInto(sources(move_sources[kind.suit].slides, o).data(),    kind.pieces.data(), words);
+                for(auto const &o : kind.attacks.leaps)  k.orInto(sources(attack_sources[kind.suit].leaps, o).data(),  kind.pieces.data(), words);
+                for(auto const &o : kind.attacks.slides) k.orInto(sources(attack_sources[kind.suit].slides, o).data(), kind.pieces.data(), words);
+            }
+
+            for(std::size_t s = 0; s < suits.size(); ++s)
+            {
+                std::copy(all.data(), all.data() + words, enemy.data());
+                k.andNotInto(enemy.data(), occupied[s].data(), words);
+                attacks.clear();
+
+                //each offset separately, so the piece a cell was reached from is known
+                auto step = [&](Offset_t const &o, Bitboard const &from, bool slide, bool capture)
+                {
+                    reach.clear();
+                    if(slide)
+                    {
+                        steps.slide(reach, from, o, empty);
+                    }
+                    else
+                    {
+                        steps.leap(reach, from, o);
+                    }
+                    k.andInto(reach.data(), cells.data(), words);
+                    if(capture)
+                    {
+                        k.orInto(attacks.data(), reach.data(), words);
+                    }
+                    std::copy(reach.data(), reach.data() + words, targets.data());
+                    k.andInto(targets.data(), (capture? enemy : empty).data(), words);
+                    k.andInto(targets.data(), turns[s].data(), words);
+                    collect(o, slide);
+                };
+                for(auto const &o : attack_sources[s].leaps)  step(o.first, o.second, false, true);
+                for(auto const &o : attack_sources[s].slides) step(o.first, o.second, true,  true);
+                for(auto const &o : move_sources[s].leaps)    step(o.first, o.second, false, false);
+                for(auto const &o : move_sources[s].slides)   step(o.first, o.second, true,  false);
+
+                for(std::size_t i = 0; i < count; ++i)
+                {
+                    std::copy(attacks.data() + i*stride, attacks.data() + i*stride + out.words, out.attacks.begin() + (s*count + i)*out.words);
+                }
+            }
+
+            //group the moves by position, then sort each position's like Board::legalMoves()
+            out.first.assign(count + 1, 0);
+            for(auto const &f : found)
+            {
+                ++out.first[f.first + 1];
+            }
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                out.first[i + 1] += out.first[i];
+            }
+            out.moves.resize(found.size());
+            {
+                std::vector<std::size_t> next {out.first.begin(), out.first.end() - 1};
+                for(auto const &f : found)
+                {
+                    out.moves[next[f.first]++] = f.second;
+                }
+            }
+            std::size_t kept = 0;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                auto begin = out.moves.begin() + out.first[i], end = out.moves.begin() + out.first[i + 1];
+                std::sort(begin, end, [](Move::Packed_t a, Move::Packed_t b)
+                {
+                    return Move(a) < Move(b);
+                });
+                end = std::unique(begin, end);
+                out.first[i] = kept;
+                kept = std::copy(begin, end, out.moves.begin() + kept) - out.moves.begin();
+            }
+            out.first[count] = kept;
+            out.moves.resize(kept);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef ChessPlusPlus_Board_BitboardPositionBatchClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_BitboardPositionBatchClass_HeaderPlusPlus
+
+#include "board/Board.hpp"
+#include "board/Bitboard.hpp"
+#include "board/Move.hpp"
+#include "board/Steps.hpp"
+#include "piece/Piece.hpp"
+#include "util/BitKernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * The moves and attacked cells of every position in a PositionBatch,
+         * in flat arrays.
+         */
+        class BatchMoves
+        {
+        public:
+            using Word_t = Bitboard::Word_t;
+
+            std::size_t positions = 0;
+            std::size_t words = 0;             //per board, as in Bitboard::data()
+            std::vector<Word_t> attacks;       //words for each suit, in BoardConfig::suits() order, then each position
+            std::vector<std::size_t> first;    //the moves of position i are moves[first[i]] up to moves[first[i + 1]]
+            std::vector<Move::Packed_t> moves; //for the suit to move, sorted like Board::legalMoves()
+
+            Word_t const *attacked(std::size_t suit, std::size_t position) const noexcept
+            {
+                return attacks.data() + (suit*positions + position)*words;
+            }
+        };
+
+        /**
+         * Many positions of one layout stored as structure-of-arrays
+         * bitboards: one bitboard per suit and kind of piece, and one per
+         * suit for its pieces and for the positions it is to move in, each
+         * holding every position of the batch. Positions are stacked one
+         * above the other with blocking rows in between, so Steps moves the
+         * pieces of the whole batch at once and nothing crosses from one
+         * position into the next.
+         *
+         * Pieces are described by their patterns as for DistanceMap: a move
+         * goes to an empty cell by the move pattern, and a capture goes to a
+         * cell of another suit's piece by the attack pattern. Moves that the
+         * patterns leave out, such as a pawn's first double step or en
+         * passant, are not generated. Attacked cells are exact, the same as
+         * AttackMap.
+         *
+         * The whole capacity is worked on by generate(), so fill batches up.
+         */
+        class PositionBatch
+        {
+        public:
+            using Word_t = Bitboard::Word_t;
+            using Position_t = Board::Position_t;
+            using Pattern = piece::Piece::Pattern;
+            using Offset_t = Steps::Offset_t;
+
+        private:
+            std::size_t const width, height, capacity;
+            std::size_t const gap;    //blocking rows after each position, enough for the longest step of any pattern
+            std::size_t const rows;   //per position with the gap, so each starts on a whole word
+            std::size_t const stride; //words per position
+            std::vector<Board::Suit> suits;
+            std::size_t count = 0;
+
+            //Pieces of one suit with the same patterns
+            class Kind
+            {
+            public:
+                std::size_t suit;
+                Pattern moves, attacks;
+                Bitboard pieces;
+            };
+            std::vector<Kind> kinds;
+            //Pieces of one suit by the offsets they move with, so each offset is stepped once
+            class Sources
+            {
+            public:
+                std::map<Offset_t, Bitboard> leaps, slides;
+            };
+            std::vector<Sources> move_sources, attack_sources; //by suit
+            std::vector<Bitboard> occupied, turns;             //by suit
+            Bitboard cells;                                    //the cells of every position, not the gaps
+            Bitboard all, empty, enemy, reach, targets, attacks;
+            Steps steps;
+
+            Pattern moves, attacked;                             //reused for each piece
+            std::vector<std::pair<std::size_t, Position_t>> placed; //kind and cell of each piece being added
+            std::vector<std::pair<std::size_t, Move::Packed_t>> found; //position and move, before sorting
+
+            static std::size_t gapFor(config::BoardConfig const &conf);
+            static std::size_t rowsFor(std::size_t w, std::size_t h, std::size_t gap) noexcept;
+            std::size_t kindOf(std::size_t suit);
+            Bitboard &sources(std::map<Offset_t, Bitboard> &m, Offset_t const &o);
+            void setBit(Bitboard &b, std::size_t position, Position_t const &p) noexcept
+            {
+                std::size_t const i = (position*rows + p.y)*width + p.x;
+                b.data()[i/64] |= Word_t(1) << (i%64);
+            }
+            //Adds a move for each cell in targets, reached from a piece by o
+            void collect(Offset_t const &o, bool slide);
+
+        public:
+            PositionBatch(config::BoardConfig const &conf, std::size_t capacity, util::BitKernels const &k = util::BitKernels::best());
+
+            std::size_t size() const noexcept
+            {
+                return count;
+            }
+            bool full() const noexcept
+            {
+                return count == capacity;
+            }
+
+            //Adds a position with the suit to move, false if the batch is full, the board is
+            //of another size, or a piece has no patterns or steps further than the layout's pieces
+            bool add(Board const &b, Board::Suit const &turn);
+            //Empties the batch, keeping its memory
+            void clear();
+
+            //Generates the moves and attacked cells of every position
+            void generate(BatchMoves &out);
+        };
+    }
+}
+
+#endif
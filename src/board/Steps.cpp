@@ -0,0 +1,86 @@
+#include "Steps.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace chesspp
+{
+    namespace board
+    {
+        Steps::Steps(std::size_t w, std::size_t h, util::BitKernels const &kernels, std::size_t longest_)
+        : k(kernels) //can't use {}
+        , width{w}
+        , height{h}
+        , longest{longest_? longest_ : std::max(w, h)}
+        , generate{w, h}
+        , propagate{w, h}
+        , scratch{w, h}
+        {
+        }
+
+        Bitboard const &Steps::landingFor(signed dx)
+        {
+            auto it = landing.find(dx);
+            if(it == landing.end())
+            {
+                Bitboard mask {width, height};
+                //by bit rather than Position_t, which may not reach every row of a stacked board
+                for(std::size_t x = 0; x < width; ++x)
+                {
+                    signed from = static_cast<signed>(x) - dx;
+                    if(from < 0 || static_cast<std::size_t>(from) >= width)
+                    {
+                        continue;
+                    }
+                    for(std::size_t i = x; i < width*height; i += width)
+                    {
+                        mask.data()[i/64] |= Bitboard::Word_t(1) << (i%64);
+                    }
+                }
+                it = landing.emplace(dx, std::move(mask)).first;
+            }
+            return it->second;
+        }
+
+        void Steps::leap(Bitboard &out, Bitboard const &from, Offset_t const &o)
+        {
+            k.orAndShift(out.data(), out.data(), landingFor(o.first).data(), from.data(), out.words(), shift(o));
+        }
+
+        void Steps::slide(Bitboard &out, Bitboard const &from, Offset_t const &step, Bitboard const &empty)
+        {
+            long s = shift(step);
+            auto const &land = landingFor(step.first);
+            std::size_t words = out.words();
+
+            //propagate: cells a ray can pass through, generate: cells the rays have reached
+            std::copy(empty.data(), empty.data() + words, propagate.data());
+            k.andInto(propagate.data(), land.data(), words);
+            std::copy(from.data(), from.data() + words, generate.data());
+            for(std::size_t reach = 1; reach < longest; reach *= 2, s *= 2)
+            {
+                k.orAndShift(scratch.data(), generate.data(), propagate.data(), generate.data(), words, s);
+                std::swap(generate, scratch);
+                if(reach*2 < longest)
+                {
+                    k.andShift(scratch.data(), propagate.data(), propagate.data(), words, s);
+                    std::swap(propagate, scratch);
+                }
+            }
+            //one more step from every reached cell, onto the piece in the way if there is one
+            k.orAndShift(out.data(), out.data(), land.data(), generate.data(), words, shift(step));
+        }
+
+        void Steps::reach(Bitboard &out, Bitboard const &from, piece::Piece::Pattern const &p, Bitboard const &empty)
+        {
+            for(auto const &o : p.leaps)
+            {
+                leap(out, from, o);
+            }
+            for(auto const &o : p.slides)
+            {
+                slide(out, from, o, empty);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ChessPlusPlus_Board_BitboardStepsClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_BitboardStepsClass_HeaderPlusPlus
+
+#include "board/Bitboard.hpp"
+#include "piece/Piece.hpp"
+#include "util/BitKernels.hpp"
+
+#include <cstddef>
+#include <map>
+
+namespace chesspp
+{
+    namespace board
+    {
+        /**
+         * Moves every cell of a bitboard at once, by a leap or along a slide,
+         * for boards of any size. A step of (dx, dy) is a shift by
+         * dy*width + dx, masked so that nothing wraps around from one row to
+         * the next. Slides are flooded with a Kogge-Stone fill, which takes
+         * log2 of the board size rounds however long the rays are.
+         *
+         * Keeps masks and buffers between calls, so keep one per board size.
+         */
+        class Steps
+        {
+        public:
+            using Offset_t = piece::Piece::Pattern::Offset_t;
+
+        private:
+            util::BitKernels const &k;
+            std::size_t const width, height, longest;
+            std::map<signed, Bitboard> landing; //cells a shift by dx can land on without wrapping a row, by dx
+            Bitboard generate, propagate, scratch;
+
+            Bitboard const &landingFor(signed dx);
+            long shift(Offset_t const &o) const noexcept
+            {
+                return static_cast<long>(o.second)*static_cast<long>(width) + o.first;
+            }
+
+        public:
+            //Rays are at most longest cells, by default the longer side. Boards stacking
+            //several positions, e.g. PositionBatch, can pass the longer side of one.
+            Steps(std::size_t w, std::size_t h, util::BitKernels const &kernels = util::BitKernels::best(), std::size_t longest = 0);
+
+            util::BitKernels const &kernels() const noexcept
+            {
+                return k;
+            }
+
+            //out |= the cells of from moved by an offset, leaving out those that end up off the board
+            void leap(Bitboard &out, Bitboard const &from, Offset_t const &o);
+            //out |= the cells reached by repeating a step from the cells of from through empty
+            //cells, up to and including the first cell that isn't empty
+            void slide(Bitboard &out, Bitboard const &from, Offset_t const &step, Bitboard const &empty);
+            //out |= the cells reached from the cells of from by any leap or slide of a pattern
+            void reach(Bitboard &out, Bitboard const &from, piece::Piece::Pattern const &p, Bitboard const &empty);
+        };
+    }
+}
+
+#endif
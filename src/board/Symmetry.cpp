@@ -0,0 +1,143 @@
+#include "Symmetry.hpp"
+
+#include "board/Board.hpp"
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <set>
+
+namespace chesspp
+{
+    namespace board
+    {
+        namespace
+        {
+            using Pattern = piece::Piece::Pattern;
+
+            //Whether a pattern turned by s is the same as another, in any order
+            static bool sameTurned(Symmetry const &s, Pattern a, Pattern b)
+            {
+                for(auto *offsets : {&a.leaps, &a.slides})
+                {
+                    for(auto &o : *offsets)
+                    {
+                        o = s(o);
+                    }
+                }
+                for(auto *p : {&a, &b})
+                {
+                    std::sort(p->leaps.begin(), p->leaps.end());
+                    std::sort(p->slides.begin(), p->slides.end());
+                }
+                return a == b;
+            }
+
+            //Whether the movements of one piece turned by s are those of another
+            static bool sameTurned(Symmetry const &s, Board::MovementsRange a, Board::MovementsRange b)
+            {
+                std::vector<Board::Position_t> x, y;
+                for(auto const &m : a)
+                {
+                    x.push_back(s(m.second));
+                }
+                for(auto const &m : b)
+                {
+                    y.push_back(m.second);
+                }
+                std::sort(x.begin(), x.end());
+                std::sort(y.begin(), y.end());
+                return x == y;
+            }
+
+            //The suits s swaps, or false if the pieces of b don't allow it
+            static bool suitsFor(Board &b, Symmetry const &s, Symmetry::Suits_t &suits)
+            {
+                suits.clear();
+                for(auto const &p : b)
+                {
+                    auto it = b.find(s(p->pos));
+                    if(it == b.end() || (*it)->pclass != p->pclass)
+                    {
+                        return false;
+                    }
+                    auto const &q = **it;
+                    auto known = suits.find(p->suit);
+                    if(known != suits.end() && known->second != q.suit)
+                    {
+                        return false;
+                    }
+                    suits[p->suit] = q.suit;
+
+                    Pattern pm, qm, pa, qa;
+                    bool const moves = p->movePattern(pm);
+                    bool const attacks = p->attackPattern(pa);
+                    if(!moves || moves != q.movePattern(qm) || attacks != q.attackPattern(qa)
+                    || !sameTurned(s, pm, qm) || (attacks && !sameTurned(s, pa, qa)))
+                    {
+                        return false;
+                    }
+                    if(!sameTurned(s, b.pieceTrajectory(*p), b.pieceTrajectory(q))
+                    || !sameTurned(s, b.pieceCapturing(*p), b.pieceCapturing(q))
+                    || !sameTurned(s, b.pieceCapturable(*p), b.pieceCapturable(q)))
+                    {
+                        return false;
+                    }
+                }
+                //a swap has to go both ways
+                for(auto const &swap : suits)
+                {
+                    auto back = suits.find(swap.second);
+                    if(back == suits.end() || back->second != swap.first)
+                    {
+                        return false;
+                    }
+                }
+                for(auto it = suits.begin(); it != suits.end(); )
+                {
+                    if(it->first == it->second)
+                    {
+                        it = suits.erase(it);
+                    }
+                    else ++it;
+                }
+                return true;
+            }
+
+            //Whether the suits still take turns in the same order once s swaps them,
+            //as suits take turns in the order of BoardConfig::suits()
+            static bool keepsTurns(Symmetry const &s, std::set<Symmetry::Suit> const &suits)
+            {
+                std::vector<Symmetry::Suit> order {suits.begin(), suits.end()};
+                auto index = [&](Symmetry::Suit const &suit) -> std::size_t
+                {
+                    return std::find(order.begin(), order.end(), suit) - order.begin();
+                };
+                for(std::size_t i = 0; i < order.size(); ++i)
+                {
+                    auto const next = (index(s(order[i])) + 1) % order.size();
+                    if(order[next] != s(order[(i + 1) % order.size()]))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        std::vector<Symmetry> Symmetry::of(Board &b)
+        {
+            std::size_t const w = b.config.boardWidth(), h = b.config.boardHeight();
+            std::vector<Symmetry> found {Symmetry{w, h, false, false}};
+            for(auto const &mirror : {std::make_pair(true, false), std::make_pair(false, true), std::make_pair(true, true)})
+            {
+                Symmetry s {w, h, mirror.first, mirror.second};
+                Suits_t suits;
+                if(suitsFor(b, s, suits) && keepsTurns(Symmetry{w, h, false, false, suits}, b.config.suits()))
+                {
+                    found.emplace_back(w, h, mirror.first, mirror.second, std::move(suits));
+                }
+            }
+            return found;
+        }
+    }
+}
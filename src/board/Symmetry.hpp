@@ -0,0 +1,85 @@
+#ifndef ChessPlusPlus_Board_BoardSymmetryClass_HeaderPlusPlus
+#define ChessPlusPlus_Board_BoardSymmetryClass_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+#include "board/Move.hpp"
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace board
+    {
+        class Board;
+
+        /**
+         * A way of turning the board over - mirroring its columns, its rows or
+         * both, which is a 180 degree turn - and swapping suits, under which
+         * the rules of a layout can't tell a position from the original.
+         * Applying a symmetry twice gives back what it was applied to, so it
+         * also turns a canonical position back.
+         */
+        class Symmetry
+        {
+        public:
+            using Position_t = config::BoardConfig::Position_t;
+            using Suit = config::BoardConfig::SuitClass_t;
+            using Offset_t = std::pair<signed, signed>;
+            using Suits_t = std::map<Suit, Suit>; //suits not in it stay as they are
+
+        private:
+            Position_t::value_type last_x, last_y;
+            bool columns, rows;
+            Suits_t suit_map;
+
+        public:
+            Symmetry(std::size_t width, std::size_t height, bool mirror_columns, bool mirror_rows, Suits_t suits = Suits_t{})
+            : last_x{static_cast<Position_t::value_type>(width - 1)}
+            , last_y{static_cast<Position_t::value_type>(height - 1)}
+            , columns{mirror_columns}
+            , rows{mirror_rows}
+            , suit_map(std::move(suits)) //can't use {}
+            {
+            }
+
+            bool mirrorsColumns() const noexcept { return columns;  }
+            bool mirrorsRows()    const noexcept { return rows;     }
+            Suits_t const &suits() const noexcept { return suit_map; }
+
+            Position_t operator()(Position_t const &p) const noexcept
+            {
+                return Position_t(columns? last_x - p.x : p.x, rows? last_y - p.y : p.y);
+            }
+            Move operator()(Move const &m) const noexcept
+            {
+                return Move((*this)(m.from), (*this)(m.to));
+            }
+            Offset_t operator()(Offset_t const &o) const noexcept
+            {
+                return Offset_t(columns? -o.first : o.first, rows? -o.second : o.second);
+            }
+            Suit const &operator()(Suit const &s) const noexcept
+            {
+                auto it = suit_map.find(s);
+                return it == suit_map.end()? s : it->second;
+            }
+
+            /**
+             * Finds the symmetries of a board in its starting position, the
+             * identity first. A symmetry is only kept if every piece lands on
+             * a piece of the same class whose suit it swaps with consistently,
+             * and the two have the same move and attack patterns and starting
+             * movements once turned - so pawns must face the mirrored way, and
+             * pieces that can't describe their moves with patterns keep only
+             * the identity. The suits swapped must also still take turns in
+             * the same order.
+             */
+            static std::vector<Symmetry> of(Board &b);
+        };
+    }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <utility>
 #include <map>
+#include <set>
 
 namespace chesspp
 {
@@ -28,16 +29,58 @@ namespace chesspp
             BoardSize_t board_width, board_height;
             CellSize_t cell_width, cell_height;
             Layout_t layout;
+            std::set<SuitClass_t> suit_set;
             Textures_t textures;
+            std::uint64_t layout_fingerprint;
+
+            //FNV-1a of a JSON value, object members in name order, skipping names in skip
+            static std::uint64_t fingerprintOf(util::JsonReader::NestedValue const &v, std::set<std::string> const &skip = {}, std::uint64_t h = 14695981039346656037ULL)
+            {
+                auto bytes = [&h](void const *p, std::size_t n)
+                {
+                    for(std::size_t i = 0; i < n; ++i)
+                    {
+                        h = (h ^ static_cast<unsigned char const *>(p)[i]) * 1099511628211ULL;
+                    }
+                };
+                auto const type = static_cast<unsigned char>(v.type());
+                bytes(&type, 1);
+                switch(v.type())
+                {
+                case json_object:
+                    for(auto const &member : v.object())
+                    {
+                        if(!skip.count(member.first))
+                        {
+                            bytes(member.first.c_str(), member.first.size() + 1);
+                            h = fingerprintOf(member.second, {}, h);
+                        }
+                    }
+                    break;
+                case json_array:
+                    for(std::size_t i = 0; i < v.length(); ++i)
+                    {
+                        h = fingerprintOf(v[i], {}, h);
+                    }
+                    break;
+                case json_integer: { std::int64_t i = v;     bytes(&i, sizeof(i));           } break;
+                case json_double:  { double d = v;           bytes(&d, sizeof(d));           } break;
+                case json_string:  { std::string t = v;      bytes(t.c_str(), t.size() + 1); } break;
+                case json_boolean: { bool b = v;             bytes(&b, sizeof(b));           } break;
+                default: break;
+                }
+                return h;
+            }
 
         public:
-            BoardConfig(ResourcesConfig &res)
-            : Configuration{"config/chesspp/board.json"}
+            BoardConfig(ResourcesConfig &res, std::string const &board_file = "config/chesspp/board.json")
+            : Configuration{board_file}
             , board_width  {reader()["board"]["width"]      }
             , board_height {reader()["board"]["height"]     }
             , cell_width   {reader()["board"]["cell width"] }
             , cell_height  {reader()["board"]["cell height"]}
             {
+                util::Allocations::Scope tag {util::Allocations::Subsystem::Config};
                 auto pieces = reader()["board"]["pieces"];
                 auto suits  = reader()["board"]["suits"];
                 for(BoardSize_t r = 0; r < board_height; ++r)
@@ -49,10 +92,17 @@ namespace chesspp
                         if(piece.type() != json_null) //it is OK if suit is null
                         {
                             layout[{c, r}] = std::make_pair<PieceClass_t, SuitClass_t>(piece, suit);
+                            if(suit.type() != json_null)
+                            {
+                                suit_set.insert(SuitClass_t(suit));
+                            }
                         }
                     }
                 }
 
+                //cell sizes only change how the board is drawn
+                layout_fingerprint = fingerprintOf(reader()["board"], {"cell width", "cell height"});
+
                 auto const &tex = res.setting("board", "pieces");
                 for(auto const &suit : tex.object())
                 {
@@ -70,6 +120,10 @@ namespace chesspp
             CellSize_t        cellWidth    () const noexcept { return cell_width;   }
             CellSize_t        cellHeight   () const noexcept { return cell_height;  }
             Textures_t const &texturePaths () const noexcept { return textures;     }
+            //The suits with pieces in the initial layout, in sorted order, which is the order they take turns in
+            std::set<SuitClass_t> const &suits() const noexcept { return suit_set; }
+            //Tells variants apart: configs get the same value only if their sizes, layouts and metadata match
+            std::uint64_t fingerprint() const noexcept { return layout_fingerprint; }
 
             template<typename... Args>
             util::JsonReader::NestedValue metadata(Args const &... path) const
@@ -20,6 +20,7 @@ namespace chesspp
             static std::string executablePath();
 
             std::string res_path;
+            std::string file_path;
             util::JsonReader reader;
 
         private:
@@ -40,7 +41,7 @@ namespace chesspp
                 {
                     res_path = exe_path;
                 }
-                return res_path + configFile;
+                return file_path = res_path + configFile;
             }
 
         public:
@@ -50,6 +51,12 @@ namespace chesspp
             }
             virtual ~Configuration() = default;
 
+            //The file read, found next to the executable if not in the working directory
+            std::string const &path() const noexcept
+            {
+                return file_path;
+            }
+
             template<typename... Path>
             auto setting(Path const &... path)
             -> decltype(reader.navigate(path...))
@@ -0,0 +1,100 @@
+#ifndef ChessPlusPlus_Config_EvaluationConfigurationManagerClass_HeaderPlusPlus
+#define ChessPlusPlus_Config_EvaluationConfigurationManagerClass_HeaderPlusPlus
+
+#include "Configuration.hpp"
+#include "BoardConfig.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace config
+    {
+        //Weights the computer players judge positions by, in hundredths of a pawn
+        class EvaluationConfig : public Configuration
+        {
+        public:
+            using Score_t = int;
+            using Values_t = std::map<BoardConfig::PieceClass_t, Score_t>;
+            //By suit and piece class, one value per cell y*width + x
+            using Squares_t = std::map<std::pair<BoardConfig::SuitClass_t, BoardConfig::PieceClass_t>, std::vector<Score_t>>;
+        private:
+            Values_t values;
+            Squares_t squares;
+            Score_t unknown;
+            Score_t mobility_weight;
+            BoardConfig::PieceClass_t tropism_target;
+            Score_t tropism_weight;
+            std::size_t tropism_moves;
+
+            static Score_t score(util::JsonReader::NestedValue const &v) noexcept
+            {
+                //tuned weights may be written with a fractional part
+                return v.type() == json_double? static_cast<Score_t>(static_cast<double>(v)) : static_cast<Score_t>(static_cast<std::int32_t>(v));
+            }
+
+        public:
+            EvaluationConfig(std::string const &file = "config/chesspp/evaluation.json")
+            : Configuration{file}
+            , unknown         {score(reader()["evaluation"]["unknown piece"])}
+            , mobility_weight {score(reader()["evaluation"]["mobility"])     }
+            , tropism_target  {BoardConfig::PieceClass_t(reader()["evaluation"]["tropism"]["target"])}
+            , tropism_weight  {score(reader()["evaluation"]["tropism"]["weight"])}
+            , tropism_moves   {static_cast<std::uint32_t>(reader()["evaluation"]["tropism"]["moves"])}
+            {
+                util::Allocations::Scope tag {util::Allocations::Subsystem::Config};
+                for(auto const &piece : reader()["evaluation"]["pieces"].object())
+                {
+                    values[piece.first] = score(piece.second);
+                }
+                //piece-square tables are optional, e.g. written by chesspp-tune
+                for(auto const &suit : reader()["evaluation"]["squares"].object())
+                {
+                    for(auto const &piece : suit.second.object())
+                    {
+                        auto &table = squares[{suit.first, piece.first}];
+                        for(std::size_t i = 0; i < piece.second.length(); ++i)
+                        {
+                            table.push_back(score(piece.second[i]));
+                        }
+                    }
+                }
+            }
+            virtual ~EvaluationConfig() = default;
+
+            //The material value of a piece class
+            Score_t pieceValue(BoardConfig::PieceClass_t const &pclass) const noexcept
+            {
+                auto it = values.find(pclass);
+                return it != values.end()? it->second : unknown;
+            }
+            Values_t const &pieceValues() const noexcept { return values;          }
+            //Added for a piece of a suit and class standing on a cell, 0 for cells past the end of its table
+            Score_t squareValue(BoardConfig::SuitClass_t const &suit, BoardConfig::PieceClass_t const &pclass, std::size_t cell) const
+            {
+                if(squares.empty())
+                {
+                    return 0;
+                }
+                auto it = squares.find({suit, pclass});
+                return it != squares.end() && cell < it->second.size()? it->second[cell] : 0;
+            }
+            Squares_t const &squareValues() const noexcept { return squares; }
+            Score_t unknownValue() const noexcept        { return unknown;         }
+            //Added for each tile a suit can move to or capture on
+            Score_t mobility() const noexcept            { return mobility_weight; }
+            //The class of the enemy pieces that pieces are rewarded for being few moves away from
+            BoardConfig::PieceClass_t const &tropismTarget() const noexcept { return tropism_target; }
+            //Added for each move less than tropismMoves()+1 a piece needs to reach a target, 0 to leave it out
+            Score_t tropism() const noexcept             { return tropism_weight;  }
+            std::size_t tropismMoves() const noexcept    { return tropism_moves;   }
+        };
+    }
+}
+
+#endif
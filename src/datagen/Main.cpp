@@ -0,0 +1,146 @@
+#include "datagen/Pipeline.hpp"
+#include "server/Game.hpp"
+#include "train/PositionReader.hpp"
+#include "net/MetricsExporter.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <typeinfo>
+
+namespace
+{
+    //Reads one shuffled epoch of the chunk files in a directory and reports how fast it went
+    void readBench(std::string const &dir, chesspp::train::PositionReader::Options const &options) noexcept(false)
+    {
+        using namespace chesspp;
+        train::PositionReader reader {train::PositionReader::filesIn(dir), options};
+        auto start = std::chrono::steady_clock::now();
+        reader.start(0);
+        std::uint64_t positions = 0, features = 0;
+        std::size_t batches = 0;
+        while(auto b = reader.next())
+        {
+            positions += b->size;
+            features += b->features.size();
+            ++batches;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(1) << positions << " positions in " << batches << " batches, "
+                  << features << " features, " << seconds << "s (" << (seconds > 0 ? positions/seconds : 0.0) << " positions/s, "
+                  << (seconds > 0 ? reader.bytes()/(1024.0*1024.0)/seconds : 0.0) << "MiB/s)" << std::endl;
+    }
+}
+
+//Plays games against itself on every core and writes sampled, scored positions as packed chunk files.
+//Usage: chesspp-datagen --out <dir> [--variant name] [--positions n] [--duration seconds]
+//                       [--play-threads n] [--score-threads n] [--random-plies n] [--play-depth plies]
+//                       [--score-depth plies] [--max-plies n] [--skip-plies n] [--sample-rate 0..1]
+//                       [--royal class] [--chunk positions] [--seed n]
+//                       [--metrics unix:<path>|tcp:<port>] [--metrics-file path] [--metrics-every seconds] [--verbose]
+//With --read it instead times reading one shuffled epoch of the chunk files in a directory.
+//       chesspp-datagen --read <dir> [--batch n] [--block positions] [--prefetch batches] [--threads n] [--seed n]
+int main(int argc, char const *const *argv)
+{
+    std::string variant = "board";
+    chesspp::datagen::Pipeline::Options options
+    {
+        "", 1000000, std::chrono::seconds(0), 0, 0, 8, 1, 2, 300, 8, 0.1, "King", 1 << 20, 1
+    };
+    std::string read_dir;
+    chesspp::train::PositionReader::Options read_options {16384, 65536, 8, 0, 1, true};
+    chesspp::net::MetricsExporter::Options metrics {"", "", std::chrono::seconds(10)};
+    bool verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--out"           && has_value) options.out           = argv[++i];
+        else if(arg == "--variant"       && has_value) variant               = argv[++i];
+        else if(arg == "--positions"     && has_value) options.positions     = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--duration"      && has_value) options.duration      = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--play-threads"  && has_value) options.play_threads  = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--score-threads" && has_value) options.score_threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--random-plies"  && has_value) options.random_plies  = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--play-depth"    && has_value) options.play_depth    = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--score-depth"   && has_value) options.score_depth   = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--max-plies"     && has_value) options.max_plies     = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--skip-plies"    && has_value) options.skip_plies    = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--sample-rate"   && has_value) options.sample_rate   = std::strtod(argv[++i], nullptr);
+        else if(arg == "--royal"         && has_value) options.royal         = argv[++i];
+        else if(arg == "--chunk"         && has_value) options.per_chunk     = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--seed"          && has_value) options.seed          = read_options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--read"          && has_value) read_dir              = argv[++i];
+        else if(arg == "--batch"         && has_value) read_options.batch_size      = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--block"         && has_value) read_options.block_positions = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--prefetch"      && has_value) read_options.prefetch        = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--threads"       && has_value) read_options.threads         = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--metrics"       && has_value) metrics.endpoint      = argv[++i];
+        else if(arg == "--metrics-file"  && has_value) metrics.file          = argv[++i];
+        else if(arg == "--metrics-every" && has_value) metrics.interval      = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--verbose")                    verbose               = true;
+        else
+        {
+            options.out.clear();
+            read_dir.clear();
+            break;
+        }
+    }
+    if(options.out.empty() && read_dir.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --out <dir> [--variant name] [--positions n] [--duration seconds]"
+                     " [--play-threads n] [--score-threads n] [--random-plies n] [--play-depth plies]"
+                     " [--score-depth plies] [--max-plies n] [--skip-plies n] [--sample-rate 0..1]"
+                     " [--royal class] [--chunk positions] [--seed n]"
+                     " [--metrics unix:<path>|tcp:<port>] [--metrics-file path] [--metrics-every seconds] [--verbose]" << std::endl
+                  << "       " << argv[0] << " --read <dir> [--batch n] [--block positions] [--prefetch batches] [--threads n] [--seed n]" << std::endl;
+        return -1;
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    if(!read_dir.empty())
+    {
+        try
+        {
+            readBench(read_dir, read_options);
+            return 0;
+        }
+        catch(std::exception &e)
+        {
+            std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    try
+    {
+        chesspp::config::ResourcesConfig res;
+        chesspp::server::Variant v {res, variant, "config/chesspp/" + variant + ".json"};
+        std::unique_ptr<chesspp::net::MetricsExporter> exporter;
+        if(!metrics.endpoint.empty() || !metrics.file.empty())
+        {
+            exporter.reset(new chesspp::net::MetricsExporter{chesspp::util::Metrics::global(), metrics});
+        }
+        chesspp::datagen::Pipeline pipeline {v, options};
+        std::cout << "Writing " << options.positions << " positions of " << variant << " to " << options.out
+                  << " on " << std::max(1u, std::thread::hardware_concurrency()) << " cores" << std::endl;
+        pipeline.run(&std::cout);
+        pipeline.report(std::cout);
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,298 @@
+#include "Pipeline.hpp"
+
+#include "train/ChunkFile.hpp"
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+namespace chesspp
+{
+    namespace datagen
+    {
+        namespace
+        {
+            static std::uint64_t microsecondsSince(Pipeline::Clock::time_point t) noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Pipeline::Clock::now() - t).count());
+            }
+            ai::Search::Limits depthLimit(unsigned depth) noexcept
+            {
+                return ai::Search::Limits{depth, 0, ai::Search::Clock::time_point::max()};
+            }
+        }
+
+        Pipeline::Pipeline(server::Variant const &v, Options const &opts, std::string const &eval_file) noexcept(false)
+        : variant(v) //can't use {}
+        , options(opts) //can't use {}
+        , eval_config{eval_file}
+        , evaluator{eval_config}
+        , layout{v.config}
+        , games{256}
+        , samples{4096}
+        , scored{4096}
+        {
+        }
+        Pipeline::~Pipeline()
+        {
+            stopping = true;
+            for(auto &t : threads)
+            {
+                if(t.joinable())
+                {
+                    t.join();
+                }
+            }
+        }
+
+        bool Pipeline::lostRoyal(board::Board const &b, std::vector<bool> &had_royal) const
+        {
+            std::vector<bool> has(layout.suits.size(), false);
+            for(auto const &p : b)
+            {
+                if(p->pclass == options.royal)
+                {
+                    has[layout.suitIndex(p->suit)] = true;
+                }
+            }
+            bool lost = false;
+            for(std::size_t s = 0; s < has.size(); ++s)
+            {
+                lost = lost || (had_royal[s] && !has[s]);
+            }
+            had_royal = has;
+            return lost;
+        }
+
+        void Pipeline::play(unsigned index)
+        {
+            std::mt19937 rng {options.seed + index};
+            ai::Search search {evaluator, variant.players, 1 << 12};
+            search.threads(1);
+            while(!stopping)
+            {
+                auto const start = Clock::now();
+                std::unique_ptr<PlayedGame> g {new PlayedGame};
+                board::Board b {variant.config};
+                std::vector<bool> had_royal(layout.suits.size(), false);
+                lostRoyal(b, had_royal);
+                auto turn = variant.first_turn;
+                for(unsigned ply = 0; ply < options.max_plies && !stopping; ++ply)
+                {
+                    auto const &suit = variant.players[turn];
+                    board::Move m;
+                    if(ply < options.random_plies)
+                    {
+                        auto legal = b.legalMoves(suit);
+                        if(legal.empty())
+                        {
+                            break;
+                        }
+                        m = legal[std::uniform_int_distribution<std::size_t>{0, legal.size() - 1}(rng)];
+                    }
+                    else
+                    {
+                        auto r = search.run(b, suit, depthLimit(options.play_depth));
+                        nodes += r.nodes;
+                        if(!r.found)
+                        {
+                            break;
+                        }
+                        m = r.best;
+                    }
+                    if(!b.moveTo(b.find(m.from), m.to))
+                    {
+                        break;
+                    }
+                    g->moves.push_back(m);
+                    if(lostRoyal(b, had_royal))
+                    {
+                        g->result = static_cast<std::uint8_t>(turn);
+                        break;
+                    }
+                    turn = (turn + 1) % variant.players.size();
+                }
+                plies += g->moves.size();
+                ++game_count;
+                game_times.record(microsecondsSince(start));
+                if(!games.push(std::move(g)))
+                {
+                    break;
+                }
+            }
+            if(--playing == 0)
+            {
+                games.close();
+            }
+        }
+
+        void Pipeline::sample()
+        {
+            std::mt19937 rng {options.seed ^ 0x9E3779B9u};
+            std::uniform_real_distribution<double> chance {0.0, 1.0};
+            std::unique_ptr<PlayedGame> g;
+            while(games.pop(g))
+            {
+                if(stopping)
+                {
+                    continue; //drain so the players are not left waiting
+                }
+                board::Board b {variant.config};
+                auto turn = variant.first_turn;
+                for(std::size_t ply = 0; ply < g->moves.size(); ++ply)
+                {
+                    if(ply >= options.skip_plies && chance(rng) < options.sample_rate)
+                    {
+                        std::unique_ptr<Sample> s {new Sample};
+                        s->board.reset(new board::Board{b});
+                        s->turn = turn;
+                        s->result = g->result;
+                        if(!samples.push(std::move(s)))
+                        {
+                            break;
+                        }
+                        ++sampled;
+                    }
+                    b.moveTo(b.find(g->moves[ply].from), g->moves[ply].to);
+                    turn = (turn + 1) % variant.players.size();
+                }
+            }
+            samples.close();
+        }
+
+        void Pipeline::score()
+        {
+            ai::Search search {evaluator, variant.players, 1 << 12};
+            search.threads(1);
+            std::unique_ptr<Sample> s;
+            while(samples.pop(s))
+            {
+                if(stopping)
+                {
+                    continue;
+                }
+                auto const start = Clock::now();
+                auto r = search.run(*s->board, variant.players[s->turn], depthLimit(options.score_depth));
+                nodes += r.nodes;
+                score_times.record(microsecondsSince(start));
+                if(!r.found)
+                {
+                    continue; //nothing to learn from a position with no moves
+                }
+                s->score = r.score;
+                scored.push(std::move(s));
+            }
+            if(--scoring == 0)
+            {
+                scored.close();
+            }
+        }
+
+        void Pipeline::pack()
+        {
+            std::unique_ptr<Sample> s;
+            try
+            {
+                train::ChunkWriter writer {options.out, layout, options.per_chunk};
+                std::vector<std::uint8_t> record(layout.recordSize());
+                while(scored.pop(s))
+                {
+                    if(options.positions && written >= options.positions)
+                    {
+                        continue;
+                    }
+                    if(!layout.pack(*s->board, variant.players[s->turn], s->score, s->result, record.data()))
+                    {
+                        ++unpackable;
+                        continue;
+                    }
+                    writer.append(record.data());
+                    bytes = writer.bytesWritten();
+                    if(++written == options.positions)
+                    {
+                        stopping = true;
+                    }
+                }
+                writer.close();
+                bytes = writer.bytesWritten();
+                files = writer.files();
+            }
+            catch(...)
+            {
+                failure = std::current_exception();
+                stopping = true;
+                while(scored.pop(s))
+                {
+                }
+            }
+            packed = true;
+        }
+
+        void Pipeline::run(std::ostream *progress, std::chrono::seconds report_interval)
+        {
+            started = Clock::now();
+            unsigned const cores = std::max(1u, std::thread::hardware_concurrency());
+            unsigned const play_threads = options.play_threads? options.play_threads : std::max(1u, cores/4);
+            unsigned const score_threads = options.score_threads? options.score_threads : std::max(1u, cores - std::min(cores, play_threads));
+            playing = play_threads;
+            scoring = score_threads;
+            for(unsigned i = 0; i < play_threads; ++i)
+            {
+                threads.emplace_back(&Pipeline::play, this, i);
+            }
+            threads.emplace_back(&Pipeline::sample, this);
+            for(unsigned i = 0; i < score_threads; ++i)
+            {
+                threads.emplace_back(&Pipeline::score, this);
+            }
+            threads.emplace_back(&Pipeline::pack, this);
+
+            auto next_report = started + report_interval;
+            while(!packed)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                auto const now = Clock::now();
+                if(options.duration.count() && now - started >= options.duration)
+                {
+                    stopping = true;
+                }
+                if(progress && now >= next_report)
+                {
+                    double const seconds = std::chrono::duration<double>(now - started).count();
+                    *progress << std::fixed << std::setprecision(1) << seconds << "s: " << written << " positions ("
+                              << written/seconds << "/s), " << game_count << " games, queued " << games.size() << " games, "
+                              << samples.size() << " to score, " << scored.size() << " to pack" << std::endl;
+                    next_report += report_interval;
+                }
+            }
+            for(auto &t : threads)
+            {
+                t.join();
+            }
+            threads.clear();
+            elapsed = Clock::now() - started;
+            if(failure)
+            {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        void Pipeline::report(std::ostream &os) const
+        {
+            double const seconds = std::chrono::duration<double>(elapsed).count();
+            os << std::fixed << std::setprecision(1)
+               << written << " positions in " << seconds << "s (" << (seconds > 0 ? written/seconds : 0.0) << " positions/s), "
+               << files << " files, " << std::setprecision(2) << bytes/(1024.0*1024.0) << "MiB (" << (seconds > 0 ? bytes/(1024.0*1024.0)/seconds : 0.0) << "MiB/s)" << std::endl;
+            os << std::setprecision(1) << game_count << " games, " << plies << " plies, " << sampled << " sampled, " << unpackable << " unpackable, "
+               << nodes << " nodes (" << (seconds > 0 ? nodes/seconds : 0.0) << "/s)" << std::endl;
+            os << "stage waits: play " << games.fullWaits() << " full, sample " << games.emptyWaits() << " empty / " << samples.fullWaits()
+               << " full, score " << samples.emptyWaits() << " empty / " << scored.fullWaits() << " full, pack " << scored.emptyWaits() << " empty" << std::endl;
+            os << "game time: ";
+            game_times.report(os, "us");
+            os << std::endl << "score time: ";
+            score_times.report(os, "us");
+            os << std::endl;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef ChessPlusPlus_DataGen_TrainingDataPipelineClass_HeaderPlusPlus
+#define ChessPlusPlus_DataGen_TrainingDataPipelineClass_HeaderPlusPlus
+
+#include "ai/Evaluator.hpp"
+#include "ai/Search.hpp"
+#include "board/Board.hpp"
+#include "board/Move.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "server/Game.hpp"
+#include "train/PackedPosition.hpp"
+#include "util/BoundedQueue.hpp"
+#include "util/Histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chesspp
+{
+    namespace datagen
+    {
+        /**
+         * Produces labelled positions for training the evaluation, on every
+         * core. Four stages run on their own threads, each connected to the
+         * next by a bounded lock-free queue, so a slow stage holds back the
+         * ones before it instead of piling up memory:
+         *
+         *  - play: self-play games, choosing random moves for the first few
+         *    plies and searching after that, until a suit loses its royal
+         *    piece, a suit has no moves or the game gets too long
+         *  - sample: replays each game and picks some of its positions
+         *  - score: a shallow search of each picked position
+         *  - pack: packs the positions with the games' results and appends
+         *    them to chunk files with a train::ChunkWriter
+         *
+         * Play and score get most of the threads; sample and pack are cheap
+         * and get one each.
+         */
+        class Pipeline
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                std::string out;              //directory for the chunk files
+                std::uint64_t positions;      //stop after this many, 0 for no limit
+                std::chrono::seconds duration; //stop after this long, 0 for no limit
+                unsigned play_threads;
+                unsigned score_threads;
+                unsigned random_plies;        //at the start of each game
+                unsigned play_depth;          //plies searched for each move after that
+                unsigned score_depth;
+                unsigned max_plies;           //games longer than this end without a winner
+                unsigned skip_plies;          //positions this early are not sampled
+                double sample_rate;           //chance of sampling each later position
+                std::string royal;            //a suit that loses all of these loses the game
+                std::uint64_t per_chunk;      //positions per chunk file
+                std::uint32_t seed;
+            };
+
+        private:
+            class PlayedGame
+            {
+            public:
+                std::vector<board::Move> moves;
+                std::uint8_t result = train::Layout::NoWinner;
+            };
+            class Sample
+            {
+            public:
+                std::unique_ptr<board::Board> board;
+                std::size_t turn;
+                std::uint8_t result;
+                train::Layout::Score_t score = 0;
+            };
+
+            server::Variant const &variant;
+            Options const options;
+            config::EvaluationConfig const eval_config;
+            ai::Evaluator const evaluator;
+            train::Layout const layout;
+
+            util::BoundedQueue<std::unique_ptr<PlayedGame>> games;
+            util::BoundedQueue<std::unique_ptr<Sample>> samples, scored;
+            std::atomic<unsigned> playing {0}, scoring {0}; //threads of those stages still running
+            std::atomic<bool> stopping {false}, packed {false};
+            std::vector<std::thread> threads;
+            std::exception_ptr failure; //from the pack stage, rethrown by run()
+
+            std::atomic<std::uint64_t> game_count {0}, plies {0}, sampled {0}, nodes {0}, written {0}, unpackable {0}, bytes {0}, files {0};
+            util::Histogram game_times;  //microseconds per game played
+            util::Histogram score_times; //microseconds per position scored
+            Clock::time_point started;
+            Clock::duration elapsed {};
+
+            void play(unsigned index);
+            void sample();
+            void score();
+            void pack();
+            //Whether a suit that had royal pieces has none left, updating had_royal by suit
+            bool lostRoyal(board::Board const &b, std::vector<bool> &had_royal) const;
+
+        public:
+            //Throws ::chesspp::Exception if the layout can't be packed
+            Pipeline(server::Variant const &v, Options const &opts, std::string const &eval_file = "config/chesspp/evaluation.json") noexcept(false);
+            ~Pipeline();
+            Pipeline(Pipeline const &) = delete;
+            Pipeline &operator=(Pipeline const &) = delete;
+
+            //Runs every stage until the position count or duration is reached, writing
+            //a line of progress to progress, if given, every report_interval
+            void run(std::ostream *progress = nullptr, std::chrono::seconds report_interval = std::chrono::seconds(5));
+
+            //Totals, positions per second and where the stages waited on each other
+            void report(std::ostream &os) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "EngineHost.hpp"
+
+#include "piece/Piece.hpp"
+#include "util/Allocations.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace chesspp
+{
+    namespace engine
+    {
+        EngineHost::EngineHost(ipc::EngineChannel &c, ai::Search::Mode m) noexcept(false)
+        : channel(c) //can't use {}
+        , board_config{res_config, std::string(c.board_file, ::strnlen(c.board_file, ipc::EngineChannel::PathSize))}
+        , evaluator{eval_config}
+        , mode{m}
+        {
+            for(std::uint32_t i = 0; i < std::min<std::uint32_t>(c.player_count, ipc::EngineChannel::MaxPlayers); ++i)
+            {
+                players.emplace_back(c.players[i], ::strnlen(c.players[i], ipc::EngineChannel::NameSize));
+            }
+            if(players.empty())
+            {
+                throw Exception("The engine channel names no players");
+            }
+        }
+
+        EngineHost::~EngineHost() = default;
+
+        bool EngineHost::catchUp(std::uint32_t history_size)
+        {
+            if(history_size > ipc::EngineChannel::MaxHistory)
+            {
+                return false;
+            }
+            if(!board || history_size < applied) //a new game
+            {
+                board.reset(new board::Board(board_config));
+                applied = 0;
+            }
+            for(; applied < history_size; ++applied)
+            {
+                board::Move m {channel.history[applied]};
+                if(!board->moveTo(board->find(m.from), m.to))
+                {
+                    std::cerr << "Engine could not replay " << m << ", starting over" << std::endl;
+                    board.reset();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void EngineHost::publish(std::uint32_t request, ai::Search::Result const &r, bool final, ai::Search::Clock::time_point start) noexcept
+        {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(ai::Search::Clock::now() - start).count();
+            std::uint32_t v = channel.info_version.load(std::memory_order_relaxed);
+            channel.info_version.store(v + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            auto &info = channel.info;
+            info.request = request;
+            info.final = final ? 1 : 0;
+            info.found = r.found ? 1 : 0;
+            info.depth = r.depth;
+            info.score = r.score;
+            info.nodes = r.nodes;
+            info.nps = micros > 0 ? r.nodes*1000000/static_cast<std::uint64_t>(micros) : 0;
+            info.pv_size = static_cast<std::uint32_t>(std::min<std::size_t>(r.pv.size(), ipc::EngineChannel::MaxPv));
+            for(std::uint32_t i = 0; i < info.pv_size; ++i)
+            {
+                info.pv[i] = r.pv[i].pack();
+            }
+
+            channel.info_version.store(v + 2, std::memory_order_release);
+            ipc::futexWake(channel.info_version);
+        }
+
+        void EngineHost::run()
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Engine};
+            pid_t parent = ::getppid();
+            std::uint32_t handled = 0;
+            //one search for every request, so its known positions are allocated once
+            ai::Search search {evaluator, players};
+            search.mode(mode);
+            search.threads(0); //the GUI leaves the machine to the engine while it thinks
+            for(;;)
+            {
+                std::uint32_t seq = channel.request.seq.load(std::memory_order_acquire);
+                if(seq == ipc::EngineChannel::Shutdown)
+                {
+                    return;
+                }
+                if(seq == handled)
+                {
+                    //wake now and then to notice if the GUI died without saying so
+                    ipc::futexWait(channel.request.seq, seq, std::chrono::seconds(1));
+                    if(::getppid() != parent)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+                handled = seq;
+
+                //the GUI does not touch the request again until it bumps seq
+                std::uint32_t const history_size = channel.request.history_size;
+                std::uint32_t const turn = channel.request.turn;
+                unsigned const depth = channel.request.depth;
+                std::chrono::milliseconds const time {channel.request.time_ms};
+                auto start = ai::Search::Clock::now();
+                ai::Search::Result result;
+                if(turn < players.size() && catchUp(history_size))
+                {
+                    search.onProgress([&](ai::Search::Result const &r)
+                    {
+                        publish(seq, r, false, start);
+                    });
+                    search.cancelWhen([&]
+                    {
+                        return channel.request.seq.load(std::memory_order_relaxed) != seq;
+                    });
+                    result = search.run(*board, players[turn], ai::Search::Limits{depth, 0, start + time});
+                }
+                publish(seq, result, true, start);
+            }
+        }
+    }
+}
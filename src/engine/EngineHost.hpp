@@ -0,0 +1,48 @@
+#ifndef ChessPlusPlus_Engine_SharedMemoryEngineHostClass_HeaderPlusPlus
+#define ChessPlusPlus_Engine_SharedMemoryEngineHostClass_HeaderPlusPlus
+
+#include "ipc/EngineChannel.hpp"
+#include "ai/Search.hpp"
+#include "ai/Evaluator.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "config/BoardConfig.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "board/Board.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace chesspp
+{
+    namespace engine
+    {
+        //The engine process side of an EngineChannel: answers search requests until told to stop
+        class EngineHost
+        {
+            ipc::EngineChannel &channel;
+            config::ResourcesConfig res_config;
+            config::BoardConfig board_config;
+            config::EvaluationConfig eval_config;
+            ai::Evaluator evaluator;
+            ai::Players_t players;
+            ai::Search::Mode mode;
+            std::unique_ptr<board::Board> board;
+            std::uint32_t applied = 0; //moves of the history played on the board
+
+            //Brings the board up to the position of the request
+            bool catchUp(std::uint32_t history_size);
+            void publish(std::uint32_t request, ai::Search::Result const &r, bool final, ai::Search::Clock::time_point start) noexcept;
+
+        public:
+            EngineHost(ipc::EngineChannel &channel, ai::Search::Mode mode) noexcept(false);
+            ~EngineHost();
+            EngineHost(EngineHost const &) = delete;
+            EngineHost &operator=(EngineHost const &) = delete;
+
+            //Serves requests until the channel says to shut down or the parent process goes away
+            void run();
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "engine/EngineHost.hpp"
+#include "ai/Search.hpp"
+#include "ai/Evaluator.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "config/BoardConfig.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "board/Board.hpp"
+#include "piece/Piece.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <typeinfo>
+
+namespace
+{
+    //Searches the starting position of a board config once for each suit and reports how fast it went
+    void bench(std::string const &board_file, chesspp::ai::Search::Mode mode, unsigned depth, unsigned threads) noexcept(false)
+    {
+        using namespace chesspp;
+        config::ResourcesConfig res_config;
+        config::BoardConfig board_config {res_config, board_file};
+        config::EvaluationConfig eval_config;
+        ai::Evaluator evaluator {eval_config};
+        ai::Players_t players {board_config.suits().begin(), board_config.suits().end()};
+        board::Board board {board_config};
+        for(auto const &suit : players)
+        {
+            ai::Search search {evaluator, players};
+            search.mode(mode);
+            search.threads(threads);
+            auto start = ai::Search::Clock::now();
+            auto result = search.run(board, suit, ai::Search::Limits{depth, 0, ai::Search::Clock::time_point::max()});
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(ai::Search::Clock::now() - start).count();
+            std::cout << suit << ": depth " << result.depth << ", " << result.nodes << " nodes in " << micros/1000 << "ms ("
+                      << (micros? result.nodes*1000000/static_cast<std::uint64_t>(micros) : 0) << "/s), best " << result.best
+                      << ", score " << result.score << std::endl;
+        }
+    }
+}
+
+//Engine process started by the GUI, sharing memory with it through an inherited descriptor.
+//With --bench it instead times searches from the start of the given board config, e.g. a four suit variant.
+//Usage: chesspp-engine --fd <shared memory descriptor> [--mode paranoid|maxn] [--verbose]
+//       chesspp-engine --bench <board file> [--mode paranoid|maxn] [--depth plies] [--threads n, 0 for one per core]
+int main(int argc, char const *const *argv)
+{
+    int fd = -1;
+    std::string bench_file;
+    chesspp::ai::Search::Mode mode = chesspp::ai::Search::Mode::Paranoid;
+    unsigned depth = 3;
+    unsigned threads = 0;
+    bool verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--fd"      && has_value) fd         = std::atoi(argv[++i]);
+        else if(arg == "--bench"   && has_value) bench_file = argv[++i];
+        else if(arg == "--mode"    && has_value && chesspp::ai::Search::modeNamed(argv[i + 1], mode)) ++i;
+        else if(arg == "--depth"   && has_value) depth      = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--threads" && has_value) threads    = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--verbose")              verbose    = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " --fd <shared memory descriptor> [--mode paranoid|maxn] [--verbose]" << std::endl
+                      << "       " << argv[0] << " --bench <board file> [--mode paranoid|maxn] [--depth plies] [--threads n]" << std::endl;
+            return -1;
+        }
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    if(!bench_file.empty())
+    {
+        try
+        {
+            bench(bench_file, mode, depth, threads);
+            return 0;
+        }
+        catch(std::exception &e)
+        {
+            std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    void *mem = fd == -1 ? MAP_FAILED : ::mmap(nullptr, sizeof(chesspp::ipc::EngineChannel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(mem == MAP_FAILED)
+    {
+        std::cerr << "chesspp-engine must be started by chesspp with --fd" << std::endl;
+        return -1;
+    }
+    ::close(fd);
+    auto &channel = *static_cast<chesspp::ipc::EngineChannel *>(mem);
+    if(channel.magic != chesspp::ipc::EngineChannel::Magic || channel.version != chesspp::ipc::EngineChannel::Version)
+    {
+        std::cerr << "Shared memory is not a matching engine channel" << std::endl;
+        return -1;
+    }
+
+    try
+    {
+        chesspp::engine::EngineHost host {channel, mode};
+        host.run();
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,84 @@
+#include "epd/Runner.hpp"
+#include "epd/Suite.hpp"
+#include "epd/Notation.hpp"
+#include "ai/Evaluator.hpp"
+#include "ai/Search.hpp"
+#include "server/Game.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "board/Board.hpp"
+#include "piece/Piece.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <typeinfo>
+
+//Searches every position of an EPD test suite and reports how many were solved and how fast.
+//Usage: chesspp-epd <suite file> [--variant name] [--eval file] [--depth plies] [--time ms per position]
+//                   [--workers n, 0 for one per core] [--mode paranoid|maxn] [--quiet] [--verbose]
+int main(int argc, char const *const *argv)
+{
+    std::string suite_file, variant = "board", eval_file = "config/chesspp/evaluation.json";
+    chesspp::epd::Runner::Options options {0, 64, std::chrono::milliseconds(1000), chesspp::ai::Search::Mode::Paranoid, 1 << 16};
+    bool quiet = false, verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--variant" && has_value) variant         = argv[++i];
+        else if(arg == "--eval"    && has_value) eval_file       = argv[++i];
+        else if(arg == "--depth"   && has_value) options.depth   = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--time"    && has_value) options.time    = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--workers" && has_value) options.workers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--mode"    && has_value && chesspp::ai::Search::modeNamed(argv[i + 1], options.mode)) ++i;
+        else if(arg == "--quiet")                quiet           = true;
+        else if(arg == "--verbose")              verbose         = true;
+        else if(suite_file.empty() && arg.compare(0, 2, "--") != 0) suite_file = arg;
+        else
+        {
+            suite_file.clear();
+            break;
+        }
+    }
+    if(suite_file.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " <suite file> [--variant name] [--eval file] [--depth plies] [--time ms per position]"
+                     " [--workers n] [--mode paranoid|maxn] [--quiet] [--verbose]" << std::endl;
+        return -1;
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    try
+    {
+        using namespace chesspp;
+        config::ResourcesConfig res;
+        server::Variant v {res, variant, "config/chesspp/" + variant + ".json"};
+        config::EvaluationConfig eval_config {eval_file};
+        ai::Evaluator evaluator {eval_config};
+        board::Board like {v.config};
+        epd::Notation notation {v.config, v.players, v.players[v.first_turn]};
+        std::ifstream in {suite_file};
+        if(!in)
+        {
+            throw Exception("Unable to read \"" + suite_file + "\"");
+        }
+        epd::Suite suite {in, notation, like};
+        epd::Runner runner {evaluator, v.players, notation, like, options};
+        runner.run(suite, quiet? nullptr : &std::cout);
+        runner.report(suite, std::cout);
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,268 @@
+#include "Notation.hpp"
+
+#include "piece/Piece.hpp"
+#include "Exception.hpp"
+
+#include <cctype>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        namespace
+        {
+            char lowerOf(std::string const &name) noexcept
+            {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(name.empty()? '?' : name[0])));
+            }
+            char upperOf(std::string const &name) noexcept
+            {
+                return static_cast<char>(std::toupper(static_cast<unsigned char>(name.empty()? '?' : name[0])));
+            }
+        }
+
+        Notation::Notation(config::BoardConfig const &conf, std::vector<Suit_t> const &players, Suit_t const &first_turn) noexcept(false)
+        : config(conf) //can't use {}
+        {
+            for(auto const &s : players)
+            {
+                if(!suits.emplace(lowerOf(s), s).second)
+                {
+                    throw Exception("Suits \"" + suits[lowerOf(s)] + "\" and \"" + s + "\" have the same letter");
+                }
+            }
+            for(auto const &c : board::Board::pieceClasses())
+            {
+                char const letter = c == "Knight"? 'N' : upperOf(c);
+                if(!classes.emplace(letter, c).second)
+                {
+                    throw Exception("Piece classes \"" + classes[letter] + "\" and \"" + c + "\" have the same letter");
+                }
+                letters[c] = letter;
+            }
+            if(players.size() == 2)
+            {
+                upper = first_turn;
+                lower = players[0] == first_turn? players[1] : players[0];
+            }
+        }
+
+        config::BoardConfig::Layout_t Notation::placement(std::string const &field) const noexcept(false)
+        {
+            config::BoardConfig::Layout_t layout;
+            std::size_t const width = config.boardWidth(), height = config.boardHeight();
+            std::size_t x = 0, y = 0;
+            auto fail = [&](std::string const &why)
+            {
+                return Exception("Bad placement \"" + field + "\": " + why);
+            };
+            for(std::size_t i = 0; i < field.size(); ++i)
+            {
+                char const c = field[i];
+                if(c == '/')
+                {
+                    if(x != width)
+                    {
+                        throw fail("row " + std::to_string(y + 1) + " is not " + std::to_string(width) + " cells");
+                    }
+                    x = 0;
+                    ++y;
+                    continue;
+                }
+                if(std::isdigit(static_cast<unsigned char>(c)))
+                {
+                    std::size_t run = 0;
+                    for(; i < field.size() && std::isdigit(static_cast<unsigned char>(field[i])); ++i)
+                    {
+                        run = run*10 + static_cast<std::size_t>(field[i] - '0');
+                    }
+                    --i;
+                    x += run;
+                    continue;
+                }
+                Suit_t suit;
+                char letter = c;
+                if(c == '(')
+                {
+                    auto s = i + 2 < field.size() && field[i + 2] == ')'? suits.find(field[i + 1]) : suits.end();
+                    if(s == suits.end() || i + 3 >= field.size())
+                    {
+                        throw fail("unknown suit at " + std::to_string(i + 1));
+                    }
+                    suit = s->second;
+                    letter = static_cast<char>(std::toupper(static_cast<unsigned char>(field[i + 3])));
+                    i += 3;
+                }
+                else if(!upper.empty())
+                {
+                    suit = std::isupper(static_cast<unsigned char>(c))? upper : lower;
+                    letter = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+                auto pclass = classes.find(letter);
+                if(suit.empty() || pclass == classes.end())
+                {
+                    throw fail(std::string("unknown piece '") + field[i] + "'");
+                }
+                if(x >= width || y >= height)
+                {
+                    throw fail("more cells than the board has");
+                }
+                layout[Position_t{static_cast<Position_t::value_type>(x), static_cast<Position_t::value_type>(y)}] = std::make_pair(pclass->second, suit);
+                ++x;
+            }
+            if(x != width || y + 1 != height)
+            {
+                throw fail("the board is " + std::to_string(width) + " by " + std::to_string(height));
+            }
+            return layout;
+        }
+
+        bool Notation::suit(std::string const &field, Suit_t &s) const
+        {
+            auto it = field.size() == 1? suits.find(static_cast<char>(std::tolower(static_cast<unsigned char>(field[0])))) : suits.end();
+            if(it == suits.end())
+            {
+                return false;
+            }
+            s = it->second;
+            return true;
+        }
+
+        bool Notation::square(std::string const &text, Position_t &p) const
+        {
+            if(text.size() < 2 || !std::islower(static_cast<unsigned char>(text[0])))
+            {
+                return false;
+            }
+            std::size_t rank = 0;
+            for(std::size_t i = 1; i < text.size(); ++i)
+            {
+                if(!std::isdigit(static_cast<unsigned char>(text[i])))
+                {
+                    return false;
+                }
+                rank = rank*10 + static_cast<std::size_t>(text[i] - '0');
+            }
+            std::size_t const file = static_cast<std::size_t>(text[0] - 'a');
+            if(file >= config.boardWidth() || rank < 1 || rank > config.boardHeight())
+            {
+                return false;
+            }
+            p = Position_t{static_cast<Position_t::value_type>(file), static_cast<Position_t::value_type>(config.boardHeight() - rank)};
+            return true;
+        }
+        std::string Notation::square(Position_t const &p) const
+        {
+            return static_cast<char>('a' + p.x) + std::to_string(config.boardHeight() - p.y);
+        }
+
+        bool Notation::move(board::Board const &b, Suit_t const &s, std::string const &text, board::Move &m) const
+        {
+            std::string t = text;
+            while(!t.empty() && (t.back() == '+' || t.back() == '#' || t.back() == '!' || t.back() == '?'))
+            {
+                t.pop_back();
+            }
+            auto const promotion = t.find('=');
+            if(promotion != std::string::npos)
+            {
+                t.erase(promotion);
+            }
+            else if(t.size() > 2 && std::isupper(static_cast<unsigned char>(t.back())) && std::isdigit(static_cast<unsigned char>(t[t.size() - 2])))
+            {
+                t.pop_back(); //e8Q
+            }
+            if(t.empty() || t[0] == 'O' || t[0] == '0')
+            {
+                return false; //castling
+            }
+            std::string plain;
+            for(char c : t)
+            {
+                if(c != 'x' && c != '-' && c != ':')
+                {
+                    plain += c;
+                }
+            }
+
+            //the destination is the last square
+            std::size_t at = plain.size();
+            while(at > 0 && std::isdigit(static_cast<unsigned char>(plain[at - 1])))
+            {
+                --at;
+            }
+            if(at == 0 || at == plain.size())
+            {
+                return false;
+            }
+            --at;
+            Position_t to;
+            if(!square(plain.substr(at), to))
+            {
+                return false;
+            }
+            std::string prefix = plain.substr(0, at);
+            Class_t pclass = "Pawn";
+            Position_t from;
+            bool const whole_from = square(prefix, from); //from and to squares
+            if(!whole_from && !prefix.empty() && std::isupper(static_cast<unsigned char>(prefix[0])))
+            {
+                auto c = classes.find(prefix[0]);
+                if(c == classes.end())
+                {
+                    return false;
+                }
+                pclass = c->second;
+                prefix.erase(0, 1);
+            }
+            //whatever is left tells pieces of the class apart by file, rank or both
+            int file = -1, rank = -1;
+            if(!whole_from && !prefix.empty())
+            {
+                std::size_t i = 0;
+                if(std::islower(static_cast<unsigned char>(prefix[0])))
+                {
+                    file = prefix[0] - 'a';
+                    ++i;
+                }
+                if(i < prefix.size())
+                {
+                    Position_t p;
+                    if(!square(std::string("a") + prefix.substr(i), p))
+                    {
+                        return false;
+                    }
+                    rank = p.y;
+                }
+            }
+
+            std::size_t found = 0;
+            for(auto const &legal : b.legalMoves(s))
+            {
+                if(legal.to != to)
+                {
+                    continue;
+                }
+                if(whole_from)
+                {
+                    if(legal.from != from)
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    auto p = b.find(legal.from);
+                    if(p == b.end() || (*p)->pclass != pclass || (file >= 0 && legal.from.x != file) || (rank >= 0 && legal.from.y != rank))
+                    {
+                        continue;
+                    }
+                }
+                m = legal;
+                ++found;
+            }
+            return found == 1;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ChessPlusPlus_Epd_PositionNotationClass_HeaderPlusPlus
+#define ChessPlusPlus_Epd_PositionNotationClass_HeaderPlusPlus
+
+#include "board/Board.hpp"
+#include "board/Move.hpp"
+#include "config/BoardConfig.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        /**
+         * Reads and writes positions and moves in the style of FEN and EPD,
+         * for any board config. Files are letters from a, ranks are numbers
+         * from 1 at the bottom row, so boards wider than 26 cells can't be
+         * written.
+         *
+         * Each piece class is written as the first letter of its name,
+         * except a Knight as N. On boards with two suits a piece of the suit
+         * that moves first is written in upper case and one of the other in
+         * lower case, as in FEN. On any board a piece can also be written
+         * with the first letter of its suit in brackets before it, e.g. (r)N
+         * for a Red Knight. The suit to move is written the same way, as one
+         * lower case letter.
+         */
+        class Notation
+        {
+        public:
+            using Position_t = board::Board::Position_t;
+            using Suit_t = config::BoardConfig::SuitClass_t;
+            using Class_t = config::BoardConfig::PieceClass_t;
+
+        private:
+            config::BoardConfig const &config;
+            std::map<char, Suit_t> suits;    //by lower case letter
+            std::map<char, Class_t> classes; //by upper case letter
+            std::map<Class_t, char> letters;
+            Suit_t upper, lower;             //the suits written by case alone, if there are two
+
+        public:
+            //Throws ::chesspp::Exception if two suits or registered piece classes would share a letter
+            Notation(config::BoardConfig const &conf, std::vector<Suit_t> const &players, Suit_t const &first_turn) noexcept(false);
+
+            //Reads the piece placement field, throws ::chesspp::Exception if it doesn't fit the board
+            config::BoardConfig::Layout_t placement(std::string const &field) const noexcept(false);
+            //Reads the suit to move, false if there is no such suit
+            bool suit(std::string const &field, Suit_t &s) const;
+
+            //Reads a square such as e4, false if it isn't one on the board
+            bool square(std::string const &text, Position_t &p) const;
+            std::string square(Position_t const &p) const;
+
+            //Reads a legal move of a suit in standard algebraic notation (Nf3, exd5, e8=Q) or from
+            //and to squares (e2e4, e2-e4). False if it isn't legal, is ambiguous, or is castling,
+            //which this engine has no move for. Promotions are read as plain moves.
+            bool move(board::Board const &b, Suit_t const &s, std::string const &text, board::Move &m) const;
+            //Writes a move as from and to squares
+            std::string move(board::Move const &m) const
+            {
+                return square(m.from) + square(m.to);
+            }
+        };
+    }
+}
+
+#endif
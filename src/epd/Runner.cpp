@@ -0,0 +1,160 @@
+#include "Runner.hpp"
+
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        namespace
+        {
+            double millisecondsOf(Runner::Clock::duration d) noexcept
+            {
+                return std::chrono::duration<double, std::milli>(d).count();
+            }
+            double perSecond(std::uint64_t n, Runner::Clock::duration d) noexcept
+            {
+                double const seconds = std::chrono::duration<double>(d).count();
+                return seconds > 0 ? n/seconds : 0.0;
+            }
+        }
+
+        Runner::Outcome Runner::search(Position const &p) const
+        {
+            auto solving = [&p](board::Move const &m)
+            {
+                return (p.best.empty() || std::find(p.best.begin(), p.best.end(), m) != p.best.end())
+                    && std::find(p.avoid.begin(), p.avoid.end(), m) == p.avoid.end();
+            };
+            Outcome o;
+            o.ran = true;
+            board::Board const b {like, p.layout};
+            ai::Search s {evaluator, players, options.known_positions};
+            s.mode(options.mode);
+            s.threads(1);
+            auto const start = Clock::now();
+            bool solved_since = false;
+            s.onProgress([&](ai::Search::Result const &r)
+            {
+                if(r.found && solving(r.best))
+                {
+                    if(!solved_since)
+                    {
+                        solved_since = true;
+                        o.solved_after = Clock::now() - start;
+                        o.solved_nodes = r.nodes;
+                        o.solved_depth = r.depth;
+                    }
+                }
+                else
+                {
+                    solved_since = false;
+                }
+            });
+            auto const r = s.run(b, p.turn, ai::Search::Limits{options.depth, 0, start + options.time});
+            o.time = Clock::now() - start;
+            o.chosen = r.best;
+            o.depth = r.depth;
+            o.nodes = r.nodes;
+            o.solved = r.found && solving(r.best);
+            if(o.solved && !solved_since)
+            {
+                //chose it without finishing an iteration that did
+                o.solved_after = o.time;
+                o.solved_nodes = r.nodes;
+                o.solved_depth = r.depth;
+            }
+            return o;
+        }
+
+        void Runner::run(Suite const &suite, std::ostream *progress)
+        {
+            auto const started = Clock::now();
+            outcomes.assign(suite.positions.size(), Outcome{});
+            std::atomic<std::size_t> next {0};
+            std::mutex output;
+            auto work = [&]
+            {
+                for(std::size_t i; (i = next++) < suite.positions.size();)
+                {
+                    auto const &p = suite.positions[i];
+                    if(!p.skipped.empty())
+                    {
+                        continue;
+                    }
+                    Outcome const o = search(p);
+                    outcomes[i] = o;
+                    if(progress)
+                    {
+                        std::lock_guard<std::mutex> lock {output};
+                        *progress << std::fixed << std::setprecision(1) << "\"" << p.id << "\": " << (o.solved? "solved" : "FAILED")
+                                  << ", chose " << notation.move(o.chosen) << " at depth " << o.depth << ", " << o.nodes << " nodes in "
+                                  << millisecondsOf(o.time) << "ms (" << perSecond(o.nodes, o.time) << " nps)";
+                        if(o.solved)
+                        {
+                            *progress << ", solved after " << millisecondsOf(o.solved_after) << "ms at depth " << o.solved_depth
+                                      << " (" << o.solved_nodes << " nodes)";
+                        }
+                        *progress << std::endl;
+                    }
+                }
+            };
+            unsigned const workers = options.workers? options.workers : std::max(1u, std::thread::hardware_concurrency());
+            std::vector<std::thread> threads;
+            for(unsigned i = 1; i < workers; ++i)
+            {
+                threads.emplace_back(work);
+            }
+            work();
+            for(auto &t : threads)
+            {
+                t.join();
+            }
+            elapsed = Clock::now() - started;
+        }
+
+        void Runner::report(Suite const &suite, std::ostream &os) const
+        {
+            std::size_t ran = 0, solved = 0;
+            std::uint64_t nodes = 0;
+            Clock::duration searching {};
+            util::Histogram solve_times, solve_nodes;
+            for(std::size_t i = 0; i < outcomes.size(); ++i)
+            {
+                auto const &o = outcomes[i];
+                if(!suite.positions[i].skipped.empty())
+                {
+                    os << "Skipped \"" << suite.positions[i].id << "\": " << suite.positions[i].skipped << std::endl;
+                }
+                if(!o.ran)
+                {
+                    continue;
+                }
+                ++ran;
+                nodes += o.nodes;
+                searching += o.time;
+                if(o.solved)
+                {
+                    ++solved;
+                    solve_times.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(o.solved_after).count()));
+                    solve_nodes.record(o.solved_nodes);
+                }
+            }
+            os << std::fixed << std::setprecision(1)
+               << "Solved " << solved << " of " << ran << " (" << (ran? 100.0*solved/ran : 0.0) << "%), " << suite.positions.size() - ran << " skipped" << std::endl
+               << nodes << " nodes in " << millisecondsOf(searching) << "ms of searching (" << perSecond(nodes, searching) << " nps per worker), "
+               << millisecondsOf(elapsed) << "ms in all (" << perSecond(nodes, elapsed) << " nps, " << perSecond(ran, elapsed) << " positions/s)" << std::endl
+               << "time to solution: ";
+            solve_times.report(os, "us");
+            os << std::endl << "nodes to solution: ";
+            solve_nodes.report(os);
+            os << std::endl;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef ChessPlusPlus_Epd_SuiteRunnerClass_HeaderPlusPlus
+#define ChessPlusPlus_Epd_SuiteRunnerClass_HeaderPlusPlus
+
+#include "epd/Notation.hpp"
+#include "epd/Suite.hpp"
+#include "ai/Evaluator.hpp"
+#include "ai/Search.hpp"
+#include "board/Board.hpp"
+#include "util/Histogram.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        /**
+         * Searches every position of a suite, several at once on worker
+         * threads, each with its own single threaded ai::Search so that
+         * results don't depend on which positions run together. A position
+         * is solved if the search ends on one of its best moves and none of
+         * its moves to avoid. The time to solution is when the iteration
+         * that first chose a solving move finished, if the search never
+         * changed its mind after that.
+         */
+        class Runner
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                unsigned workers;               //0 for one per core
+                unsigned depth;                 //plies
+                std::chrono::milliseconds time; //per position
+                ai::Search::Mode mode;
+                std::size_t known_positions;    //remembered by each search
+            };
+            class Outcome
+            {
+            public:
+                bool ran = false, solved = false;
+                board::Move chosen;
+                unsigned depth = 0;
+                std::uint64_t nodes = 0;
+                Clock::duration time {};
+                Clock::duration solved_after {};  //if solved
+                std::uint64_t solved_nodes = 0;
+                unsigned solved_depth = 0;
+            };
+
+        private:
+            ai::Evaluator const &evaluator;
+            ai::Players_t const &players;
+            Notation const &notation;
+            board::Board const &like;
+            Options const options;
+
+            Outcome search(Position const &p) const;
+
+        public:
+            std::vector<Outcome> outcomes; //by position of the last run
+            Clock::duration elapsed {};    //of the last run
+
+            Runner(ai::Evaluator const &e, ai::Players_t const &p, Notation const &n, board::Board const &b, Options const &opts)
+            : evaluator(e) //can't use {}
+            , players(p) //can't use {}
+            , notation(n) //can't use {}
+            , like(b) //can't use {}
+            , options(opts) //can't use {}
+            {
+            }
+
+            //Runs every position of the suite that can be run, writing a line to
+            //progress, if given, for each as it finishes
+            void run(Suite const &suite, std::ostream *progress = nullptr);
+
+            //Solve rate, time to solution, nodes and nodes per second in total
+            void report(Suite const &suite, std::ostream &os) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "Suite.hpp"
+
+#include "board/Board.hpp"
+#include "piece/Piece.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        namespace
+        {
+            //Splits the operations after the fields into opcode and operands, keeping quoted operands whole
+            std::vector<std::vector<std::string>> operations(std::string const &text)
+            {
+                std::vector<std::vector<std::string>> ops {{}};
+                std::string word;
+                bool quoted = false;
+                auto end_word = [&]
+                {
+                    if(!word.empty())
+                    {
+                        ops.back().push_back(word);
+                        word.clear();
+                    }
+                };
+                for(char c : text)
+                {
+                    if(c == '"')
+                    {
+                        quoted = !quoted;
+                        if(!quoted)
+                        {
+                            ops.back().push_back(word);
+                            word.clear();
+                        }
+                    }
+                    else if(quoted)
+                    {
+                        word += c;
+                    }
+                    else if(c == ';')
+                    {
+                        end_word();
+                        ops.emplace_back();
+                    }
+                    else if(c == ' ' || c == '\t')
+                    {
+                        end_word();
+                    }
+                    else
+                    {
+                        word += c;
+                    }
+                }
+                end_word();
+                ops.erase(std::remove_if(ops.begin(), ops.end(), [](std::vector<std::string> const &op)
+                {
+                    return op.empty();
+                }), ops.end());
+                return ops;
+            }
+        }
+
+        Suite::Suite(std::istream &in, Notation const &notation, board::Board const &like) noexcept(false)
+        {
+            std::string text;
+            for(std::size_t line = 1; std::getline(in, text); ++line)
+            {
+                if(!text.empty() && text.back() == '\r')
+                {
+                    text.pop_back();
+                }
+                if(text.find_first_not_of(" \t") == std::string::npos || text[text.find_first_not_of(" \t")] == '#')
+                {
+                    continue;
+                }
+                auto fail = [&](std::string const &why)
+                {
+                    return Exception("Line " + std::to_string(line) + ": " + why);
+                };
+                std::istringstream fields {text};
+                std::string placement, side;
+                fields >> placement >> side;
+                Position p;
+                p.line = line;
+                p.id = "line " + std::to_string(line);
+                try
+                {
+                    p.layout = notation.placement(placement);
+                }
+                catch(Exception &e)
+                {
+                    throw fail(e.what());
+                }
+                if(!notation.suit(side, p.turn))
+                {
+                    throw fail("no suit to move \"" + side + "\"");
+                }
+                //castling and en passant, if present, are not used
+                for(int i = 0; i < 2; ++i)
+                {
+                    auto const mark = fields.tellg();
+                    std::string field;
+                    Notation::Position_t square;
+                    if(!(fields >> field) || (field != "-" && field.find_first_not_of("KQkq") != std::string::npos && !notation.square(field, square)))
+                    {
+                        fields.clear();
+                        fields.seekg(mark);
+                        break;
+                    }
+                }
+                std::string rest;
+                std::getline(fields, rest);
+
+                board::Board const b {like, p.layout};
+                for(auto const &op : operations(rest))
+                {
+                    if(op[0] == "id" && op.size() > 1)
+                    {
+                        p.id = op[1];
+                    }
+                    else if(op[0] == "bm" || op[0] == "am")
+                    {
+                        for(std::size_t i = 1; i < op.size(); ++i)
+                        {
+                            board::Move m;
+                            if(!notation.move(b, p.turn, op[i], m))
+                            {
+                                p.skipped = op[0] + " " + op[i] + " is not a legal move here";
+                                break;
+                            }
+                            (op[0] == "bm"? p.best : p.avoid).push_back(m);
+                        }
+                    }
+                }
+                if(p.skipped.empty() && p.best.empty() && p.avoid.empty())
+                {
+                    p.skipped = "no bm or am";
+                }
+                positions.push_back(std::move(p));
+            }
+        }
+
+        std::size_t Suite::runnable() const noexcept
+        {
+            return static_cast<std::size_t>(std::count_if(positions.begin(), positions.end(), [](Position const &p)
+            {
+                return p.skipped.empty();
+            }));
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef ChessPlusPlus_Epd_TestSuiteClass_HeaderPlusPlus
+#define ChessPlusPlus_Epd_TestSuiteClass_HeaderPlusPlus
+
+#include "epd/Notation.hpp"
+#include "board/Move.hpp"
+#include "config/BoardConfig.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace epd
+    {
+        /**
+         * One position of a test suite: the piece placement, the suit to
+         * move, then castling and en passant fields which are read but not
+         * used, then operations ending in semicolons, of which these are
+         * used:
+         *
+         *  - bm: the best moves, one of which the search should choose
+         *  - am: moves the search should avoid
+         *  - id: a name for the position, in quotes
+         */
+        class Position
+        {
+        public:
+            std::size_t line = 0;
+            std::string id;
+            config::BoardConfig::Layout_t layout;
+            Notation::Suit_t turn;
+            std::vector<board::Move> best, avoid;
+            std::string skipped; //why the position can't be run, e.g. its moves are castling
+        };
+
+        class Suite
+        {
+        public:
+            std::vector<Position> positions;
+
+            //Reads one position per line, skipping blank lines and lines starting with #.
+            //Throws ::chesspp::Exception for lines that can't be read; positions with moves
+            //that aren't legal here are kept with the reason they are skipped.
+            Suite(std::istream &in, Notation const &notation, board::Board const &like) noexcept(false);
+
+            std::size_t runnable() const noexcept;
+        };
+    }
+}
+
+#endif
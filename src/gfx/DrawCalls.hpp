@@ -0,0 +1,39 @@
+#ifndef ChessPlusPlus_Gfx_DrawCallCounterClass_HeaderPlusPlus
+#define ChessPlusPlus_Gfx_DrawCallCounterClass_HeaderPlusPlus
+
+#include "SFML.hpp"
+
+#include <cstddef>
+
+namespace chesspp
+{
+    namespace gfx
+    {
+        //Draws through SFML counting the draw calls, for the performance overlay. Only the GUI thread draws.
+        class DrawCalls
+        {
+            static std::size_t &counter() noexcept
+            {
+                static std::size_t n = 0;
+                return n;
+            }
+
+        public:
+            static void draw(sf::RenderTarget &target, sf::Drawable const &d, sf::RenderStates const &states = sf::RenderStates::Default)
+            {
+                ++counter();
+                target.draw(d, states);
+            }
+
+            //The draw calls made since the last time this was called
+            static std::size_t take() noexcept
+            {
+                std::size_t const n = counter();
+                counter() = 0;
+                return n;
+            }
+        };
+    }
+}
+
+#endif
@@ -1,8 +1,12 @@
 #include "Graphics.hpp"
+#include "DrawCalls.hpp"
 
 #include "res/SfmlFileResource.hpp"
 #include "config/Configuration.hpp"
+#include "util/Allocations.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace chesspp
@@ -20,17 +24,151 @@ namespace chesspp
         , enemy_move   {res.from_config<Texture_res>("board", "enemy move"   )}
         , valid_capture{res.from_config<Texture_res>("board", "valid capture")}
         , enemy_capture{res.from_config<Texture_res>("board", "enemy capture")}
+        , camera{sf::FloatRect(0, 0, disp.getSize().x, disp.getSize().y)}
         {
+            clampCamera();
+        }
+
+        float GraphicsHandler::maxScale() const
+        {
+            //far enough out to see the whole board with a margin
+            float fit = std::max(float(board_config.boardWidth()*board_config.cellWidth())/display.getSize().x,
+                                 float(board_config.boardHeight()*board_config.cellHeight())/display.getSize().y);
+            return std::max(1.0f, fit*1.25f);
+        }
+        void GraphicsHandler::clampCamera()
+        {
+            auto center = camera.getCenter();
+            float width  = float(board_config.boardWidth() *board_config.cellWidth());
+            float height = float(board_config.boardHeight()*board_config.cellHeight());
+            camera.setCenter(std::min(std::max(center.x, 0.0f), width), std::min(std::max(center.y, 0.0f), height));
+        }
+        bool GraphicsHandler::visibleCells(board::Board::Position_t &first, board::Board::Position_t &last) const
+        {
+            auto center = camera.getCenter();
+            auto size = camera.getSize();
+            long left   = static_cast<long>(std::floor((center.x - size.x/2)/board_config.cellWidth()));
+            long top    = static_cast<long>(std::floor((center.y - size.y/2)/board_config.cellHeight()));
+            long right  = static_cast<long>(std::floor((center.x + size.x/2)/board_config.cellWidth()));
+            long bottom = static_cast<long>(std::floor((center.y + size.y/2)/board_config.cellHeight()));
+            if(right < 0 || bottom < 0 || left >= board_config.boardWidth() || top >= board_config.boardHeight())
+            {
+                return false;
+            }
+            using Size_t = board::Board::BoardSize_t;
+            first = {static_cast<Size_t>(std::max(left, 0L)), static_cast<Size_t>(std::max(top, 0L))};
+            last  = {static_cast<Size_t>(std::min(right,  long(board_config.boardWidth()  - 1))),
+                     static_cast<Size_t>(std::min(bottom, long(board_config.boardHeight() - 1)))};
+            return true;
+        }
+        sf::Color const &GraphicsHandler::lodColor(piece::Piece const &p)
+        {
+            auto key = std::make_pair(p.suit, p.pclass);
+            auto it = lod_colors.find(key);
+            if(it == lod_colors.end())
+            {
+                sf::Texture const &texture = res.from_config<Texture_res>("board", "pieces", p.suit, p.pclass);
+                auto image = texture.copyToImage();
+                unsigned long r = 0, g = 0, b = 0, weight = 0;
+                for(unsigned y = 0; y < image.getSize().y; ++y)
+                {
+                    for(unsigned x = 0; x < image.getSize().x; ++x)
+                    {
+                        auto c = image.getPixel(x, y);
+                        r += c.r*c.a;
+                        g += c.g*c.a;
+                        b += c.b*c.a;
+                        weight += c.a;
+                    }
+                }
+                sf::Color average {127, 127, 127};
+                if(weight)
+                {
+                    average = sf::Color(sf::Uint8(r/weight), sf::Uint8(g/weight), sf::Uint8(b/weight));
+                }
+                it = lod_colors.emplace(key, average).first;
+            }
+            return it->second;
+        }
+
+        void GraphicsHandler::resize(unsigned width, unsigned height)
+        {
+            camera.setSize(width*scale, height*scale);
+            clampCamera();
+        }
+        void GraphicsHandler::zoom(float factor, sf::Vector2i const &pixel)
+        {
+            float target = std::min(std::max(scale*factor, float(MinScale)), maxScale());
+            auto before = display.mapPixelToCoords(pixel, camera);
+            camera.zoom(target/scale);
+            scale = target;
+            auto after = display.mapPixelToCoords(pixel, camera);
+            camera.move(before.x - after.x, before.y - after.y);
+            clampCamera();
+        }
+        void GraphicsHandler::pan(sf::Vector2i const &pixels)
+        {
+            camera.move(-pixels.x*scale, -pixels.y*scale);
+            clampCamera();
+        }
+        auto GraphicsHandler::cellAt(sf::Vector2i const &pixel) const
+        -> board::Board::Position_t
+        {
+            auto world = display.mapPixelToCoords(pixel, camera);
+            if(world.x < 0 || world.y < 0)
+            {
+                return {board_config.boardWidth(), board_config.boardHeight()}; //off the board
+            }
+            long x = static_cast<long>(world.x/board_config.cellWidth());
+            long y = static_cast<long>(world.y/board_config.cellHeight());
+            using Size_t = board::Board::BoardSize_t;
+            return {static_cast<Size_t>(std::min(x, long(board_config.boardWidth()))),
+                    static_cast<Size_t>(std::min(y, long(board_config.boardHeight())))};
         }
 
         void GraphicsHandler::drawBackground()
         {
-            display.draw(board);
+            board::Board::Position_t first, last;
+            if(!visibleCells(first, last))
+            {
+                return;
+            }
+            float left   = float(first.x*board_config.cellWidth());
+            float top    = float(first.y*board_config.cellHeight());
+            float right  = float((last.x + 1)*board_config.cellWidth());
+            float bottom = float((last.y + 1)*board_config.cellHeight());
+            if(lod())
+            {
+                sf::RectangleShape shade {sf::Vector2f(right - left, bottom - top)};
+                shade.setPosition(left, top);
+                shade.setFillColor(sf::Color(90, 70, 50));
+                DrawCalls::draw(display, shade);
+                return;
+            }
+            //the background image is repeated over boards larger than it, only where it can be seen
+            auto tile = board.getLocalBounds();
+            int tile_w = static_cast<int>(tile.width), tile_h = static_cast<int>(tile.height);
+            int board_w = board_config.boardWidth()*board_config.cellWidth();
+            int board_h = board_config.boardHeight()*board_config.cellHeight();
+            if(tile_w <= 0 || tile_h <= 0)
+            {
+                return;
+            }
+            for(int y = static_cast<int>(top)/tile_h*tile_h; y < bottom; y += tile_h)
+            {
+                for(int x = static_cast<int>(left)/tile_w*tile_w; x < right; x += tile_w)
+                {
+                    sf::Sprite piece_of_board {board};
+                    piece_of_board.setTextureRect(sf::IntRect(0, 0, std::min(tile_w, board_w - x), std::min(tile_h, board_h - y)));
+                    piece_of_board.setPosition(float(x), float(y));
+                    DrawCalls::draw(display, piece_of_board);
+                }
+            }
         }
         void GraphicsHandler::drawSpriteAtCell(sf::Sprite &s, std::size_t x, std::size_t y)
         {
             s.setPosition(x*board_config.cellWidth(), y*board_config.cellHeight());
-            display.draw(s);
+            DrawCalls::draw(display, s);
         }
         void GraphicsHandler::drawPiece(piece::Piece const &p)
         {
@@ -41,61 +179,112 @@ namespace chesspp
         {
             sf::Sprite piece {res.from_config<Texture_res>("board", "pieces", p.suit, p.pclass)};
             piece.setPosition(pos.x - (board_config.cellWidth()/2), pos.y - (board_config.cellHeight()/2));
-            display.draw(piece);
+            DrawCalls::draw(display, piece);
         }
-        void GraphicsHandler::drawTrajectory(piece::Piece const &p, bool enemy)
+        void GraphicsHandler::drawMoves(piece::Piece const &p, board::Board::MoveList_t const &moves, bool enemy)
         {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Gfx};
+            board::Board::Position_t first, last;
+            if(!visibleCells(first, last))
             {
-                auto &sprite = (enemy? enemy_move : valid_move);
-                for(auto const &it : p.board.pieceTrajectory(p))
-                {
-                    if(!p.board.occupied(it.second))
-                    {
-                        if(std::find_if(p.board.pieceCapturables().begin(),
-                                        p.board.pieceCapturables().end(),
-                                        [&](board::Board::Movements_t::value_type const &m)
+                return;
+            }
+            auto const trajectory = p.board.pieceTrajectory(p);
+            auto own = std::equal_range(moves.begin(), moves.end(), board::Move(p.pos, p.pos),
+                                        [](board::Move const &a, board::Move const &b)
                                         {
-                                            return m.second == it.second && (*m.first)->suit != p.suit;
-                                        }) == p.board.pieceCapturables().end())
-                        {
-                            drawSpriteAtCell(sprite, it.second.x, it.second.y);
-                        }
-                    }
+                                            return a.from < b.from;
+                                        });
+            for(auto it = own.first; it != own.second; ++it)
+            {
+                auto const &to = it->to;
+                if(!to.isWithin(first, last))
+                {
+                    continue;
+                }
+                //legal moves onto empty cells the piece can go to are plain moves, the rest capture
+                bool const capture = p.board.occupied(to)
+                                  || std::find_if(trajectory.begin(), trajectory.end(),
+                                                  [&](board::Board::Movements_t::value_type const &m)
+                                                  {
+                                                      return m.second == to;
+                                                  }) == trajectory.end();
+                if(!capture)
+                {
+                    drawSpriteAtCell(enemy? enemy_move : valid_move, to.x, to.y);
+                    continue;
                 }
+                drawSpriteAtCell(enemy? enemy_capture : valid_capture, to.x, to.y);
+                auto occupant = p.board.find(to);
+                if(occupant != p.board.end())
+                {
+                    drawPiece(**occupant); //redraw
+                }
+            }
+        }
+        void GraphicsHandler::drawDistances(board::DistanceMap const &d, std::size_t n)
+        {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Gfx};
+            board::Board::Position_t first, last;
+            if(!visibleCells(first, last))
+            {
+                return;
             }
+            //one batched draw however many cells are reachable
+            reach_quads.clear();
+            float w = board_config.cellWidth(), h = board_config.cellHeight();
+            n = std::min(n, d.depth());
+            for(std::size_t i = 1; i <= n; ++i)
             {
-                auto &sprite = (enemy? enemy_capture : valid_capture);
-                for(auto const &it : p.board.pieceCapturing(p))
+                sf::Color color {64, 160, 255, static_cast<sf::Uint8>(160 - 112*(i - 1)/n)};
+                d.ring(i).forEach([&](board::Board::Position_t const &pos)
                 {
-                    for(auto const &c : p.board.pieceCapturables())
+                    if(!pos.isWithin(first, last))
                     {
-                        if(c.second == it.second && (*c.first)->suit != p.suit)
-                        {
-                            drawSpriteAtCell(sprite, it.second.x, it.second.y);
-                            auto jt = std::find_if(p.board.pieceTrajectories().begin(),
-                                                   p.board.pieceTrajectories().end(),
-                                                   [&](board::Board::Movements_t::value_type const &m)
-                                                   {
-                                                       return (*m.first)->pos == it.second;
-                                                   });
-                            if(jt != p.board.pieceTrajectories().end())
-                            {
-                                drawPiece(**(jt->first)); //redraw
-                            }
-                            break;
-                        }
+                        return;
                     }
-                }
+                    float x = pos.x*w, y = pos.y*h;
+                    reach_quads.append(sf::Vertex(sf::Vector2f(x,     y    ), color));
+                    reach_quads.append(sf::Vertex(sf::Vector2f(x + w, y    ), color));
+                    reach_quads.append(sf::Vertex(sf::Vector2f(x + w, y + h), color));
+                    reach_quads.append(sf::Vertex(sf::Vector2f(x,     y + h), color));
+                });
             }
+            DrawCalls::draw(display, reach_quads);
         }
         void GraphicsHandler::drawBoard(board::Board const &b)
         {
+            util::Allocations::Scope tag {util::Allocations::Subsystem::Gfx};
+            display.setView(camera);
+            display.clear();
             drawBackground();
 
-            for(auto const &pp : b)
+            board::Board::Position_t first, last;
+            if(!visibleCells(first, last))
             {
-                drawPiece(*pp);
+                return;
             }
+            if(!lod())
+            {
+                b.within(first, last, [this](piece::Piece const &p)
+                {
+                    drawPiece(p);
+                });
+                return;
+            }
+            //tiny cells, one batched draw of flat quads instead of a textured sprite per piece
+            lod_quads.clear();
+            float w = board_config.cellWidth(), h = board_config.cellHeight();
+            b.within(first, last, [&](piece::Piece const &p)
+            {
+                auto const &color = lodColor(p);
+                float x = p.pos.x*w, y = p.pos.y*h;
+                lod_quads.append(sf::Vertex(sf::Vector2f(x,     y    ), color));
+                lod_quads.append(sf::Vertex(sf::Vector2f(x + w, y    ), color));
+                lod_quads.append(sf::Vertex(sf::Vector2f(x + w, y + h), color));
+                lod_quads.append(sf::Vertex(sf::Vector2f(x,     y + h), color));
+            });
+            DrawCalls::draw(display, lod_quads);
         }
     }
 }
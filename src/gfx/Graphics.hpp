@@ -5,9 +5,11 @@
 #include "config/ResourcesConfig.hpp"
 #include "config/BoardConfig.hpp"
 #include "board/Board.hpp"
+#include "board/DistanceMap.hpp"
 #include "piece/Piece.hpp"
 
 #include <map>
+#include <utility>
 
 namespace chesspp
 {
@@ -26,6 +28,28 @@ namespace chesspp
             ,          valid_capture
             ,          enemy_capture;
 
+            //The camera looks at the board in board pixels, one cell being cellWidth() x cellHeight()
+            sf::View camera;
+            float scale = 1.0f; //board pixels per window pixel
+            //Below this many window pixels per cell, pieces are drawn as flat colored quads in one batch
+            static constexpr float LodCellPixels = 16.0f;
+            static constexpr float MinScale = 0.25f;
+            std::map<std::pair<piece::Piece::Suit_t, piece::Piece::Class_t>, sf::Color> lod_colors;
+            sf::VertexArray lod_quads {sf::Quads};
+            sf::VertexArray reach_quads {sf::Quads};
+
+            float maxScale() const;
+            //Keeps the camera over the board
+            void clampCamera();
+            //The range of cells the camera sees, false if it sees none
+            bool visibleCells(board::Board::Position_t &first, board::Board::Position_t &last) const;
+            bool lod() const noexcept
+            {
+                return board_config.cellWidth()/scale < LodCellPixels || board_config.cellHeight()/scale < LodCellPixels;
+            }
+            //Average color of a piece's texture, computed once
+            sf::Color const &lodColor(piece::Piece const &p);
+
         public:
             GraphicsHandler(sf::RenderWindow &display, config::ResourcesConfig &resc, config::BoardConfig &bc);
 
@@ -41,11 +65,23 @@ namespace chesspp
             //Separate version of drawPiece to draw a piece at any location on the screen.
             void drawPieceAt(piece::Piece const &p, sf::Vector2i const &pos);
 
-            //draws the trajectory and captures for the piece
-            void drawTrajectory(piece::Piece const &p, bool enemy = false);
+            //draws the moves and captures for the piece out of the sorted legal moves of its suit
+            void drawMoves(piece::Piece const &p, board::Board::MoveList_t const &moves, bool enemy = false);
 
-            //Draws the board and pieces
+            //Shades the cells at most n moves away, fainter the more moves they take
+            void drawDistances(board::DistanceMap const &d, std::size_t n);
+
+            //Draws the board and the pieces the camera can see
             void drawBoard(board::Board const &b);
+
+            //Fits the camera to a new window size, keeping the zoom
+            void resize(unsigned width, unsigned height);
+            //Zooms by a factor (above 1 zooms out) keeping the point under the given window pixel in place
+            void zoom(float factor, sf::Vector2i const &pixel);
+            //Moves the board along with the mouse by a number of window pixels
+            void pan(sf::Vector2i const &pixels);
+            //The cell under a window pixel, which may not be valid on the board
+            board::Board::Position_t cellAt(sf::Vector2i const &pixel) const;
         };
     }
 }
@@ -0,0 +1,27 @@
+#include "EngineChannel.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+
+namespace chesspp
+{
+    namespace ipc
+    {
+        //not FUTEX_PRIVATE_FLAG, the word is in memory shared with another process
+        void futexWait(std::atomic<std::uint32_t> &word, std::uint32_t expected, std::chrono::microseconds timeout) noexcept
+        {
+            static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex words must be plain 32-bit integers");
+            timespec ts;
+            ts.tv_sec = static_cast<time_t>(timeout.count()/1000000);
+            ts.tv_nsec = static_cast<long>(timeout.count()%1000000*1000);
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+        }
+        void futexWake(std::atomic<std::uint32_t> &word) noexcept
+        {
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE, 0x7FFFFFFF, nullptr, nullptr, 0);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ChessPlusPlus_Ipc_SharedEngineChannel_HeaderPlusPlus
+#define ChessPlusPlus_Ipc_SharedEngineChannel_HeaderPlusPlus
+
+#include "board/Move.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace chesspp
+{
+    namespace ipc
+    {
+        //Sleeps while word == expected, until woken or the timeout passes; works across processes
+        void futexWait(std::atomic<std::uint32_t> &word, std::uint32_t expected, std::chrono::microseconds timeout) noexcept;
+        //Wakes every process sleeping on the word
+        void futexWake(std::atomic<std::uint32_t> &word) noexcept;
+
+        /**
+         * The memory shared between the GUI and an engine process. The GUI
+         * appends each move played to the history, so asking for a search
+         * only means filling in a few numbers and bumping the request
+         * sequence number; the engine replays just the moves it has not seen
+         * yet. The engine streams what it has found so far into info,
+         * guarded by a sequence lock. Both sides sleep on futexes.
+         * Both processes must be built from the same source.
+         */
+        class EngineChannel
+        {
+        public:
+            static std::uint32_t const Magic = 0x45505043; //"CPPE"
+            static std::uint32_t const Version = 1;
+            static std::uint32_t const Shutdown = 0xFFFFFFFF; //request sequence number telling the engine to exit
+            static std::size_t const MaxHistory = 16384;
+            static std::size_t const MaxPv = 32;
+            static std::size_t const MaxPlayers = 8;
+            static std::size_t const NameSize = 64;
+            static std::size_t const PathSize = 256;
+
+            class Request
+            {
+            public:
+                std::atomic<std::uint32_t> seq; //futex word, bumped by the GUI for each search
+                std::uint32_t history_size;     //moves of history making up the position
+                std::uint32_t turn;             //index into players
+                std::uint32_t depth;
+                std::uint32_t time_ms;
+            };
+            class Info
+            {
+            public:
+                std::uint32_t request; //the sequence number it answers
+                std::uint32_t final;   //nonzero once the search is over
+                std::uint32_t found;   //zero if there was no legal move
+                std::uint32_t depth;
+                std::int32_t score;
+                std::uint64_t nodes;
+                std::uint64_t nps;
+                std::uint32_t pv_size;
+                board::Move::Packed_t pv[MaxPv];
+            };
+
+            //written once by the GUI before the engine starts
+            std::uint32_t magic;
+            std::uint32_t version;
+            char board_file[PathSize];
+            std::uint32_t player_count;
+            char players[MaxPlayers][NameSize]; //in turn order
+
+            alignas(64) Request request;
+            alignas(64) std::atomic<std::uint32_t> info_version; //odd while info is written, futex word
+            Info info;
+
+            //appended by the GUI, never rewritten
+            alignas(64) board::Move::Packed_t history[MaxHistory];
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "EngineProcess.hpp"
+
+#include "Exception.hpp"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+extern char **environ;
+
+namespace chesspp
+{
+    namespace ipc
+    {
+        EngineProcess::EngineProcess(std::string const &engine_path, std::string const &board_file, std::vector<board::Board::Suit> const &players) noexcept(false)
+        : path{engine_path}
+        {
+            if(board_file.size() >= EngineChannel::PathSize || players.size() > EngineChannel::MaxPlayers)
+            {
+                throw Exception("Board is too large to hand to an engine process");
+            }
+            //inherited by the engine, not closed on exec
+            memfd = ::memfd_create("chesspp-engine", 0);
+            if(memfd == -1 || ::ftruncate(memfd, sizeof(EngineChannel)) == -1)
+            {
+                throw Exception(std::string("Unable to create engine shared memory: ") + std::strerror(errno));
+            }
+            void *mem = ::mmap(nullptr, sizeof(EngineChannel), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+            if(mem == MAP_FAILED)
+            {
+                ::close(memfd);
+                throw Exception(std::string("Unable to map engine shared memory: ") + std::strerror(errno));
+            }
+            channel = static_cast<EngineChannel *>(mem); //zero filled by ftruncate
+            channel->magic = EngineChannel::Magic;
+            channel->version = EngineChannel::Version;
+            std::strncpy(channel->board_file, board_file.c_str(), EngineChannel::PathSize - 1);
+            channel->player_count = static_cast<std::uint32_t>(players.size());
+            for(std::size_t i = 0; i < players.size(); ++i)
+            {
+                std::strncpy(channel->players[i], players[i].c_str(), EngineChannel::NameSize - 1);
+            }
+            spawn();
+        }
+        EngineProcess::~EngineProcess()
+        {
+            if(channel)
+            {
+                channel->request.seq.store(EngineChannel::Shutdown, std::memory_order_release);
+                futexWake(channel->request.seq);
+            }
+            if(pid > 0)
+            {
+                //a search notices within a few nodes, give it a moment before insisting
+                bool exited = false;
+                for(int i = 0; i < 100 && !(exited = ::waitpid(pid, nullptr, WNOHANG) != 0); ++i)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                if(!exited && ::kill(pid, SIGKILL) == 0)
+                {
+                    ::waitpid(pid, nullptr, 0);
+                }
+            }
+            if(channel)
+            {
+                ::munmap(channel, sizeof(EngineChannel));
+            }
+            if(memfd != -1)
+            {
+                ::close(memfd);
+            }
+        }
+
+        void EngineProcess::spawn() noexcept(false)
+        {
+            std::string fd = std::to_string(memfd);
+            char const *argv[] = {path.c_str(), "--fd", fd.c_str(), nullptr};
+            int error = ::posix_spawn(&pid, path.c_str(), nullptr, nullptr, const_cast<char *const *>(argv), environ);
+            if(error != 0)
+            {
+                pid = -1;
+                throw Exception("Unable to start engine \"" + path + "\": " + std::strerror(error));
+            }
+        }
+
+        bool EngineProcess::record(board::Move const &m) noexcept
+        {
+            std::uint32_t size = channel->request.history_size;
+            if(size >= EngineChannel::MaxHistory)
+            {
+                return false;
+            }
+            //only read by the engine once a request covers it, which publishes it
+            channel->history[size] = m.pack();
+            channel->request.history_size = size + 1;
+            return true;
+        }
+
+        std::uint32_t EngineProcess::search(std::size_t turn, unsigned depth, std::chrono::milliseconds time) noexcept
+        {
+            auto &r = channel->request;
+            r.turn = static_cast<std::uint32_t>(turn);
+            r.depth = depth;
+            r.time_ms = static_cast<std::uint32_t>(time.count());
+            std::uint32_t seq = r.seq.load(std::memory_order_relaxed) + 1;
+            if(seq == EngineChannel::Shutdown)
+            {
+                seq = 1;
+            }
+            r.seq.store(seq, std::memory_order_release);
+            futexWake(r.seq);
+            return seq;
+        }
+
+        bool EngineProcess::poll(Info &out) noexcept
+        {
+            for(;;)
+            {
+                std::uint32_t v = channel->info_version.load(std::memory_order_acquire);
+                if(v == seen)
+                {
+                    return false;
+                }
+                if(v & 1)
+                {
+                    continue; //being written, it is only a few hundred bytes
+                }
+                EngineChannel::Info info;
+                std::memcpy(&info, &channel->info, sizeof(info));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(channel->info_version.load(std::memory_order_relaxed) != v)
+                {
+                    continue; //torn, try again
+                }
+                seen = v;
+                out.request = info.request;
+                out.final = info.final != 0;
+                out.found = info.found != 0;
+                out.depth = info.depth;
+                out.score = info.score;
+                out.nodes = info.nodes;
+                out.nps = info.nps;
+                out.pv.clear();
+                for(std::uint32_t i = 0; i < std::min<std::uint32_t>(info.pv_size, EngineChannel::MaxPv); ++i)
+                {
+                    out.pv.emplace_back(info.pv[i]);
+                }
+                return true;
+            }
+        }
+        bool EngineProcess::wait(Info &out, std::chrono::microseconds timeout) noexcept
+        {
+            std::uint32_t v = channel->info_version.load(std::memory_order_acquire);
+            if(v == seen)
+            {
+                futexWait(channel->info_version, v, timeout);
+            }
+            return poll(out);
+        }
+
+        bool EngineProcess::restartIfDead() noexcept(false)
+        {
+            int status = 0;
+            if(pid <= 0 || ::waitpid(pid, &status, WNOHANG) != pid)
+            {
+                return false;
+            }
+            std::cerr << "Engine process " << pid << " died";
+            if(WIFSIGNALED(status))
+            {
+                std::cerr << " from signal " << WTERMSIG(status);
+            }
+            std::cerr << ", restarting it" << std::endl;
+            //it may have died halfway through writing info
+            if(channel->info_version.load() & 1)
+            {
+                channel->info_version.fetch_add(1);
+            }
+            spawn();
+            return true;
+        }
+    }
+}
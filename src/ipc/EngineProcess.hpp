@@ -0,0 +1,67 @@
+#ifndef ChessPlusPlus_Ipc_EngineProcessClass_HeaderPlusPlus
+#define ChessPlusPlus_Ipc_EngineProcessClass_HeaderPlusPlus
+
+#include "ipc/EngineChannel.hpp"
+#include "board/Board.hpp"
+#include "board/Move.hpp"
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace ipc
+    {
+        //Runs the engine in a separate process sharing an EngineChannel with
+        //this one, so an engine crash or memory blowup leaves the caller alone.
+        class EngineProcess
+        {
+        public:
+            //A snapshot of what the engine has streamed
+            class Info
+            {
+            public:
+                std::uint32_t request = 0;
+                bool final = false;
+                bool found = false;
+                unsigned depth = 0;
+                std::int32_t score = 0;
+                std::uint64_t nodes = 0, nps = 0;
+                board::Board::MoveList_t pv;
+            };
+
+        private:
+            std::string const path;
+            int memfd = -1;
+            EngineChannel *channel = nullptr;
+            pid_t pid = -1;
+            std::uint32_t seen = 0; //info version last returned by poll()
+
+            void spawn() noexcept(false);
+
+        public:
+            //Starts the engine executable at path for a board config file and its players in turn order
+            EngineProcess(std::string const &engine_path, std::string const &board_file, std::vector<board::Board::Suit> const &players) noexcept(false);
+            ~EngineProcess();
+            EngineProcess(EngineProcess const &) = delete;
+            EngineProcess &operator=(EngineProcess const &) = delete;
+
+            //Appends a move to the shared history, call for every move played on the board
+            bool record(board::Move const &m) noexcept;
+            //Asks for a search of the position after the recorded moves, returns the request id
+            std::uint32_t search(std::size_t turn, unsigned depth, std::chrono::milliseconds time) noexcept;
+            //Whether there is info newer than the last poll, and copies it if so
+            bool poll(Info &out) noexcept;
+            //Like poll() but sleeps up to the timeout for something new
+            bool wait(Info &out, std::chrono::microseconds timeout) noexcept;
+            //Starts the engine again if it has died, it then picks up the current request by itself
+            bool restartIfDead() noexcept(false);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,429 @@
+#include "LoadGenerator.hpp"
+
+#include "board/Board.hpp"
+#include "net/Protocol.hpp"
+#include "piece/Piece.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace chesspp
+{
+    namespace loadgen
+    {
+        namespace
+        {
+            static std::uint64_t microsecondsSince(LoadGenerator::Clock::time_point t) noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(LoadGenerator::Clock::now() - t).count());
+            }
+        }
+
+        class LoadGenerator::Worker
+        {
+            class Client
+            {
+            public:
+                net::Socket socket;
+                net::Buffer_t in, out;
+                bool writing = false;
+                std::size_t table, seat;
+            };
+            class Table
+            {
+            public:
+                std::vector<std::size_t> clients; //by seat, in the order of the players
+                std::unique_ptr<board::Board> board; //replica of the server's, to pick legal moves
+                std::uint32_t game = 0;
+                bool playing = false;
+                std::size_t joined = 0;
+                std::size_t turn = 0; //seat to move
+                std::size_t mover = 0; //seat that made the move in flight
+                std::uint32_t seq = 0;
+                std::size_t pending = 0; //Accepted and Updates still expected for the move in flight
+                Clock::time_point created, submitted, next_due;
+            };
+
+            LoadGenerator &gen;
+            board::Board::Suit const *players;
+            std::size_t player_count;
+            Clock::duration interval;
+            net::Socket poller;
+            std::vector<Client> clients;
+            std::vector<Table> tables;
+            std::mt19937 rng;
+            Clock::time_point end;
+            std::thread thread;
+
+            void watch(std::size_t id, bool writable)
+            {
+                epoll_event e;
+                e.events = EPOLLIN | (writable ? EPOLLOUT : 0);
+                e.data.u64 = id;
+                if(::epoll_ctl(poller.handle(), EPOLL_CTL_MOD, clients[id].socket.handle(), &e) == -1)
+                {
+                    ::epoll_ctl(poller.handle(), EPOLL_CTL_ADD, clients[id].socket.handle(), &e);
+                }
+            }
+            void flush(std::size_t id)
+            {
+                Client &c = clients[id];
+                std::size_t sent = 0;
+                while(sent < c.out.size())
+                {
+                    ssize_t n = ::send(c.socket.handle(), c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+                    if(n == -1)
+                    {
+                        if(errno != EAGAIN && errno != EWOULDBLOCK)
+                        {
+                            ++gen.failures;
+                            c.out.clear();
+                            return;
+                        }
+                        break;
+                    }
+                    sent += static_cast<std::size_t>(n);
+                }
+                c.out.erase(c.out.begin(), c.out.begin() + sent);
+                if(c.out.empty() == c.writing)
+                {
+                    c.writing = !c.out.empty();
+                    watch(id, c.writing);
+                }
+            }
+            void send(std::size_t id, net::Buffer_t const &frame)
+            {
+                Client &c = clients[id];
+                c.out.insert(c.out.end(), frame.begin(), frame.end());
+                if(!c.writing)
+                {
+                    flush(id);
+                }
+            }
+
+            void startGame(Table &t)
+            {
+                t.playing = false;
+                t.joined = 0;
+                t.pending = 0;
+                t.created = Clock::now();
+                net::Buffer_t frame;
+                net::FrameWriter(frame, net::Message::Create).str(gen.options.variant);
+                send(t.clients.front(), frame);
+            }
+            void submit(Table &t)
+            {
+                auto legal = t.board->legalMoves(players[t.turn]);
+                if(legal.empty())
+                {
+                    ++gen.games;
+                    return startGame(t);
+                }
+                auto m = legal[std::uniform_int_distribution<std::size_t>(0, legal.size() - 1)(rng)];
+                t.submitted = Clock::now();
+                t.mover = t.turn;
+                t.pending = t.clients.size() + 1;
+                net::Buffer_t frame;
+                net::FrameWriter(frame, net::Message::Move).u32(t.game).move(m);
+                send(t.clients[t.turn], frame);
+            }
+            //Called as each expected reply to the move in flight arrives
+            void settle(Table &t)
+            {
+                if(t.pending == 0 || --t.pending > 0)
+                {
+                    return;
+                }
+                if(t.seq >= gen.options.plies)
+                {
+                    ++gen.games;
+                    return startGame(t);
+                }
+                t.next_due = std::max(Clock::now(), t.submitted + interval);
+            }
+
+            bool onFrame(std::size_t id, net::Message type, net::FrameReader &r)
+            {
+                Client &c = clients[id];
+                Table &t = tables[c.table];
+                switch(type)
+                {
+                case net::Message::Created:
+                    {
+                        std::uint32_t g = r.u32();
+                        if(!r) return false;
+                        t.game = g;
+                        for(std::size_t seat = 0; seat < t.clients.size(); ++seat)
+                        {
+                            net::Buffer_t frame;
+                            net::FrameWriter(frame, net::Message::Join).u32(g).str(players[seat]);
+                            send(t.clients[seat], frame);
+                        }
+                        return true;
+                    }
+                case net::Message::Joined:
+                    {
+                        std::uint32_t g = r.u32();
+                        auto turn = r.str();
+                        if(!r) return false;
+                        if(g != t.game || ++t.joined < t.clients.size())
+                        {
+                            return true;
+                        }
+                        gen.create_times.record(microsecondsSince(t.created));
+                        t.turn = static_cast<std::size_t>(std::find(players, players + player_count, turn) - players) % player_count;
+                        t.board.reset(new board::Board(gen.config));
+                        t.seq = 0;
+                        t.playing = true;
+                        t.next_due = Clock::now();
+                        return true;
+                    }
+                case net::Message::Accepted:
+                    {
+                        std::uint32_t g = r.u32();
+                        if(!r) return false;
+                        if(g == t.game && t.pending)
+                        {
+                            ++gen.moves;
+                            gen.ack_times.record(microsecondsSince(t.submitted));
+                            settle(t);
+                        }
+                        return true;
+                    }
+                case net::Message::Update:
+                    {
+                        std::uint32_t g = r.u32();
+                        std::uint32_t seq = r.u32();
+                        auto m = r.move();
+                        if(!r) return false;
+                        if(g != t.game || !t.pending)
+                        {
+                            return true;
+                        }
+                        if(c.seat != t.mover)
+                        {
+                            gen.broadcast_times.record(microsecondsSince(t.submitted));
+                        }
+                        if(seq == t.seq + 1) //the first of the table's clients to hear of it
+                        {
+                            t.board->moveTo(t.board->find(m.from), m.to);
+                            t.seq = seq;
+                            t.turn = (t.turn + 1) % player_count;
+                        }
+                        settle(t);
+                        return true;
+                    }
+                case net::Message::Rejected:
+                    {
+                        //our replica disagrees with the server, start over rather than stall
+                        ++gen.rejected;
+                        if(t.pending)
+                        {
+                            ++gen.games;
+                            startGame(t);
+                        }
+                        return true;
+                    }
+                case net::Message::Error:
+                    {
+                        ++gen.failures;
+                        return true;
+                    }
+                default: return true; //e.g. frames for other clients' protocols
+                }
+            }
+
+            void read(std::size_t id)
+            {
+                Client &c = clients[id];
+                std::uint8_t chunk[16384];
+                ssize_t n;
+                while((n = ::read(c.socket.handle(), chunk, sizeof(chunk))) > 0)
+                {
+                    c.in.insert(c.in.end(), chunk, chunk + n);
+                }
+                if(n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+                {
+                    ++gen.failures;
+                    ::epoll_ctl(poller.handle(), EPOLL_CTL_DEL, c.socket.handle(), nullptr);
+                    return;
+                }
+                if(!net::consumeFrames(c.in, [&](net::Message type, net::FrameReader &r)
+                {
+                    return onFrame(id, type, r);
+                }))
+                {
+                    ++gen.failures;
+                    c.in.clear();
+                }
+            }
+
+            void run()
+            {
+                for(auto &t : tables)
+                {
+                    startGame(t);
+                }
+                epoll_event events[256];
+                for(auto now = Clock::now(); now < end; now = Clock::now())
+                {
+                    int timeout = 100;
+                    for(auto &t : tables)
+                    {
+                        if(!t.playing || t.pending)
+                        {
+                            continue;
+                        }
+                        if(t.next_due <= now)
+                        {
+                            submit(t);
+                        }
+                        else
+                        {
+                            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(t.next_due - now).count();
+                            timeout = std::min<int>(timeout, static_cast<int>(wait));
+                        }
+                    }
+                    int n = ::epoll_wait(poller.handle(), events, 256, timeout);
+                    if(n == -1 && errno != EINTR)
+                    {
+                        std::cerr << "Load generator event loop failed: " << std::strerror(errno) << std::endl;
+                        return;
+                    }
+                    for(int i = 0; i < n; ++i)
+                    {
+                        auto id = static_cast<std::size_t>(events[i].data.u64);
+                        if(events[i].events & EPOLLOUT)
+                        {
+                            flush(id);
+                        }
+                        if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                        {
+                            read(id);
+                        }
+                    }
+                }
+            }
+
+        public:
+            Worker(LoadGenerator &g, std::vector<board::Board::Suit> const &suits, std::size_t table_count, std::uint32_t seed) noexcept(false)
+            : gen(g) //can't use {}
+            , players{suits.data()}
+            , player_count{suits.size()}
+            , poller{::epoll_create1(EPOLL_CLOEXEC)}
+            , rng{seed}
+            {
+                if(!poller)
+                {
+                    throw Exception(std::string("Unable to create load generator event loop: ") + std::strerror(errno));
+                }
+                //a table makes one move per client per period
+                interval = gen.options.rate > 0
+                         ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/(gen.options.rate*player_count)))
+                         : Clock::duration::zero();
+                net::Endpoint endpoint {gen.options.endpoint};
+                tables.resize(table_count);
+                for(std::size_t t = 0; t < table_count; ++t)
+                {
+                    for(std::size_t seat = 0; seat < player_count; ++seat)
+                    {
+                        Client c;
+                        c.socket = endpoint.connect();
+                        c.socket.setNonBlocking();
+                        c.socket.setNoDelay();
+                        c.table = t;
+                        c.seat = seat;
+                        tables[t].clients.push_back(clients.size());
+                        clients.push_back(std::move(c));
+                        watch(clients.size() - 1, false);
+                    }
+                }
+            }
+            Worker(Worker const &) = delete;
+            Worker &operator=(Worker const &) = delete;
+
+            void start(Clock::time_point until)
+            {
+                end = until;
+                thread = std::thread(&Worker::run, this);
+            }
+            void join()
+            {
+                if(thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+        };
+
+        LoadGenerator::LoadGenerator(config::BoardConfig const &conf, Options const &opts) noexcept(false)
+        : config(conf)  //can't use {}
+        , options(opts) //can't use {}
+        , players{conf.suits().begin(), conf.suits().end()} //same as the server
+        {
+            if(players.empty())
+            {
+                throw Exception("The board has no suits to play");
+            }
+        }
+        LoadGenerator::~LoadGenerator()
+        {
+            for(auto &w : workers)
+            {
+                w->join();
+            }
+        }
+
+        void LoadGenerator::run()
+        {
+            std::size_t tables = options.clients/players.size();
+            std::size_t threads = std::max<std::size_t>(1, std::min(options.threads, tables));
+            if(tables == 0)
+            {
+                throw Exception("Need at least one client per suit");
+            }
+
+            workers.clear();
+            for(std::size_t i = 0; i < threads; ++i)
+            {
+                std::size_t share = tables/threads + (i < tables%threads ? 1 : 0);
+                workers.emplace_back(new Worker(*this, players, share, options.seed + static_cast<std::uint32_t>(i)));
+            }
+
+            auto start = Clock::now();
+            for(auto &w : workers)
+            {
+                w->start(start + options.duration);
+            }
+            for(auto &w : workers)
+            {
+                w->join();
+            }
+            elapsed = Clock::now() - start;
+            workers.clear(); //disconnects
+        }
+
+        void LoadGenerator::report(std::ostream &os) const
+        {
+            double seconds = std::chrono::duration<double>(elapsed).count();
+            os << std::fixed << std::setprecision(1)
+               << moves << " moves in " << seconds << "s (" << (seconds > 0 ? moves/seconds : 0.0) << " moves/s), "
+               << games << " games finished, " << rejected << " rejected, " << failures << " failures" << std::endl;
+            os << "create -> joined: ";
+            create_times.report(os, "us");
+            os << std::endl << "submit -> ack: ";
+            ack_times.report(os, "us");
+            os << std::endl << "submit -> broadcast: ";
+            broadcast_times.report(os, "us");
+            os << std::endl;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef ChessPlusPlus_LoadGen_GameServerLoadGeneratorClass_HeaderPlusPlus
+#define ChessPlusPlus_LoadGen_GameServerLoadGeneratorClass_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+#include "net/Socket.hpp"
+#include "util/Histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chesspp
+{
+    namespace loadgen
+    {
+        /**
+         * Simulates many clients playing random legal moves against a game
+         * server. Clients are grouped into tables of one client per suit; each
+         * table plays a game to a fixed length and then starts another. The
+         * tables are spread over a few event-loop threads.
+         */
+        class LoadGenerator
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                std::string endpoint;
+                std::string variant;          //empty for the default board
+                std::size_t clients;          //rounded down to whole tables
+                double rate;                  //moves per second per client, 0 to move as soon as it is our turn
+                std::uint32_t plies;          //moves per game before starting a new one
+                std::chrono::seconds duration;
+                std::size_t threads;
+                std::uint32_t seed;
+            };
+
+        private:
+            class Worker;
+
+            config::BoardConfig const &config;
+            Options const options;
+            std::vector<config::BoardConfig::SuitClass_t> const players;
+            std::vector<std::unique_ptr<Worker>> workers;
+
+            std::atomic<std::uint64_t> moves {0}, games {0}, rejected {0}, failures {0};
+            util::Histogram ack_times;       //microseconds from sending a move to its Accepted
+            util::Histogram broadcast_times; //microseconds from sending a move to each opponent's Update
+            util::Histogram create_times;    //microseconds from Create to every seat being Joined
+            Clock::duration elapsed {};
+
+            friend class Worker;
+
+        public:
+            //The board config must match the variant being played, it is used to pick legal moves
+            LoadGenerator(config::BoardConfig const &conf, Options const &opts) noexcept(false);
+            ~LoadGenerator();
+            LoadGenerator(LoadGenerator const &) = delete;
+            LoadGenerator &operator=(LoadGenerator const &) = delete;
+
+            //Connects every client, plays for the configured duration then disconnects
+            void run();
+
+            //Throughput and latency percentiles of the last run
+            void report(std::ostream &os) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "loadgen/LoadGenerator.hpp"
+#include "server/GameServer.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "config/BoardConfig.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <unistd.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <typeinfo>
+
+//Measures how many moves per second and concurrent games the game server sustains.
+//Without --connect it starts its own server in this process on a private Unix socket.
+//Usage: chesspp-loadgen [--connect unix:<path>|tcp:<port>] [--shards n] [--clients n] [--rate moves/s]
+//                       [--plies n] [--duration seconds] [--threads n] [--variant name] [--seed n]
+//                       [--journal dir] [--verbose]
+int main(int argc, char const *const *argv)
+{
+    std::string connect;
+    std::string journal; //for the in-process server
+    unsigned long shards = std::thread::hardware_concurrency()/2;
+    chesspp::loadgen::LoadGenerator::Options options
+    {
+        "", "", 64, 0.0, 80, std::chrono::seconds(10), std::max(1u, std::thread::hardware_concurrency()/2), 1
+    };
+    bool verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--connect"  && has_value) connect          = argv[++i];
+        else if(arg == "--shards"   && has_value) shards           = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--clients"  && has_value) options.clients  = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--rate"     && has_value) options.rate     = std::strtod(argv[++i], nullptr);
+        else if(arg == "--plies"    && has_value) options.plies    = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--duration" && has_value) options.duration = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--threads"  && has_value) options.threads  = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--variant"  && has_value) options.variant  = argv[++i];
+        else if(arg == "--seed"     && has_value) options.seed     = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--journal"  && has_value) journal          = argv[++i];
+        else if(arg == "--verbose")               verbose          = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--connect unix:<path>|tcp:<port>] [--shards n] [--clients n] [--rate moves/s]"
+                         " [--plies n] [--duration seconds] [--threads n] [--variant name] [--seed n]"
+                         " [--journal dir] [--verbose]" << std::endl;
+            return -1;
+        }
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    try
+    {
+        chesspp::config::ResourcesConfig res;
+        chesspp::config::BoardConfig board
+        {
+            res,
+            options.variant.empty() ? "config/chesspp/board.json" : "config/chesspp/" + options.variant + ".json"
+        };
+
+        std::unique_ptr<chesspp::server::GameServer> server;
+        std::string socket_path;
+        if(connect.empty())
+        {
+            socket_path = "chesspp-loadgen-" + std::to_string(::getpid()) + ".sock";
+            options.endpoint = "unix:" + socket_path;
+            server.reset(new chesspp::server::GameServer
+            {
+                chesspp::net::Endpoint(options.endpoint),
+                static_cast<std::uint32_t>(std::max(1ul, shards)),
+                "config/chesspp/",
+                std::chrono::seconds(3600),
+                chesspp::server::GameServer::EngineOptions{0, std::chrono::milliseconds(0), 0, 0, 0, chesspp::ai::Search::Mode::Paranoid},
+                chesspp::server::GameServer::JournalOptions{journal, std::chrono::milliseconds(5), std::chrono::seconds(10)}
+            });
+            server->start();
+        }
+        else
+        {
+            options.endpoint = connect;
+        }
+
+        std::cout << "Running " << options.clients << " clients against " << chesspp::net::Endpoint(options.endpoint)
+                  << " for " << options.duration.count() << "s" << std::endl;
+        chesspp::loadgen::LoadGenerator load {board, options};
+        load.run();
+        load.report(std::cout);
+
+        if(server)
+        {
+            server->stop();
+            std::cout << "Server side:" << std::endl;
+            server->report(std::cout);
+            server.reset();
+            ::unlink(socket_path.c_str());
+        }
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,353 @@
+#include "Harness.hpp"
+
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace movegen
+    {
+        namespace
+        {
+            using Generation = board::Board::Generation;
+
+            //Every movement as a move from the piece's position, sorted, so boards can be compared
+            board::Board::MoveList_t listed(board::Board::Movements const &m)
+            {
+                board::Board::MoveList_t moves;
+                for(auto const &e : m)
+                {
+                    moves.emplace_back((*e.first)->pos, e.second);
+                }
+                std::sort(moves.begin(), moves.end());
+                return moves;
+            }
+
+            //The first move in one sorted list and not the other
+            std::string firstDifference(board::Board::MoveList_t const &optimized, board::Board::MoveList_t const &reference)
+            {
+                std::ostringstream os;
+                auto m = std::mismatch(optimized.begin(), optimized.end(), reference.begin());
+                if(m.first != optimized.end() && (m.second == reference.end() || *m.first < *m.second))
+                {
+                    os << *m.first << " only optimized";
+                }
+                else if(m.second != reference.end())
+                {
+                    os << *m.second << " only reference";
+                }
+                else
+                {
+                    os << optimized.size() << " optimized, " << reference.size() << " reference";
+                }
+                return os.str();
+            }
+
+            double microseconds(Harness::Clock::duration d) noexcept
+            {
+                return std::chrono::duration<double, std::micro>(d).count();
+            }
+        }
+
+        Harness::Harness(server::Variant const &v, Options const &opts)
+        : variant(v) //can't use {}
+        , options(opts) //can't use {}
+        , like{v.config}
+        , attack_map{v.config}
+        {
+            starts.push_back(Start{"start", true, {}, v.players[v.first_turn]});
+        }
+
+        void Harness::add(epd::Suite const &suite)
+        {
+            for(auto const &p : suite.positions)
+            {
+                starts.push_back(Start{p.id, false, p.layout, p.turn});
+            }
+        }
+
+        std::unique_ptr<board::Board> Harness::setUp(Start const &s, Generation g) const
+        {
+            std::unique_ptr<board::Board> b {s.initial? new board::Board{like} : new board::Board{like, s.layout}};
+            if(g != b->generation())
+            {
+                b->generation(g);
+            }
+            return b;
+        }
+
+        std::size_t Harness::turnOf(Start const &s) const
+        {
+            return static_cast<std::size_t>(std::find(variant.players.begin(), variant.players.end(), s.turn) - variant.players.begin()) % variant.players.size();
+        }
+
+        std::string Harness::compare(board::Board const &optimized, board::Board const &reference)
+        {
+            for(auto const &suit : variant.players)
+            {
+                auto const legal = optimized.legalMoves(suit), expected = reference.legalMoves(suit);
+                if(legal != expected)
+                {
+                    return "legal moves of \"" + suit + "\" differ: " + firstDifference(legal, expected);
+                }
+            }
+            struct
+            {
+                char const *name;
+                board::Board::Movements const &optimized, &reference;
+            } const movements[]
+            {
+                {"trajectories", optimized.pieceTrajectories(), reference.pieceTrajectories()},
+                {"capturings",   optimized.pieceCapturings(),   reference.pieceCapturings()  },
+                {"capturables",  optimized.pieceCapturables(),  reference.pieceCapturables() },
+            };
+            for(auto const &m : movements)
+            {
+                auto const a = listed(m.optimized), b = listed(m.reference);
+                if(a != b)
+                {
+                    return std::string(m.name) + " differ: " + firstDifference(a, b);
+                }
+            }
+            attack_map.compute(optimized);
+            for(auto const &s : variant.config.suits())
+            {
+                if(!(optimized.attacked(s) == reference.attacked(s)))
+                {
+                    return "cells attacked by \"" + s + "\" differ";
+                }
+                if(!(attack_map.of(s) == reference.attacked(s)))
+                {
+                    return "AttackMap cells of \"" + s + "\" differ from the reference";
+                }
+            }
+            for(std::size_t i = 0; i < optimized.symmetries().size(); ++i)
+            {
+                if(optimized.hash(i) != reference.hash(i))
+                {
+                    return "hash " + std::to_string(i) + " differs";
+                }
+            }
+            return "";
+        }
+
+        bool Harness::replay(Start const &s, std::vector<board::Move> const &moves, std::size_t &ply, std::string &what)
+        {
+            auto optimized = setUp(s, Generation::Optimized), reference = setUp(s, Generation::Reference);
+            for(ply = 0; ; ++ply)
+            {
+                what = compare(*optimized, *reference);
+                if(!what.empty() || ply == moves.size())
+                {
+                    return true;
+                }
+                //the board doesn't keep turns, so each move is made by the suit of the piece moving
+                auto const &m = moves[ply];
+                auto const piece = reference->find(m.from);
+                if(piece == reference->end())
+                {
+                    return false;
+                }
+                auto const legal = reference->legalMoves((*piece)->suit);
+                if(!std::binary_search(legal.begin(), legal.end(), m))
+                {
+                    return false;
+                }
+                bool const moved = optimized->moveTo(optimized->find(m.from), m.to);
+                if(reference->moveTo(piece, m.to) != moved)
+                {
+                    std::ostringstream os;
+                    os << "moveTo() " << m << " refused only by the " << (moved? "reference" : "optimized") << " board";
+                    what = os.str();
+                    ++ply;
+                    return true;
+                }
+            }
+        }
+
+        bool Harness::shorter(Start const &s, std::vector<board::Move> &candidate, Divergence &d)
+        {
+            std::size_t ply;
+            std::string what;
+            if(!replay(s, candidate, ply, what) || what.empty())
+            {
+                return false;
+            }
+            candidate.resize(ply);
+            d.moves.swap(candidate);
+            d.what = what;
+            return true;
+        }
+
+        void Harness::shrink(Start const &s, Divergence &d)
+        {
+            std::vector<board::Move> candidate;
+            for(bool shrinking = true; shrinking;)
+            {
+                shrinking = false;
+                //drop ever smaller runs of moves
+                for(std::size_t chunk = std::max<std::size_t>(1, d.moves.size()/2); chunk > 0;)
+                {
+                    bool shrunk = false;
+                    for(std::size_t at = 0; at + chunk <= d.moves.size();)
+                    {
+                        candidate.assign(d.moves.begin(), d.moves.begin() + static_cast<std::ptrdiff_t>(at));
+                        candidate.insert(candidate.end(), d.moves.begin() + static_cast<std::ptrdiff_t>(at + chunk), d.moves.end());
+                        if(shorter(s, candidate, d))
+                        {
+                            shrunk = shrinking = true;
+                        }
+                        else
+                        {
+                            at += chunk;
+                        }
+                    }
+                    chunk = std::min(shrunk? chunk : chunk/2, d.moves.size());
+                }
+                //make a piece's move and its next one in one go, at either time, or not at all if it came back
+                for(std::size_t i = 0; i < d.moves.size(); ++i)
+                {
+                    auto const next = std::find_if(d.moves.begin() + static_cast<std::ptrdiff_t>(i + 1), d.moves.end(), [&](board::Move const &m)
+                    {
+                        return m.from == d.moves[i].to;
+                    });
+                    if(next == d.moves.end())
+                    {
+                        continue;
+                    }
+                    std::size_t const j = static_cast<std::size_t>(next - d.moves.begin());
+                    board::Move const merged {d.moves[i].from, d.moves[j].to};
+                    for(int when = 0; when < 2; ++when)
+                    {
+                        candidate = d.moves;
+                        candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(j));
+                        if(merged.from == merged.to)
+                        {
+                            candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(i));
+                        }
+                        else if(when == 0)
+                        {
+                            candidate[i] = merged;
+                        }
+                        else
+                        {
+                            candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(i));
+                            candidate.insert(candidate.begin() + static_cast<std::ptrdiff_t>(j - 1), merged);
+                        }
+                        if(shorter(s, candidate, d))
+                        {
+                            shrinking = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        bool Harness::run(Divergence &first)
+        {
+            for(std::uint64_t game = 0; game < options.games; ++game)
+            {
+                for(std::size_t i = 0; i < starts.size(); ++i)
+                {
+                    auto const &s = starts[i];
+                    std::mt19937 rng {options.seed + static_cast<std::uint32_t>(game*starts.size() + i)};
+                    auto optimized = setUp(s, Generation::Optimized), reference = setUp(s, Generation::Reference);
+                    auto turn = turnOf(s);
+                    Played p {i, {}};
+                    std::string what;
+                    for(unsigned ply = 0; ply <= options.max_plies; ++ply)
+                    {
+                        auto const &suit = variant.players[turn];
+                        what = compare(*optimized, *reference);
+                        auto const legal = reference->legalMoves(suit);
+                        if(!what.empty() || legal.empty() || ply == options.max_plies)
+                        {
+                            break;
+                        }
+                        auto const m = legal[std::uniform_int_distribution<std::size_t>{0, legal.size() - 1}(rng)];
+                        p.moves.push_back(m);
+                        bool const moved = optimized->moveTo(optimized->find(m.from), m.to);
+                        if(reference->moveTo(reference->find(m.from), m.to) != moved)
+                        {
+                            std::ostringstream os;
+                            os << "moveTo() " << m << " refused only by the " << (moved? "reference" : "optimized") << " board";
+                            what = os.str();
+                            break;
+                        }
+                        turn = (turn + 1) % variant.players.size();
+                    }
+                    if(!what.empty())
+                    {
+                        first.variant = variant.name;
+                        first.start = s.name;
+                        first.moves = p.moves;
+                        first.unshrunk = p.moves.size();
+                        first.what = what;
+                        shrink(s, first);
+                        return false;
+                    }
+                    played.push_back(std::move(p));
+                }
+            }
+            return true;
+        }
+
+        void Harness::benchmark(std::ostream &os) const
+        {
+            struct
+            {
+                char const *name;
+                Generation generation;
+                std::uint64_t plies;
+                Clock::duration generating, moving;
+            } paths[]
+            {
+                {"optimized", Generation::Optimized, 0, {}, {}},
+                {"reference", Generation::Reference, 0, {}, {}},
+            };
+            for(auto &path : paths)
+            {
+                for(auto const &p : played)
+                {
+                    auto const &s = starts[p.start];
+                    auto b = setUp(s, path.generation);
+                    auto turn = turnOf(s);
+                    for(auto const &m : p.moves)
+                    {
+                        auto const start = Clock::now();
+                        auto const legal = b->legalMoves(variant.players[turn]);
+                        auto const generated = Clock::now();
+                        b->moveTo(b->find(m.from), m.to);
+                        path.moving += Clock::now() - generated;
+                        path.generating += generated - start;
+                        ++path.plies;
+                        turn = (turn + 1) % variant.players.size();
+                    }
+                }
+            }
+            if(played.empty())
+            {
+                os << variant.name << ": no games to time" << std::endl;
+                return;
+            }
+            os << std::fixed << std::setprecision(2);
+            for(auto const &path : paths)
+            {
+                double const plies = static_cast<double>(std::max<std::uint64_t>(path.plies, 1));
+                os << variant.name << " " << path.name << ": " << path.plies << " plies, legalMoves() " << microseconds(path.generating)/plies
+                   << "us, moveTo() " << microseconds(path.moving)/plies << "us per ply" << std::endl;
+            }
+            auto ratio = [](Clock::duration a, Clock::duration b)
+            {
+                return b.count()? static_cast<double>(a.count())/b.count() : 0.0;
+            };
+            os << variant.name << " speedup: legalMoves() " << ratio(paths[1].generating, paths[0].generating) << "x, moveTo() "
+               << ratio(paths[1].moving, paths[0].moving) << "x, both " << ratio(paths[1].generating + paths[1].moving, paths[0].generating + paths[0].moving) << "x" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef ChessPlusPlus_MoveGen_DifferentialHarnessClass_HeaderPlusPlus
+#define ChessPlusPlus_MoveGen_DifferentialHarnessClass_HeaderPlusPlus
+
+#include "epd/Suite.hpp"
+#include "server/Game.hpp"
+#include "board/AttackMap.hpp"
+#include "board/Board.hpp"
+#include "board/Move.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace movegen
+    {
+        /**
+         * Plays random games on two boards at once, one keeping its
+         * movements up to date the optimized way and one the reference way
+         * (see Board::Generation), from the starting layout and from stored
+         * positions. After every move the two must have the same legal
+         * moves, movements, attacked cells and hash, and an AttackMap of the
+         * optimized board the same attacked cells as the reference.
+         *
+         * The first difference is shrunk to as few moves as still show one,
+         * by dropping runs of moves and making a piece's moves in one go
+         * where the rest stay legal. The board doesn't keep turns, so a suit
+         * may then move several times in a row. The games played can be
+         * replayed on each board alone to time them against each other.
+         */
+        class Harness
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                std::uint64_t games; //from each start
+                unsigned max_plies;
+                std::uint32_t seed;
+            };
+            //Where games start from
+            class Start
+            {
+            public:
+                std::string name;
+                bool initial;                          //the variant's starting layout, not a stored position
+                config::BoardConfig::Layout_t layout;  //if not initial
+                board::Board::Suit turn;
+            };
+            class Divergence
+            {
+            public:
+                std::string variant, start;
+                std::vector<board::Move> moves; //from the start, as few as still show it
+                std::size_t unshrunk = 0;       //moves played before shrinking
+                std::string what;
+            };
+
+        private:
+            server::Variant const &variant;
+            Options const options;
+            board::Board const like;
+            board::AttackMap attack_map;
+            std::vector<Start> starts;
+            //Games played, by start
+            class Played
+            {
+            public:
+                std::size_t start;
+                std::vector<board::Move> moves;
+            };
+            std::vector<Played> played;
+
+            std::unique_ptr<board::Board> setUp(Start const &s, board::Board::Generation g) const;
+            std::size_t turnOf(Start const &s) const;
+            //What differs between the optimized and reference boards, empty if nothing
+            std::string compare(board::Board const &optimized, board::Board const &reference);
+            //Plays moves from a start on both boards, each by the suit of the piece moving. Returns
+            //false if one is not legal on the reference board; otherwise ply is how many were played
+            //before they differed and what describes it, or is empty if they never did.
+            bool replay(Start const &s, std::vector<board::Move> const &moves, std::size_t &ply, std::string &what);
+            //Takes the moves instead of d's if they still show a difference, ending with the first one
+            bool shorter(Start const &s, std::vector<board::Move> &candidate, Divergence &d);
+            void shrink(Start const &s, Divergence &d);
+
+        public:
+            Harness(server::Variant const &v, Options const &opts);
+
+            //Adds the positions of a suite as starts
+            void add(epd::Suite const &suite);
+
+            //Plays games from every start until the first difference. Returns false and fills
+            //in first if there was one.
+            bool run(Divergence &first);
+
+            //Replays every game played on each board alone, timing legalMoves() and moveTo()
+            void benchmark(std::ostream &os) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "movegen/Harness.hpp"
+#include "epd/Notation.hpp"
+#include "epd/Suite.hpp"
+#include "stress/Stress.hpp"
+#include "server/Game.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "board/Board.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <typeinfo>
+
+//Plays random games with the optimized and the reference move generation side by side, reports the first
+//position where they differ with as few moves as still show it, and times one against the other.
+//Usage: chesspp-movegen-diff [--variant name [--suite file]...]... [--variants dir] [--games n per start]
+//                            [--max-plies n] [--seed n] [--verbose]
+//Suites given after a variant are read as positions of that variant to start games from as well.
+int main(int argc, char const *const *argv)
+{
+    std::vector<std::pair<std::string, std::vector<std::string>>> named; //variants and their suites
+    std::string dir = "config/chesspp/";
+    chesspp::movegen::Harness::Options options {20, 200, 1};
+    bool verbose = false, bad = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--variant"   && has_value) named.emplace_back(argv[++i], std::vector<std::string>{});
+        else if(arg == "--suite"     && has_value && !named.empty()) named.back().second.push_back(argv[++i]);
+        else if(arg == "--variants"  && has_value) dir               = argv[++i];
+        else if(arg == "--games"     && has_value) options.games     = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--max-plies" && has_value) options.max_plies = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--seed"      && has_value) options.seed      = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--verbose")                verbose           = true;
+        else bad = true;
+    }
+    if(bad)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--variant name [--suite file]...]... [--variants dir] [--games n per start]"
+                     " [--max-plies n] [--seed n] [--verbose]" << std::endl;
+        return -1;
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    try
+    {
+        using namespace chesspp;
+        if(!dir.empty() && dir.back() != '/')
+        {
+            dir += '/';
+        }
+        if(named.empty())
+        {
+            for(auto const &name : stress::Stress::variantsIn(dir))
+            {
+                named.emplace_back(name, std::vector<std::string>{});
+            }
+        }
+        config::ResourcesConfig res;
+        bool same = true;
+        for(auto const &n : named)
+        {
+            server::Variant v {res, n.first, dir + n.first + ".json"};
+            movegen::Harness harness {v, options};
+            board::Board const like {v.config};
+            epd::Notation notation {v.config, v.players, v.players[v.first_turn]};
+            for(auto const &file : n.second)
+            {
+                std::ifstream in {file};
+                if(!in)
+                {
+                    throw Exception("Unable to read \"" + file + "\"");
+                }
+                harness.add(epd::Suite{in, notation, like});
+            }
+
+            movegen::Harness::Divergence d;
+            if(!harness.run(d))
+            {
+                same = false;
+                std::cout << "DIVERGED " << d.variant << " from \"" << d.start << "\" after " << d.moves.size()
+                          << " moves (" << d.unshrunk << " before shrinking): " << d.what << std::endl << " ";
+                for(auto const &m : d.moves)
+                {
+                    std::cout << " " << m.from << "->" << m.to;
+                }
+                std::cout << std::endl;
+            }
+            else
+            {
+                std::cout << v.name << ": no differences" << std::endl;
+            }
+            harness.benchmark(std::cout);
+        }
+        return same? 0 : 1;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
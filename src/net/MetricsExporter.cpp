@@ -0,0 +1,193 @@
+#include "MetricsExporter.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace net
+    {
+        namespace
+        {
+            static bool sendAll(int fd, std::string const &data) noexcept
+            {
+                std::size_t sent = 0;
+                while(sent < data.size())
+                {
+                    ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                    if(n == -1 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if(n <= 0)
+                    {
+                        return false;
+                    }
+                    sent += static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+        }
+
+        MetricsExporter::MetricsExporter(util::Metrics &metrics_, Options const &options_) noexcept(false)
+        : metrics(metrics_) //can't use {}
+        , options{options_}
+        , waker{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+        {
+            if(!options.endpoint.empty())
+            {
+                listener = Endpoint{options.endpoint}.listen();
+                if(!listener.setNonBlocking())
+                {
+                    throw Exception(std::string("Unable to set up metrics endpoint: ") + std::strerror(errno));
+                }
+            }
+            if(!waker)
+            {
+                throw Exception(std::string("Unable to set up metrics exporter: ") + std::strerror(errno));
+            }
+            if(!options.file.empty() && options.interval.count() <= 0)
+            {
+                throw Exception("Metrics file interval must be positive");
+            }
+            running = true;
+            thread = std::thread(&MetricsExporter::run, this);
+            if(listener)
+            {
+                std::clog << "Serving metrics on " << Endpoint{options.endpoint} << std::endl;
+            }
+        }
+        MetricsExporter::~MetricsExporter()
+        {
+            running = false;
+            std::uint64_t one = 1;
+            if(::write(waker.handle(), &one, sizeof(one)) == -1)
+            {
+                std::cerr << "Unable to wake metrics exporter" << std::endl;
+            }
+            thread.join();
+            if(!options.file.empty())
+            {
+                writeFile();
+            }
+        }
+
+        void MetricsExporter::run()
+        {
+            using Clock = std::chrono::steady_clock;
+            auto due = Clock::now() + options.interval;
+            pollfd fds[2] {{waker.handle(), POLLIN, 0}, {listener.handle(), POLLIN, 0}}; //poll skips a negative descriptor
+            while(running)
+            {
+                int timeout = -1;
+                if(!options.file.empty())
+                {
+                    auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now()).count();
+                    timeout = static_cast<int>(std::max<decltype(left)>(left, 0));
+                }
+                int n = ::poll(fds, 2, timeout);
+                if(n == -1 && errno != EINTR)
+                {
+                    std::cerr << "Metrics exporter failed: " << std::strerror(errno) << std::endl;
+                    break;
+                }
+                if(fds[0].revents & POLLIN)
+                {
+                    std::uint64_t count;
+                    while(::read(waker.handle(), &count, sizeof(count)) > 0)
+                    {
+                    }
+                }
+                if(fds[1].revents & POLLIN)
+                {
+                    int fd;
+                    while((fd = ::accept4(listener.handle(), nullptr, nullptr, SOCK_CLOEXEC)) != -1)
+                    {
+                        serve(Socket{fd});
+                    }
+                }
+                if(!options.file.empty() && Clock::now() >= due)
+                {
+                    writeFile();
+                    due = Clock::now() + options.interval;
+                }
+            }
+        }
+
+        void MetricsExporter::serve(Socket client)
+        {
+            //a scrape is one short request, don't let a silent client hold up the thread
+            timeval const wait {1, 0};
+            ::setsockopt(client.handle(), SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+            std::string request;
+            char buffer[1024];
+            while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+            {
+                ssize_t r = ::read(client.handle(), buffer, sizeof(buffer));
+                if(r == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                if(r <= 0)
+                {
+                    break;
+                }
+                request.append(buffer, static_cast<std::size_t>(r));
+            }
+
+            std::string method, target;
+            std::istringstream{request} >> method >> target;
+            std::string status = "200 OK", body;
+            if(method != "GET")
+            {
+                status = "405 Method Not Allowed";
+            }
+            else if(target != "/metrics" && target != "/")
+            {
+                status = "404 Not Found";
+            }
+            else
+            {
+                std::ostringstream os;
+                metrics.write(os);
+                body = os.str();
+            }
+            std::ostringstream response;
+            response << "HTTP/1.1 " << status << "\r\n"
+                     << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                     << "Content-Length: " << body.size() << "\r\n"
+                     << "Connection: close\r\n\r\n"
+                     << body;
+            sendAll(client.handle(), response.str());
+        }
+
+        void MetricsExporter::writeFile()
+        {
+            std::string const partial = options.file + ".tmp";
+            {
+                std::ofstream out {partial, std::ios::trunc};
+                metrics.write(out);
+                if(!out)
+                {
+                    std::cerr << "Unable to write metrics to " << partial << std::endl;
+                    return;
+                }
+            }
+            if(std::rename(partial.c_str(), options.file.c_str()) != 0)
+            {
+                std::cerr << "Unable to replace " << options.file << ": " << std::strerror(errno) << std::endl;
+            }
+        }
+    }
+}
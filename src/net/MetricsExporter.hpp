@@ -0,0 +1,54 @@
+#ifndef ChessPlusPlus_Net_MetricsExporterClass_HeaderPlusPlus
+#define ChessPlusPlus_Net_MetricsExporterClass_HeaderPlusPlus
+
+#include "Socket.hpp"
+#include "util/Metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace chesspp
+{
+    namespace net
+    {
+        /**
+         * Exports a metrics registry from a thread of its own, in the
+         * Prometheus text format. It answers HTTP GET /metrics on a local
+         * endpoint, writes a file every interval, or both. The file is
+         * replaced in one rename, so a reader never sees half of it.
+         */
+        class MetricsExporter
+        {
+        public:
+            class Options
+            {
+            public:
+                std::string endpoint; //unix:<path> or tcp:<port> on the loopback interface, empty for none
+                std::string file;     //empty for none
+                std::chrono::milliseconds interval;
+            };
+
+        private:
+            util::Metrics &metrics;
+            Options const options;
+            Socket listener, waker;
+            std::thread thread;
+            std::atomic<bool> running {false};
+
+            void run();
+            void serve(Socket client);
+            void writeFile();
+
+        public:
+            MetricsExporter(util::Metrics &metrics, Options const &options) noexcept(false);
+            MetricsExporter(MetricsExporter const &) = delete;
+            MetricsExporter &operator=(MetricsExporter const &) = delete;
+            //Writes the file one last time
+            ~MetricsExporter();
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef ChessPlusPlus_Net_GameProtocolFraming_HeaderPlusPlus
+#define ChessPlusPlus_Net_GameProtocolFraming_HeaderPlusPlus
+
+#include "board/Move.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace chesspp
+{
+    namespace net
+    {
+        using Buffer_t = std::vector<std::uint8_t>;
+
+        //Each frame is a little-endian u16 length (of type and payload), a u8 type, then the payload.
+        //Strings are a u8 length followed by the characters, moves are board::Move::pack()ed.
+        enum class Message : std::uint8_t
+        {
+            //client to server
+            Create   = 0x01, //variant name
+            Join     = 0x02, //u32 game, suit to play (empty to spectate)
+            Move     = 0x03, //u32 game, move
+            Engine   = 0x04, //u32 game, suit for the server to play
+            //server to client
+            Created  = 0x81, //u32 game
+            Joined   = 0x82, //u32 game, suit to move, u32 moves made (each is then sent as an Update)
+            Accepted = 0x83, //u32 game, u32 sequence number of the move
+            Rejected = 0x84, //u32 game, u8 Reason
+            Update   = 0x85, //u32 game, u32 sequence number, move
+            Error    = 0x86, //u8 Reason
+            //spectator stream
+            Captured = 0x87, //u32 game, u32 sequence number, move, u8 x, u8 y of the captured piece
+            Keyframe = 0x88, //u32 game, u32 sequence number, u8 width, u8 height,
+                             //u8 count, suit names, u8 count, piece class names,
+                             //u16 count, pieces as u8 x, u8 y, u8 suit index, u8 class index
+            //server to client
+            Seated   = 0x89  //u32 game, suit the server now plays
+        };
+        enum class Reason : std::uint8_t
+        {
+            Malformed = 1,
+            UnknownVariant,
+            UnknownGame,
+            SeatTaken,
+            NotYourTurn,
+            IllegalMove,
+            NoEngine,
+            GameClosed //sent to every watcher, e.g. when its history no longer replays
+        };
+
+        std::size_t const FrameHeaderSize = 3;
+        std::size_t const MaxFrameSize = FrameHeaderSize + 0xFFFF;
+
+        //Appends one frame to a buffer, the length is filled in on destruction
+        class FrameWriter
+        {
+            Buffer_t &out;
+            std::size_t start;
+
+        public:
+            FrameWriter(Buffer_t &out_, Message type)
+            : out(out_) //can't use {}
+            , start{out_.size()}
+            {
+                out.resize(start + FrameHeaderSize);
+                out[start + 2] = static_cast<std::uint8_t>(type);
+            }
+            FrameWriter(FrameWriter const &) = delete;
+            FrameWriter &operator=(FrameWriter const &) = delete;
+            ~FrameWriter()
+            {
+                std::size_t length = out.size() - start - 2;
+                out[start    ] = static_cast<std::uint8_t>(length     );
+                out[start + 1] = static_cast<std::uint8_t>(length >> 8);
+            }
+
+            FrameWriter &u8(std::uint8_t v)
+            {
+                out.push_back(v);
+                return *this;
+            }
+            FrameWriter &u16(std::uint16_t v)
+            {
+                out.push_back(static_cast<std::uint8_t>(v     ));
+                out.push_back(static_cast<std::uint8_t>(v >> 8));
+                return *this;
+            }
+            FrameWriter &u32(std::uint32_t v)
+            {
+                for(unsigned i = 0; i < 4; ++i)
+                {
+                    out.push_back(static_cast<std::uint8_t>(v >> (i*8)));
+                }
+                return *this;
+            }
+            FrameWriter &str(std::string const &s)
+            {
+                std::size_t length = s.size() < 0xFF ? s.size() : 0xFF;
+                u8(static_cast<std::uint8_t>(length));
+                out.insert(out.end(), s.begin(), s.begin() + length);
+                return *this;
+            }
+            FrameWriter &move(board::Move const &m)
+            {
+                return u32(m.pack());
+            }
+        };
+
+        //Reads the payload of one frame, any read past the end marks the reader as bad
+        class FrameReader
+        {
+            std::uint8_t const *p, *e;
+            bool good = true;
+
+            bool need(std::size_t n) noexcept
+            {
+                if(static_cast<std::size_t>(e - p) < n)
+                {
+                    good = false;
+                }
+                return good;
+            }
+
+        public:
+            FrameReader(std::uint8_t const *payload, std::size_t size) noexcept
+            : p{payload}
+            , e{payload + size}
+            {
+            }
+
+            //true if every read so far was in bounds
+            explicit operator bool() const noexcept
+            {
+                return good;
+            }
+
+            std::uint8_t u8() noexcept
+            {
+                return need(1) ? *p++ : 0;
+            }
+            std::uint16_t u16() noexcept
+            {
+                std::uint16_t v = 0;
+                if(need(2))
+                {
+                    v = static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+                    p += 2;
+                }
+                return v;
+            }
+            std::uint32_t u32() noexcept
+            {
+                std::uint32_t v = 0;
+                if(need(4))
+                {
+                    for(unsigned i = 0; i < 4; ++i)
+                    {
+                        v |= static_cast<std::uint32_t>(*p++) << (i*8);
+                    }
+                }
+                return v;
+            }
+            std::string str()
+            {
+                std::size_t length = u8();
+                if(!need(length))
+                {
+                    return "";
+                }
+                std::string s (reinterpret_cast<char const *>(p), length);
+                p += length;
+                return s;
+            }
+            board::Move move() noexcept
+            {
+                return board::Move(u32());
+            }
+        };
+
+        //Calls f(type, reader) for each complete frame at the front of the buffer,
+        //then erases them. Returns false if a frame is malformed.
+        template<typename F>
+        bool consumeFrames(Buffer_t &in, F f)
+        {
+            std::size_t offset = 0;
+            bool ok = true;
+            while(ok && in.size() - offset >= FrameHeaderSize)
+            {
+                std::size_t length = in[offset] | (static_cast<std::size_t>(in[offset + 1]) << 8);
+                if(length == 0)
+                {
+                    ok = false;
+                    break;
+                }
+                if(in.size() - offset < 2 + length)
+                {
+                    break; //incomplete
+                }
+                FrameReader r {in.data() + offset + FrameHeaderSize, length - 1};
+                ok = f(static_cast<Message>(in[offset + 2]), r);
+                offset += 2 + length;
+            }
+            in.erase(in.begin(), in.begin() + offset);
+            return ok;
+        }
+    }
+}
+
+#endif
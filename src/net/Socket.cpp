@@ -0,0 +1,136 @@
+#include "Socket.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+
+namespace chesspp
+{
+    namespace net
+    {
+        void Socket::close() noexcept
+        {
+            if(fd != -1)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        bool Socket::setNonBlocking() noexcept
+        {
+            int flags = ::fcntl(fd, F_GETFL, 0);
+            return flags != -1 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+        }
+        void Socket::setNoDelay() noexcept
+        {
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        Endpoint::Endpoint(std::string const &spec) noexcept(false)
+        {
+            static std::string const unix_prefix = "unix:";
+            static std::string const tcp_prefix  = "tcp:";
+            if(spec.compare(0, unix_prefix.size(), unix_prefix) == 0)
+            {
+                unix_path = spec.substr(unix_prefix.size());
+                if(unix_path.empty() || unix_path.size() >= sizeof(sockaddr_un::sun_path))
+                {
+                    throw Exception("Invalid Unix domain socket path in endpoint \"" + spec + "\"");
+                }
+                return;
+            }
+            std::string port = spec.compare(0, tcp_prefix.size(), tcp_prefix) == 0 ? spec.substr(tcp_prefix.size()) : spec;
+            char *end = nullptr;
+            unsigned long p = std::strtoul(port.c_str(), &end, 10);
+            if(port.empty() || *end != '\0' || p == 0 || p > 65535)
+            {
+                throw Exception("Invalid endpoint \"" + spec + "\", expected unix:<path> or tcp:<port>");
+            }
+            tcp_port = static_cast<std::uint16_t>(p);
+        }
+
+        namespace
+        {
+            static Socket open(bool unix_domain) noexcept(false)
+            {
+                Socket s {::socket(unix_domain ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+                if(!s)
+                {
+                    throw Exception(std::string("Unable to create socket: ") + std::strerror(errno));
+                }
+                return s;
+            }
+            static sockaddr_un unixAddress(std::string const &path) noexcept
+            {
+                sockaddr_un addr;
+                std::memset(&addr, 0, sizeof(addr));
+                addr.sun_family = AF_UNIX;
+                std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+                return addr;
+            }
+            static sockaddr_in loopbackAddress(std::uint16_t port) noexcept
+            {
+                sockaddr_in addr;
+                std::memset(&addr, 0, sizeof(addr));
+                addr.sin_family = AF_INET;
+                addr.sin_port = htons(port);
+                addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                return addr;
+            }
+        }
+
+        Socket Endpoint::listen() const noexcept(false)
+        {
+            Socket s = open(isUnix());
+            int result;
+            if(isUnix())
+            {
+                ::unlink(unix_path.c_str()); //stale socket file from a previous run
+                sockaddr_un addr = unixAddress(unix_path);
+                result = ::bind(s.handle(), reinterpret_cast<sockaddr const *>(&addr), sizeof(addr));
+            }
+            else
+            {
+                int on = 1;
+                ::setsockopt(s.handle(), SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+                sockaddr_in addr = loopbackAddress(tcp_port);
+                result = ::bind(s.handle(), reinterpret_cast<sockaddr const *>(&addr), sizeof(addr));
+            }
+            if(result == -1 || ::listen(s.handle(), SOMAXCONN) == -1)
+            {
+                throw Exception(std::string("Unable to listen: ") + std::strerror(errno));
+            }
+            return s;
+        }
+        Socket Endpoint::connect() const noexcept(false)
+        {
+            Socket s = open(isUnix());
+            int result;
+            if(isUnix())
+            {
+                sockaddr_un addr = unixAddress(unix_path);
+                result = ::connect(s.handle(), reinterpret_cast<sockaddr const *>(&addr), sizeof(addr));
+            }
+            else
+            {
+                sockaddr_in addr = loopbackAddress(tcp_port);
+                result = ::connect(s.handle(), reinterpret_cast<sockaddr const *>(&addr), sizeof(addr));
+                s.setNoDelay();
+            }
+            if(result == -1)
+            {
+                throw Exception(std::string("Unable to connect: ") + std::strerror(errno));
+            }
+            return s;
+        }
+    }
+}
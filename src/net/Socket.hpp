@@ -0,0 +1,96 @@
+#ifndef ChessPlusPlus_Net_LocalSocketClasses_HeaderPlusPlus
+#define ChessPlusPlus_Net_LocalSocketClasses_HeaderPlusPlus
+
+#include "Exception.hpp"
+
+#include <string>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+
+namespace chesspp
+{
+    namespace net
+    {
+        //Owns a file descriptor and closes it when destructed
+        class Socket
+        {
+            int fd = -1;
+
+        public:
+            Socket() = default;
+            explicit Socket(int fd_) noexcept
+            : fd{fd_}
+            {
+            }
+            Socket(Socket const &) = delete;
+            Socket &operator=(Socket const &) = delete;
+            Socket(Socket &&from) noexcept
+            : fd{from.fd}
+            {
+                from.fd = -1;
+            }
+            Socket &operator=(Socket &&from) noexcept
+            {
+                std::swap(fd, from.fd);
+                return *this;
+            }
+            ~Socket()
+            {
+                close();
+            }
+
+            int handle() const noexcept
+            {
+                return fd;
+            }
+            explicit operator bool() const noexcept
+            {
+                return fd != -1;
+            }
+
+            void close() noexcept;
+            //Gives up ownership of the descriptor without closing it
+            int release() noexcept
+            {
+                int r = fd;
+                fd = -1;
+                return r;
+            }
+            //Makes reads and writes return immediately instead of blocking
+            bool setNonBlocking() noexcept;
+            //Sends small writes immediately on TCP sockets, does nothing for Unix domain sockets
+            void setNoDelay() noexcept;
+        };
+
+        //A local address, either "unix:<path>" for a Unix domain socket
+        //or "<port>" / "tcp:<port>" for TCP on the loopback interface
+        class Endpoint
+        {
+            std::string unix_path;
+            std::uint16_t tcp_port = 0;
+
+        public:
+            Endpoint(std::string const &spec) noexcept(false);
+
+            bool isUnix() const noexcept
+            {
+                return !unix_path.empty();
+            }
+
+            Socket listen() const noexcept(false);
+            Socket connect() const noexcept(false);
+
+            friend std::ostream &operator<<(std::ostream &os, Endpoint const &e)
+            {
+                if(e.isUnix())
+                {
+                    return os << "unix:" << e.unix_path;
+                }
+                return os << "tcp:127.0.0.1:" << e.tcp_port;
+            }
+        };
+    }
+}
+
+#endif
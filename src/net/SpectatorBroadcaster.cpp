@@ -0,0 +1,349 @@
+#include "SpectatorBroadcaster.hpp"
+
+#include "piece/Piece.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace chesspp
+{
+    namespace net
+    {
+        SpectatorBroadcaster::SpectatorBroadcaster(Endpoint const &endpoint, std::size_t keyframe_interval_, std::size_t max_pending_) noexcept(false)
+        : keyframe_interval{std::max<std::size_t>(keyframe_interval_, 1)}
+        , max_pending{max_pending_}
+        , listener{endpoint.listen()}
+        , poller{::epoll_create1(EPOLL_CLOEXEC)}
+        , waker{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+        {
+            if(!poller || !waker || !listener.setNonBlocking())
+            {
+                throw Exception(std::string("Unable to set up spectator broadcasting: ") + std::strerror(errno));
+            }
+            watch(listener.handle(), false);
+            watch(waker.handle(), false);
+            running = true;
+            thread = std::thread(&SpectatorBroadcaster::run, this);
+            std::clog << "Broadcasting to spectators on " << endpoint << std::endl;
+        }
+        SpectatorBroadcaster::~SpectatorBroadcaster()
+        {
+            running = false;
+            std::uint64_t one = 1;
+            if(::write(waker.handle(), &one, sizeof(one)) == -1)
+            {
+                std::cerr << "Unable to wake spectator broadcaster" << std::endl;
+            }
+            thread.join();
+        }
+
+        void SpectatorBroadcaster::attach(board::Board &b)
+        {
+            {
+                Buffer_t frame;
+                writeKeyframe(frame, b, seq);
+                publish(std::make_shared<Buffer_t const>(std::move(frame)), true);
+            }
+            b.addListener([this, &b](board::Move const &m, board::Board::Position_t const *captured)
+            {
+                ++seq;
+                {
+                    Buffer_t frame;
+                    if(captured)
+                    {
+                        FrameWriter(frame, Message::Captured).u32(0).u32(seq).move(m).u8(captured->x).u8(captured->y);
+                    }
+                    else
+                    {
+                        FrameWriter(frame, Message::Update).u32(0).u32(seq).move(m);
+                    }
+                    publish(std::make_shared<Buffer_t const>(std::move(frame)), false);
+                }
+                if(seq % keyframe_interval == 0)
+                {
+                    Buffer_t frame;
+                    writeKeyframe(frame, b, seq);
+                    publish(std::make_shared<Buffer_t const>(std::move(frame)), true);
+                }
+            });
+        }
+
+        void SpectatorBroadcaster::writeKeyframe(Buffer_t &out, board::Board const &b, std::uint32_t seq)
+        {
+            std::vector<board::Board::Suit> suits;
+            std::vector<config::BoardConfig::PieceClass_t> classes;
+            for(auto const &p : b)
+            {
+                if(std::find(suits.begin(), suits.end(), p->suit) == suits.end())
+                {
+                    suits.push_back(p->suit);
+                }
+                if(std::find(classes.begin(), classes.end(), p->pclass) == classes.end())
+                {
+                    classes.push_back(p->pclass);
+                }
+            }
+            FrameWriter w {out, Message::Keyframe};
+            w.u32(0).u32(seq).u8(b.config.boardWidth()).u8(b.config.boardHeight());
+            w.u8(static_cast<std::uint8_t>(suits.size()));
+            for(auto const &s : suits)
+            {
+                w.str(s);
+            }
+            w.u8(static_cast<std::uint8_t>(classes.size()));
+            for(auto const &c : classes)
+            {
+                w.str(c);
+            }
+            w.u16(static_cast<std::uint16_t>(std::distance(b.begin(), b.end())));
+            for(auto const &p : b)
+            {
+                w.u8(p->pos.x).u8(p->pos.y)
+                 .u8(static_cast<std::uint8_t>(std::find(suits.begin(), suits.end(), p->suit) - suits.begin()))
+                 .u8(static_cast<std::uint8_t>(std::find(classes.begin(), classes.end(), p->pclass) - classes.begin()));
+            }
+        }
+
+        void SpectatorBroadcaster::publish(Frame_t f, bool is_keyframe)
+        {
+            {
+                std::lock_guard<std::mutex> lock {inbox_mutex};
+                inbox.emplace_back(std::move(f), is_keyframe);
+            }
+            std::uint64_t one = 1;
+            if(::write(waker.handle(), &one, sizeof(one)) == -1 && errno != EAGAIN)
+            {
+                std::cerr << "Unable to wake spectator broadcaster" << std::endl;
+            }
+        }
+
+        void SpectatorBroadcaster::run()
+        {
+            epoll_event events[64];
+            while(running)
+            {
+                int n = ::epoll_wait(poller.handle(), events, 64, -1);
+                if(n == -1 && errno != EINTR)
+                {
+                    std::cerr << "Spectator broadcaster failed: " << std::strerror(errno) << std::endl;
+                    break;
+                }
+                for(int i = 0; i < n; ++i)
+                {
+                    int fd = events[i].data.fd;
+                    if(fd == waker.handle())
+                    {
+                        std::uint64_t count;
+                        while(::read(fd, &count, sizeof(count)) > 0)
+                        {
+                        }
+                        drainInbox();
+                        continue;
+                    }
+                    if(fd == listener.handle())
+                    {
+                        accept();
+                        continue;
+                    }
+                    auto it = subscribers.find(fd);
+                    if(it == subscribers.end())
+                    {
+                        continue;
+                    }
+                    if(events[i].events & EPOLLIN)
+                    {
+                        char discard[256]; //spectators have nothing to say, only notice them leaving
+                        ssize_t r = ::read(fd, discard, sizeof(discard));
+                        if(r == 0 || (r == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+                        {
+                            drop(fd);
+                            continue;
+                        }
+                    }
+                    if(events[i].events & (EPOLLERR | EPOLLHUP))
+                    {
+                        drop(fd);
+                        continue;
+                    }
+                    if(events[i].events & EPOLLOUT)
+                    {
+                        flush(fd, *it->second);
+                    }
+                }
+            }
+        }
+        void SpectatorBroadcaster::drainInbox()
+        {
+            std::vector<std::pair<Frame_t, bool>> frames;
+            {
+                std::lock_guard<std::mutex> lock {inbox_mutex};
+                frames.swap(inbox);
+            }
+            std::vector<int> fds; //enqueueing and flushing may drop subscribers
+            for(auto const &s : subscribers)
+            {
+                fds.push_back(s.first);
+            }
+            for(auto const &f : frames)
+            {
+                if(f.second)
+                {
+                    //subscribers already following along don't need it
+                    keyframe = f.first;
+                    since_keyframe.clear();
+                    continue;
+                }
+                since_keyframe.push_back(f.first);
+                for(int fd : fds)
+                {
+                    auto it = subscribers.find(fd);
+                    if(it != subscribers.end())
+                    {
+                        enqueue(fd, *it->second, f.first);
+                    }
+                }
+            }
+            for(int fd : fds)
+            {
+                auto it = subscribers.find(fd);
+                if(it != subscribers.end() && !it->second->writing)
+                {
+                    flush(fd, *it->second);
+                }
+            }
+        }
+        void SpectatorBroadcaster::accept()
+        {
+            int fd;
+            while((fd = ::accept4(listener.handle(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+            {
+                std::unique_ptr<Subscriber> s {new Subscriber(Socket(fd))};
+                s->socket.setNoDelay();
+                if(keyframe)
+                {
+                    s->queue.push_back(keyframe);
+                    s->pending += keyframe->size();
+                }
+                for(auto const &f : since_keyframe)
+                {
+                    s->queue.push_back(f);
+                    s->pending += f->size();
+                }
+                auto &sub = *(subscribers[fd] = std::move(s));
+                subscriber_count = subscribers.size();
+                watch(fd, false);
+                flush(fd, sub);
+            }
+        }
+        void SpectatorBroadcaster::enqueue(int fd, Subscriber &s, Frame_t const &f)
+        {
+            s.queue.push_back(f);
+            s.pending += f->size();
+            if(s.pending > max_pending)
+            {
+                resync(fd, s);
+            }
+        }
+        void SpectatorBroadcaster::resync(int fd, Subscriber &s)
+        {
+            if(s.resynced)
+            {
+                std::clog << "Disconnecting spectator " << fd << ", it keeps falling behind" << std::endl;
+                return drop(fd);
+            }
+            std::clog << "Spectator " << fd << " fell behind, skipping ahead to the latest keyframe" << std::endl;
+            //a partially sent frame must be finished to keep the stream in sync
+            std::size_t keep = s.offset > 0 ? 1 : 0;
+            s.queue.erase(s.queue.begin() + keep, s.queue.end());
+            s.pending = keep ? s.queue.front()->size() - s.offset : 0;
+            if(keyframe)
+            {
+                s.queue.push_back(keyframe);
+                s.pending += keyframe->size();
+            }
+            for(auto const &f : since_keyframe)
+            {
+                s.queue.push_back(f);
+                s.pending += f->size();
+            }
+            s.resynced = true;
+        }
+        void SpectatorBroadcaster::flush(int fd, Subscriber &s)
+        {
+            while(!s.queue.empty())
+            {
+                iovec iov[64];
+                std::size_t count = 0;
+                for(auto it = s.queue.begin(); it != s.queue.end() && count < 64; ++it, ++count)
+                {
+                    std::size_t skip = (count == 0 ? s.offset : 0);
+                    iov[count].iov_base = const_cast<std::uint8_t *>((*it)->data() + skip);
+                    iov[count].iov_len  = (*it)->size() - skip;
+                }
+                msghdr msg;
+                std::memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = iov;
+                msg.msg_iovlen = count;
+                ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if(n == -1)
+                {
+                    if(errno != EAGAIN && errno != EWOULDBLOCK)
+                    {
+                        return drop(fd);
+                    }
+                    break;
+                }
+                std::size_t sent = static_cast<std::size_t>(n);
+                s.pending -= sent;
+                while(sent > 0)
+                {
+                    std::size_t left = s.queue.front()->size() - s.offset;
+                    if(sent < left)
+                    {
+                        s.offset += sent;
+                        break;
+                    }
+                    sent -= left;
+                    s.offset = 0;
+                    s.queue.pop_front();
+                }
+                if(s.offset > 0)
+                {
+                    break; //socket buffer is full
+                }
+            }
+            if(s.queue.empty())
+            {
+                s.resynced = false; //caught up
+            }
+            if(s.writing != !s.queue.empty())
+            {
+                s.writing = !s.queue.empty();
+                watch(fd, s.writing);
+            }
+        }
+        void SpectatorBroadcaster::drop(int fd)
+        {
+            subscribers.erase(fd); //closing the socket also removes it from epoll
+            subscriber_count = subscribers.size();
+        }
+        void SpectatorBroadcaster::watch(int fd, bool writable)
+        {
+            epoll_event e;
+            e.events = EPOLLIN | (writable ? EPOLLOUT : 0);
+            e.data.fd = fd;
+            if(::epoll_ctl(poller.handle(), EPOLL_CTL_MOD, fd, &e) == -1)
+            {
+                ::epoll_ctl(poller.handle(), EPOLL_CTL_ADD, fd, &e);
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef ChessPlusPlus_Net_SpectatorBroadcasterClass_HeaderPlusPlus
+#define ChessPlusPlus_Net_SpectatorBroadcasterClass_HeaderPlusPlus
+
+#include "Socket.hpp"
+#include "Protocol.hpp"
+#include "board/Board.hpp"
+
+#include <memory>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace chesspp
+{
+    namespace net
+    {
+        //Streams a live game to spectator processes. Each move is serialized once into a
+        //delta frame shared by every subscriber's queue and written with scatter-gather I/O.
+        //Late joiners get the latest keyframe and the deltas since; subscribers that fall too
+        //far behind are resynced the same way once, and disconnected if they lag again.
+        class SpectatorBroadcaster
+        {
+        public:
+            using Frame_t = std::shared_ptr<Buffer_t const>;
+
+        private:
+            class Subscriber
+            {
+            public:
+                Socket socket;
+                std::deque<Frame_t> queue;
+                std::size_t offset = 0;  //bytes of the front frame already sent
+                std::size_t pending = 0; //bytes queued but not yet sent
+                bool resynced = false;   //downsampled since it last caught up
+                bool writing = false;
+
+                Subscriber(Socket s)
+                : socket{std::move(s)}
+                {
+                }
+            };
+
+            std::size_t const keyframe_interval;
+            std::size_t const max_pending;
+            Socket listener, poller, waker;
+            std::thread thread;
+            std::atomic<bool> running {false};
+
+            std::mutex inbox_mutex;
+            std::vector<std::pair<Frame_t, bool>> inbox; //frame, whether it is a keyframe
+
+            //only used by the thread making moves
+            std::uint32_t seq = 0;
+
+            //only used by the broadcasting thread
+            Frame_t keyframe;
+            std::vector<Frame_t> since_keyframe;
+            std::unordered_map<int, std::unique_ptr<Subscriber>> subscribers;
+            std::atomic<std::size_t> subscriber_count {0};
+
+        public:
+            SpectatorBroadcaster(Endpoint const &endpoint, std::size_t keyframe_interval = 32, std::size_t max_pending = 1 << 18) noexcept(false);
+            SpectatorBroadcaster(SpectatorBroadcaster const &) = delete;
+            SpectatorBroadcaster &operator=(SpectatorBroadcaster const &) = delete;
+            ~SpectatorBroadcaster();
+
+            //Publishes a keyframe of the board, then every move made on it
+            void attach(board::Board &b);
+
+            std::size_t subscriberCount() const noexcept
+            {
+                return subscriber_count;
+            }
+
+            //Serializes the pieces on a board
+            static void writeKeyframe(Buffer_t &out, board::Board const &b, std::uint32_t seq);
+
+        private:
+            void publish(Frame_t f, bool is_keyframe);
+
+            void run();
+            void drainInbox();
+            void accept();
+            void enqueue(int fd, Subscriber &s, Frame_t const &f);
+            void resync(int fd, Subscriber &s);
+            void flush(int fd, Subscriber &s);
+            void drop(int fd);
+            void watch(int fd, bool writable);
+        };
+    }
+}
+
+#endif
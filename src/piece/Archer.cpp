@@ -21,6 +21,40 @@ namespace chesspp
         : Piece{b, pos_, s_, pc}
         {
         }
+        Archer::Archer(Archer const &other, board::Board &b)
+        : Piece{other, b}
+        {
+        }
+        std::unique_ptr<Piece> Archer::clone(board::Board &b) const
+        {
+            return std::unique_ptr<Piece>(new Archer(*this, b));
+        }
+
+        bool Archer::attackPattern(Pattern &p) const
+        {
+            p.leaps.insert(p.leaps.end(), {{ 1, -2}, { 2, -1}, { 2,  1}, { 1,  2}
+                                          ,{-1,  2}, {-2,  1}, {-2, -1}, {-1, -2}
+                                          ,{ 0,  2}, {-2,  0}, { 2,  0}, { 0, -2}});
+            return true;
+        }
+
+        bool Archer::movePattern(Pattern &p) const
+        {
+            using Dir = util::Direction;
+            for(Dir d : {Dir::NorthEast
+                        ,Dir::SouthEast
+                        ,Dir::SouthWest
+                        ,Dir::NorthWest})
+            {
+                p.leaps.push_back(util::Offset(d));
+            }
+            return true;
+        }
+
+        bool Archer::outdated(bool touched) const
+        {
+            return touched;
+        }
 
         void Archer::calcTrajectory()
         {
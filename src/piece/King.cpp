@@ -21,6 +21,41 @@ namespace chesspp
         : Piece{b, pos_, s_, pc}
         {
         }
+        King::King(King const &other, board::Board &b)
+        : Piece{other, b}
+        {
+        }
+        std::unique_ptr<Piece> King::clone(board::Board &b) const
+        {
+            return std::unique_ptr<Piece>(new King(*this, b));
+        }
+
+        bool King::attackPattern(Pattern &p) const
+        {
+            using Dir = util::Direction;
+            for(Dir d : {Dir::North
+                        ,Dir::NorthEast
+                        ,Dir::East
+                        ,Dir::SouthEast
+                        ,Dir::South
+                        ,Dir::SouthWest
+                        ,Dir::West
+                        ,Dir::NorthWest})
+            {
+                p.leaps.push_back(util::Offset(d));
+            }
+            return true;
+        }
+
+        bool King::movePattern(Pattern &p) const
+        {
+            return attackPattern(p); //moves where it captures
+        }
+
+        bool King::outdated(bool touched) const
+        {
+            return touched;
+        }
 
         void King::calcTrajectory()
         {
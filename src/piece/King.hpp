@@ -12,6 +12,12 @@ namespace chesspp
         {
         public:
             King(board::Board &b, Position_t const &pos, Suit_t const &s, Class_t const &pc);
+            King(King const &other, board::Board &b);
+
+            virtual std::unique_ptr<Piece> clone(board::Board &b) const override;
+            virtual bool attackPattern(Pattern &p) const override;
+            virtual bool movePattern(Pattern &p) const override;
+            virtual bool outdated(bool touched) const override;
 
         protected:
             virtual void calcTrajectory() override;
@@ -21,6 +21,31 @@ namespace chesspp
         : Piece{b, pos_, s_, pc}
         {
         }
+        Knight::Knight(Knight const &other, board::Board &b)
+        : Piece{other, b}
+        {
+        }
+        std::unique_ptr<Piece> Knight::clone(board::Board &b) const
+        {
+            return std::unique_ptr<Piece>(new Knight(*this, b));
+        }
+
+        bool Knight::attackPattern(Pattern &p) const
+        {
+            p.leaps.insert(p.leaps.end(), {{ 1, -2}, { 2, -1}, { 2,  1}, { 1,  2}
+                                          ,{-1,  2}, {-2,  1}, {-2, -1}, {-1, -2}});
+            return true;
+        }
+
+        bool Knight::movePattern(Pattern &p) const
+        {
+            return attackPattern(p); //moves where it captures
+        }
+
+        bool Knight::outdated(bool touched) const
+        {
+            return touched;
+        }
 
         void Knight::calcTrajectory()
         {
@@ -1,5 +1,6 @@
 #include "Pawn.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -13,16 +14,40 @@ namespace chesspp
             [](board::Board &b, board::Board::Position_t const &p, board::Board::Suit const &s)
             -> board::Board::Pieces_t::value_type
             {
+                //a pawn set up away from its suit's starting cells faces the same way they do
+                auto const &start = b.config.initialLayout();
+                auto home = start.find(p);
+                bool const at_start = home != start.end() && home->second.first == "Pawn" && home->second.second == s;
+                if(!at_start)
+                {
+                    home = std::find_if(start.begin(), start.end(), [&](config::BoardConfig::Layout_t::value_type const &slot)
+                    {
+                        return slot.second.first == "Pawn" && slot.second.second == s;
+                    });
+                }
+                auto const &cell = home != start.end()? home->first : p;
                 auto d = util::Direction::None;
-                std::istringstream {std::string(b.config.metadata("pawn facing", p.y, p.x))} >> d;
-                return board::Board::Pieces_t::value_type(new Pawn(b, p, s, "Pawn", d));
+                std::istringstream {std::string(b.config.metadata("pawn facing", cell.y, cell.x))} >> d;
+                return board::Board::Pieces_t::value_type(new Pawn(b, p, s, "Pawn", d, at_start));
             }
         );
 
-        Pawn::Pawn(board::Board &b, Position_t const &pos_, Suit_t const &s_, Class_t const &pc, util::Direction const &face)
+        Pawn::Pawn(board::Board &b, Position_t const &pos_, Suit_t const &s_, Class_t const &pc, util::Direction const &face, bool at_start)
         : Piece{b, pos_, s_, pc}
         , facing{face}
+        , started{!at_start}
+        {
+        }
+        Pawn::Pawn(Pawn const &other, board::Board &b)
+        : Piece{other, b}
+        , en_passant{other.en_passant}
+        , facing{other.facing}
+        , started{other.started}
+        {
+        }
+        std::unique_ptr<Piece> Pawn::clone(board::Board &b) const
         {
+            return std::unique_ptr<Piece>(new Pawn(*this, b));
         }
 
         void Pawn::tick(Position_t const &m)
@@ -33,6 +58,36 @@ namespace chesspp
             }
         }
 
+        void Pawn::moveUpdate(Position_t const &from, Position_t const &to)
+        {
+            //only a double step can be captured en passant, not a single step or a capture
+            en_passant = moves == 0 && to == Position_t(from).move(facing, 2);
+        }
+
+        bool Pawn::attackPattern(Pattern &p) const
+        {
+            p.leaps.push_back(util::Offset(Rotate(facing, +1)));
+            p.leaps.push_back(util::Offset(Rotate(facing, -1)));
+            return true;
+        }
+
+        bool Pawn::movePattern(Pattern &p) const
+        {
+            p.leaps.push_back(util::Offset(facing));
+            return true;
+        }
+
+        std::uint64_t Pawn::hashState() const noexcept
+        {
+            return moves == 1 && en_passant? 1 : 0;
+        }
+
+        bool Pawn::outdated(bool touched) const
+        {
+            //may still be capturable en passant, which the next move ends
+            return touched || (moves == 1 && en_passant);
+        }
+
         void Pawn::calcTrajectory()
         {
             //Pawns can move 1 or 2 spaces forward on their first turn,
@@ -43,7 +98,7 @@ namespace chesspp
             //if they just moved forward two spaces (en passant).
 
             addTrajectory(Position_t(pos).move(facing));
-            if(moves == 0) //first move
+            if(moves == 0 && !started) //first move
             {
                 if(!board.occupied(Position_t(pos).move(facing))) //can't jump over pieces
                 {
@@ -10,16 +10,25 @@ namespace chesspp
     {
         class Pawn : public virtual Piece
         {
-            bool en_passant = true;
+            bool en_passant = false; //first move was a double step, until the next move
             util::Direction facing;
+            bool started; //set up away from its starting cells, so its first double step is gone
 
         public:
-            Pawn(board::Board &b, Position_t const &pos, Suit_t const &s, Class_t const &pc, util::Direction const &face);
+            Pawn(board::Board &b, Position_t const &pos, Suit_t const &s, Class_t const &pc, util::Direction const &face, bool at_start = true);
+            Pawn(Pawn const &other, board::Board &b);
+
+            virtual std::unique_ptr<Piece> clone(board::Board &b) const override;
+            virtual bool attackPattern(Pattern &p) const override;
+            virtual bool movePattern(Pattern &p) const override;
+            virtual bool outdated(bool touched) const override;
+            virtual std::uint64_t hashState() const noexcept override;
 
             virtual void tick(Position_t const &p) override;
 
         protected:
             virtual void calcTrajectory() override;
+            virtual void moveUpdate(Position_t const &from, Position_t const &to) override;
         };
     }
 }
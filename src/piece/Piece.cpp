@@ -16,6 +16,14 @@ namespace chesspp
         {
             std::clog << "Creation of " << *this << std::endl;
         }
+        Piece::Piece(Piece const &other, board::Board &b)
+        : board(b) //can't use {}
+        , p{other.p}
+        , s{other.s}
+        , c{other.c}
+        , m{other.m}
+        {
+        }
 
         void Piece::addTrajectory(Position_t const &tile)
         {
@@ -3,8 +3,11 @@
 
 #include "config/BoardConfig.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <set>
+#include <utility>
+#include <vector>
 #include <typeinfo>
 #include <iostream>
 
@@ -38,8 +41,50 @@ namespace chesspp
             std::size_t const &moves  = m;
 
             Piece(board::Board &b, Position_t const &pos, Suit_t const &s, Class_t const &pc);
+            //Copies the state of a piece onto another board
+            Piece(Piece const &other, board::Board &b);
+            Piece(Piece const &) = delete;
+            Piece &operator=(Piece const &) = delete;
             virtual ~Piece() = default;
 
+            //Deriving classes should copy themselves with their copying constructor
+            virtual std::unique_ptr<Piece> clone(board::Board &b) const = 0;
+
+            //Cells relative to a piece, for whole-board bitset operations
+            class Pattern
+            {
+            public:
+                using Offset_t = std::pair<signed, signed>;
+                std::vector<Offset_t> leaps;  //single cells
+                std::vector<Offset_t> slides; //steps repeated up to and including the first piece in the way
+
+                friend bool operator==(Pattern const &a, Pattern const &b) noexcept
+                {
+                    return a.leaps == b.leaps && a.slides == b.slides;
+                }
+            };
+            //Adds the cells calcTrajectory() calls addCapturing() for, or returns false if they
+            //can't be described by a pattern, in which case the piece's capturings are used as they are
+            virtual bool attackPattern(Pattern &p) const
+            {
+                return false;
+            }
+            //Adds the cells the piece can usually move to without capturing, or returns false if
+            //they can't be described by a pattern. Used for distances, so it may leave out
+            //special moves such as a first double step.
+            virtual bool movePattern(Pattern &p) const
+            {
+                return false;
+            }
+
+            //State other than the position and number of moves that changes the piece's
+            //movements, e.g. whether it can be captured en passant, for the board's hash.
+            //Must fit in 32 bits; none by default.
+            virtual std::uint64_t hashState() const noexcept
+            {
+                return 0;
+            }
+
             //non-virtual, calls calcTrajectory(), which should call addTrajectory() for each possible tile
             void makeTrajectory()
             {
@@ -51,6 +96,14 @@ namespace chesspp
             //should call addTrajectory() for each calculated trajectory
             //and addCapture() for each possible capture
             virtual void calcTrajectory() = 0;
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            //The straightforward version of calcTrajectory(), for the board's reference generation
+            //to check optimized ones against. Pieces without an optimized one needn't override it.
+            virtual void calcReference()
+            {
+                calcTrajectory();
+            }
+#endif
 
             //deriving classes should call this from makeTrajectory to add a calculated trajectory tile
             void addTrajectory(Position_t const &tile);
@@ -73,6 +126,14 @@ namespace chesspp
             {
             }
 
+            //Called before tick() after another piece moves, with whether any of this piece's
+            //trajectories, capturings or capturables are at a cell the move emptied or filled.
+            //Returns whether calcTrajectory() has to run again; by default it always does.
+            virtual bool outdated(bool touched) const
+            {
+                return true;
+            }
+
             //Sets the piece position as instructed by the board
             void move(Position_t const &to)
             {
@@ -21,8 +21,73 @@ namespace chesspp
         : Piece{b, pos_, s_, pc}
         {
         }
+        Queen::Queen(Queen const &other, board::Board &b)
+        : Piece{other, b}
+        {
+        }
+        std::unique_ptr<Piece> Queen::clone(board::Board &b) const
+        {
+            return std::unique_ptr<Piece>(new Queen(*this, b));
+        }
+
+        bool Queen::attackPattern(Pattern &p) const
+        {
+            using Dir = util::Direction;
+            for(Dir d : {Dir::North
+                        ,Dir::NorthEast
+                        ,Dir::East
+                        ,Dir::SouthEast
+                        ,Dir::South
+                        ,Dir::SouthWest
+                        ,Dir::West
+                        ,Dir::NorthWest})
+            {
+                p.slides.push_back(util::Offset(d));
+            }
+            return true;
+        }
+
+        bool Queen::movePattern(Pattern &p) const
+        {
+            return attackPattern(p); //moves where it captures
+        }
+
+        bool Queen::outdated(bool touched) const
+        {
+            //every cell up to the first piece in the way is a capturing
+            return touched;
+        }
 
         void Queen::calcTrajectory()
+        {
+            //Queens can move infinitely in all eight directions
+            using Dir = util::Direction;
+            for(Dir d : {Dir::North
+                        ,Dir::NorthEast
+                        ,Dir::East
+                        ,Dir::SouthEast
+                        ,Dir::South
+                        ,Dir::SouthWest
+                        ,Dir::West
+                        ,Dir::NorthWest})
+            {
+                Position_t blocker;
+                bool blocked = board.nearestBlocker(pos, d, blocker);
+                for(Position_t t = Position_t(pos).move(d); board.valid(t); t.move(d))
+                {
+                    addCapturing(t);
+                    if(blocked && t == blocker)
+                    {
+                        break; //can't jump over pieces
+                    }
+                    addTrajectory(t);
+                }
+            }
+        }
+
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+        //Steps cell by cell instead of asking the board for the nearest blocker
+        void Queen::calcReference()
         {
             //Queens can move infinitely in all eight directions
             using Dir = util::Direction;
@@ -47,5 +112,6 @@ namespace chesspp
                 }
             }
         }
+#endif
     }
 }
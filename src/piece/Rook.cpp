@@ -21,8 +21,65 @@ namespace chesspp
         : Piece{b, pos_, s_, pc}
         {
         }
+        Rook::Rook(Rook const &other, board::Board &b)
+        : Piece{other, b}
+        {
+        }
+        std::unique_ptr<Piece> Rook::clone(board::Board &b) const
+        {
+            return std::unique_ptr<Piece>(new Rook(*this, b));
+        }
+
+        bool Rook::attackPattern(Pattern &p) const
+        {
+            using Dir = util::Direction;
+            for(Dir d : {Dir::North
+                        ,Dir::East
+                        ,Dir::South
+                        ,Dir::West})
+            {
+                p.slides.push_back(util::Offset(d));
+            }
+            return true;
+        }
+
+        bool Rook::movePattern(Pattern &p) const
+        {
+            return attackPattern(p); //moves where it captures
+        }
+
+        bool Rook::outdated(bool touched) const
+        {
+            //every cell up to the first piece in the way is a capturing
+            return touched;
+        }
 
         void Rook::calcTrajectory()
+        {
+            //Rooks can move infinitely in the four straight directions
+            using Dir = util::Direction;
+            for(Dir d : {Dir::North
+                        ,Dir::East
+                        ,Dir::South
+                        ,Dir::West})
+            {
+                Position_t blocker;
+                bool blocked = board.nearestBlocker(pos, d, blocker);
+                for(Position_t t = Position_t(pos).move(d); board.valid(t); t.move(d))
+                {
+                    addCapturing(t);
+                    if(blocked && t == blocker)
+                    {
+                        break; //can't jump over pieces
+                    }
+                    addTrajectory(t);
+                }
+            }
+        }
+
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+        //Steps cell by cell instead of asking the board for the nearest blocker
+        void Rook::calcReference()
         {
             //Rooks can move infinitely in the four straight directions
             using Dir = util::Direction;
@@ -43,5 +100,6 @@ namespace chesspp
                 }
             }
         }
+#endif
     }
 }
@@ -12,9 +12,18 @@ namespace chesspp
         {
         public:
             Rook(board::Board &b, Position_t const &pos, Suit_t const &s, Class_t const &pc);
+            Rook(Rook const &other, board::Board &b);
+
+            virtual std::unique_ptr<Piece> clone(board::Board &b) const override;
+            virtual bool attackPattern(Pattern &p) const override;
+            virtual bool movePattern(Pattern &p) const override;
+            virtual bool outdated(bool touched) const override;
 
         protected:
             virtual void calcTrajectory() override;
+#if defined(CHESSPP_REFERENCE_MOVEGEN)
+            virtual void calcReference() override;
+#endif
         };
     }
 }
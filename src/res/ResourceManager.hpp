@@ -3,6 +3,8 @@
 
 #include "config/Configuration.hpp"
 #include "util/Utilities.hpp"
+#include "util/Allocations.hpp"
+#include "util/Metrics.hpp"
 
 #include <map>
 #include <typeinfo>
@@ -25,16 +27,49 @@ namespace chesspp
             : conf(conf_) //can't use {}
             {
             }
+            ResourceManager(ResourceManager const &) = delete;
+            ResourceManager &operator=(ResourceManager const &) = delete;
+            //Takes its resources back out of the gauges
+            ~ResourceManager()
+            {
+                auto &m = metrics();
+                m.resources.add(-static_cast<std::int64_t>(res.size()));
+                m.bytes.add(-static_cast<std::int64_t>(bytes));
+            }
 
             class Resource
             {
             public:
                 virtual ~Resource() = 0;
+
+                //Roughly how much memory the resource holds on to, 0 if unknown
+                virtual std::size_t bytes() const noexcept
+                {
+                    return 0;
+                }
             };
 
         private:
             using Res_t = std::map<std::pair<std::string, std::type_index>, std::unique_ptr<Resource>>;
             Res_t res;
+            std::size_t bytes = 0;
+
+            struct Stats
+            {
+                util::Metrics::Counter &hits, &misses;
+                util::Metrics::Gauge &resources, &bytes;
+            };
+            static Stats &metrics()
+            {
+                static Stats m
+                {
+                    util::Metrics::global().counter("chesspp_resource_hits_total", "Resources found already loaded"),
+                    util::Metrics::global().counter("chesspp_resource_misses_total", "Resources loaded on first use"),
+                    util::Metrics::global().gauge("chesspp_resources", "Resources loaded by every resource manager"),
+                    util::Metrics::global().gauge("chesspp_resource_bytes", "Memory held by loaded resources, where known")
+                };
+                return m;
+            }
 
         public:
             template<typename ResT, typename... Path>
@@ -45,13 +80,31 @@ namespace chesspp
                 ResT &
             >::type
             {
+                util::Allocations::Scope tag {util::Allocations::Subsystem::Res};
                 Res_t::key_type key {util::path_concat(std::string("\0", 1), path...), typeid(ResT)};
-                if(res.find(key) == std::end(res))
+                auto &m = metrics();
+                auto it = res.find(key);
+                if(it == std::end(res))
+                {
+                    m.misses.add();
+                    it = res.emplace(key, Res_t::mapped_type{new ResT{conf.setting(path...)}}).first;
+                    std::size_t const b = it->second->bytes();
+                    bytes += b;
+                    m.resources.add(1);
+                    m.bytes.add(static_cast<std::int64_t>(b));
+                }
+                else
                 {
-                    res.emplace(key, Res_t::mapped_type{new ResT{conf.setting(path...)}});
+                    m.hits.add();
                 }
                 //This cast is guaranteed to be correct
-                return static_cast<ResT &>(*res[key]);
+                return static_cast<ResT &>(*it->second);
+            }
+
+            //How many resources have been loaded
+            std::size_t size() const noexcept
+            {
+                return res.size();
             }
         };
         inline ResourceManager::Resource::~Resource() = default;
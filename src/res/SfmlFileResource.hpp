@@ -4,6 +4,7 @@
 #include "ResourceManager.hpp"
 //#include "SFML.hpp"
 
+#include <fstream>
 #include <iostream>
 
 namespace chesspp
@@ -13,6 +14,23 @@ namespace chesspp
         template<typename sfmlT>
         class SfmlFileResource : public ResourceManager::Resource
         {
+            std::size_t size = 0;
+
+            //Textures take four bytes a pixel once loaded
+            template<typename T>
+            static auto bytesOf(T const &t, std::string const &, int) noexcept
+            -> decltype(std::size_t(t.getSize().x)*t.getSize().y)
+            {
+                return std::size_t(t.getSize().x)*t.getSize().y*4;
+            }
+            //Anything else is about the size of its file
+            template<typename T>
+            static std::size_t bytesOf(T const &, std::string const &file_path, long) noexcept
+            {
+                std::ifstream f {file_path, std::ios::binary | std::ios::ate};
+                return f? static_cast<std::size_t>(f.tellg()) : 0;
+            }
+
         public:
             sfmlT res;
 
@@ -29,9 +47,15 @@ namespace chesspp
                     std::clog << "SFML Resource loaded \""
                               << file_path << "\" for "
                               << typeid(sfmlT).name() << std::endl;
+                    size = bytesOf(res, file_path, 0); //prefers the int overload where it applies
                 }
             }
 
+            std::size_t bytes() const noexcept override
+            {
+                return size;
+            }
+
             operator sfmlT &() noexcept
             {
                 return res;
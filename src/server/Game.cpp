@@ -0,0 +1,141 @@
+#include "Game.hpp"
+
+#include "piece/Piece.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace chesspp
+{
+    namespace server
+    {
+        namespace
+        {
+            static Variant::Players_t playersOf(config::BoardConfig const &conf)
+            {
+                //same as the GUI: every suit in the layout plays, in sorted order
+                return Variant::Players_t{conf.suits().begin(), conf.suits().end()};
+            }
+        }
+
+        Variant::Variant(config::ResourcesConfig &res, std::string const &name_, std::string const &board_file)
+        : name{name_}
+        , config{res, board_file}
+        , players{playersOf(config)}
+        , first_turn
+          {
+              static_cast<Players_t::size_type>(std::find(players.begin(), players.end(), std::string(config.metadata("first turn"))) - players.begin()) % std::max<Players_t::size_type>(players.size(), 1)
+          }
+        {
+            if(players.empty())
+            {
+                throw Exception("Variant \"" + name + "\" has no suits to play");
+            }
+        }
+
+        Game::Game(GameId id_, Variant const &v)
+        : id{id_}
+        , variant(v) //can't use {}
+        , turn{v.first_turn}
+        , last_active{Clock::now()}
+        {
+        }
+
+        board::Board &Game::board() noexcept(false)
+        {
+            last_active = Clock::now();
+            if(!b)
+            {
+                std::unique_ptr<board::Board> replayed {new board::Board(variant.config)};
+                //the moves were logged and counted when they were played
+                replayed->logMoves(false);
+                for(std::size_t i = 0; i < moves.size(); ++i)
+                {
+                    board::Move move {moves[i]};
+                    if(!replayed->moveTo(replayed->find(move.from), move.to))
+                    {
+                        throw Exception("Game " + std::to_string(id) + " diverged replaying move " + std::to_string(i + 1) + " of its history");
+                    }
+                }
+                replayed->logMoves(true);
+                b = std::move(replayed);
+            }
+            return *b;
+        }
+        void Game::hibernate() noexcept
+        {
+            b.reset();
+            moves.shrink_to_fit();
+        }
+
+        void Game::restore(History_t const &history)
+        {
+            b.reset();
+            moves = history;
+            turn = (variant.first_turn + moves.size()) % variant.players.size();
+        }
+
+        bool Game::play(board::Move const &m, board::MoveCache &legal)
+        {
+            auto &bd = board();
+            if(!bd.valid(m.from) || !bd.valid(m.to) || !legal.legal(bd, turnSuit(), m))
+            {
+                return false;
+            }
+            auto source = bd.find(m.from);
+            if(source == bd.end() || (*source)->suit != turnSuit())
+            {
+                return false;
+            }
+            if(!bd.moveTo(source, m.to))
+            {
+                return false;
+            }
+            moves.push_back(m.pack());
+            turn = (turn + 1) % variant.players.size();
+            return true;
+        }
+
+        bool Game::sit(board::Board::Suit const &suit, ConnectionRef const &c)
+        {
+            if(std::find(variant.players.begin(), variant.players.end(), suit) == variant.players.end())
+            {
+                return false;
+            }
+            auto it = seats.find(suit);
+            if(it != seats.end())
+            {
+                return it->second == c;
+            }
+            seats.emplace(suit, c);
+            return true;
+        }
+        bool Game::seated(board::Board::Suit const &suit, ConnectionRef const &c) const noexcept
+        {
+            auto it = seats.find(suit);
+            return it != seats.end() && it->second == c;
+        }
+
+        void Game::subscribe(ConnectionRef const &c)
+        {
+            if(std::find(subscribers.begin(), subscribers.end(), c) == subscribers.end())
+            {
+                subscribers.push_back(c);
+            }
+        }
+        void Game::leave(ConnectionRef const &c)
+        {
+            for(auto it = seats.begin(); it != seats.end(); )
+            {
+                if(it->second == c)
+                {
+                    it = seats.erase(it);
+                }
+                else ++it;
+            }
+            subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), c), subscribers.end());
+        }
+    }
+}
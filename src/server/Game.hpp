@@ -0,0 +1,121 @@
+#ifndef ChessPlusPlus_Server_HostedGameClass_HeaderPlusPlus
+#define ChessPlusPlus_Server_HostedGameClass_HeaderPlusPlus
+
+#include "config/ResourcesConfig.hpp"
+#include "config/BoardConfig.hpp"
+#include "board/Board.hpp"
+#include "board/MoveCache.hpp"
+#include "board/Move.hpp"
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace chesspp
+{
+    namespace server
+    {
+        using GameId = std::uint32_t;
+
+        //Identifies a client connection by the shard that owns it
+        class ConnectionRef
+        {
+        public:
+            std::uint32_t shard, id; //intentionally public
+
+            friend bool operator==(ConnectionRef const &a, ConnectionRef const &b) noexcept
+            {
+                return a.shard == b.shard && a.id == b.id;
+            }
+        };
+        //Holds the seats the server plays itself; messages to it are dropped
+        ConnectionRef const EngineSeat {std::numeric_limits<std::uint32_t>::max(), 0};
+
+        //A board layout games can be created from, shared by all of a shard's games of that variant
+        class Variant
+        {
+        public:
+            using Players_t = std::vector<board::Board::Suit>;
+
+            std::string const name;
+            config::BoardConfig const config;
+            Players_t const players; //in turn order
+            Players_t::size_type const first_turn;
+
+            Variant(config::ResourcesConfig &res, std::string const &name, std::string const &board_file);
+        };
+
+        //A hosted game. While idle it may hibernate, dropping its Board
+        //and keeping only its move history to replay when next needed.
+        class Game
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            using History_t = std::vector<board::Move::Packed_t>;
+            using Seats_t = std::map<board::Board::Suit, ConnectionRef>;
+            using Subscribers_t = std::vector<ConnectionRef>;
+
+            GameId const id;
+            Variant const &variant;
+
+        private:
+            std::unique_ptr<board::Board> b;
+            History_t moves;
+            Variant::Players_t::size_type turn;
+            Seats_t seats;
+            Subscribers_t subscribers;
+            Clock::time_point last_active;
+
+        public:
+            Game(GameId id, Variant const &v);
+
+            //The board, replayed from the move history first if hibernating.
+            //Throws if a move no longer replays, leaving the game hibernating.
+            board::Board &board() noexcept(false);
+            bool hibernating() const noexcept
+            {
+                return !b;
+            }
+            void hibernate() noexcept;
+            Clock::time_point lastActive() const noexcept
+            {
+                return last_active;
+            }
+
+            History_t const &history() const noexcept
+            {
+                return moves;
+            }
+            board::Board::Suit const &turnSuit() const noexcept
+            {
+                return variant.players[turn];
+            }
+
+            //Takes the moves of a recovered game, to be replayed when the board is next needed
+            void restore(History_t const &history);
+
+            //Plays a move for the suit whose turn it is, returns false if it is not legal.
+            //Illegal moves are turned away by the cache without trying them on the board.
+            bool play(board::Move const &m, board::MoveCache &legal);
+
+            //Claims the seat of a suit, fails if the suit is not playing or is taken by another connection
+            bool sit(board::Board::Suit const &suit, ConnectionRef const &c);
+            //Whether the connection holds the seat of a suit
+            bool seated(board::Board::Suit const &suit, ConnectionRef const &c) const noexcept;
+
+            void subscribe(ConnectionRef const &c);
+            //Removes the connection's seats and subscription
+            void leave(ConnectionRef const &c);
+            Subscribers_t const &watchers() const noexcept
+            {
+                return subscribers;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "GameServer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace chesspp
+{
+    namespace server
+    {
+        GameServer::GameServer(net::Endpoint const &endpoint, std::uint32_t shard_count, std::string const &variant_dir_, std::chrono::seconds idle_timeout_, EngineOptions const &engine, JournalOptions const &journal) noexcept(false)
+        : variant_dir{variant_dir_}
+        , idle_timeout{idle_timeout_}
+        , listener{endpoint.listen()}
+        , snapshot_interval{journal.snapshot_interval}
+        , last_snapshot{Game::Clock::now()}
+        , engine_time{engine.time}
+        , engine_depth{engine.depth}
+        , engine_mode{engine.mode}
+        {
+            if(!listener.setNonBlocking())
+            {
+                throw Exception("Unable to make the listening socket non-blocking");
+            }
+            for(std::uint32_t i = 0; i < std::max<std::uint32_t>(shard_count, 1); ++i)
+            {
+                shards.emplace_back(new Shard(*this, i));
+            }
+            if(!journal.dir.empty())
+            {
+                auto recovered = Journal::recover(journal.dir);
+                for(auto const &g : recovered)
+                {
+                    shardOf(g.first).restore(g.first, g.second.variant, g.second.moves);
+                }
+                wal.reset(new Journal(journal.dir, journal.sync_interval, shards.size()));
+                std::clog << "Recovered " << recovered.size() << " games from " << journal.dir << std::endl;
+            }
+            if(engine.workers > 0)
+            {
+                search.reset(new ai::SearchService(engine.workers, engine.max_queue, engine.cache_entries));
+            }
+            std::clog << "Game server listening on " << endpoint << " with " << shards.size() << " shards and " << engine.workers << " engine workers" << std::endl;
+        }
+
+        void GameServer::start()
+        {
+            for(auto &s : shards)
+            {
+                s->start();
+            }
+        }
+        void GameServer::stop()
+        {
+            for(auto &s : shards)
+            {
+                s->stop();
+            }
+            //searches finishing now post to the stopped shards, which is harmless
+            if(search)
+            {
+                search->stop();
+            }
+            if(wal)
+            {
+                wal->stop();
+            }
+        }
+
+        void GameServer::snapshotIfDue()
+        {
+            auto now = Game::Clock::now();
+            if(!wal || now - last_snapshot < snapshot_interval || snapshotting.exchange(true))
+            {
+                return;
+            }
+            last_snapshot = now;
+            auto segment = wal->rotate();
+            auto remaining = std::make_shared<std::atomic<std::uint32_t>>(shardCount());
+            for(auto &s : shards)
+            {
+                s->post([this, segment, remaining](Shard &shard)
+                {
+                    shard.snapshot(segment, remaining);
+                    if(*remaining == 0)
+                    {
+                        snapshotting = false;
+                    }
+                });
+            }
+        }
+
+        void GameServer::report(std::ostream &os) const
+        {
+            util::Histogram moves, broadcasts;
+            for(auto const &s : shards)
+            {
+                moves.merge(s->moveTimes());
+                broadcasts.merge(s->broadcastTimes());
+            }
+            os << "move handling: ";
+            moves.report(os, "us");
+            os << std::endl << "broadcast: ";
+            broadcasts.report(os, "us");
+            os << std::endl << "legal move cache: " << legal_moves.hits() << " hits, " << legal_moves.misses() << " misses" << std::endl;
+            if(wal)
+            {
+                wal->report(os);
+            }
+        }
+
+        std::string GameServer::variantFile(std::string const &name) const
+        {
+            if(name.empty())
+            {
+                return variant_dir + "board.json";
+            }
+            if(name[0] == '.' || name.find_first_of("/\\") != std::string::npos)
+            {
+                return "";
+            }
+            return variant_dir + name + ".json";
+        }
+    }
+}
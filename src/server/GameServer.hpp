@@ -0,0 +1,143 @@
+#ifndef ChessPlusPlus_Server_ShardedGameServerClass_HeaderPlusPlus
+#define ChessPlusPlus_Server_ShardedGameServerClass_HeaderPlusPlus
+
+#include "Shard.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "net/Socket.hpp"
+#include "ai/SearchService.hpp"
+#include "board/MoveCache.hpp"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace chesspp
+{
+    namespace server
+    {
+        //Hosts games from many clients in one process. Games are sharded by id
+        //across a fixed set of event-loop threads, each owning its games outright.
+        class GameServer
+        {
+            config::ResourcesConfig res_config;
+            std::string variant_dir;
+            std::chrono::seconds idle_timeout;
+            net::Socket listener;
+            std::vector<std::unique_ptr<Shard>> shards;
+            std::atomic<std::uint32_t> next_shard {0};
+            std::unique_ptr<Journal> wal;
+            std::chrono::seconds snapshot_interval;
+            Game::Clock::time_point last_snapshot;
+            std::atomic<bool> snapshotting {false};
+            board::MoveCache legal_moves {1 << 16}; //shared by the shards
+            //declared after the shards so it is destroyed first, its last callbacks post to them
+            std::unique_ptr<ai::SearchService> search;
+            std::chrono::milliseconds engine_time;
+            unsigned engine_depth;
+            ai::Search::Mode engine_mode;
+
+        public:
+            //How the server plays the seats given to it, no engine is started without workers
+            class EngineOptions
+            {
+            public:
+                std::size_t workers;
+                std::chrono::milliseconds time; //per move
+                unsigned depth;
+                std::size_t max_queue;
+                std::size_t cache_entries;
+                ai::Search::Mode mode; //for variants with more than two suits
+            };
+
+            //Where games are journaled, no journal is kept without a directory
+            class JournalOptions
+            {
+            public:
+                std::string dir;
+                std::chrono::milliseconds sync_interval;
+                std::chrono::seconds snapshot_interval;
+            };
+
+            //Recovers the games in the journal directory before listening
+            GameServer(net::Endpoint const &endpoint, std::uint32_t shard_count, std::string const &variant_dir, std::chrono::seconds idle_timeout, EngineOptions const &engine, JournalOptions const &journal) noexcept(false);
+            ~GameServer()
+            {
+                stop();
+            }
+
+            void start();
+            void stop();
+
+            std::uint32_t shardCount() const noexcept
+            {
+                return static_cast<std::uint32_t>(shards.size());
+            }
+            Shard &shard(std::uint32_t index) noexcept
+            {
+                return *shards[index];
+            }
+            Shard &shardOf(GameId game) noexcept
+            {
+                return shard(game % shardCount());
+            }
+            //The shard the next accepted connection should go to
+            Shard &nextShard() noexcept
+            {
+                return shard(next_shard++ % shardCount());
+            }
+
+            config::ResourcesConfig &resourcesConfig() noexcept
+            {
+                return res_config;
+            }
+            net::Socket const &listenSocket() const noexcept
+            {
+                return listener;
+            }
+            std::chrono::seconds idleTimeout() const noexcept
+            {
+                return idle_timeout;
+            }
+            //The write-ahead log of the games, or nullptr if disabled
+            Journal *journal() noexcept
+            {
+                return wal.get();
+            }
+            //Starts a snapshot of every game if the interval has passed, called by shard 0
+            void snapshotIfDue();
+
+            //The search service playing engine seats, or nullptr if disabled
+            ai::SearchService *engine() noexcept
+            {
+                return search.get();
+            }
+            std::chrono::milliseconds engineTime() const noexcept
+            {
+                return engine_time;
+            }
+            unsigned engineDepth() const noexcept
+            {
+                return engine_depth;
+            }
+            ai::Search::Mode engineMode() const noexcept
+            {
+                return engine_mode;
+            }
+            //Legal moves of positions in any game, for checking moves
+            board::MoveCache &moveCache() noexcept
+            {
+                return legal_moves;
+            }
+            //Move handling and broadcast latency percentiles of all shards, and legal move cache hits
+            void report(std::ostream &os) const;
+            //Path of a variant's board config, or empty if the name is not acceptable
+            std::string variantFile(std::string const &name) const;
+        };
+    }
+}
+
+#endif
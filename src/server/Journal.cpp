@@ -0,0 +1,374 @@
+#include "Journal.hpp"
+
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace chesspp
+{
+    namespace server
+    {
+        namespace
+        {
+            //Each record is a u32 length of the type and payload, a u32 CRC-32 of them, the u8 type, then the payload
+            static std::size_t const RecordHeaderSize = 8;
+
+            static std::uint32_t crcOf(std::uint8_t const *data, std::size_t size) noexcept
+            {
+                boost::crc_32_type crc;
+                crc.process_bytes(data, size);
+                return crc.checksum();
+            }
+            static void putU32(net::Buffer_t &out, std::uint32_t v)
+            {
+                for(unsigned i = 0; i < 4; ++i)
+                {
+                    out.push_back(static_cast<std::uint8_t>(v >> (i*8)));
+                }
+            }
+            static std::uint32_t getU32(std::uint8_t const *p) noexcept
+            {
+                return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+            }
+            static void putStr(net::Buffer_t &out, std::string const &s)
+            {
+                std::size_t length = std::min<std::size_t>(s.size(), 0xFF);
+                out.push_back(static_cast<std::uint8_t>(length));
+                out.insert(out.end(), s.begin(), s.begin() + length);
+            }
+            static std::string segmentName(Journal::Segment_t s)
+            {
+                char name[40];
+                std::snprintf(name, sizeof(name), "journal-%016llu.wal", static_cast<unsigned long long>(s));
+                return name;
+            }
+            static std::uint64_t microsecondsSince(std::chrono::steady_clock::time_point t) noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t).count());
+            }
+        }
+
+        Journal::Journal(std::string const &dir_, std::chrono::milliseconds sync_interval, std::size_t lane_count) noexcept(false)
+        : dir{dir_.empty() || dir_.back() == '/' ? dir_ : dir_ + "/"}
+        , interval{sync_interval}
+        {
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(dir, ec);
+            auto existing = segments(dir);
+            segment = existing.empty() ? 1 : existing.back().first + 1;
+            for(std::size_t i = 0; i < std::max<std::size_t>(lane_count, 1); ++i)
+            {
+                lanes.emplace_back(new Lane);
+                lanes.back()->segment = segment;
+            }
+            if(!open(segment))
+            {
+                throw Exception("Unable to open journal segment in \"" + dir + "\": " + std::strerror(errno));
+            }
+            writer = std::thread(&Journal::run, this);
+        }
+
+        auto Journal::segments(std::string const &dir)
+        -> std::vector<std::pair<Segment_t, std::string>>
+        {
+            std::vector<std::pair<Segment_t, std::string>> found;
+            boost::system::error_code ec;
+            for(boost::filesystem::directory_iterator it {dir, ec}, end; !ec && it != end; it.increment(ec))
+            {
+                auto name = it->path().filename().string();
+                unsigned long long s = 0;
+                char extension[5] = {};
+                if(std::sscanf(name.c_str(), "journal-%16llu.%4s", &s, extension) == 2 && std::string(extension) == "wal")
+                {
+                    found.emplace_back(static_cast<Segment_t>(s), it->path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            return found;
+        }
+
+        auto Journal::recover(std::string const &dir)
+        -> RecoveredGames_t
+        {
+            RecoveredGames_t games;
+            for(auto const &seg : segments(dir))
+            {
+                std::ifstream file {seg.second, std::ios::binary};
+                net::Buffer_t data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+                std::size_t offset = 0, records = 0;
+                while(data.size() - offset >= RecordHeaderSize + 1)
+                {
+                    std::uint32_t length = getU32(data.data() + offset);
+                    std::uint8_t const *body = data.data() + offset + RecordHeaderSize;
+                    if(length == 0 || data.size() - offset - RecordHeaderSize < length || crcOf(body, length) != getU32(data.data() + offset + 4))
+                    {
+                        break; //torn or damaged, nothing after it can be trusted
+                    }
+                    offset += RecordHeaderSize + length;
+                    ++records;
+
+                    net::FrameReader r {body + 1, length - 1};
+                    switch(static_cast<Record>(body[0]))
+                    {
+                    case Record::Create:
+                        {
+                            GameId g = r.u32();
+                            auto variant = r.str();
+                            if(r) games[g] = Recovered{variant, {}};
+                            break;
+                        }
+                    case Record::Move:
+                        {
+                            GameId g = r.u32();
+                            auto m = r.u32();
+                            auto it = games.find(g);
+                            if(r && it != games.end()) it->second.moves.push_back(m);
+                            break;
+                        }
+                    case Record::Snapshot:
+                        {
+                            GameId g = r.u32();
+                            Recovered game;
+                            game.variant = r.str();
+                            game.moves.resize(r.u32());
+                            for(auto &m : game.moves)
+                            {
+                                m = r.u32();
+                            }
+                            if(r) games[g] = std::move(game);
+                            break;
+                        }
+                    default: break;
+                    }
+                }
+                if(offset != data.size())
+                {
+                    std::cerr << "Journal segment " << seg.second << " is damaged after " << records << " records, ignoring the rest" << std::endl;
+                }
+            }
+            return games;
+        }
+
+        void Journal::append(std::size_t lane, Record type, net::Buffer_t const &payload)
+        {
+            //worked out before taking the lane, which the writer may be collecting
+            boost::crc_32_type crc;
+            crc.process_byte(static_cast<std::uint8_t>(type));
+            crc.process_bytes(payload.data(), payload.size());
+            std::uint32_t const length = static_cast<std::uint32_t>(payload.size() + 1);
+            Segment_t const s = segment.load(std::memory_order_acquire);
+
+            Lane &l = *lanes[lane];
+            std::lock_guard<std::mutex> lock {l.mutex};
+            if(l.segment != s)
+            {
+                if(!l.pending.empty())
+                {
+                    l.sealed.emplace_back(l.segment, std::move(l.pending));
+                    l.pending.clear();
+                }
+                l.segment = s;
+            }
+            putU32(l.pending, length);
+            putU32(l.pending, crc.checksum());
+            l.pending.push_back(static_cast<std::uint8_t>(type));
+            l.pending.insert(l.pending.end(), payload.begin(), payload.end());
+            ++l.records;
+        }
+        void Journal::created(std::size_t lane, GameId game, std::string const &variant)
+        {
+            net::Buffer_t payload;
+            putU32(payload, game);
+            putStr(payload, variant);
+            append(lane, Record::Create, payload);
+        }
+        void Journal::moved(std::size_t lane, GameId game, board::Move::Packed_t move)
+        {
+            net::Buffer_t payload;
+            putU32(payload, game);
+            putU32(payload, move);
+            append(lane, Record::Move, payload);
+        }
+        void Journal::snapshot(std::size_t lane, GameId game, std::string const &variant, Game::History_t const &moves)
+        {
+            net::Buffer_t payload;
+            putU32(payload, game);
+            putStr(payload, variant);
+            putU32(payload, static_cast<std::uint32_t>(moves.size()));
+            for(auto m : moves)
+            {
+                putU32(payload, m);
+            }
+            append(lane, Record::Snapshot, payload);
+        }
+        auto Journal::rotate()
+        -> Segment_t
+        {
+            //each lane seals what it has for the old segment on its next append
+            return ++segment;
+        }
+        void Journal::snapshotDone(std::size_t lane, Segment_t s)
+        {
+            net::Buffer_t payload;
+            putU32(payload, static_cast<std::uint32_t>(s));
+            putU32(payload, static_cast<std::uint32_t>(s >> 32));
+            append(lane, Record::SnapshotDone, payload);
+            std::lock_guard<std::mutex> lock {mutex};
+            cleanup = std::max(cleanup, s);
+        }
+
+        bool Journal::open(Segment_t s)
+        {
+            if(fd != -1)
+            {
+                ::fdatasync(fd);
+                ::close(fd);
+            }
+            fd = ::open((dir + segmentName(s)).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            fd_segment = s;
+            if(fd == -1)
+            {
+                return false;
+            }
+            //make the new file's directory entry durable too
+            int d = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(d != -1)
+            {
+                ::fsync(d);
+                ::close(d);
+            }
+            return true;
+        }
+
+        void Journal::write()
+        {
+            Segment_t clean;
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                clean = cleanup;
+                cleanup = 0;
+            }
+            //collected after reading cleanup, so everything appended before it was set is written first
+            std::map<Segment_t, net::Buffer_t> batches;
+            std::uint64_t records = 0;
+            for(auto &l : lanes)
+            {
+                std::lock_guard<std::mutex> lock {l->mutex};
+                for(auto &b : l->sealed)
+                {
+                    auto &batch = batches[b.first];
+                    batch.insert(batch.end(), b.second.begin(), b.second.end());
+                }
+                l->sealed.clear();
+                if(!l->pending.empty())
+                {
+                    auto &batch = batches[l->segment];
+                    batch.insert(batch.end(), l->pending.begin(), l->pending.end());
+                    l->pending.clear();
+                }
+                records += l->records;
+                l->records = 0;
+            }
+            if(records == 0 && !clean)
+            {
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for(auto const &b : batches)
+            {
+                if(b.first != fd_segment && !open(b.first))
+                {
+                    std::cerr << "Unable to open journal segment " << b.first << ": " << std::strerror(errno) << std::endl;
+                    continue;
+                }
+                std::size_t written = 0;
+                while(written < b.second.size())
+                {
+                    ssize_t n = ::write(fd, b.second.data() + written, b.second.size() - written);
+                    if(n == -1)
+                    {
+                        if(errno == EINTR) continue;
+                        std::cerr << "Unable to write journal: " << std::strerror(errno) << std::endl;
+                        break;
+                    }
+                    written += static_cast<std::size_t>(n);
+                }
+            }
+            if(fd != -1 && ::fdatasync(fd) == -1)
+            {
+                std::cerr << "Unable to sync journal: " << std::strerror(errno) << std::endl;
+                return; //keep the old segments
+            }
+            sync_times.record(microsecondsSince(start));
+            batch_records.record(records);
+
+            if(clean)
+            {
+                for(auto const &seg : segments(dir))
+                {
+                    if(seg.first < clean)
+                    {
+                        boost::system::error_code ec;
+                        boost::filesystem::remove(seg.second, ec);
+                    }
+                }
+            }
+        }
+
+        void Journal::run()
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            for(;;)
+            {
+                //everything appended during the wait shares one fsync
+                wake.wait_for(lock, interval, [this]{ return stopping; });
+                bool last = stopping;
+                lock.unlock();
+                write();
+                lock.lock();
+                if(last)
+                {
+                    return;
+                }
+            }
+        }
+
+        void Journal::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                stopping = true;
+            }
+            wake.notify_all();
+            if(writer.joinable())
+            {
+                writer.join();
+            }
+            if(fd != -1)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+
+        void Journal::report(std::ostream &os) const
+        {
+            os << "journal sync: ";
+            sync_times.report(os, "us");
+            os << std::endl << "journal records per sync: ";
+            batch_records.report(os);
+            os << std::endl;
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef ChessPlusPlus_Server_WriteAheadJournalClass_HeaderPlusPlus
+#define ChessPlusPlus_Server_WriteAheadJournalClass_HeaderPlusPlus
+
+#include "Game.hpp"
+#include "net/Protocol.hpp"
+#include "util/Histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace server
+    {
+        /**
+         * Write-ahead log of the games a server hosts. Shards append records
+         * without waiting, each to a lane of its own so they never contend
+         * with each other; a writer thread collects the lanes, writes and
+         * fsyncs whatever has accumulated every sync interval, so one fsync
+         * covers the moves of every game in that window and moves are never
+         * delayed by the disk. A crash loses at most the last interval.
+         *
+         * The log is split into numbered segment files. A snapshot starts a
+         * new segment holding the full state of every game, after which the
+         * older segments are deleted. Recovery replays all segments in order.
+         */
+        class Journal
+        {
+        public:
+            using Segment_t = std::uint64_t;
+            enum class Record : std::uint8_t
+            {
+                Create       = 1, //u32 game, variant name
+                Move         = 2, //u32 game, packed move
+                Snapshot     = 3, //u32 game, variant name, u32 count, packed moves; replaces the game
+                SnapshotDone = 4  //u64 segment; every game has a Snapshot in this segment
+            };
+            class Recovered
+            {
+            public:
+                std::string variant;
+                Game::History_t moves;
+            };
+            using RecoveredGames_t = std::map<GameId, Recovered>;
+
+        private:
+            std::string const dir;
+            std::chrono::milliseconds const interval;
+
+            //Records appended by one thread, only ever contended by the writer collecting them
+            class Lane
+            {
+            public:
+                std::mutex mutex;
+                std::vector<std::pair<Segment_t, net::Buffer_t>> sealed; //earlier segments not yet written out
+                net::Buffer_t pending;
+                Segment_t segment = 0; //that pending records belong to
+                std::uint64_t records = 0;
+            };
+            std::vector<std::unique_ptr<Lane>> lanes;
+            std::atomic<Segment_t> segment; //records are appended to
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            Segment_t cleanup = 0;   //delete segments before this once what was appended before is synced
+            bool stopping = false;
+            std::thread writer;
+
+            int fd = -1;
+            Segment_t fd_segment = 0;
+
+            util::Histogram sync_times;    //microseconds per write and fsync
+            util::Histogram batch_records; //records per fsync
+
+            void append(std::size_t lane, Record type, net::Buffer_t const &payload);
+            void write();
+            void run();
+            bool open(Segment_t s);
+            static std::vector<std::pair<Segment_t, std::string>> segments(std::string const &dir);
+
+        public:
+            //Starts a new segment after the last one in the directory, creating it if needed
+            Journal(std::string const &dir, std::chrono::milliseconds sync_interval, std::size_t lane_count) noexcept(false);
+            ~Journal()
+            {
+                stop();
+            }
+            Journal(Journal const &) = delete;
+            Journal &operator=(Journal const &) = delete;
+
+            //Reads every game in a journal directory, stopping at the first damaged record of each segment
+            static RecoveredGames_t recover(std::string const &dir);
+
+            //Record appenders, callable from any thread as long as each lane is used by one at a time
+            void created(std::size_t lane, GameId game, std::string const &variant);
+            void moved(std::size_t lane, GameId game, board::Move::Packed_t move);
+            void snapshot(std::size_t lane, GameId game, std::string const &variant, Game::History_t const &moves);
+            //Seals the current segment, returns the new one snapshots should be written to
+            Segment_t rotate();
+            //Every game has been snapshotted into a segment, older ones may go
+            void snapshotDone(std::size_t lane, Segment_t s);
+
+            //Writes out everything appended so far and stops the writer thread
+            void stop();
+
+            //Sync latency and group size percentiles
+            void report(std::ostream &os) const;
+        };
+    }
+}
+
+#endif
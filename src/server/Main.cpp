@@ -0,0 +1,105 @@
+#include "server/GameServer.hpp"
+#include "net/MetricsExporter.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <signal.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <typeinfo>
+
+//Headless server hosting many games over a local socket.
+//Usage: chesspp-server [--listen unix:<path>|tcp:<port>] [--shards n] [--idle seconds] [--variants dir]
+//                      [--engine-workers n] [--engine-time ms] [--engine-depth plies] [--engine-mode paranoid|maxn]
+//                      [--journal dir] [--sync-ms ms] [--snapshot seconds]
+//                      [--metrics unix:<path>|tcp:<port>] [--metrics-file path] [--metrics-every seconds] [--verbose]
+int main(int argc, char const *const *argv)
+{
+    std::string listen = "unix:chesspp-server.sock";
+    std::string variants = "config/chesspp/";
+    unsigned long shards = std::thread::hardware_concurrency();
+    unsigned long idle = 60;
+    chesspp::server::GameServer::EngineOptions engine {2, std::chrono::milliseconds(1000), 4, 1024, 1 << 16, chesspp::ai::Search::Mode::Paranoid};
+    chesspp::server::GameServer::JournalOptions journal {"", std::chrono::milliseconds(5), std::chrono::seconds(60)};
+    chesspp::net::MetricsExporter::Options metrics {"", "", std::chrono::seconds(10)};
+    bool verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--listen"         && has_value) listen                    = argv[++i];
+        else if(arg == "--shards"         && has_value) shards                    = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--idle"           && has_value) idle                      = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--variants"       && has_value) variants                  = argv[++i];
+        else if(arg == "--engine-workers" && has_value) engine.workers            = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--engine-time"    && has_value) engine.time               = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--engine-depth"   && has_value) engine.depth              = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--engine-mode"    && has_value && chesspp::ai::Search::modeNamed(argv[i + 1], engine.mode)) ++i;
+        else if(arg == "--journal"        && has_value) journal.dir               = argv[++i];
+        else if(arg == "--sync-ms"        && has_value) journal.sync_interval     = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--snapshot"       && has_value) journal.snapshot_interval = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--metrics"        && has_value) metrics.endpoint          = argv[++i];
+        else if(arg == "--metrics-file"   && has_value) metrics.file              = argv[++i];
+        else if(arg == "--metrics-every"  && has_value) metrics.interval          = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--verbose")                     verbose                   = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--listen unix:<path>|tcp:<port>] [--shards n] [--idle seconds] [--variants dir]"
+                         " [--engine-workers n] [--engine-time ms] [--engine-depth plies] [--engine-mode paranoid|maxn]"
+                         " [--journal dir] [--sync-ms ms] [--snapshot seconds]"
+                         " [--metrics unix:<path>|tcp:<port>] [--metrics-file path] [--metrics-every seconds] [--verbose]" << std::endl;
+            return -1;
+        }
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    //shards must not receive the shutdown signals, only the main thread waits for them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try
+    {
+        chesspp::server::GameServer server
+        {
+            chesspp::net::Endpoint(listen),
+            static_cast<std::uint32_t>(shards),
+            variants,
+            std::chrono::seconds(idle),
+            engine,
+            journal
+        };
+        std::unique_ptr<chesspp::net::MetricsExporter> exporter;
+        if(!metrics.endpoint.empty() || !metrics.file.empty())
+        {
+            exporter.reset(new chesspp::net::MetricsExporter{chesspp::util::Metrics::global(), metrics});
+        }
+        server.start();
+        std::cout << "Listening on " << chesspp::net::Endpoint(listen) << std::endl;
+
+        int sig = 0;
+        sigwait(&signals, &sig);
+        std::cout << "Shutting down" << std::endl;
+        server.stop();
+        server.report(std::cout);
+        if(auto *search = server.engine())
+        {
+            search->report(std::cout);
+        }
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,635 @@
+#include "Shard.hpp"
+
+#include "GameServer.hpp"
+#include "piece/Piece.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <iostream>
+
+namespace chesspp
+{
+    namespace server
+    {
+        namespace
+        {
+            static std::uint64_t const WakeKey   = std::numeric_limits<std::uint64_t>::max();
+            static std::uint64_t const ListenKey = WakeKey - 1;
+            //Clients that stop reading are disconnected once this much output is pending
+            static std::size_t const MaxPendingOutput = 1 << 20;
+
+            static std::uint64_t microsecondsSince(Game::Clock::time_point t) noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Game::Clock::now() - t).count());
+            }
+        }
+
+        Shard::Shard(GameServer &server_, std::uint32_t index_) noexcept(false)
+        : index{index_}
+        , server(server_) //can't use {}
+        , poller{::epoll_create1(EPOLL_CLOEXEC)}
+        , waker{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+        , last_sweep{Game::Clock::now()}
+        {
+            if(!poller || !waker)
+            {
+                throw Exception(std::string("Unable to create shard event loop: ") + std::strerror(errno));
+            }
+            watch(waker.handle(), WakeKey, false);
+            if(index == 0) //the first shard accepts connections for all of them
+            {
+                watch(server.listenSocket().handle(), ListenKey, false);
+            }
+        }
+        Shard::~Shard()
+        {
+            stop();
+        }
+
+        void Shard::start()
+        {
+            running = true;
+            thread = std::thread(&Shard::run, this);
+        }
+        void Shard::stop()
+        {
+            running = false;
+            std::uint64_t one = 1;
+            if(::write(waker.handle(), &one, sizeof(one)) == -1)
+            {
+                std::cerr << "Unable to wake shard " << index << std::endl;
+            }
+            if(thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        void Shard::post(Task t)
+        {
+            {
+                std::lock_guard<std::mutex> lock {mailbox_mutex};
+                mailbox.push_back(std::move(t));
+            }
+            std::uint64_t one = 1;
+            if(::write(waker.handle(), &one, sizeof(one)) == -1 && errno != EAGAIN)
+            {
+                std::cerr << "Unable to wake shard " << index << std::endl;
+            }
+        }
+        void Shard::adopt(net::Socket socket)
+        {
+            int fd = socket.release(); //std::function needs a copyable capture
+            post([fd](Shard &s)
+            {
+                std::uint32_t id = s.next_connection++;
+                s.connections.emplace(id, std::unique_ptr<Connection>(new Connection(net::Socket(fd))));
+                s.watch(fd, id, false);
+            });
+        }
+        void Shard::restore(GameId id, std::string const &name, Game::History_t const &moves)
+        {
+            Variant *v = variant(name);
+            if(!v)
+            {
+                std::cerr << "Unable to recover game " << id << ", its variant \"" << name << "\" is gone" << std::endl;
+                return;
+            }
+            auto &game = games[id];
+            game.reset(new Game(id, *v));
+            game->restore(moves);
+            next_game = std::max<GameId>(next_game, id/server.shardCount() + 1);
+        }
+        void Shard::snapshot(Journal::Segment_t segment, std::shared_ptr<std::atomic<std::uint32_t>> remaining)
+        {
+            Journal *j = server.journal();
+            for(auto const &g : games)
+            {
+                j->snapshot(index, g.first, g.second->variant.name, g.second->history());
+            }
+            if(--*remaining == 0)
+            {
+                j->snapshotDone(index, segment);
+            }
+        }
+        void Shard::deliver(ConnectionRef const &c, net::Buffer_t const &frames)
+        {
+            if(c == EngineSeat)
+            {
+                return;
+            }
+            if(c.shard == index)
+            {
+                send(c.id, frames);
+                return;
+            }
+            std::uint32_t id = c.id;
+            server.shard(c.shard).post([id, frames](Shard &s)
+            {
+                s.send(id, frames);
+            });
+        }
+
+        void Shard::run()
+        {
+            epoll_event events[64];
+            while(running)
+            {
+                int n = ::epoll_wait(poller.handle(), events, 64, 1000);
+                if(n == -1 && errno != EINTR)
+                {
+                    std::cerr << "Shard " << index << " event loop failed: " << std::strerror(errno) << std::endl;
+                    break;
+                }
+                for(int i = 0; i < n; ++i)
+                {
+                    std::uint64_t key = events[i].data.u64;
+                    if(key == WakeKey)
+                    {
+                        std::uint64_t count;
+                        while(::read(waker.handle(), &count, sizeof(count)) > 0)
+                        {
+                        }
+                        runMailbox();
+                    }
+                    else if(key == ListenKey)
+                    {
+                        accept();
+                    }
+                    else
+                    {
+                        auto it = connections.find(static_cast<std::uint32_t>(key));
+                        if(it == connections.end())
+                        {
+                            continue;
+                        }
+                        auto id = it->first;
+                        auto &c = *it->second;
+                        if(events[i].events & (EPOLLERR | EPOLLHUP))
+                        {
+                            close(id);
+                            continue;
+                        }
+                        if(events[i].events & EPOLLOUT)
+                        {
+                            flush(id, c);
+                        }
+                        if(events[i].events & EPOLLIN && !c.closed)
+                        {
+                            read(id, c);
+                        }
+                    }
+                    reap();
+                }
+                sweep();
+            }
+        }
+        void Shard::runMailbox()
+        {
+            std::vector<Task> tasks;
+            {
+                std::lock_guard<std::mutex> lock {mailbox_mutex};
+                tasks.swap(mailbox);
+            }
+            for(auto &t : tasks)
+            {
+                t(*this);
+            }
+        }
+        void Shard::sweep()
+        {
+            auto now = Game::Clock::now();
+            if(now - last_sweep < std::chrono::seconds(1))
+            {
+                return;
+            }
+            last_sweep = now;
+            if(index == 0)
+            {
+                server.snapshotIfDue();
+            }
+            std::set<GameId> retry;
+            retry.swap(engine_retry);
+            for(GameId g : retry)
+            {
+                if(Game *game = awake(g))
+                {
+                    think(*game);
+                }
+            }
+            for(auto &g : games)
+            {
+                if(!g.second->hibernating() && now - g.second->lastActive() > server.idleTimeout())
+                {
+                    g.second->hibernate();
+                }
+            }
+        }
+        void Shard::watch(int fd, std::uint64_t key, bool writable)
+        {
+            epoll_event e;
+            e.events = EPOLLIN | (writable ? EPOLLOUT : 0);
+            e.data.u64 = key;
+            if(::epoll_ctl(poller.handle(), EPOLL_CTL_MOD, fd, &e) == -1)
+            {
+                ::epoll_ctl(poller.handle(), EPOLL_CTL_ADD, fd, &e);
+            }
+        }
+
+        void Shard::accept()
+        {
+            int fd;
+            while((fd = ::accept4(server.listenSocket().handle(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+            {
+                net::Socket s {fd};
+                s.setNoDelay();
+                server.nextShard().adopt(std::move(s));
+            }
+        }
+        void Shard::read(std::uint32_t id, Connection &c)
+        {
+            std::uint8_t chunk[4096];
+            ssize_t n;
+            while((n = ::read(c.socket.handle(), chunk, sizeof(chunk))) > 0)
+            {
+                c.in.insert(c.in.end(), chunk, chunk + n);
+            }
+            //a client may send its last frames and then close its end, so handle what arrived first
+            bool const ended = n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK);
+            bool ok = net::consumeFrames(c.in, [&](net::Message type, net::FrameReader &r)
+            {
+                return onFrame(id, c, type, r);
+            });
+            if(!ok)
+            {
+                net::Buffer_t error;
+                net::FrameWriter(error, net::Message::Error).u8(static_cast<std::uint8_t>(net::Reason::Malformed));
+                send(id, error);
+                close(id);
+            }
+            else if(ended)
+            {
+                close(id);
+            }
+        }
+        void Shard::flush(std::uint32_t id, Connection &c)
+        {
+            std::size_t sent = 0;
+            while(sent < c.out.size())
+            {
+                ssize_t n = ::send(c.socket.handle(), c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+                if(n == -1)
+                {
+                    if(errno != EAGAIN && errno != EWOULDBLOCK)
+                    {
+                        return close(id);
+                    }
+                    break;
+                }
+                sent += static_cast<std::size_t>(n);
+            }
+            c.out.erase(c.out.begin(), c.out.begin() + sent);
+            if(c.out.empty() == c.writing) //only touch epoll when interest changes
+            {
+                c.writing = !c.out.empty();
+                watch(c.socket.handle(), id, c.writing);
+            }
+        }
+        void Shard::send(std::uint32_t id, net::Buffer_t const &frames)
+        {
+            auto it = connections.find(id);
+            if(it == connections.end())
+            {
+                return; //already disconnected
+            }
+            auto &c = *it->second;
+            if(c.closed)
+            {
+                return;
+            }
+            c.out.insert(c.out.end(), frames.begin(), frames.end());
+            if(c.out.size() > MaxPendingOutput)
+            {
+                std::cerr << "Disconnecting client " << index << ":" << id << " for not reading its updates" << std::endl;
+                return close(id);
+            }
+            if(!c.writing)
+            {
+                flush(id, c);
+            }
+        }
+        void Shard::close(std::uint32_t id)
+        {
+            auto it = connections.find(id);
+            if(it != connections.end() && !it->second->closed)
+            {
+                it->second->closed = true;
+                closing.push_back(id);
+            }
+        }
+        void Shard::reap()
+        {
+            for(auto id : closing)
+            {
+                auto it = connections.find(id);
+                ConnectionRef ref {index, id};
+                for(GameId g : it->second->joined)
+                {
+                    route(g, [ref, g](Shard &s)
+                    {
+                        if(Game *game = s.find(g))
+                        {
+                            game->leave(ref);
+                        }
+                    });
+                }
+                connections.erase(it); //closing the socket also removes it from epoll
+            }
+            closing.clear();
+        }
+
+        bool Shard::onFrame(std::uint32_t id, Connection &c, net::Message type, net::FrameReader &r)
+        {
+            ConnectionRef from {index, id};
+            switch(type)
+            {
+            case net::Message::Create:
+                {
+                    auto name = r.str();
+                    if(!r) return false;
+                    create(from, name);
+                    return true;
+                }
+            case net::Message::Join:
+                {
+                    GameId g = r.u32();
+                    auto suit = r.str();
+                    if(!r) return false;
+                    c.joined.insert(g);
+                    route(g, [from, g, suit](Shard &s)
+                    {
+                        s.join(from, g, suit);
+                    });
+                    return true;
+                }
+            case net::Message::Move:
+                {
+                    GameId g = r.u32();
+                    auto m = r.move();
+                    if(!r) return false;
+                    auto received = Game::Clock::now();
+                    route(g, [from, g, m, received](Shard &s)
+                    {
+                        s.move(from, g, m, received);
+                    });
+                    return true;
+                }
+            case net::Message::Engine:
+                {
+                    GameId g = r.u32();
+                    auto suit = r.str();
+                    if(!r) return false;
+                    route(g, [from, g, suit](Shard &s)
+                    {
+                        s.engine(from, g, suit);
+                    });
+                    return true;
+                }
+            default: return false;
+            }
+        }
+
+        void Shard::route(GameId game, Task t)
+        {
+            Shard &owner = server.shardOf(game);
+            if(&owner == this)
+            {
+                return t(*this);
+            }
+            owner.post(std::move(t));
+        }
+        Variant *Shard::variant(std::string const &name)
+        {
+            auto it = variants.find(name);
+            if(it != variants.end())
+            {
+                return it->second.get();
+            }
+            auto file = server.variantFile(name);
+            if(file.empty())
+            {
+                return nullptr;
+            }
+            try
+            {
+                auto &v = variants[name];
+                v.reset(new Variant(server.resourcesConfig(), name, file));
+                return v.get();
+            }
+            catch(std::exception &e)
+            {
+                variants.erase(name);
+                std::cerr << "Unable to load variant \"" << name << "\": " << e.what() << std::endl;
+                return nullptr;
+            }
+        }
+        Game *Shard::find(GameId game)
+        {
+            auto it = games.find(game);
+            return it == games.end() ? nullptr : it->second.get();
+        }
+        Game *Shard::awake(GameId g)
+        {
+            Game *game = find(g);
+            if(!game)
+            {
+                return nullptr;
+            }
+            try
+            {
+                game->board();
+            }
+            catch(std::exception &e)
+            {
+                //serving another position than the one players saw would be worse
+                std::cerr << e.what() << ", closing it" << std::endl;
+                for(auto const &w : game->watchers())
+                {
+                    reject(w, g, net::Reason::GameClosed);
+                }
+                engine_retry.erase(g);
+                games.erase(g);
+                return nullptr;
+            }
+            return game;
+        }
+
+        void Shard::create(ConnectionRef const &from, std::string const &name)
+        {
+            Variant *v = variant(name);
+            if(!v)
+            {
+                net::Buffer_t error;
+                net::FrameWriter(error, net::Message::Error).u8(static_cast<std::uint8_t>(net::Reason::UnknownVariant));
+                return deliver(from, error);
+            }
+            GameId id = next_game++ * server.shardCount() + index;
+            games.emplace(id, std::unique_ptr<Game>(new Game(id, *v)));
+            if(Journal *j = server.journal())
+            {
+                j->created(index, id, v->name);
+            }
+            net::Buffer_t reply;
+            net::FrameWriter(reply, net::Message::Created).u32(id);
+            deliver(from, reply);
+        }
+        void Shard::join(ConnectionRef const &from, GameId g, board::Board::Suit const &suit)
+        {
+            Game *game = find(g);
+            if(!game)
+            {
+                return reject(from, g, net::Reason::UnknownGame);
+            }
+            if(!suit.empty() && !game->sit(suit, from))
+            {
+                return reject(from, g, net::Reason::SeatTaken);
+            }
+            game->subscribe(from);
+            net::Buffer_t reply;
+            {
+                auto const &history = game->history();
+                net::FrameWriter(reply, net::Message::Joined).u32(g).str(game->turnSuit()).u32(static_cast<std::uint32_t>(history.size()));
+                for(std::size_t i = 0; i < history.size(); ++i)
+                {
+                    net::FrameWriter(reply, net::Message::Update).u32(g).u32(static_cast<std::uint32_t>(i + 1)).u32(history[i]);
+                }
+            }
+            deliver(from, reply);
+        }
+        void Shard::move(ConnectionRef const &from, GameId g, board::Move const &m, Game::Clock::time_point received)
+        {
+            Game *game = awake(g);
+            if(!game)
+            {
+                return reject(from, g, net::Reason::UnknownGame);
+            }
+            if(!game->seated(game->turnSuit(), from))
+            {
+                return reject(from, g, net::Reason::NotYourTurn);
+            }
+            if(!game->play(m, server.moveCache()))
+            {
+                return reject(from, g, net::Reason::IllegalMove);
+            }
+            {
+                net::Buffer_t ack;
+                net::FrameWriter(ack, net::Message::Accepted).u32(g).u32(static_cast<std::uint32_t>(game->history().size()));
+                deliver(from, ack);
+            }
+            move_times.record(microsecondsSince(received));
+            played(*game, m);
+        }
+        void Shard::engine(ConnectionRef const &from, GameId g, board::Board::Suit const &suit)
+        {
+            Game *game = awake(g);
+            if(!game)
+            {
+                return reject(from, g, net::Reason::UnknownGame);
+            }
+            if(!server.engine())
+            {
+                return reject(from, g, net::Reason::NoEngine);
+            }
+            if(!game->sit(suit, EngineSeat))
+            {
+                return reject(from, g, net::Reason::SeatTaken);
+            }
+            net::Buffer_t reply;
+            net::FrameWriter(reply, net::Message::Seated).u32(g).str(suit);
+            deliver(from, reply);
+            think(*game);
+        }
+        void Shard::played(Game &game, board::Move const &m)
+        {
+            if(Journal *j = server.journal())
+            {
+                j->moved(index, game.id, m.pack()); //the ack does not wait for it to reach the disk
+            }
+            auto start = Game::Clock::now();
+            net::Buffer_t update;
+            net::FrameWriter(update, net::Message::Update).u32(game.id).u32(static_cast<std::uint32_t>(game.history().size())).move(m);
+            for(auto const &w : game.watchers())
+            {
+                deliver(w, update);
+            }
+            broadcast_times.record(microsecondsSince(start));
+            think(game);
+        }
+        void Shard::think(Game &game)
+        {
+            ai::SearchService *service = server.engine();
+            if(!service || !game.seated(game.turnSuit(), EngineSeat))
+            {
+                return;
+            }
+            ai::SearchRequest request;
+            request.position = std::make_shared<board::Board const>(game.board()); //a snapshot, the game moves on
+            request.players = game.variant.players;
+            request.turn = game.turnSuit();
+            request.deadline = ai::SearchService::Clock::now() + server.engineTime();
+            request.depth = server.engineDepth();
+            if(request.players.size() > 2)
+            {
+                request.mode = server.engineMode();
+            }
+            GameId g = game.id;
+            std::size_t ply = game.history().size();
+            GameServer &srv = server;
+            request.done = [&srv, g, ply](ai::SearchResult const &result)
+            {
+                srv.shardOf(g).post([g, ply, result](Shard &s)
+                {
+                    s.engineMove(g, ply, result);
+                });
+            };
+            service->submit(std::move(request));
+        }
+        void Shard::engineMove(GameId g, std::size_t ply, ai::SearchResult const &result)
+        {
+            Game *game = awake(g);
+            //the game may have moved on, e.g. the seat was given up
+            if(!game || game->history().size() != ply || !game->seated(game->turnSuit(), EngineSeat))
+            {
+                return;
+            }
+            if(!result.found)
+            {
+                if(result.status == ai::SearchResult::Status::Rejected || result.status == ai::SearchResult::Status::Expired)
+                {
+                    engine_retry.insert(g); //the service is busy, back off
+                }
+                return; //otherwise there are no legal moves
+            }
+            board::Move m = result.best;
+            if(!game->play(m, server.moveCache()))
+            {
+                std::cerr << "Engine move " << m << " rejected in game " << g << std::endl;
+                return;
+            }
+            played(*game, m);
+        }
+        void Shard::reject(ConnectionRef const &to, GameId g, net::Reason why)
+        {
+            net::Buffer_t reply;
+            net::FrameWriter(reply, net::Message::Rejected).u32(g).u8(static_cast<std::uint8_t>(why));
+            deliver(to, reply);
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef ChessPlusPlus_Server_EventLoopShardClass_HeaderPlusPlus
+#define ChessPlusPlus_Server_EventLoopShardClass_HeaderPlusPlus
+
+#include "Game.hpp"
+#include "Journal.hpp"
+#include "net/Socket.hpp"
+#include "net/Protocol.hpp"
+#include "ai/SearchService.hpp"
+#include "util/Histogram.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace chesspp
+{
+    namespace server
+    {
+        class GameServer;
+
+        //One event-loop thread owning a subset of the games (those with id % shard count == index)
+        //and of the connections. Other threads only talk to it by posting tasks to its mailbox.
+        class Shard
+        {
+        public:
+            using Task = std::function<void (Shard &)>;
+
+            std::uint32_t const index;
+
+        private:
+            class Connection
+            {
+            public:
+                net::Socket socket;
+                net::Buffer_t in, out;
+                std::set<GameId> joined;
+                bool writing = false;
+                bool closed = false;
+
+                Connection(net::Socket s)
+                : socket{std::move(s)}
+                {
+                }
+            };
+
+            GameServer &server;
+            net::Socket poller, waker;
+            std::thread thread;
+            std::atomic<bool> running {false};
+
+            std::mutex mailbox_mutex;
+            std::vector<Task> mailbox;
+
+            std::map<std::string, std::unique_ptr<Variant>> variants;
+            std::unordered_map<GameId, std::unique_ptr<Game>> games;
+            GameId next_game = 0;
+            std::unordered_map<std::uint32_t, std::unique_ptr<Connection>> connections;
+            std::uint32_t next_connection = 0;
+            std::vector<std::uint32_t> closing;
+            std::set<GameId> engine_retry; //games the search service turned away, asked again on the next sweep
+            Game::Clock::time_point last_sweep;
+
+            util::Histogram move_times;      //microseconds from reading a move to queueing its ack
+            util::Histogram broadcast_times; //microseconds to queue an update for every watcher
+
+        public:
+            Shard(GameServer &server, std::uint32_t index) noexcept(false);
+            Shard(Shard const &) = delete;
+            Shard &operator=(Shard const &) = delete;
+            ~Shard();
+
+            void start();
+            //Stops the event loop and waits for the thread to finish
+            void stop();
+
+            //Runs a task on this shard's thread, callable from any thread
+            void post(Task t);
+            //Takes ownership of a freshly accepted socket, callable from any thread
+            void adopt(net::Socket s);
+            //Recreates a game from the journal, only before the shard is started
+            void restore(GameId game, std::string const &variant, Game::History_t const &moves);
+            //Writes every game to a journal segment, then counts down the shards still snapshotting
+            void snapshot(Journal::Segment_t segment, std::shared_ptr<std::atomic<std::uint32_t>> remaining);
+            //Sends frames to a connection owned by any shard
+            void deliver(ConnectionRef const &c, net::Buffer_t const &frames);
+
+            std::size_t gameCount() const noexcept
+            {
+                return games.size();
+            }
+            //Safe to read from any thread
+            util::Histogram const &moveTimes() const noexcept
+            {
+                return move_times;
+            }
+            util::Histogram const &broadcastTimes() const noexcept
+            {
+                return broadcast_times;
+            }
+
+        private:
+            void run();
+            void runMailbox();
+            void sweep();
+            void watch(int fd, std::uint64_t key, bool writable);
+
+            void accept();
+            void read(std::uint32_t id, Connection &c);
+            void flush(std::uint32_t id, Connection &c);
+            void send(std::uint32_t id, net::Buffer_t const &frames);
+            //Connections are only destroyed by reap(), after the current event is handled
+            void close(std::uint32_t id);
+            void reap();
+            bool onFrame(std::uint32_t id, Connection &c, net::Message type, net::FrameReader &r);
+
+            //Runs a task on the shard that owns a game
+            void route(GameId game, Task t);
+            Variant *variant(std::string const &name);
+            Game *find(GameId game);
+            //The game with its board replayed, nullptr if there is none or it no longer replays, which closes it
+            Game *awake(GameId game);
+
+            void create(ConnectionRef const &from, std::string const &variant);
+            void join(ConnectionRef const &from, GameId game, board::Board::Suit const &suit);
+            void move(ConnectionRef const &from, GameId game, board::Move const &m, Game::Clock::time_point received);
+            void engine(ConnectionRef const &from, GameId game, board::Board::Suit const &suit);
+            //Tells the watchers of a game about the move just played
+            void played(Game &game, board::Move const &m);
+            //Asks the search service for a move if the server holds the seat to move
+            void think(Game &game);
+            void engineMove(GameId game, std::size_t ply, ai::SearchResult const &result);
+            void reject(ConnectionRef const &to, GameId game, net::Reason why);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,291 @@
+#include "Checker.hpp"
+
+#include "piece/Piece.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace stress
+    {
+        namespace
+        {
+            using Position_t = board::Board::Position_t;
+
+            //Every movement as a move from the piece's position, sorted, so boards can be compared
+            board::Board::MoveList_t listed(board::Board::Movements const &m)
+            {
+                board::Board::MoveList_t moves;
+                for(auto const &e : m)
+                {
+                    moves.emplace_back((*e.first)->pos, e.second);
+                }
+                std::sort(moves.begin(), moves.end());
+                return moves;
+            }
+
+            std::string describe(board::Board::MoveList_t const &moves)
+            {
+                std::ostringstream os;
+                os << moves.size() << " {";
+                for(auto const &m : moves)
+                {
+                    os << " " << m;
+                }
+                os << " }";
+                return os.str();
+            }
+
+            //The moves in one list and not the other
+            std::string difference(board::Board::MoveList_t const &a, board::Board::MoveList_t const &b)
+            {
+                board::Board::MoveList_t only_a, only_b;
+                std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(only_a));
+                std::set_difference(b.begin(), b.end(), a.begin(), a.end(), std::back_inserter(only_b));
+                return "only in the first " + describe(only_a) + ", only in the second " + describe(only_b);
+            }
+        }
+
+        Checker::Checker(server::Variant const &v, board::MoveCache &c, std::size_t batch_size)
+        : variant(v) //can't use {}
+        , cache(c) //can't use {}
+        , attack_map{v.config}
+        , batch{v.config, batch_size}
+        {
+        }
+
+        void Checker::occupancy(board::Board const &b, std::string const &where, Failures_t &failures) const
+        {
+            std::size_t const w = b.config.boardWidth(), h = b.config.boardHeight();
+            std::size_t pieces = 0;
+            for(auto it = b.begin(); it != b.end(); ++it, ++pieces)
+            {
+                auto const &p = **it;
+                if(b.find(p.pos) != it || b.find(p) != it)
+                {
+                    std::ostringstream os;
+                    os << where << ": " << p << " is not found at its position";
+                    failures.push_back(os.str());
+                }
+            }
+            std::size_t seen = 0;
+            b.within(Position_t::Origin(), Position_t(static_cast<Position_t::value_type>(w - 1), static_cast<Position_t::value_type>(h - 1)), [&](piece::Piece const &p)
+            {
+                ++seen;
+                if(b.find(p.pos) == b.end() || b.find(p.pos)->get() != &p)
+                {
+                    std::ostringstream os;
+                    os << where << ": " << p << " is listed at another piece's position";
+                    failures.push_back(os.str());
+                }
+            });
+            if(seen != pieces)
+            {
+                failures.push_back(where + ": " + std::to_string(seen) + " occupied cells for " + std::to_string(pieces) + " pieces");
+            }
+
+            //the nearest blocker in every direction from every piece, against stepping cell by cell
+            for(auto const &p : b)
+            {
+                for(int d = static_cast<int>(util::Direction::North); d <= static_cast<int>(util::Direction::NorthWest); ++d)
+                {
+                    auto const dir = static_cast<util::Direction>(d);
+                    auto const step = util::Offset(dir);
+                    bool expected = false;
+                    Position_t expected_at;
+                    for(long x = long(p->pos.x) + step.first, y = long(p->pos.y) + step.second;
+                        x >= 0 && y >= 0 && std::size_t(x) < w && std::size_t(y) < h;
+                        x += step.first, y += step.second)
+                    {
+                        Position_t const cell {static_cast<Position_t::value_type>(x), static_cast<Position_t::value_type>(y)};
+                        if(b.occupied(cell))
+                        {
+                            expected = true;
+                            expected_at = cell;
+                            break;
+                        }
+                    }
+                    Position_t at;
+                    bool const found = b.nearestBlocker(p->pos, dir, at);
+                    if(found != expected || (found && at != expected_at))
+                    {
+                        std::ostringstream os;
+                        os << where << ": nearest blocker " << dir << " of " << p->pos << " is ";
+                        if(found) os << at; else os << "none";
+                        os << ", scanning finds ";
+                        if(expected) os << expected_at; else os << "none";
+                        failures.push_back(os.str());
+                    }
+                }
+            }
+        }
+
+        void Checker::regenerated(board::Board const &b, board::Board::Suit const &turn, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures) const
+        {
+            board::Board const fresh {b};
+            struct
+            {
+                char const *name;
+                board::Board::Movements const &kept, &anew;
+            } const movements[]
+            {
+                {"trajectories", b.pieceTrajectories(), fresh.pieceTrajectories()},
+                {"capturings",   b.pieceCapturings(),   fresh.pieceCapturings()  },
+                {"capturables",  b.pieceCapturables(),  fresh.pieceCapturables() },
+            };
+            for(auto const &m : movements)
+            {
+                auto const kept = listed(m.kept), anew = listed(m.anew);
+                if(kept != anew)
+                {
+                    failures.push_back(where + ": " + m.name + " kept move by move differ from worked out anew, " + difference(kept, anew));
+                }
+            }
+
+            //attack counts against counting the capturings
+            std::size_t const w = b.config.boardWidth(), h = b.config.boardHeight();
+            for(auto const &s : b.config.suits())
+            {
+                std::vector<std::size_t> counted(w*h, 0);
+                for(auto const &c : b.pieceCapturings())
+                {
+                    if((*c.first)->suit == s)
+                    {
+                        ++counted[c.second.y*w + c.second.x];
+                    }
+                }
+                board::Bitboard cells {w, h};
+                for(std::size_t y = 0; y < h; ++y)
+                {
+                    for(std::size_t x = 0; x < w; ++x)
+                    {
+                        Position_t const cell {static_cast<Position_t::value_type>(x), static_cast<Position_t::value_type>(y)};
+                        std::size_t const kept = b.attackers(s, cell);
+                        if(kept != counted[y*w + x] || fresh.attackers(s, cell) != kept)
+                        {
+                            std::ostringstream os;
+                            os << where << ": \"" << s << "\" has " << kept << " attackers at " << cell << ", "
+                               << counted[y*w + x] << " capturings there and " << fresh.attackers(s, cell) << " on a copy";
+                            failures.push_back(os.str());
+                        }
+                        if(counted[y*w + x])
+                        {
+                            cells.set(cell);
+                        }
+                    }
+                }
+                if(!(b.attacked(s) == cells))
+                {
+                    failures.push_back(where + ": attacked cells of \"" + s + "\" differ from its attack counts");
+                }
+            }
+
+            auto const again = fresh.legalMoves(turn);
+            if(again != legal)
+            {
+                failures.push_back(where + ": legal moves differ on a copy, " + difference(legal, again));
+            }
+        }
+
+        void Checker::hashes(board::Board const &b, std::string const &where, Failures_t &failures) const
+        {
+            for(std::size_t i = 0; i < b.symmetries().size(); ++i)
+            {
+                if(b.hash(i) != b.rehash(i))
+                {
+                    failures.push_back(where + ": hash " + std::to_string(i) + " kept move by move differs from hashing every piece");
+                }
+            }
+        }
+
+        void Checker::check(board::Board const &b, board::Board::Suit const &turn, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures)
+        {
+            occupancy(b, where, failures);
+            regenerated(b, turn, legal, where, failures);
+            hashes(b, where, failures);
+
+            attack_map.compute(b);
+            for(auto const &s : b.config.suits())
+            {
+                if(!(attack_map.of(s) == b.attacked(s)))
+                {
+                    failures.push_back(where + ": AttackMap cells of \"" + s + "\" differ from the board's");
+                }
+            }
+
+            auto const cached = cache.legalMoves(b, turn);
+            if(cached != legal)
+            {
+                failures.push_back(where + ": MoveCache moves differ, " + difference(legal, cached));
+            }
+
+            if(batch.add(b, turn))
+            {
+                Batched p;
+                p.where = where;
+                p.legal = legal;
+                for(auto const &s : b.config.suits())
+                {
+                    p.attacked.push_back(b.attacked(s));
+                }
+                batched.push_back(std::move(p));
+            }
+        }
+
+        void Checker::play(board::Board const &b, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures) const
+        {
+            for(auto const &m : legal)
+            {
+                board::Board copy {b};
+                auto const suit = (*copy.find(m.from))->suit;
+                std::ostringstream os;
+                os << where << ": legal move " << m;
+                if(!copy.moveTo(copy.find(m.from), m.to))
+                {
+                    failures.push_back(os.str() + " is refused by moveTo()");
+                }
+                else if(copy.occupied(m.from) || copy.find(m.to) == copy.end() || (*copy.find(m.to))->suit != suit)
+                {
+                    failures.push_back(os.str() + " does not leave the piece at its destination");
+                }
+            }
+        }
+
+        void Checker::flush(Failures_t &failures)
+        {
+            if(batched.empty())
+            {
+                return;
+            }
+            batch.generate(batch_moves);
+            for(std::size_t i = 0; i < batched.size(); ++i)
+            {
+                auto const &p = batched[i];
+                board::Board::MoveList_t generated;
+                for(std::size_t j = batch_moves.first[i]; j < batch_moves.first[i + 1]; ++j)
+                {
+                    generated.emplace_back(board::Move{batch_moves.moves[j]});
+                }
+                //moves the patterns leave out are not generated, but every one generated must be legal
+                if(!std::includes(p.legal.begin(), p.legal.end(), generated.begin(), generated.end()))
+                {
+                    failures.push_back(p.where + ": PositionBatch moves are not all legal, " + difference(generated, p.legal));
+                }
+                std::size_t s = 0;
+                for(auto const &suit : variant.config.suits())
+                {
+                    auto const *words = batch_moves.attacked(s, i);
+                    if(!std::equal(words, words + batch_moves.words, p.attacked[s].data()))
+                    {
+                        failures.push_back(p.where + ": PositionBatch cells attacked by \"" + suit + "\" differ from the board's");
+                    }
+                    ++s;
+                }
+            }
+            batch.clear();
+            batched.clear();
+        }
+    }
+}
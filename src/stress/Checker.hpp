@@ -0,0 +1,81 @@
+#ifndef ChessPlusPlus_Stress_BoardInvariantCheckerClass_HeaderPlusPlus
+#define ChessPlusPlus_Stress_BoardInvariantCheckerClass_HeaderPlusPlus
+
+#include "server/Game.hpp"
+#include "board/AttackMap.hpp"
+#include "board/Bitboard.hpp"
+#include "board/Board.hpp"
+#include "board/MoveCache.hpp"
+#include "board/PositionBatch.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace stress
+    {
+        /**
+         * Checks that what a Board keeps up to date move by move agrees with
+         * the same worked out again from scratch, and that the faster ways
+         * of finding moves and attacks agree with the board's own:
+         *
+         *  - occupancy: every piece is found at its position, nothing else
+         *    is, and nearest blockers match a cell by cell scan
+         *  - movements and attack counts: the same as a copy of the board,
+         *    which works out every piece's movements anew
+         *  - hashes: the same as hashing every piece again
+         *  - AttackMap and PositionBatch: the same attacked cells, and batch
+         *    moves are legal moves
+         *  - MoveCache: the same legal moves
+         *
+         * Positions for the batch are kept until flush(), so failures found
+         * by it come later than the others. Use one per thread; checkers may
+         * share a MoveCache.
+         */
+        class Checker
+        {
+        public:
+            using Failures_t = std::vector<std::string>;
+        private:
+            server::Variant const &variant;
+            board::MoveCache &cache;
+            board::AttackMap attack_map;
+            board::PositionBatch batch;
+            board::BatchMoves batch_moves;
+            //What the board said about a position in the batch
+            class Batched
+            {
+            public:
+                std::string where;
+                board::Board::MoveList_t legal;
+                std::vector<board::Bitboard> attacked; //by suit, in BoardConfig::suits() order
+            };
+            std::vector<Batched> batched;
+
+            void occupancy(board::Board const &b, std::string const &where, Failures_t &failures) const;
+            void regenerated(board::Board const &b, board::Board::Suit const &turn, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures) const;
+            void hashes(board::Board const &b, std::string const &where, Failures_t &failures) const;
+
+        public:
+            Checker(server::Variant const &v, board::MoveCache &c, std::size_t batch_size);
+
+            //Checks a position with the suit to move and the moves b.legalMoves(turn) gave,
+            //adding a line saying where and what for each thing that is wrong
+            void check(board::Board const &b, board::Board::Suit const &turn, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures);
+            //Plays each legal move on a copy of the board, checking that moveTo() takes it and
+            //that the piece ends up there
+            void play(board::Board const &b, board::Board::MoveList_t const &legal, std::string const &where, Failures_t &failures) const;
+            //Whether the batch is full, so positions checked before flush() are not batched
+            bool full() const noexcept
+            {
+                return batch.full();
+            }
+            //Generates the moves of the positions batched so far and checks them
+            void flush(Failures_t &failures);
+        };
+    }
+}
+
+#endif
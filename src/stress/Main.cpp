@@ -0,0 +1,89 @@
+#include "stress/Stress.hpp"
+#include "server/Game.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <typeinfo>
+
+//Plays random legal games on every core, checking the boards' invariants after every move, and times move generation.
+//Usage: chesspp-stress [--variant name]... [--variants dir] [--games n per variant] [--first n] [--duration seconds]
+//                      [--threads n] [--max-plies n] [--check-every plies] [--play-every plies] [--batch positions]
+//                      [--seed n] [--verbose]
+//To play one game again: --variant <name> --first <game> --games 1
+int main(int argc, char const *const *argv)
+{
+    std::vector<std::string> names;
+    std::string dir = "config/chesspp/";
+    chesspp::stress::Stress::Options options {1000, 0, std::chrono::seconds(0), 0, 300, 1, 16, 64, 1};
+    bool verbose = false, bad = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--variant"     && has_value) names.push_back(argv[++i]);
+        else if(arg == "--variants"    && has_value) dir                 = argv[++i];
+        else if(arg == "--games"       && has_value) options.games       = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--first"       && has_value) options.first       = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--duration"    && has_value) options.duration    = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--threads"     && has_value) options.threads     = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--max-plies"   && has_value) options.max_plies   = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--check-every" && has_value) options.check_every = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--play-every"  && has_value) options.play_every  = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--batch"       && has_value) options.batch       = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--seed"        && has_value) options.seed        = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--verbose")                  verbose             = true;
+        else bad = true;
+    }
+    if(bad || options.batch == 0 || (options.games == 0 && options.duration.count() == 0))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--variant name]... [--variants dir] [--games n per variant, 0 for no limit] [--first n]"
+                     " [--duration seconds] [--threads n] [--max-plies n] [--check-every plies] [--play-every plies]"
+                     " [--batch positions] [--seed n] [--verbose]" << std::endl;
+        return -1;
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    try
+    {
+        using namespace chesspp;
+        if(!dir.empty() && dir.back() != '/')
+        {
+            dir += '/';
+        }
+        if(names.empty())
+        {
+            names = stress::Stress::variantsIn(dir);
+            if(names.empty())
+            {
+                throw Exception("No variants in \"" + dir + "\"");
+            }
+        }
+        config::ResourcesConfig res;
+        std::vector<std::unique_ptr<server::Variant>> variants;
+        std::vector<server::Variant const *> playing;
+        for(auto const &name : names)
+        {
+            variants.emplace_back(new server::Variant{res, name, dir + name + ".json"});
+            playing.push_back(variants.back().get());
+        }
+        stress::Stress stress {playing, options};
+        bool const passed = stress.run(std::cout);
+        stress.report(std::cout);
+        return passed? 0 : 1;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,219 @@
+#include "Stress.hpp"
+
+#include "util/JsonReader.hpp"
+#include "piece/Piece.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace chesspp
+{
+    namespace stress
+    {
+        namespace
+        {
+            double perSecond(double n, double seconds) noexcept
+            {
+                return seconds > 0 ? n/seconds : 0.0;
+            }
+        }
+
+        Stress::Stress(std::vector<server::Variant const *> v, Options const &opts)
+        : variants{std::move(v)}
+        , options(opts) //can't use {}
+        {
+            for(std::size_t i = 0; i < variants.size(); ++i)
+            {
+                stats.emplace_back(new Stats);
+            }
+        }
+
+        std::vector<std::string> Stress::variantsIn(std::string const &dir)
+        {
+            std::vector<std::string> found;
+            boost::system::error_code ec;
+            for(boost::filesystem::directory_iterator it {dir, ec}, end; !ec && it != end; it.increment(ec))
+            {
+                if(it->path().extension() != ".json")
+                {
+                    continue;
+                }
+                try
+                {
+                    util::JsonReader reader {std::ifstream{it->path().string()}};
+                    if(reader()["board"]["suits"].type() == json_array)
+                    {
+                        found.push_back(it->path().stem().string());
+                    }
+                }
+                catch(Exception &)
+                {
+                    //not JSON, so not a variant
+                }
+            }
+            std::sort(found.begin(), found.end());
+            return found;
+        }
+
+        void Stress::fail(Checker::Failures_t const &failures, std::vector<board::Move> const *moves)
+        {
+            if(failures.empty())
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock {output};
+            for(auto const &f : failures)
+            {
+                *failures_out << "FAILED " << f << std::endl;
+            }
+            if(moves)
+            {
+                *failures_out << "  after";
+                for(auto const &m : *moves)
+                {
+                    *failures_out << " " << m.from << "->" << m.to;
+                }
+                *failures_out << std::endl;
+            }
+        }
+
+        void Stress::play(std::size_t variant, std::uint64_t game, Checker &checker)
+        {
+            auto const &v = *variants[variant];
+            auto &st = *stats[variant];
+            std::mt19937 rng {options.seed + static_cast<std::uint32_t>(game)};
+            board::Board b {v.config};
+            std::vector<board::Move> moves;
+            Checker::Failures_t failures;
+            auto turn = v.first_turn;
+            for(unsigned ply = 0; ply < options.max_plies; ++ply)
+            {
+                auto const &suit = v.players[turn];
+                auto const start = Clock::now();
+                auto const legal = b.legalMoves(suit);
+                st.generation.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+                st.generated += legal.size();
+
+                bool const check = options.check_every && ply % options.check_every == 0;
+                bool const play_all = options.play_every && ply % options.play_every == 0;
+                if(check || play_all)
+                {
+                    auto const checked = Clock::now();
+                    std::string const where = v.name + " game " + std::to_string(game) + " ply " + std::to_string(ply);
+                    if(check && checker.full())
+                    {
+                        Checker::Failures_t batched;
+                        checker.flush(batched);
+                        st.failed += batched.size();
+                        fail(batched, nullptr);
+                    }
+                    if(check)
+                    {
+                        checker.check(b, suit, legal, where, failures);
+                    }
+                    if(play_all)
+                    {
+                        checker.play(b, legal, where, failures);
+                    }
+                    st.checking.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - checked).count()));
+                }
+                if(failures.empty() && !legal.empty())
+                {
+                    auto const m = legal[std::uniform_int_distribution<std::size_t>{0, legal.size() - 1}(rng)];
+                    if(!b.moveTo(b.find(m.from), m.to))
+                    {
+                        std::ostringstream os;
+                        os << v.name << " game " << game << " ply " << ply << ": legal move " << m << " is refused by moveTo()";
+                        failures.push_back(os.str());
+                    }
+                    moves.push_back(m);
+                }
+                if(!failures.empty() || legal.empty())
+                {
+                    break;
+                }
+                ++st.plies;
+                turn = (turn + 1) % v.players.size();
+            }
+            ++st.games;
+            if(!failures.empty())
+            {
+                st.failed += failures.size();
+                fail(failures, &moves);
+            }
+        }
+
+        bool Stress::run(std::ostream &failures)
+        {
+            failures_out = &failures;
+            auto const started = Clock::now();
+            auto const deadline = options.duration.count()? started + options.duration : Clock::time_point::max();
+            auto work = [&]
+            {
+                std::vector<std::unique_ptr<Checker>> checkers(variants.size());
+                for(std::uint64_t j; Clock::now() < deadline && (j = next++, !options.games || j/variants.size() < options.games);)
+                {
+                    std::size_t const variant = static_cast<std::size_t>(j%variants.size());
+                    auto &checker = checkers[variant];
+                    if(!checker)
+                    {
+                        checker.reset(new Checker{*variants[variant], cache, options.batch});
+                    }
+                    play(variant, options.first + j/variants.size(), *checker);
+                }
+                for(std::size_t i = 0; i < checkers.size(); ++i)
+                {
+                    if(checkers[i])
+                    {
+                        Checker::Failures_t batched;
+                        checkers[i]->flush(batched);
+                        stats[i]->failed += batched.size();
+                        fail(batched, nullptr);
+                    }
+                }
+            };
+            unsigned const threads = options.threads? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            std::vector<std::thread> pool;
+            for(unsigned i = 1; i < threads; ++i)
+            {
+                pool.emplace_back(work);
+            }
+            work();
+            for(auto &t : pool)
+            {
+                t.join();
+            }
+            elapsed = Clock::now() - started;
+            return std::all_of(stats.begin(), stats.end(), [](std::unique_ptr<Stats> const &s)
+            {
+                return s->failed == 0;
+            });
+        }
+
+        void Stress::report(std::ostream &os) const
+        {
+            double const seconds = std::chrono::duration<double>(elapsed).count();
+            for(std::size_t i = 0; i < variants.size(); ++i)
+            {
+                auto const &st = *stats[i];
+                double const generating = st.generation.mean()*st.generation.count()/1e9;
+                os << std::fixed << std::setprecision(1)
+                   << variants[i]->name << ": " << st.games << " games, " << st.plies << " plies, " << st.failed << " failures ("
+                   << perSecond(3600.0*st.games, seconds) << " games/hour, " << perSecond(st.plies, seconds) << " plies/s)" << std::endl
+                   << "  legalMoves(): " << st.generation.count() << " calls, " << st.generated << " moves ("
+                   << perSecond(st.generation.count(), generating) << " calls/s, " << perSecond(st.generated, generating) << " moves/s while generating), ";
+                st.generation.report(os, "ns");
+                os << std::endl << "  checks: ";
+                st.checking.report(os, "us");
+                os << std::endl;
+            }
+            os << std::fixed << std::setprecision(1) << seconds << "s in all, move cache " << cache.hits() << " hits, " << cache.misses() << " misses" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef ChessPlusPlus_Stress_RandomGameStressClass_HeaderPlusPlus
+#define ChessPlusPlus_Stress_RandomGameStressClass_HeaderPlusPlus
+
+#include "stress/Checker.hpp"
+#include "server/Game.hpp"
+#include "board/Move.hpp"
+#include "board/MoveCache.hpp"
+#include "util/Histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace stress
+    {
+        /**
+         * Plays random legal games of several variants on every core,
+         * checking the board with a Checker as it goes, and times move
+         * generation. A game ends when the suit to move has no moves, when
+         * it gets too long or at the first failure, which is written out
+         * with the moves that led to it.
+         *
+         * Games are numbered per variant and each is played from its own
+         * seed, so any game can be played again on its own.
+         */
+        class Stress
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                std::uint64_t games;           //per variant, 0 for no limit
+                std::uint64_t first;           //number of the first game of each variant
+                std::chrono::seconds duration; //stop after this long, 0 for no limit
+                unsigned threads;              //0 for one per core
+                unsigned max_plies;
+                unsigned check_every;          //plies between checks, 0 for none
+                unsigned play_every;           //plies between playing every legal move on a copy, 0 for never
+                std::size_t batch;             //positions per PositionBatch
+                std::uint32_t seed;
+            };
+            class Stats
+            {
+            public:
+                std::atomic<std::uint64_t> games {0}, plies {0}, generated {0};
+                std::atomic<std::uint64_t> failed {0}; //things found wrong
+                util::Histogram generation; //ns per legalMoves()
+                util::Histogram checking;   //us per check
+            };
+
+        private:
+            std::vector<server::Variant const *> variants;
+            Options const options;
+            std::vector<std::unique_ptr<Stats>> stats; //by variant
+            board::MoveCache cache;
+            std::atomic<std::uint64_t> next {0};
+            std::mutex output;
+            std::ostream *failures_out = nullptr;
+            Clock::duration elapsed {};
+
+            void play(std::size_t variant, std::uint64_t game, Checker &checker);
+            void fail(Checker::Failures_t const &failures, std::vector<board::Move> const *moves);
+
+        public:
+            Stress(std::vector<server::Variant const *> v, Options const &opts);
+
+            //The names of the variants in a directory: its .json files with a board layout
+            static std::vector<std::string> variantsIn(std::string const &dir);
+
+            //Plays until the games run out or the time is up, writing every failure to
+            //failures. Returns whether there were none.
+            bool run(std::ostream &failures);
+
+            //Games per hour, move generation throughput and latency, and checking time per variant
+            void report(std::ostream &os) const;
+        };
+    }
+}
+
+#endif
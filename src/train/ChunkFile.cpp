@@ -0,0 +1,235 @@
+#include "ChunkFile.hpp"
+
+#include "Exception.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace chesspp
+{
+    namespace train
+    {
+        constexpr std::size_t ChunkHeader::HeaderSize;
+        constexpr std::uint32_t ChunkHeader::Version;
+
+        namespace
+        {
+            char const Magic[8] = {'C', 'P', 'P', 'T', 'R', 'A', 'I', 'N'};
+
+            void putLE(std::uint8_t *&out, std::uint64_t v, unsigned bytes) noexcept
+            {
+                for(unsigned i = 0; i < bytes; ++i)
+                {
+                    *out++ = static_cast<std::uint8_t>(v >> (i*8));
+                }
+            }
+            std::uint64_t getLE(std::uint8_t const *&in, unsigned bytes) noexcept
+            {
+                std::uint64_t v = 0;
+                for(unsigned i = 0; i < bytes; ++i)
+                {
+                    v |= static_cast<std::uint64_t>(*in++) << (i*8);
+                }
+                return v;
+            }
+            //Writes all of it, retrying short writes
+            bool writeAll(int fd, std::uint8_t const *data, std::size_t size) noexcept
+            {
+                while(size)
+                {
+                    ssize_t n = ::write(fd, data, size);
+                    if(n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if(n <= 0)
+                    {
+                        return false;
+                    }
+                    data += n;
+                    size -= static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+        }
+
+        void ChunkHeader::write(Layout const &l, std::uint64_t count, std::uint8_t *out) noexcept
+        {
+            std::uint8_t *const end = out + HeaderSize;
+            std::memset(out, 0, HeaderSize);
+            std::memcpy(out, Magic, sizeof(Magic));
+            out += sizeof(Magic);
+            putLE(out, Version, 4);
+            putLE(out, l.recordSize(), 4);
+            putLE(out, l.fingerprint, 8);
+            putLE(out, count, 8);
+            putLE(out, l.width, 1);
+            putLE(out, l.height, 1);
+            putLE(out, l.suits.size(), 1);
+            putLE(out, l.classes.size(), 1);
+            putLE(out, l.max_pieces, 2);
+            for(auto const *names : {&l.suits, &l.classes})
+            {
+                for(auto const &name : *names)
+                {
+                    //names are cut short rather than run off the page
+                    std::size_t const room = static_cast<std::size_t>(end - out);
+                    if(room == 0)
+                    {
+                        return;
+                    }
+                    std::size_t const length = std::min<std::size_t>({name.size(), 0xFF, room - 1});
+                    *out++ = static_cast<std::uint8_t>(length);
+                    std::memcpy(out, name.data(), length);
+                    out += length;
+                }
+            }
+        }
+
+        Layout ChunkHeader::read(std::uint8_t const *in, std::size_t size, std::uint64_t &count) noexcept(false)
+        {
+            if(size < HeaderSize || std::memcmp(in, Magic, sizeof(Magic)) != 0)
+            {
+                throw Exception("Not a packed position chunk");
+            }
+            std::uint8_t const *const end = in + HeaderSize;
+            in += sizeof(Magic);
+            if(getLE(in, 4) != Version)
+            {
+                throw Exception("Packed position chunk of an unknown version");
+            }
+            std::size_t const record_size = static_cast<std::size_t>(getLE(in, 4));
+            std::uint64_t const fingerprint = getLE(in, 8);
+            count = getLE(in, 8);
+            std::size_t const width = static_cast<std::size_t>(getLE(in, 1));
+            std::size_t const height = static_cast<std::size_t>(getLE(in, 1));
+            std::vector<Layout::Suit_t> suits(static_cast<std::size_t>(getLE(in, 1)));
+            std::vector<Layout::Class_t> classes(static_cast<std::size_t>(getLE(in, 1)));
+            std::size_t const max_pieces = static_cast<std::size_t>(getLE(in, 2));
+            for(auto *names : {&suits, &classes})
+            {
+                for(auto &name : *names)
+                {
+                    std::size_t const length = in < end ? *in++ : 0;
+                    if(end - in < static_cast<std::ptrdiff_t>(length))
+                    {
+                        throw Exception("Damaged packed position chunk header");
+                    }
+                    name.assign(reinterpret_cast<char const *>(in), length);
+                    in += length;
+                }
+            }
+            Layout l {fingerprint, width, height, std::move(suits), std::move(classes), max_pieces};
+            if(l.recordSize() != record_size)
+            {
+                throw Exception("Damaged packed position chunk header");
+            }
+            return l;
+        }
+
+        ChunkWriter::ChunkWriter(std::string const &dir_, Layout const &l, std::uint64_t positions_per_chunk, std::size_t buffer_bytes) noexcept(false)
+        : dir{dir_.empty() || dir_.back() == '/' ? dir_ : dir_ + "/"}
+        , layout(l) //can't use {}
+        , per_chunk{std::max<std::uint64_t>(positions_per_chunk, 1)}
+        , buffer(std::max(buffer_bytes/l.recordSize(), std::size_t(1))*l.recordSize())
+        {
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(dir, ec);
+            if(ec)
+            {
+                throw Exception("Unable to create \"" + dir + "\": " + ec.message());
+            }
+        }
+        ChunkWriter::~ChunkWriter()
+        {
+            try
+            {
+                close();
+            }
+            catch(std::exception &)
+            {
+            }
+        }
+
+        std::string ChunkWriter::fileName(std::uint64_t chunk)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "chunk-%06llu.bin", static_cast<unsigned long long>(chunk));
+            return name;
+        }
+
+        void ChunkWriter::open()
+        {
+            std::string const path = dir + fileName(chunk);
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            std::uint8_t header[ChunkHeader::HeaderSize];
+            ChunkHeader::write(layout, 0, header);
+            if(fd == -1 || !writeAll(fd, header, sizeof(header)))
+            {
+                throw Exception("Unable to write \"" + path + "\": " + std::strerror(errno));
+            }
+            bytes += sizeof(header);
+            in_chunk = 0;
+        }
+
+        void ChunkWriter::flush()
+        {
+            if(buffered && !writeAll(fd, buffer.data(), buffered))
+            {
+                throw Exception("Unable to write \"" + dir + fileName(chunk) + "\": " + std::strerror(errno));
+            }
+            bytes += buffered;
+            buffered = 0;
+        }
+
+        void ChunkWriter::finish()
+        {
+            flush();
+            std::uint8_t header[ChunkHeader::HeaderSize];
+            ChunkHeader::write(layout, in_chunk, header);
+            bool const ok = ::pwrite(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+            ::close(fd);
+            fd = -1;
+            ++chunk;
+            if(!ok)
+            {
+                throw Exception("Unable to finish \"" + dir + fileName(chunk - 1) + "\": " + std::strerror(errno));
+            }
+        }
+
+        void ChunkWriter::append(std::uint8_t const *record)
+        {
+            if(fd == -1)
+            {
+                open();
+            }
+            std::size_t const size = layout.recordSize();
+            if(buffered + size > buffer.size())
+            {
+                flush();
+            }
+            std::memcpy(buffer.data() + buffered, record, size);
+            buffered += size;
+            ++total;
+            if(++in_chunk == per_chunk)
+            {
+                finish();
+            }
+        }
+
+        void ChunkWriter::close()
+        {
+            if(fd != -1)
+            {
+                finish();
+            }
+        }
+    }
+}
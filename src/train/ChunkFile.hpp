@@ -0,0 +1,93 @@
+#ifndef ChessPlusPlus_Train_PositionChunkFiles_HeaderPlusPlus
+#define ChessPlusPlus_Train_PositionChunkFiles_HeaderPlusPlus
+
+#include "PackedPosition.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace train
+    {
+        /**
+         * The start of a chunk file: a page describing the Layout of the
+         * packed positions after it, so the file can be read without the
+         * board config. Records start at HeaderSize, which keeps them page
+         * aligned for memory mapping.
+         *
+         * "CPPTRAIN", u32 version, u32 record size, u64 layout fingerprint,
+         * u64 record count, u8 width, u8 height, u8 suits, u8 classes,
+         * u16 max pieces, then the suit and class names, each a u8 length
+         * and its characters.
+         */
+        class ChunkHeader
+        {
+        public:
+            static constexpr std::size_t HeaderSize = 4096;
+            static constexpr std::uint32_t Version = 1;
+
+            static void write(Layout const &l, std::uint64_t count, std::uint8_t *out) noexcept;
+            //Reads a header, throws ::chesspp::Exception if it is not one or is of another version
+            static Layout read(std::uint8_t const *in, std::size_t size, std::uint64_t &count) noexcept(false);
+        };
+
+        /**
+         * Appends packed positions to numbered chunk files in a directory,
+         * chunk-000000.bin and on, starting the next file once one holds
+         * positions_per_chunk. Records are gathered in a large buffer and
+         * written with one system call when it fills, so the disk sees big
+         * sequential writes. The record count in a file's header is filled
+         * in when the file is finished.
+         *
+         * Not thread-safe; one pipeline stage owns it.
+         */
+        class ChunkWriter
+        {
+            std::string const dir;
+            Layout const layout;
+            std::uint64_t const per_chunk;
+            std::vector<std::uint8_t> buffer;
+            std::size_t buffered = 0;
+            int fd = -1;
+            std::uint64_t chunk = 0, in_chunk = 0, total = 0, bytes = 0;
+
+            void open();
+            void flush();
+            void finish();
+
+        public:
+            //Throws ::chesspp::Exception if the directory can't be created or a file can't be written
+            ChunkWriter(std::string const &dir, Layout const &l, std::uint64_t positions_per_chunk, std::size_t buffer_bytes = 4 << 20) noexcept(false);
+            ~ChunkWriter();
+            ChunkWriter(ChunkWriter const &) = delete;
+            ChunkWriter &operator=(ChunkWriter const &) = delete;
+
+            //Takes layout.recordSize() bytes
+            void append(std::uint8_t const *record);
+            //Writes out the buffer and finishes the current file
+            void close();
+
+            std::uint64_t positions() const noexcept
+            {
+                return total;
+            }
+            std::uint64_t bytesWritten() const noexcept
+            {
+                return bytes;
+            }
+            std::uint64_t files() const noexcept
+            {
+                return chunk + (fd != -1);
+            }
+
+            //Name of a chunk file within its directory
+            static std::string fileName(std::uint64_t chunk);
+        };
+    }
+}
+
+#endif
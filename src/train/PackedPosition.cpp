@@ -0,0 +1,103 @@
+#include "PackedPosition.hpp"
+
+#include "piece/Piece.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <set>
+#include <utility>
+
+namespace chesspp
+{
+    namespace train
+    {
+        constexpr std::uint8_t Layout::NoWinner;
+        constexpr std::size_t Layout::FixedBytes;
+
+        namespace
+        {
+            std::vector<Layout::Class_t> classesOf(config::BoardConfig const &conf)
+            {
+                std::set<Layout::Class_t> classes;
+                for(auto const &p : conf.initialLayout())
+                {
+                    classes.insert(p.second.first);
+                }
+                return {classes.begin(), classes.end()};
+            }
+        }
+
+        Layout::Layout(config::BoardConfig const &conf) noexcept(false)
+        : Layout{conf.fingerprint(), conf.boardWidth(), conf.boardHeight(), {conf.suits().begin(), conf.suits().end()}, classesOf(conf), conf.initialLayout().size()}
+        {
+        }
+        Layout::Layout(std::uint64_t fingerprint_, std::size_t width_, std::size_t height_, std::vector<Suit_t> suits_, std::vector<Class_t> classes_, std::size_t max_pieces_) noexcept(false)
+        : fingerprint{fingerprint_}
+        , width{width_}
+        , height{height_}
+        , suits(std::move(suits_))     //can't use {}
+        , classes(std::move(classes_)) //can't use {}
+        , max_pieces{max_pieces_}
+        {
+            if(suits.size() > 16 || classes.size() > 16)
+            {
+                throw Exception("Packed positions hold at most 16 suits and 16 piece classes");
+            }
+            if(max_pieces > 0xFF)
+            {
+                throw Exception("Packed positions hold at most 255 pieces");
+            }
+        }
+
+        std::size_t Layout::suitIndex(Suit_t const &s) const noexcept
+        {
+            return static_cast<std::size_t>(std::find(suits.begin(), suits.end(), s) - suits.begin());
+        }
+        std::size_t Layout::classIndex(Class_t const &c) const noexcept
+        {
+            auto it = std::lower_bound(classes.begin(), classes.end(), c);
+            return it != classes.end() && *it == c ? static_cast<std::size_t>(it - classes.begin()) : classes.size();
+        }
+
+        bool Layout::pack(board::Board const &b, Suit_t const &turn, Score_t score, std::uint8_t result, std::uint8_t *out) const noexcept
+        {
+            std::size_t const t = suitIndex(turn);
+            if(b.config.boardWidth() != width || b.config.boardHeight() != height || t == suits.size())
+            {
+                return false;
+            }
+            std::memset(out, 0, recordSize());
+            auto const s = static_cast<std::uint32_t>(score);
+            out[0] = static_cast<std::uint8_t>(s);
+            out[1] = static_cast<std::uint8_t>(s >> 8);
+            out[2] = static_cast<std::uint8_t>(s >> 16);
+            out[3] = static_cast<std::uint8_t>(s >> 24);
+            out[4] = static_cast<std::uint8_t>(t);
+            out[5] = result;
+
+            //codes go in cell order, which the pieces are not kept in
+            std::array<std::pair<std::uint32_t, std::uint8_t>, 0xFF> codes;
+            std::size_t count = 0;
+            for(auto const &p : b)
+            {
+                std::size_t const suit = suitIndex(p->suit), pclass = classIndex(p->pclass);
+                if(suit == suits.size() || pclass == classes.size() || count == max_pieces)
+                {
+                    return false;
+                }
+                codes[count++] = std::make_pair(static_cast<std::uint32_t>(p->pos.y*width + p->pos.x), static_cast<std::uint8_t>(suit << 4 | pclass));
+            }
+            std::sort(codes.begin(), codes.begin() + count);
+            out[6] = static_cast<std::uint8_t>(count);
+            std::uint8_t *occupancy = out + FixedBytes, *code = occupancy + occupancyBytes();
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                occupancy[codes[i].first/8] |= static_cast<std::uint8_t>(1u << (codes[i].first%8));
+                code[i] = codes[i].second;
+            }
+            return true;
+        }
+    }
+}
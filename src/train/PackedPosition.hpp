@@ -0,0 +1,125 @@
+#ifndef ChessPlusPlus_Train_PackedPositionFormat_HeaderPlusPlus
+#define ChessPlusPlus_Train_PackedPositionFormat_HeaderPlusPlus
+
+#include "config/BoardConfig.hpp"
+#include "board/Board.hpp"
+#include "util/Bits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace train
+    {
+        /**
+         * How the positions of one board layout are packed into records of a
+         * fixed size, so a file of them can be indexed and shuffled without
+         * reading it through. Each record, little-endian, is:
+         *
+         *  - i32 score, for the suit to move, in hundredths of a pawn
+         *  - u8 suit to move
+         *  - u8 result: the winning suit, or NoWinner
+         *  - u8 number of pieces
+         *  - u8 unused, 0
+         *  - occupancy bits, one per cell from (0, 0) along each row
+         *  - one byte per occupied cell, in the order of the bits:
+         *    suit index in the high four bits, piece class in the low four
+         *  - zeros up to the record size, a multiple of 8
+         *
+         * Suits are numbered in BoardConfig::suits() order and piece classes
+         * in sorted order of the classes in the initial layout.
+         */
+        class Layout
+        {
+        public:
+            using Suit_t = config::BoardConfig::SuitClass_t;
+            using Class_t = config::BoardConfig::PieceClass_t;
+            using Score_t = std::int32_t;
+            static constexpr std::uint8_t NoWinner = 0xFF;
+            static constexpr std::size_t FixedBytes = 8;
+
+            std::uint64_t fingerprint;
+            std::size_t width, height;
+            std::vector<Suit_t> suits;
+            std::vector<Class_t> classes;
+            std::size_t max_pieces; //pieces in the initial layout; there are never more
+
+            //Throws ::chesspp::Exception if there are more than 16 suits or piece classes, or 255 pieces
+            Layout(config::BoardConfig const &conf) noexcept(false);
+            Layout(std::uint64_t fingerprint, std::size_t width, std::size_t height, std::vector<Suit_t> suits, std::vector<Class_t> classes, std::size_t max_pieces) noexcept(false);
+
+            std::size_t cells() const noexcept
+            {
+                return width*height;
+            }
+            std::size_t occupancyBytes() const noexcept
+            {
+                return (cells() + 7)/8;
+            }
+            std::size_t recordSize() const noexcept
+            {
+                return (FixedBytes + occupancyBytes() + max_pieces + 7)/8*8;
+            }
+            //Index of a suit or class, or their count if unknown
+            std::size_t suitIndex(Suit_t const &s) const noexcept;
+            std::size_t classIndex(Class_t const &c) const noexcept;
+
+            //Writes recordSize() bytes, false if the board has a piece this layout doesn't know
+            bool pack(board::Board const &b, Suit_t const &turn, Score_t score, std::uint8_t result, std::uint8_t *out) const noexcept;
+        };
+
+        //Reads one record of a Layout
+        class PackedPosition
+        {
+            std::uint8_t const *p;
+            Layout const &layout;
+
+        public:
+            PackedPosition(std::uint8_t const *record, Layout const &l) noexcept
+            : p{record}
+            , layout(l) //can't use {}
+            {
+            }
+
+            Layout::Score_t score() const noexcept
+            {
+                return static_cast<Layout::Score_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24));
+            }
+            std::uint8_t turn() const noexcept
+            {
+                return p[4];
+            }
+            std::uint8_t result() const noexcept
+            {
+                return p[5];
+            }
+            std::size_t pieces() const noexcept
+            {
+                return p[6];
+            }
+
+            //Calls f(cell, suit, class) for each piece, cell being y*width + x
+            template<typename Func>
+            void forEachPiece(Func f) const
+            {
+                std::uint8_t const *occupancy = p + Layout::FixedBytes;
+                std::uint8_t const *codes = occupancy + layout.occupancyBytes();
+                std::size_t const bytes = layout.occupancyBytes();
+                for(std::size_t i = 0; i < bytes; ++i)
+                {
+                    for(unsigned bits = occupancy[i]; bits; bits &= bits - 1)
+                    {
+                        unsigned const bit = util::lowestBit(bits);
+                        f(i*8 + bit, static_cast<std::size_t>(*codes >> 4), static_cast<std::size_t>(*codes & 0xF));
+                        ++codes;
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif
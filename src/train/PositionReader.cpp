@@ -0,0 +1,337 @@
+#include "PositionReader.hpp"
+
+#include "ChunkFile.hpp"
+#include "Exception.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+
+namespace chesspp
+{
+    namespace train
+    {
+        //A chunk file mapped into memory
+        class PositionReader::Mapped
+        {
+        public:
+            std::uint8_t const *data = nullptr;
+            std::size_t size = 0;
+            std::uint64_t count = 0;
+            std::unique_ptr<Layout> layout;
+
+            Mapped(std::string const &path) noexcept(false)
+            {
+                int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat st;
+                if(fd == -1 || ::fstat(fd, &st) != 0)
+                {
+                    if(fd != -1)
+                    {
+                        ::close(fd);
+                    }
+                    throw Exception("Unable to open \"" + path + "\": " + std::strerror(errno));
+                }
+                size = static_cast<std::size_t>(st.st_size);
+                void *mem = size? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+                ::close(fd);
+                if(mem == MAP_FAILED)
+                {
+                    throw Exception("Unable to map \"" + path + "\": " + std::strerror(errno));
+                }
+                data = static_cast<std::uint8_t const *>(mem);
+                try
+                {
+                    layout.reset(new Layout(ChunkHeader::read(data, size, count)));
+                }
+                catch(...)
+                {
+                    ::munmap(mem, size);
+                    throw;
+                }
+                //a file whose writer stopped early has a count of 0 but whole records up to its end
+                std::uint64_t const whole = (size - ChunkHeader::HeaderSize)/layout->recordSize();
+                count = count? std::min(count, whole) : whole;
+            }
+            ~Mapped()
+            {
+                ::munmap(const_cast<std::uint8_t *>(data), size);
+            }
+            Mapped(Mapped const &) = delete;
+            Mapped &operator=(Mapped const &) = delete;
+
+            std::uint8_t const *record(std::uint64_t i) const noexcept
+            {
+                return data + ChunkHeader::HeaderSize + i*layout->recordSize();
+            }
+            //Asks the kernel to start reading records now
+            void willNeed(std::uint64_t first, std::uint64_t n) const noexcept
+            {
+                std::uintptr_t const page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+                std::uintptr_t const begin = reinterpret_cast<std::uintptr_t>(record(first)) & ~(page - 1);
+                std::uintptr_t const end = reinterpret_cast<std::uintptr_t>(record(first + n));
+                ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED);
+            }
+        };
+
+        namespace
+        {
+            //Spreads the bits of a seed so nearby seeds give unrelated values
+            std::uint64_t mix(std::uint64_t x) noexcept
+            {
+                x ^= x >> 30;
+                x *= 0xBF58476D1CE4E5B9ULL;
+                x ^= x >> 27;
+                x *= 0x94D049BB133111EBULL;
+                return x ^ (x >> 31);
+            }
+            std::uint64_t gcd(std::uint64_t a, std::uint64_t b) noexcept
+            {
+                while(b)
+                {
+                    a %= b;
+                    std::swap(a, b);
+                }
+                return a;
+            }
+            //A shuffled order of n records without storing it: i -> (i*step + offset) mod n
+            //visits each once when step and n share no factor
+            class Permutation
+            {
+                std::uint64_t n, step, offset;
+
+            public:
+                Permutation(std::uint64_t n_, std::uint64_t seed) noexcept
+                : n{n_}
+                , step{n_ > 1 ? mix(seed) % n_ : 1}
+                , offset{n_ ? mix(seed + 1) % n_ : 0}
+                {
+                    while(n > 1 && (step == 0 || gcd(step, n) != 1))
+                    {
+                        step = (step + 1) % n;
+                    }
+                }
+                std::uint64_t operator()(std::uint64_t i) const noexcept
+                {
+                    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(i)*step + offset) % n);
+                }
+            };
+        }
+
+        PositionReader::PositionReader(std::vector<std::string> const &paths, Options const &opts) noexcept(false)
+        : options(opts) //can't use {}
+        {
+            for(auto const &path : paths)
+            {
+                files.emplace_back(new Mapped{path});
+                auto const &l = *files.back()->layout;
+                if(!layout_)
+                {
+                    layout_.reset(new Layout(l));
+                }
+                else if(l.fingerprint != layout_->fingerprint || l.recordSize() != layout_->recordSize())
+                {
+                    throw Exception("\"" + path + "\" holds positions of another layout");
+                }
+                total += files.back()->count;
+            }
+            if(!layout_)
+            {
+                throw Exception("No packed position files to read");
+            }
+        }
+        PositionReader::~PositionReader()
+        {
+            stop();
+        }
+
+        std::vector<std::string> PositionReader::filesIn(std::string const &dir)
+        {
+            std::vector<std::string> found;
+            boost::system::error_code ec;
+            for(boost::filesystem::directory_iterator it {dir, ec}, end; !ec && it != end; it.increment(ec))
+            {
+                auto name = it->path().filename().string();
+                if(name.compare(0, 6, "chunk-") == 0 && it->path().extension() == ".bin")
+                {
+                    found.push_back(it->path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            return found;
+        }
+
+        std::uint64_t PositionReader::bytes() const noexcept
+        {
+            std::uint64_t sum = 0;
+            for(auto const &f : files)
+            {
+                sum += f->size;
+            }
+            return sum;
+        }
+
+        void PositionReader::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                stopping = true;
+            }
+            wake.notify_all();
+            for(auto &w : workers)
+            {
+                w.join();
+            }
+            workers.clear();
+        }
+
+        void PositionReader::start(std::uint32_t epoch)
+        {
+            stop();
+
+            blocks.clear();
+            std::size_t const per_block = std::max<std::size_t>(options.block_positions, 1);
+            for(std::size_t f = 0; f < files.size(); ++f)
+            {
+                for(std::uint64_t first = 0; first < files[f]->count; first += per_block)
+                {
+                    blocks.push_back(Block{f, first, std::min<std::uint64_t>(per_block, files[f]->count - first)});
+                }
+            }
+            epoch_seed = static_cast<std::uint32_t>(mix(options.seed ^ (static_cast<std::uint64_t>(epoch) << 32)));
+            std::shuffle(blocks.begin(), blocks.end(), std::mt19937{epoch_seed});
+            starts.resize(blocks.size());
+            std::uint64_t at = 0;
+            for(std::size_t i = 0; i < blocks.size(); ++i)
+            {
+                starts[i] = at;
+                at += blocks[i].count;
+            }
+
+            std::size_t const batch_size = std::max<std::size_t>(options.batch_size, 1);
+            std::size_t const prefetch = std::max<std::size_t>(options.prefetch, 1);
+            batches = static_cast<std::size_t>((total + batch_size - 1)/batch_size);
+            claimed = consumed = 0;
+            holding = false;
+            stopping = false;
+            slots.resize(prefetch);
+            for(auto &s : slots)
+            {
+                s.ready = false;
+            }
+            unsigned const threads = options.threads? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            for(unsigned i = 0; i < threads; ++i)
+            {
+                workers.emplace_back(&PositionReader::work, this);
+            }
+        }
+
+        void PositionReader::work()
+        {
+            std::size_t const prefetch = slots.size();
+            std::unique_lock<std::mutex> lock {mutex};
+            for(;;)
+            {
+                wake.wait(lock, [&]
+                {
+                    return stopping || claimed == batches || claimed < consumed + prefetch;
+                });
+                if(stopping || claimed == batches)
+                {
+                    return;
+                }
+                std::size_t const number = claimed++;
+                Slot &s = slots[number % prefetch];
+                s.number = number;
+                s.ready = false;
+                lock.unlock();
+
+                decode(number, s.batch);
+
+                lock.lock();
+                s.ready = true;
+                wake.notify_all();
+            }
+        }
+
+        void PositionReader::decode(std::size_t number, Batch &b)
+        {
+            std::size_t const batch_size = std::max<std::size_t>(options.batch_size, 1);
+            std::uint64_t const begin = static_cast<std::uint64_t>(number)*batch_size;
+            std::uint64_t const end = std::min<std::uint64_t>(begin + batch_size, total);
+            std::size_t const suits = layout_->suits.size(), classes = layout_->classes.size(), cells = layout_->cells();
+
+            //start reading what the batch a whole prefetch window later will need
+            std::uint64_t const ahead = begin + static_cast<std::uint64_t>(slots.size())*batch_size;
+            if(ahead < total)
+            {
+                std::size_t i = static_cast<std::size_t>(std::upper_bound(starts.begin(), starts.end(), ahead) - starts.begin()) - 1;
+                files[blocks[i].file]->willNeed(blocks[i].first, blocks[i].count);
+            }
+
+            b.size = static_cast<std::size_t>(end - begin);
+            b.features.clear();
+            b.first.clear();
+            b.scores.clear();
+            b.turns.clear();
+            b.results.clear();
+            std::size_t i = static_cast<std::size_t>(std::upper_bound(starts.begin(), starts.end(), begin) - starts.begin()) - 1;
+            Permutation order {blocks[i].count, epoch_seed ^ mix(i)};
+            for(std::uint64_t p = begin; p < end; ++p)
+            {
+                if(p - starts[i] == blocks[i].count)
+                {
+                    ++i;
+                    order = Permutation{blocks[i].count, epoch_seed ^ mix(i)};
+                }
+                Block const &block = blocks[i];
+                PackedPosition const pos {files[block.file]->record(block.first + order(p - starts[i])), *layout_};
+                std::size_t const turn = pos.turn();
+                auto relative = [&](std::size_t s)
+                {
+                    return options.relative? (s + suits - turn) % suits : s;
+                };
+                b.first.push_back(static_cast<std::uint32_t>(b.features.size()));
+                pos.forEachPiece([&](std::size_t cell, std::size_t suit, std::size_t pclass)
+                {
+                    b.features.push_back(static_cast<std::uint32_t>((relative(suit)*classes + pclass)*cells + cell));
+                });
+                b.scores.push_back(pos.score());
+                b.turns.push_back(pos.turn());
+                b.results.push_back(pos.result() == Layout::NoWinner ? Layout::NoWinner : static_cast<std::uint8_t>(relative(pos.result())));
+            }
+            b.first.push_back(static_cast<std::uint32_t>(b.features.size()));
+        }
+
+        Batch const *PositionReader::next()
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            if(holding)
+            {
+                //the batch handed out last time is done with, its slot can be decoded into
+                holding = false;
+                ++consumed;
+                wake.notify_all();
+            }
+            if(consumed == batches || workers.empty())
+            {
+                return nullptr;
+            }
+            Slot &s = slots[consumed % slots.size()];
+            wake.wait(lock, [&]
+            {
+                return s.ready && s.number == consumed;
+            });
+            holding = true;
+            return &s.batch;
+        }
+    }
+}
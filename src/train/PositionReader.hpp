@@ -0,0 +1,133 @@
+#ifndef ChessPlusPlus_Train_ShuffledPositionReaderClass_HeaderPlusPlus
+#define ChessPlusPlus_Train_ShuffledPositionReaderClass_HeaderPlusPlus
+
+#include "PackedPosition.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chesspp
+{
+    namespace train
+    {
+        /**
+         * Positions decoded for training, in flat arrays. Each position is
+         * a list of active features, one per piece: with S suits, C piece
+         * classes and N cells, a piece of suit s and class c on cell n is
+         * feature (s*C + c)*N + n. Suits may be counted from the suit to
+         * move, so the same arrangement gives the same features whoever's
+         * turn it is.
+         */
+        class Batch
+        {
+        public:
+            std::size_t size = 0;
+            std::vector<std::uint32_t> features;
+            std::vector<std::uint32_t> first;  //the features of position i are features[first[i]] up to features[first[i + 1]]
+            std::vector<Layout::Score_t> scores;
+            std::vector<std::uint8_t> turns;
+            std::vector<std::uint8_t> results; //winning suit, counted the same way as the features' suits, or Layout::NoWinner
+        };
+
+        /**
+         * Reads packed chunk files of one layout for training. The files are
+         * memory mapped rather than read, and split into blocks of records.
+         * Each epoch visits the blocks in an order shuffled with a seeded
+         * generator, and the records within each block in a shuffled order
+         * too, so runs with the same seed see the same batches.
+         *
+         * Worker threads decode batches ahead of the consumer, up to the
+         * prefetch depth, and ask the kernel to read the blocks they will
+         * need next, so reading large blocks runs alongside decoding and
+         * the disk is kept busy.
+         */
+        class PositionReader
+        {
+        public:
+            class Options
+            {
+            public:
+                std::size_t batch_size;
+                std::size_t block_positions; //records read in one go, in file order
+                std::size_t prefetch;        //batches decoded ahead of the consumer
+                unsigned threads;            //0 for one per core
+                std::uint32_t seed;
+                bool relative;               //count suits from the suit to move
+            };
+
+        private:
+            class Mapped;
+            class Block
+            {
+            public:
+                std::size_t file;
+                std::uint64_t first, count;
+            };
+            class Slot
+            {
+            public:
+                Batch batch;
+                std::size_t number = 0; //of the batch it holds, or is being decoded into
+                bool ready = false;
+            };
+
+            Options const options;
+            std::vector<std::unique_ptr<Mapped>> files;
+            std::unique_ptr<Layout> layout_;
+            std::uint64_t total = 0;
+            std::vector<Block> blocks;        //in this epoch's order
+            std::vector<std::uint64_t> starts; //position in the epoch each block starts at
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::vector<Slot> slots;
+            std::size_t batches = 0, claimed = 0, consumed = 0; //consumed counts batches given back by calling next() again
+            bool holding = false;                               //whether the consumer has a batch
+            std::uint32_t epoch_seed = 0;
+            bool stopping = false;
+            std::vector<std::thread> workers;
+
+            void work();
+            void decode(std::size_t number, Batch &b);
+            void stop();
+
+        public:
+            //Maps every file, throws ::chesspp::Exception if one can't be read or they differ in layout
+            PositionReader(std::vector<std::string> const &paths, Options const &opts) noexcept(false);
+            ~PositionReader();
+            PositionReader(PositionReader const &) = delete;
+            PositionReader &operator=(PositionReader const &) = delete;
+
+            //The chunk files in a directory, in name order
+            static std::vector<std::string> filesIn(std::string const &dir);
+
+            Layout const &layout() const noexcept
+            {
+                return *layout_;
+            }
+            std::uint64_t positions() const noexcept
+            {
+                return total;
+            }
+            std::size_t features() const noexcept
+            {
+                return layout_->suits.size()*layout_->classes.size()*layout_->cells();
+            }
+            std::uint64_t bytes() const noexcept;
+
+            //Shuffles for an epoch and starts decoding it
+            void start(std::uint32_t epoch);
+            //The next batch of the epoch, valid until the next call, or nullptr at the end.
+            //Every batch holds batch_size positions except maybe the last.
+            Batch const *next();
+        };
+    }
+}
+
+#endif
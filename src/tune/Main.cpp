@@ -0,0 +1,77 @@
+#include "tune/Tuner.hpp"
+#include "train/PositionReader.hpp"
+#include "server/Game.hpp"
+#include "config/ResourcesConfig.hpp"
+#include "config/EvaluationConfig.hpp"
+#include "Debug.hpp"
+#include "Exception.hpp"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <typeinfo>
+
+//Tunes the evaluation's weights against positions written by chesspp-datagen and writes them as an evaluation config.
+//Usage: chesspp-tune --data <dir> --out <file> [--variant name] [--eval file] [--epochs n] [--rate x]
+//                    [--lambda 0..1] [--l2 x] [--scale k] [--threads n] [--no-values] [--no-squares]
+//                    [--no-mobility] [--no-tropism] [--verbose]
+int main(int argc, char const *const *argv)
+{
+    std::string data, out, variant = "board", eval_file = "config/chesspp/evaluation.json";
+    chesspp::tune::Tuner::Options options {0, 200, 1.0, 0.0, 1e-7, 0.0, true, true, true, true};
+    bool verbose = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if     (arg == "--data"        && has_value) data             = argv[++i];
+        else if(arg == "--out"         && has_value) out              = argv[++i];
+        else if(arg == "--variant"     && has_value) variant          = argv[++i];
+        else if(arg == "--eval"        && has_value) eval_file        = argv[++i];
+        else if(arg == "--epochs"      && has_value) options.epochs   = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--rate"        && has_value) options.rate     = std::strtod(argv[++i], nullptr);
+        else if(arg == "--lambda"      && has_value) options.lambda   = std::strtod(argv[++i], nullptr);
+        else if(arg == "--l2"          && has_value) options.l2       = std::strtod(argv[++i], nullptr);
+        else if(arg == "--scale"       && has_value) options.scale    = std::strtod(argv[++i], nullptr);
+        else if(arg == "--threads"     && has_value) options.threads  = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--no-values")                options.values   = false;
+        else if(arg == "--no-squares")               options.squares  = false;
+        else if(arg == "--no-mobility")              options.mobility = false;
+        else if(arg == "--no-tropism")               options.tropism  = false;
+        else if(arg == "--verbose")                  verbose          = true;
+        else
+        {
+            data.clear();
+            break;
+        }
+    }
+    if(data.empty() || out.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --data <dir> --out <file> [--variant name] [--eval file] [--epochs n] [--rate x]"
+                     " [--lambda 0..1] [--l2 x] [--scale k] [--threads n] [--no-values] [--no-squares]"
+                     " [--no-mobility] [--no-tropism] [--verbose]" << std::endl;
+        return -1;
+    }
+    if(!verbose)
+    {
+        LogUtil::discardLog();
+    }
+
+    try
+    {
+        chesspp::config::ResourcesConfig res;
+        chesspp::server::Variant v {res, variant, "config/chesspp/" + variant + ".json"};
+        chesspp::config::EvaluationConfig eval_config {eval_file};
+        chesspp::tune::Tuner tuner {v, eval_config, options};
+        tuner.load(chesspp::train::PositionReader::filesIn(data), &std::cout);
+        tuner.run(&std::cout);
+        tuner.write(out);
+        std::cout << "Wrote " << out << std::endl;
+        return 0;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << typeid(e).name() << " caught in main: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,464 @@
+#include "Tuner.hpp"
+
+#include "ai/Evaluator.hpp"
+#include "board/Board.hpp"
+#include "board/DistanceMap.hpp"
+#include "train/PackedPosition.hpp"
+#include "train/PositionReader.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+namespace chesspp
+{
+    namespace tune
+    {
+        namespace
+        {
+            double sigmoid(double x) noexcept
+            {
+                return 1.0/(1.0 + std::exp(-x));
+            }
+            std::uint16_t clamp16(ai::Score_t v) noexcept
+            {
+                return static_cast<std::uint16_t>(std::min<ai::Score_t>(std::max<ai::Score_t>(v, 0), std::numeric_limits<std::uint16_t>::max()));
+            }
+        }
+
+        Tuner::Tuner(server::Variant const &v, config::EvaluationConfig const &conf, Options const &opts) noexcept(false)
+        : variant(v) //can't use {}
+        , start(conf) //can't use {}
+        , options(opts) //can't use {}
+        , threads{opts.threads? opts.threads : std::max(1u, std::thread::hardware_concurrency())}
+        {
+            train::Layout const layout {v.config};
+            suits = layout.suits.size();
+            classes = layout.classes.size();
+            cells = layout.cells();
+            features = suits*classes*cells;
+            if(features > std::numeric_limits<std::uint16_t>::max() + std::size_t(1))
+            {
+                throw Exception("Too many suits, piece classes and cells to tune at once");
+            }
+            suit_names = layout.suits;
+            class_names = layout.classes;
+
+            suit_of.resize(features);
+            class_of.resize(features);
+            params.assign(classes + features + 2, 0.0);
+            for(std::size_t c = 0; c < classes; ++c)
+            {
+                params[c] = start.pieceValue(class_names[c]);
+            }
+            for(std::size_t f = 0; f < features; ++f)
+            {
+                suit_of[f] = static_cast<std::uint8_t>(f/(classes*cells));
+                class_of[f] = static_cast<std::uint8_t>(f/cells%classes);
+                params[classes + f] = start.squareValue(suit_names[suit_of[f]], class_names[class_of[f]], f%cells);
+            }
+            params[mobilityAt()] = start.mobility();
+            params[tropismAt()] = start.tropism();
+            moment.assign(params.size(), 0.0);
+            second.assign(params.size(), 0.0);
+            grads.assign(threads, std::vector<double>(features + 2, 0.0));
+            losses.assign(threads, 0.0);
+            rebuildWeights();
+        }
+
+        template<typename Func>
+        void Tuner::parallel(Func f)
+        {
+            std::vector<std::thread> workers;
+            std::vector<std::exception_ptr> failures(threads);
+            auto range = [&](std::size_t t)
+            {
+                try
+                {
+                    f(count*t/threads, count*(t + 1)/threads, t);
+                }
+                catch(...)
+                {
+                    failures[t] = std::current_exception();
+                }
+            };
+            for(std::size_t t = 1; t < threads; ++t)
+            {
+                workers.emplace_back(range, t);
+            }
+            range(0);
+            for(auto &w : workers)
+            {
+                w.join();
+            }
+            for(auto const &e : failures)
+            {
+                if(e)
+                {
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+
+        void Tuner::load(std::vector<std::string> const &paths, std::ostream *progress) noexcept(false)
+        {
+            auto const started = Clock::now();
+            train::PositionReader reader {paths, train::PositionReader::Options{1 << 14, 1 << 16, 8, threads, 0, false}};
+            if(reader.layout().fingerprint != variant.config.fingerprint() || reader.features() != features)
+            {
+                throw Exception("The positions are not of this variant");
+            }
+            if(reader.positions() > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw Exception("Too many positions to tune at once");
+            }
+            count = 0;
+            piece_features.clear();
+            first.assign(1, 0);
+            turns.clear();
+            outcomes.clear();
+            scores.clear();
+            reader.start(0);
+            while(auto b = reader.next())
+            {
+                for(std::size_t i = 0; i < b->size; ++i)
+                {
+                    for(std::uint32_t j = b->first[i]; j < b->first[i + 1]; ++j)
+                    {
+                        piece_features.push_back(static_cast<std::uint16_t>(b->features[j]));
+                    }
+                    if(piece_features.size() > std::numeric_limits<std::uint32_t>::max())
+                    {
+                        throw Exception("Too many pieces to tune at once");
+                    }
+                    first.push_back(static_cast<std::uint32_t>(piece_features.size()));
+                    turns.push_back(b->turns[i]);
+                    outcomes.push_back(b->results[i] == train::Layout::NoWinner ? 0.5f : b->results[i] == b->turns[i] ? 1.0f : 0.0f);
+                    scores.push_back(static_cast<float>(b->scores[i]));
+                }
+                count += b->size;
+            }
+            if(!count)
+            {
+                throw Exception("No positions to tune with");
+            }
+
+            //mobility and tropism need the moves of every piece, so set each position up once
+            ai::Evaluator const evaluator {start};
+            board::Board const like {variant.config};
+            bool const closeness = options.tropism || start.tropism();
+            std::size_t const width = variant.config.boardWidth();
+            reaches.assign(count*suits, 0);
+            closenesses.assign(count*suits, 0);
+            parallel([&](std::size_t begin, std::size_t end, std::size_t)
+            {
+                config::BoardConfig::Layout_t layout;
+                for(std::size_t i = begin; i < end; ++i)
+                {
+                    layout.clear();
+                    for(std::uint32_t j = first[i]; j < first[i + 1]; ++j)
+                    {
+                        std::size_t const f = piece_features[j], cell = f%cells;
+                        config::BoardConfig::Position_t const pos {static_cast<config::BoardConfig::BoardSize_t>(cell%width), static_cast<config::BoardConfig::BoardSize_t>(cell/width)};
+                        layout[pos] = std::make_pair(class_names[class_of[f]], suit_names[suit_of[f]]);
+                    }
+                    board::Board b {like, layout};
+                    board::DistanceMaps maps;
+                    for(std::size_t s = 0; s < suits; ++s)
+                    {
+                        reaches[i*suits + s] = clamp16(ai::Evaluator::reach(b, suit_names[s]));
+                        if(closeness)
+                        {
+                            closenesses[i*suits + s] = clamp16(evaluator.closeness(b, suit_names[s], maps));
+                        }
+                    }
+                }
+            });
+            if(progress)
+            {
+                *progress << std::fixed << std::setprecision(1) << "Loaded " << count << " positions, " << piece_features.size() << " pieces, in "
+                          << std::chrono::duration<double>(Clock::now() - started).count() << "s" << std::endl;
+            }
+        }
+
+        void Tuner::rebuildWeights()
+        {
+            weights.resize(features);
+            for(std::size_t f = 0; f < features; ++f)
+            {
+                weights[f] = params[class_of[f]] + params[classes + f];
+            }
+        }
+
+        void Tuner::pass(std::size_t begin, std::size_t end, double k, bool gradient, std::size_t thread)
+        {
+            double const mobility = params[mobilityAt()], tropism = params[tropismAt()];
+            double *const g = grads[thread].data();
+            double sum = 0;
+            double score[16]; //train::Layout allows no more suits
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                std::uint16_t const *const reach = &reaches[i*suits], *const close = &closenesses[i*suits];
+                for(std::size_t s = 0; s < suits; ++s)
+                {
+                    score[s] = mobility*reach[s] + tropism*close[s];
+                }
+                for(std::uint32_t j = first[i]; j < first[i + 1]; ++j)
+                {
+                    score[suit_of[piece_features[j]]] += weights[piece_features[j]];
+                }
+                //relative to the strongest opponent, as ai::Evaluator::evaluate()
+                std::size_t const turn = turns[i];
+                std::size_t opponent = suits;
+                for(std::size_t s = 0; s < suits; ++s)
+                {
+                    if(s != turn && (opponent == suits || score[s] > score[opponent]))
+                    {
+                        opponent = s;
+                    }
+                }
+                double const eval = score[turn] - (opponent < suits ? score[opponent] : 0.0);
+                double const p = sigmoid(k*eval);
+                double const error = targets[i] - p;
+                sum += error*error;
+                if(!gradient)
+                {
+                    continue;
+                }
+                double const d = -2.0*error*p*(1.0 - p)*k;
+                for(std::uint32_t j = first[i]; j < first[i + 1]; ++j)
+                {
+                    std::size_t const f = piece_features[j];
+                    if(suit_of[f] == turn)
+                    {
+                        g[f] += d;
+                    }
+                    else if(suit_of[f] == opponent)
+                    {
+                        g[f] -= d;
+                    }
+                }
+                if(opponent < suits)
+                {
+                    g[features]     += d*(double(reach[turn]) - reach[opponent]);
+                    g[features + 1] += d*(double(close[turn]) - close[opponent]);
+                }
+                else
+                {
+                    g[features]     += d*reach[turn];
+                    g[features + 1] += d*close[turn];
+                }
+            }
+            losses[thread] = sum;
+        }
+
+        double Tuner::loss(double k, bool gradient)
+        {
+            if(gradient)
+            {
+                for(auto &g : grads)
+                {
+                    std::fill(g.begin(), g.end(), 0.0);
+                }
+            }
+            parallel([&](std::size_t begin, std::size_t end, std::size_t thread)
+            {
+                pass(begin, end, k, gradient, thread);
+            });
+            double sum = 0;
+            for(auto l : losses)
+            {
+                sum += l;
+            }
+            if(gradient)
+            {
+                for(std::size_t t = 1; t < grads.size(); ++t)
+                {
+                    for(std::size_t i = 0; i < grads[0].size(); ++i)
+                    {
+                        grads[0][i] += grads[t][i];
+                    }
+                }
+                for(auto &g : grads[0])
+                {
+                    g /= static_cast<double>(count);
+                }
+            }
+            return sum/static_cast<double>(count);
+        }
+
+        void Tuner::run(std::ostream *progress)
+        {
+            scale = options.scale;
+            if(scale <= 0)
+            {
+                //golden section search of the scale that best predicts the results with the starting weights
+                targets.assign(outcomes.begin(), outcomes.end());
+                double lo = std::log(1e-5), hi = std::log(1e-1);
+                double const r = (std::sqrt(5.0) - 1.0)/2.0;
+                double a = hi - r*(hi - lo), b = lo + r*(hi - lo);
+                double fa = loss(std::exp(a), false), fb = loss(std::exp(b), false);
+                for(int i = 0; i < 40; ++i)
+                {
+                    if(fa < fb)
+                    {
+                        hi = b;
+                        b = a;
+                        fb = fa;
+                        a = hi - r*(hi - lo);
+                        fa = loss(std::exp(a), false);
+                    }
+                    else
+                    {
+                        lo = a;
+                        a = b;
+                        fa = fb;
+                        b = lo + r*(hi - lo);
+                        fb = loss(std::exp(b), false);
+                    }
+                }
+                scale = std::exp((lo + hi)/2.0);
+            }
+            targets.resize(count);
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                targets[i] = static_cast<float>(options.lambda*sigmoid(scale*scores[i]) + (1.0 - options.lambda)*outcomes[i]);
+            }
+            if(progress)
+            {
+                *progress << std::setprecision(6) << "Scale " << scale << ", starting loss " << loss(scale, false) << std::endl;
+            }
+
+            double const beta1 = 0.9, beta2 = 0.999, epsilon = 1e-12;
+            std::vector<double> step(params.size());
+            for(unsigned epoch = 1; epoch <= options.epochs; ++epoch)
+            {
+                auto const begun = Clock::now();
+                double const l = loss(scale, true);
+                auto const &g = grads[0];
+                std::fill(step.begin(), step.end(), 0.0);
+                if(options.values)
+                {
+                    for(std::size_t f = 0; f < features; ++f)
+                    {
+                        step[class_of[f]] += g[f];
+                    }
+                }
+                if(options.squares)
+                {
+                    for(std::size_t f = 0; f < features; ++f)
+                    {
+                        step[classes + f] = g[f] + options.l2*params[classes + f];
+                    }
+                }
+                if(options.mobility)
+                {
+                    step[mobilityAt()] = g[features];
+                }
+                if(options.tropism)
+                {
+                    step[tropismAt()] = g[features + 1];
+                }
+                double const correct1 = 1.0 - std::pow(beta1, epoch), correct2 = 1.0 - std::pow(beta2, epoch);
+                for(std::size_t i = 0; i < params.size(); ++i)
+                {
+                    if(step[i] == 0.0)
+                    {
+                        continue; //not tuned, or not seen in any position
+                    }
+                    moment[i] = beta1*moment[i] + (1.0 - beta1)*step[i];
+                    second[i] = beta2*second[i] + (1.0 - beta2)*step[i]*step[i];
+                    params[i] -= options.rate*(moment[i]/correct1)/(std::sqrt(second[i]/correct2) + epsilon);
+                }
+                rebuildWeights();
+                if(progress)
+                {
+                    double const seconds = std::chrono::duration<double>(Clock::now() - begun).count();
+                    *progress << std::setprecision(6) << "Epoch " << epoch << ": loss " << l << std::setprecision(3) << ", " << seconds << "s ("
+                              << (seconds > 0 ? count/seconds/1e6 : 0.0) << "M positions/s)" << std::endl;
+                }
+            }
+            if(progress)
+            {
+                *progress << std::setprecision(6) << "Final loss " << loss(scale, false) << ", rounded " << roundedLoss() << std::endl;
+            }
+        }
+
+        double Tuner::roundedLoss()
+        {
+            auto const exact = params;
+            for(auto &p : params)
+            {
+                p = std::round(p);
+            }
+            rebuildWeights();
+            double const l = loss(scale, false);
+            params = exact;
+            rebuildWeights();
+            return l;
+        }
+
+        void Tuner::write(std::string const &file) const noexcept(false)
+        {
+            std::ofstream out {file};
+            if(!out)
+            {
+                throw Exception("Unable to write \"" + file + "\"");
+            }
+            auto value = [this](std::size_t i)
+            {
+                return static_cast<long>(std::lround(params[i]));
+            };
+            auto values = start.pieceValues();
+            for(std::size_t c = 0; c < classes; ++c)
+            {
+                values[class_names[c]] = static_cast<config::EvaluationConfig::Score_t>(value(c));
+            }
+            out << "{\n    \"evaluation\":\n    {\n        \"pieces\":\n        {\n";
+            for(auto it = values.begin(); it != values.end(); ++it)
+            {
+                out << "            \"" << it->first << "\": " << it->second << (std::next(it) != values.end() ? ",\n" : "\n");
+            }
+            out << "        },\n"
+                << "        \"unknown piece\": " << start.unknownValue() << ",\n"
+                << "        \"mobility\": " << value(mobilityAt()) << ",\n"
+                << "        \"tropism\":\n        {\n"
+                << "            \"target\": \"" << start.tropismTarget() << "\",\n"
+                << "            \"weight\": " << value(tropismAt()) << ",\n"
+                << "            \"moves\":  " << start.tropismMoves() << "\n"
+                << "        }";
+            if(!options.squares && start.squareValues().empty())
+            {
+                out << "\n    }\n}\n";
+                return;
+            }
+            out << ",\n        \"squares\":\n        {\n";
+            std::size_t const width = variant.config.boardWidth();
+            for(std::size_t s = 0; s < suits; ++s)
+            {
+                out << "            \"" << suit_names[s] << "\":\n            {\n";
+                for(std::size_t c = 0; c < classes; ++c)
+                {
+                    out << "                \"" << class_names[c] << "\":\n                [";
+                    for(std::size_t cell = 0; cell < cells; ++cell)
+                    {
+                        out << (cell%width ? " " : "\n                    ") << value(classes + (s*classes + c)*cells + cell) << (cell + 1 < cells ? "," : "");
+                    }
+                    out << "\n                ]" << (c + 1 < classes ? ",\n" : "\n");
+                }
+                out << "            }" << (s + 1 < suits ? ",\n" : "\n");
+            }
+            out << "        }\n    }\n}\n";
+            if(!out)
+            {
+                throw Exception("Unable to write \"" + file + "\"");
+            }
+        }
+    }
+}
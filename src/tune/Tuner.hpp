@@ -0,0 +1,113 @@
+#ifndef ChessPlusPlus_Tune_EvaluationTunerClass_HeaderPlusPlus
+#define ChessPlusPlus_Tune_EvaluationTunerClass_HeaderPlusPlus
+
+#include "config/EvaluationConfig.hpp"
+#include "server/Game.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace tune
+    {
+        /**
+         * Tunes the weights of ai::Evaluator against labelled positions, as
+         * in Texel tuning: the evaluation of each position, squashed by a
+         * sigmoid, should predict the result of the game it came from,
+         * optionally mixed with the score the search gave it.
+         *
+         * Loading works out, once, everything about each position that the
+         * weights multiply: its pieces as feature indices, and the reach
+         * and closeness of each suit, by setting up a board::Board and
+         * asking the evaluator. After that the evaluator is linear in its
+         * weights per suit, so each epoch is a pass over flat arrays on
+         * every core with no allocation and no boards, giving the loss and
+         * its gradient, followed by an Adam step.
+         */
+        class Tuner
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            class Options
+            {
+            public:
+                unsigned threads; //0 for one per core
+                unsigned epochs;
+                double rate;      //Adam step size, in hundredths of a pawn
+                double lambda;    //weight of the search score against the game's result, 0 to 1
+                double l2;        //pulls piece-square values toward 0
+                double scale;     //of the sigmoid, per hundredth of a pawn, 0 to fit it
+                bool values, squares, mobility, tropism; //which weights to tune
+            };
+
+        private:
+            server::Variant const &variant;
+            config::EvaluationConfig const &start;
+            Options const options;
+            unsigned const threads;
+            std::size_t suits = 0, classes = 0, cells = 0, features = 0;
+            std::vector<config::BoardConfig::SuitClass_t> suit_names;
+            std::vector<config::BoardConfig::PieceClass_t> class_names;
+
+            //The positions, in flat arrays
+            std::size_t count = 0;
+            std::vector<std::uint16_t> piece_features;   //(suit*classes + class)*cells + cell
+            std::vector<std::uint32_t> first;            //the features of position i are piece_features[first[i]] up to piece_features[first[i + 1]]
+            std::vector<std::uint8_t> turns;
+            std::vector<float> outcomes;                 //1 if the suit to move won, 0 if another did, 0.5 if nobody
+            std::vector<float> scores;                   //from the search, for the suit to move
+            std::vector<std::uint16_t> reaches, closenesses; //suits for each position
+            std::vector<float> targets;
+
+            std::vector<std::uint8_t> suit_of, class_of; //by feature
+
+            //Weights: a value per class, a value per feature, then mobility and tropism
+            std::vector<double> params, weights; //weights are the value and square value of each feature added up
+            std::size_t mobilityAt() const noexcept { return classes + features;     }
+            std::size_t tropismAt() const noexcept  { return classes + features + 1; }
+            std::vector<double> moment, second;   //Adam's averages
+            std::vector<std::vector<double>> grads; //per thread
+            std::vector<double> losses;           //per thread
+            double scale = 0;
+
+            //Sums the loss, and the gradient by feature, mobility and tropism if wanted, of some positions
+            void pass(std::size_t begin, std::size_t end, double k, bool gradient, std::size_t thread);
+            //The mean loss over every position, with its gradient as pass() sums it in grads[0] if wanted
+            double loss(double k, bool gradient);
+            void rebuildWeights();
+            //Runs f(begin, end, thread) over the positions on every thread
+            template<typename Func>
+            void parallel(Func f);
+
+        public:
+            //Throws ::chesspp::Exception if the variant's positions can't be packed
+            Tuner(server::Variant const &v, config::EvaluationConfig const &conf, Options const &opts) noexcept(false);
+            Tuner(Tuner const &) = delete;
+            Tuner &operator=(Tuner const &) = delete;
+
+            //Reads every position of some chunk files once and works out what the weights multiply.
+            //Throws ::chesspp::Exception if the files can't be read or are of another variant.
+            void load(std::vector<std::string> const &paths, std::ostream *progress = nullptr) noexcept(false);
+            std::size_t positions() const noexcept
+            {
+                return count;
+            }
+
+            //Fits the sigmoid's scale to the starting weights unless given, then runs every
+            //epoch, writing the loss and speed of each to progress if given
+            void run(std::ostream *progress = nullptr);
+            //The mean loss with the weights rounded as they would be written
+            double roundedLoss();
+
+            //Writes an evaluation config with the tuned weights, and the starting config's other settings
+            void write(std::string const &file) const noexcept(false);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,235 @@
+#include "Allocations.hpp"
+
+#include <iomanip>
+
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#endif
+
+namespace chesspp
+{
+    namespace util
+    {
+        namespace
+        {
+            static char const *const names[] {"other", "board", "piece", "config", "res", "gfx", "app", "engine", "log"};
+            static_assert(sizeof(names)/sizeof(*names) == static_cast<std::size_t>(Allocations::Subsystem::Count), "a subsystem has no name");
+
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+            //Atomics are trivially constructed, so these are zero before anything is allocated
+            struct alignas(64) Counters
+            {
+                std::atomic<std::uint64_t> allocations, frees, bytes, live_bytes, peak_bytes;
+            };
+            static Counters counters[static_cast<std::size_t>(Allocations::Subsystem::Count)];
+            static thread_local Allocations::Subsystem current = Allocations::Subsystem::Other;
+
+            //Kept in front of every allocation, padded so what follows stays aligned for any type
+            struct Header
+            {
+                std::size_t size;
+                Allocations::Subsystem subsystem;
+            };
+            static constexpr std::size_t HeaderSize = 16;
+            static_assert(sizeof(Header) <= HeaderSize && alignof(long double) <= HeaderSize, "the header does not keep allocations aligned");
+
+            static void *charge(void *block, std::size_t size) noexcept
+            {
+                auto &c = counters[static_cast<std::size_t>(current)];
+                c.allocations.fetch_add(1, std::memory_order_relaxed);
+                c.bytes.fetch_add(size, std::memory_order_relaxed);
+                std::uint64_t live = c.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+                for(std::uint64_t peak = c.peak_bytes.load(std::memory_order_relaxed); live > peak
+                    && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed);)
+                {
+                }
+                auto h = static_cast<Header *>(block);
+                h->size = size;
+                h->subsystem = current;
+                return static_cast<char *>(block) + HeaderSize;
+            }
+
+            //Like the default operator new, calls the new handler until it can allocate
+            static void *allocate(std::size_t size)
+            {
+                for(;;)
+                {
+                    if(void *block = std::malloc(size + HeaderSize))
+                    {
+                        return charge(block, size);
+                    }
+                    std::new_handler handler = std::get_new_handler();
+                    if(!handler)
+                    {
+                        throw std::bad_alloc();
+                    }
+                    handler();
+                }
+            }
+            static void *allocate(std::size_t size, std::nothrow_t const &) noexcept
+            {
+                try
+                {
+                    return allocate(size);
+                }
+                catch(std::bad_alloc &)
+                {
+                    return nullptr;
+                }
+            }
+
+            static void release(void *p) noexcept
+            {
+                if(!p)
+                {
+                    return;
+                }
+                void *block = static_cast<char *>(p) - HeaderSize;
+                auto const h = static_cast<Header *>(block);
+                auto &c = counters[static_cast<std::size_t>(h->subsystem)];
+                c.frees.fetch_add(1, std::memory_order_relaxed);
+                c.live_bytes.fetch_sub(h->size, std::memory_order_relaxed);
+                std::free(block);
+            }
+
+            //Appends the counts to a file when the process exits
+            static struct AtExit
+            {
+                AtExit() noexcept
+                {
+                    std::atexit([]
+                    {
+                        std::ofstream out {"debug_allocations.log", std::ios::out|std::ios::app};
+                        out << "Heap allocations at exit:" << std::endl;
+                        Allocations::dump(out);
+                    });
+                }
+            } const at_exit;
+#endif
+        }
+
+        char const *Allocations::name(Subsystem s) noexcept
+        {
+            return names[static_cast<std::size_t>(s)];
+        }
+
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+        Allocations::Scope::Scope(Subsystem s) noexcept
+        : previous{current}
+        {
+            current = s;
+        }
+        Allocations::Scope::~Scope() noexcept
+        {
+            current = previous;
+        }
+
+        void *Allocations::jsonAlloc(std::size_t size, int zero, void *)
+        {
+            Scope tag {Subsystem::Config};
+            void *p = allocate(size, std::nothrow);
+            if(p && zero)
+            {
+                std::memset(p, 0, size);
+            }
+            return p;
+        }
+        void Allocations::jsonFree(void *p, void *)
+        {
+            release(p);
+        }
+#endif
+
+        auto Allocations::counts(Subsystem s) noexcept
+        -> Counts
+        {
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+            auto const &c = counters[static_cast<std::size_t>(s)];
+            return Counts
+            {
+                c.allocations.load(std::memory_order_relaxed),
+                c.frees.load(std::memory_order_relaxed),
+                c.bytes.load(std::memory_order_relaxed),
+                c.live_bytes.load(std::memory_order_relaxed),
+                c.peak_bytes.load(std::memory_order_relaxed)
+            };
+#else
+            static_cast<void>(s);
+            return Counts{0, 0, 0, 0, 0};
+#endif
+        }
+
+        void Allocations::dump(std::ostream &os)
+        {
+            if(!enabled())
+            {
+                os << "Heap allocations are not tracked, build with -DTRACK_ALLOCATIONS=1" << std::endl;
+                return;
+            }
+            //read everything before writing, the stream may allocate
+            Counts all[static_cast<std::size_t>(Subsystem::Count)];
+            for(std::size_t i = 0; i < static_cast<std::size_t>(Subsystem::Count); ++i)
+            {
+                all[i] = counts(static_cast<Subsystem>(i));
+            }
+            os << std::left << std::setw(8) << "" << std::right
+               << std::setw(14) << "allocations" << std::setw(14) << "frees" << std::setw(12) << "live"
+               << std::setw(14) << "live bytes" << std::setw(14) << "peak bytes" << std::setw(16) << "bytes in all" << std::endl;
+            Counts total {0, 0, 0, 0, 0};
+            for(std::size_t i = 0; i < static_cast<std::size_t>(Subsystem::Count); ++i)
+            {
+                auto const &c = all[i];
+                os << std::left << std::setw(8) << names[i] << std::right
+                   << std::setw(14) << c.allocations << std::setw(14) << c.frees << std::setw(12) << c.live()
+                   << std::setw(14) << c.live_bytes << std::setw(14) << c.peak_bytes << std::setw(16) << c.bytes << std::endl;
+                total.allocations += c.allocations;
+                total.frees += c.frees;
+                total.live_bytes += c.live_bytes;
+                total.bytes += c.bytes;
+            }
+            //peaks of different subsystems need not have been at the same time, so they aren't added up
+            os << std::left << std::setw(8) << "total" << std::right
+               << std::setw(14) << total.allocations << std::setw(14) << total.frees << std::setw(12) << total.live()
+               << std::setw(14) << total.live_bytes << std::setw(14) << "" << std::setw(16) << total.bytes << std::endl;
+        }
+    }
+}
+
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+void *operator new(std::size_t size)
+{
+    return chesspp::util::allocate(size);
+}
+void *operator new[](std::size_t size)
+{
+    return chesspp::util::allocate(size);
+}
+void *operator new(std::size_t size, std::nothrow_t const &t) noexcept
+{
+    return chesspp::util::allocate(size, t);
+}
+void *operator new[](std::size_t size, std::nothrow_t const &t) noexcept
+{
+    return chesspp::util::allocate(size, t);
+}
+void operator delete(void *p) noexcept
+{
+    chesspp::util::release(p);
+}
+void operator delete[](void *p) noexcept
+{
+    chesspp::util::release(p);
+}
+void operator delete(void *p, std::nothrow_t const &) noexcept
+{
+    chesspp::util::release(p);
+}
+void operator delete[](void *p, std::nothrow_t const &) noexcept
+{
+    chesspp::util::release(p);
+}
+#endif
@@ -0,0 +1,98 @@
+#ifndef ChessPlusPlus_Util_HeapAllocationAccountingClass_HeaderPlusPlus
+#define ChessPlusPlus_Util_HeapAllocationAccountingClass_HeaderPlusPlus
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Counts heap allocations by the subsystem that made them, when built
+         * with CHESSPP_TRACK_ALLOCATIONS (-DTRACK_ALLOCATIONS=1). The global
+         * operator new and delete are then replaced, and each allocation is
+         * charged to the innermost Scope open on its thread, or to Other.
+         * Frees are charged to the subsystem that allocated, so live objects
+         * and bytes are what that subsystem still holds. The JSON DOM is
+         * always charged to Config.
+         *
+         * Without the option nothing is replaced, a Scope is empty and the
+         * counts are all zero.
+         */
+        class Allocations
+        {
+        public:
+            enum class Subsystem : std::uint8_t
+            {
+                Other,
+                Board,
+                Piece,
+                Config,
+                Res,
+                Gfx,
+                App,
+                Engine,
+                Log,
+                Count
+            };
+            static char const *name(Subsystem s) noexcept;
+
+            class Counts
+            {
+            public:
+                std::uint64_t allocations, frees;
+                std::uint64_t bytes;      //allocated in all
+                std::uint64_t live_bytes;
+                std::uint64_t peak_bytes; //most live at once
+
+                std::uint64_t live() const noexcept
+                {
+                    return allocations - frees;
+                }
+            };
+
+            //Charges allocations on this thread to a subsystem while it lives
+            class Scope
+            {
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+                Subsystem previous;
+
+            public:
+                explicit Scope(Subsystem s) noexcept;
+                ~Scope() noexcept;
+#else
+            public:
+                explicit Scope(Subsystem) noexcept
+                {
+                }
+#endif
+                Scope(Scope const &) = delete;
+                Scope &operator=(Scope const &) = delete;
+            };
+
+            static constexpr bool enabled() noexcept
+            {
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            static Counts counts(Subsystem s) noexcept;
+
+            //Writes a table of the counts of every subsystem
+            static void dump(std::ostream &os);
+
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+            //json-parser's mem_alloc and mem_free
+            static void *jsonAlloc(std::size_t size, int zero, void *user_data);
+            static void jsonFree(void *p, void *user_data);
+#endif
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,342 @@
+#include "BitKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHESSPP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include <cstdlib>
+
+namespace chesspp
+{
+    namespace util
+    {
+        namespace
+        {
+            using Word_t = BitKernels::Word_t;
+
+            //Word i of src shifted by n, for any i
+            static inline Word_t shiftedWord(Word_t const *src, std::size_t words, std::ptrdiff_t i, long n) noexcept
+            {
+                std::ptrdiff_t w = static_cast<std::ptrdiff_t>(words);
+                if(n >= 0)
+                {
+                    std::ptrdiff_t q = n/64;
+                    unsigned r = static_cast<unsigned>(n%64);
+                    Word_t hi = i - q >= 0 && i - q < w ? src[i - q] << r : 0;
+                    Word_t lo = r && i - q - 1 >= 0 && i - q - 1 < w ? src[i - q - 1] >> (64 - r) : 0;
+                    return hi | lo;
+                }
+                std::ptrdiff_t q = (-n)/64;
+                unsigned r = static_cast<unsigned>((-n)%64);
+                Word_t lo = i + q >= 0 && i + q < w ? src[i + q] >> r : 0;
+                Word_t hi = r && i + q + 1 >= 0 && i + q + 1 < w ? src[i + q + 1] << (64 - r) : 0;
+                return lo | hi;
+            }
+
+            //The words whose shifted value reads only words inside src, so vector loops need no bounds checks
+            static void interior(std::size_t words, long n, std::size_t &first, std::size_t &last) noexcept
+            {
+                std::size_t q = static_cast<std::size_t>(n >= 0 ? n : -n)/64 + 1;
+                if(q >= words)
+                {
+                    first = last = 0;
+                }
+                else if(n >= 0)
+                {
+                    first = q;
+                    last = words;
+                }
+                else
+                {
+                    first = 0;
+                    last = words - q;
+                }
+            }
+
+            static void andShiftScalar(Word_t *dst, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    dst[i] = mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n);
+                }
+            }
+            static void orAndShiftScalar(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    dst[i] = a[i] | (mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n));
+                }
+            }
+            static void orIntoScalar(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    dst[i] |= src[i];
+                }
+            }
+            static void andIntoScalar(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    dst[i] &= src[i];
+                }
+            }
+            static void andNotIntoScalar(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    dst[i] &= ~src[i];
+                }
+            }
+
+            static BitKernels const Scalar {"scalar", andShiftScalar, orAndShiftScalar, orIntoScalar, andIntoScalar, andNotIntoScalar};
+
+#if defined(CHESSPP_X86_KERNELS)
+            //Each shifted word is built from the source word most of its bits come from (main)
+            //and the neighbour the rest come from (carry); with_or also ORs in a
+            template<bool with_or>
+            __attribute__((target("sse2")))
+            static void shiftSse2(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                std::size_t first, last;
+                interior(words, n, first, last);
+                std::ptrdiff_t q = (n >= 0 ? n : -n)/64;
+                int r = static_cast<int>((n >= 0 ? n : -n)%64);
+                __m128i main_count = _mm_cvtsi32_si128(r), carry_count = _mm_cvtsi32_si128(64 - r);
+                std::size_t i = 0;
+                for(; i < first; ++i)
+                {
+                    Word_t v = mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n);
+                    dst[i] = with_or ? a[i] | v : v;
+                }
+                for(; i + 2 <= last; i += 2)
+                {
+                    __m128i v;
+                    if(n >= 0)
+                    {
+                        __m128i main  = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i - q));
+                        __m128i carry = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i - q - 1));
+                        v = _mm_or_si128(_mm_sll_epi64(main, main_count), _mm_srl_epi64(carry, carry_count));
+                    }
+                    else
+                    {
+                        __m128i main  = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i + q));
+                        __m128i carry = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i + q + 1));
+                        v = _mm_or_si128(_mm_srl_epi64(main, main_count), _mm_sll_epi64(carry, carry_count));
+                    }
+                    v = _mm_and_si128(v, _mm_loadu_si128(reinterpret_cast<__m128i const *>(mask + i)));
+                    if(with_or)
+                    {
+                        v = _mm_or_si128(v, _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i)));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+                }
+                for(; i < words; ++i)
+                {
+                    Word_t v = mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n);
+                    dst[i] = with_or ? a[i] | v : v;
+                }
+            }
+            static void andShiftSse2(Word_t *dst, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                shiftSse2<false>(dst, nullptr, mask, src, words, n);
+            }
+            static void orAndShiftSse2(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                shiftSse2<true>(dst, a, mask, src, words, n);
+            }
+            __attribute__((target("sse2")))
+            static void orIntoSse2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 2 <= words; i += 2)
+                {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + i));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(d, s));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] |= src[i];
+                }
+            }
+            __attribute__((target("sse2")))
+            static void andIntoSse2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 2 <= words; i += 2)
+                {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + i));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_and_si128(d, s));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] &= src[i];
+                }
+            }
+
+            __attribute__((target("sse2")))
+            static void andNotIntoSse2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 2 <= words; i += 2)
+                {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + i));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_andnot_si128(s, d));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] &= ~src[i];
+                }
+            }
+
+            template<bool with_or>
+            __attribute__((target("avx2")))
+            static void shiftAvx2(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                std::size_t first, last;
+                interior(words, n, first, last);
+                std::ptrdiff_t q = (n >= 0 ? n : -n)/64;
+                int r = static_cast<int>((n >= 0 ? n : -n)%64);
+                __m128i main_count = _mm_cvtsi32_si128(r), carry_count = _mm_cvtsi32_si128(64 - r);
+                std::size_t i = 0;
+                for(; i < first; ++i)
+                {
+                    Word_t v = mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n);
+                    dst[i] = with_or ? a[i] | v : v;
+                }
+                for(; i + 4 <= last; i += 4)
+                {
+                    __m256i v;
+                    if(n >= 0)
+                    {
+                        __m256i main  = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i - q));
+                        __m256i carry = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i - q - 1));
+                        v = _mm256_or_si256(_mm256_sll_epi64(main, main_count), _mm256_srl_epi64(carry, carry_count));
+                    }
+                    else
+                    {
+                        __m256i main  = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i + q));
+                        __m256i carry = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i + q + 1));
+                        v = _mm256_or_si256(_mm256_srl_epi64(main, main_count), _mm256_sll_epi64(carry, carry_count));
+                    }
+                    v = _mm256_and_si256(v, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(mask + i)));
+                    if(with_or)
+                    {
+                        v = _mm256_or_si256(v, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i)));
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+                }
+                for(; i < words; ++i)
+                {
+                    Word_t v = mask[i] & shiftedWord(src, words, static_cast<std::ptrdiff_t>(i), n);
+                    dst[i] = with_or ? a[i] | v : v;
+                }
+            }
+            static void andShiftAvx2(Word_t *dst, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                shiftAvx2<false>(dst, nullptr, mask, src, words, n);
+            }
+            static void orAndShiftAvx2(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n)
+            {
+                shiftAvx2<true>(dst, a, mask, src, words, n);
+            }
+            __attribute__((target("avx2")))
+            static void orIntoAvx2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 4 <= words; i += 4)
+                {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dst + i));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(d, s));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] |= src[i];
+                }
+            }
+            __attribute__((target("avx2")))
+            static void andIntoAvx2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 4 <= words; i += 4)
+                {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dst + i));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_and_si256(d, s));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] &= src[i];
+                }
+            }
+            __attribute__((target("avx2")))
+            static void andNotIntoAvx2(Word_t *dst, Word_t const *src, std::size_t words)
+            {
+                std::size_t i = 0;
+                for(; i + 4 <= words; i += 4)
+                {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dst + i));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_andnot_si256(s, d));
+                }
+                for(; i < words; ++i)
+                {
+                    dst[i] &= ~src[i];
+                }
+            }
+
+            static BitKernels const Sse2 {"sse2", andShiftSse2, orAndShiftSse2, orIntoSse2, andIntoSse2, andNotIntoSse2};
+            static BitKernels const Avx2 {"avx2", andShiftAvx2, orAndShiftAvx2, orIntoAvx2, andIntoAvx2, andNotIntoAvx2};
+#endif
+        }
+
+        BitKernels const &BitKernels::best() noexcept
+        {
+            static BitKernels const &chosen = []() -> BitKernels const &
+            {
+                //CHESSPP_BIT_KERNELS=scalar|sse2|avx2 overrides the choice, e.g. to compare them
+                if(char const *forced = std::getenv("CHESSPP_BIT_KERNELS"))
+                {
+                    if(auto k = named(forced))
+                    {
+                        return *k;
+                    }
+                }
+                for(char const *n : {"avx2", "sse2"})
+                {
+                    if(auto k = named(n))
+                    {
+                        return *k;
+                    }
+                }
+                return Scalar;
+            }();
+            return chosen;
+        }
+
+        BitKernels const *BitKernels::named(std::string const &name) noexcept
+        {
+            if(name == Scalar.name)
+            {
+                return &Scalar;
+            }
+#if defined(CHESSPP_X86_KERNELS)
+            __builtin_cpu_init();
+            if(name == Sse2.name && __builtin_cpu_supports("sse2"))
+            {
+                return &Sse2;
+            }
+            if(name == Avx2.name && __builtin_cpu_supports("avx2"))
+            {
+                return &Avx2;
+            }
+#endif
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef ChessPlusPlus_Util_VectorizedBitsetKernels_HeaderPlusPlus
+#define ChessPlusPlus_Util_VectorizedBitsetKernels_HeaderPlusPlus
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Operations on bitsets of any number of 64-bit words, used for
+         * board-sized bitsets. There is a scalar version of each and, on
+         * x86, SSE2 and AVX2 versions; the best one the processor supports
+         * is picked at runtime.
+         *
+         * A shift by n moves bit i to bit i + n, so negative shifts move bits
+         * down. Bits shifted past either end are lost and zeros come in.
+         * Destinations may not overlap the source being shifted.
+         */
+        class BitKernels
+        {
+        public:
+            using Word_t = std::uint64_t;
+
+            char const *name;
+            //dst = mask & (src shifted by n)
+            void (*andShift)(Word_t *dst, Word_t const *mask, Word_t const *src, std::size_t words, long n);
+            //dst = a | (mask & (src shifted by n)), dst may be a
+            void (*orAndShift)(Word_t *dst, Word_t const *a, Word_t const *mask, Word_t const *src, std::size_t words, long n);
+            //dst |= src
+            void (*orInto)(Word_t *dst, Word_t const *src, std::size_t words);
+            //dst &= src
+            void (*andInto)(Word_t *dst, Word_t const *src, std::size_t words);
+            //dst &= ~src
+            void (*andNotInto)(Word_t *dst, Word_t const *src, std::size_t words);
+
+            //The fastest kernels this processor supports
+            static BitKernels const &best() noexcept;
+            //Kernels by name ("scalar", "sse2", "avx2"), nullptr if unknown or unsupported here
+            static BitKernels const *named(std::string const &name) noexcept;
+        };
+    }
+}
+
+#endif
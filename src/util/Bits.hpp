@@ -0,0 +1,52 @@
+#ifndef ChessPlusPlus_Util_BitManipulation_HeaderPlusPlus
+#define ChessPlusPlus_Util_BitManipulation_HeaderPlusPlus
+
+#include <cstdint>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Number of set bits.
+         */
+        inline unsigned popCount(std::uint64_t v) noexcept
+        {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_popcountll(v));
+#else
+            unsigned n = 0;
+            for(; v; v &= v - 1)
+            {
+                ++n;
+            }
+            return n;
+#endif
+        }
+        /**
+         * Index of the lowest set bit, v must not be 0.
+         */
+        inline unsigned lowestBit(std::uint64_t v) noexcept
+        {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctzll(v));
+#else
+            unsigned n = 0;
+            for(; !(v & 1); v >>= 1)
+            {
+                ++n;
+            }
+            return n;
+#endif
+        }
+        /**
+         * Bits first through last set, inclusive, both below 64.
+         */
+        inline std::uint64_t bitRange(unsigned first, unsigned last) noexcept
+        {
+            return (last == 63 ? ~std::uint64_t(0) : (std::uint64_t(1) << (last + 1)) - 1) & ~((std::uint64_t(1) << first) - 1);
+        }
+    }
+}
+
+#endif
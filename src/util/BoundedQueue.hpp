@@ -0,0 +1,211 @@
+#ifndef ChessPlusPlus_Util_BoundedLockFreeQueue_HeaderPlusPlus
+#define ChessPlusPlus_Util_BoundedLockFreeQueue_HeaderPlusPlus
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Fixed capacity first-in first-out queue for any number of producer
+         * and consumer threads, without locks. Each slot carries a sequence
+         * number telling whether it is free for the push or the pop that
+         * reaches it next, so a push or pop is one compare-and-swap on the
+         * shared position plus a store to the slot.
+         *
+         * push() and pop() wait for room or for a value by spinning, then
+         * yielding, then sleeping briefly. Once close() is called, push()
+         * fails and pop() fails when nothing is left, so a pipeline stage
+         * can drain its input and then close its output.
+         * \tparam T must be default constructible and movable.
+         */
+        template<typename T>
+        class BoundedQueue
+        {
+            struct Slot
+            {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+            //on separate cache lines so producers and consumers don't slow each other down
+            alignas(64) std::size_t const mask;
+            std::unique_ptr<Slot[]> slots;
+            alignas(64) std::atomic<std::size_t> tail {0}; //next push
+            alignas(64) std::atomic<std::size_t> head {0}; //next pop
+            alignas(64) std::atomic<bool> closed {false};
+            std::atomic<std::uint64_t> full_waits {0}, empty_waits {0};
+
+            static std::size_t roundUp(std::size_t n) noexcept
+            {
+                std::size_t r = 2;
+                while(r < n)
+                {
+                    r *= 2;
+                }
+                return r;
+            }
+            static void backOff(unsigned &tries)
+            {
+                if(++tries < 64)
+                {
+                    return;
+                }
+                if(tries < 128)
+                {
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+
+        public:
+            //Capacity is rounded up to a power of two
+            BoundedQueue(std::size_t capacity)
+            : mask{roundUp(capacity) - 1}
+            , slots{new Slot[mask + 1]}
+            {
+                for(std::size_t i = 0; i <= mask; ++i)
+                {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+            BoundedQueue(BoundedQueue const &) = delete;
+            BoundedQueue &operator=(BoundedQueue const &) = delete;
+
+            //Adds a value unless the queue is full, in which case v is left alone
+            bool tryPush(T &v)
+            {
+                std::size_t pos = tail.load(std::memory_order_relaxed);
+                for(;;)
+                {
+                    Slot &s = slots[pos & mask];
+                    std::size_t const seq = s.sequence.load(std::memory_order_acquire);
+                    auto const diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                    if(diff == 0)
+                    {
+                        if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            s.value = std::move(v);
+                            s.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(diff < 0)
+                    {
+                        return false; //the slot still holds the value from a lap ago
+                    }
+                    else
+                    {
+                        pos = tail.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+            //Takes the oldest value unless the queue is empty
+            bool tryPop(T &v)
+            {
+                std::size_t pos = head.load(std::memory_order_relaxed);
+                for(;;)
+                {
+                    Slot &s = slots[pos & mask];
+                    std::size_t const seq = s.sequence.load(std::memory_order_acquire);
+                    auto const diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                    if(diff == 0)
+                    {
+                        if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            v = std::move(s.value);
+                            s.sequence.store(pos + mask + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = head.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            //Waits for room, returns false without adding if the queue is closed
+            bool push(T v)
+            {
+                bool waited = false;
+                for(unsigned tries = 0; !closed.load(std::memory_order_acquire); backOff(tries))
+                {
+                    if(tryPush(v))
+                    {
+                        return true;
+                    }
+                    if(!waited)
+                    {
+                        waited = true;
+                        full_waits.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                return false;
+            }
+            //Waits for a value, returns false once the queue is closed and empty
+            bool pop(T &v)
+            {
+                bool waited = false;
+                for(unsigned tries = 0;; backOff(tries))
+                {
+                    if(tryPop(v))
+                    {
+                        return true;
+                    }
+                    if(closed.load(std::memory_order_acquire))
+                    {
+                        return tryPop(v); //a push may have landed just before closing
+                    }
+                    if(!waited)
+                    {
+                        waited = true;
+                        empty_waits.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            //No more pushes; values already in the queue can still be popped.
+            //Call it once every producer is done pushing.
+            void close() noexcept
+            {
+                closed.store(true, std::memory_order_release);
+            }
+
+            std::size_t capacity() const noexcept
+            {
+                return mask + 1;
+            }
+            //Approximate while other threads push and pop
+            std::size_t size() const noexcept
+            {
+                std::size_t const t = tail.load(std::memory_order_relaxed), h = head.load(std::memory_order_relaxed);
+                return t > h ? t - h : 0;
+            }
+            //How many pushes found the queue full, and pops found it empty, at least once
+            std::uint64_t fullWaits() const noexcept
+            {
+                return full_waits.load(std::memory_order_relaxed);
+            }
+            std::uint64_t emptyWaits() const noexcept
+            {
+                return empty_waits.load(std::memory_order_relaxed);
+            }
+        };
+    }
+}
+
+#endif
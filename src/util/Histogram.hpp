@@ -0,0 +1,192 @@
+#ifndef ChessPlusPlus_Util_LogLinearHistogram_HeaderPlusPlus
+#define ChessPlusPlus_Util_LogLinearHistogram_HeaderPlusPlus
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Lock-free histogram of non-negative integer samples (e.g. microseconds).
+         * Values below 64 are counted exactly; above that each power of two is
+         * split into 32 buckets, so any reported percentile is within ~3% of the
+         * real one no matter the range. Recording is wait-free and may happen
+         * from any number of threads while another thread reads.
+         */
+        class Histogram
+        {
+        public:
+            using Value_t = std::uint64_t;
+        private:
+            static constexpr unsigned SubBits = 5;
+            static constexpr unsigned Exact = 2u << SubBits; //64
+            static constexpr unsigned Buckets = Exact + (64 - (SubBits + 1))*(1u << SubBits);
+
+            std::array<std::atomic<std::uint64_t>, Buckets> buckets;
+            std::atomic<std::uint64_t> samples {0};
+            std::atomic<std::uint64_t> sum     {0};
+            std::atomic<Value_t>       maximum {0};
+
+            static unsigned msb(Value_t v) noexcept
+            {
+                unsigned r = 0;
+                while(v >>= 1)
+                {
+                    ++r;
+                }
+                return r;
+            }
+            static unsigned bucketOf(Value_t v) noexcept
+            {
+                if(v < Exact)
+                {
+                    return static_cast<unsigned>(v);
+                }
+                unsigned const m = msb(v);
+                return Exact + (m - (SubBits + 1))*(1u << SubBits) + static_cast<unsigned>((v >> (m - SubBits)) & ((1u << SubBits) - 1));
+            }
+            //Largest value that falls into a bucket
+            static Value_t highestIn(unsigned b) noexcept
+            {
+                if(b < Exact)
+                {
+                    return b;
+                }
+                unsigned const m = (b - Exact)/(1u << SubBits) + SubBits + 1;
+                Value_t const sub = (b - Exact)%(1u << SubBits);
+                Value_t const low = (Value_t(1) << m) | (sub << (m - SubBits));
+                return low + ((Value_t(1) << (m - SubBits)) - 1);
+            }
+
+        public:
+            Histogram() noexcept
+            {
+                reset();
+            }
+            Histogram(Histogram const &) = delete;
+            Histogram &operator=(Histogram const &) = delete;
+
+            void record(Value_t v) noexcept
+            {
+                buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+                samples.fetch_add(1, std::memory_order_relaxed);
+                sum.fetch_add(v, std::memory_order_relaxed);
+                Value_t m = maximum.load(std::memory_order_relaxed);
+                while(v > m && !maximum.compare_exchange_weak(m, v, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            //Not atomic with respect to concurrent record() calls
+            void reset() noexcept
+            {
+                for(auto &b : buckets)
+                {
+                    b.store(0, std::memory_order_relaxed);
+                }
+                samples.store(0, std::memory_order_relaxed);
+                sum.store(0, std::memory_order_relaxed);
+                maximum.store(0, std::memory_order_relaxed);
+            }
+
+            //Adds the samples of another histogram to this one
+            void merge(Histogram const &other) noexcept
+            {
+                for(unsigned i = 0; i < Buckets; ++i)
+                {
+                    buckets[i].fetch_add(other.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+                samples.fetch_add(other.count(), std::memory_order_relaxed);
+                sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                Value_t v = other.max();
+                Value_t m = maximum.load(std::memory_order_relaxed);
+                while(v > m && !maximum.compare_exchange_weak(m, v, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            std::uint64_t count() const noexcept
+            {
+                return samples.load(std::memory_order_relaxed);
+            }
+            Value_t max() const noexcept
+            {
+                return maximum.load(std::memory_order_relaxed);
+            }
+            //Every sample added up
+            std::uint64_t total() const noexcept
+            {
+                return sum.load(std::memory_order_relaxed);
+            }
+            double mean() const noexcept
+            {
+                auto n = count();
+                return n? static_cast<double>(sum.load(std::memory_order_relaxed))/n : 0.0;
+            }
+
+            /**
+             * The smallest value at least the given fraction of samples are at
+             * or below, rounded up to the edge of its bucket.
+             * \param q the quantile, 0.5 for the median, 0.99 for p99.
+             */
+            Value_t percentile(double q) const noexcept
+            {
+                std::uint64_t total = 0;
+                std::array<std::uint64_t, Buckets> snapshot;
+                for(unsigned i = 0; i < Buckets; ++i)
+                {
+                    total += snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+                }
+                if(total == 0)
+                {
+                    return 0;
+                }
+                auto rank = static_cast<std::uint64_t>(q*total + 0.5);
+                if(rank < 1)
+                {
+                    rank = 1;
+                }
+                std::uint64_t seen = 0;
+                for(unsigned i = 0; i < Buckets; ++i)
+                {
+                    if((seen += snapshot[i]) >= rank)
+                    {
+                        Value_t const high = highestIn(i);
+                        Value_t const m = max();
+                        return (m && m < high)? m : high;
+                    }
+                }
+                return max();
+            }
+
+            //Samples in the buckets up to the one v falls into, so at most ~3% of v off from those at or below v
+            std::uint64_t atMost(Value_t v) const noexcept
+            {
+                std::uint64_t seen = 0;
+                for(unsigned i = 0, last = bucketOf(v); i <= last; ++i)
+                {
+                    seen += buckets[i].load(std::memory_order_relaxed);
+                }
+                return seen;
+            }
+
+            //One line: count, mean, p50, p90, p99, p99.9 and max
+            void report(std::ostream &os, char const *unit = "") const
+            {
+                os << "n=" << count()
+                   << " mean=" << static_cast<std::uint64_t>(mean()) << unit
+                   << " p50=" << percentile(0.5) << unit
+                   << " p90=" << percentile(0.9) << unit
+                   << " p99=" << percentile(0.99) << unit
+                   << " p99.9=" << percentile(0.999) << unit
+                   << " max=" << max() << unit;
+            }
+        };
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define ChessPlusPlus_Util_JsonReaderClass_HeaderPlusPlus
 
 #include "Exception.hpp"
+#include "Allocations.hpp"
 
 #include <json.h>
 
@@ -27,6 +28,19 @@ namespace chesspp
              * Underlying json_value pointer.
              */
             json_value *json {nullptr};
+
+            /**
+             * Settings for json-parser, which allocates the DOM
+             * through Allocations when it is tracking.
+             */
+            static json_settings settings() noexcept
+            {
+#if defined(CHESSPP_TRACK_ALLOCATIONS)
+                return json_settings{0, 0, Allocations::jsonAlloc, Allocations::jsonFree, nullptr};
+#else
+                return json_settings{0, 0, nullptr, nullptr, nullptr};
+#endif
+            }
         public:
             JsonReader() = delete;
             JsonReader(JsonReader const &) = delete;
@@ -43,7 +57,7 @@ namespace chesspp
                     throw Exception("stream given to JsonReader in bad state");
                 }
                 std::string str ((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
-                json_settings options {0, 0, nullptr, nullptr, nullptr};
+                json_settings options = settings();
                 char error[json_error_max];
                 json = json_parse_ex(&options, str.c_str(), str.length(), error);
                 if(json == nullptr)
@@ -94,7 +108,8 @@ namespace chesspp
              */
             ~JsonReader()
             {
-                json_value_free(json), json = nullptr;
+                json_settings options = settings();
+                json_value_free_ex(&options, json), json = nullptr;
             }
 
             /**
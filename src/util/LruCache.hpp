@@ -0,0 +1,135 @@
+#ifndef ChessPlusPlus_Util_ShardedLruCache_HeaderPlusPlus
+#define ChessPlusPlus_Util_ShardedLruCache_HeaderPlusPlus
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Thread-safe least-recently-used cache. The keys are spread over
+         * independently locked shards so that lookups from many threads rarely
+         * contend; each shard evicts on its own once it holds capacity/shards
+         * entries.
+         * \tparam Key must be hashable with Hash and comparable with ==.
+         * \tparam Value is copied out on lookup.
+         */
+        template<typename Key, typename Value, typename Hash = std::hash<Key>>
+        class LruCache
+        {
+            struct Shard
+            {
+                using Entries_t = std::list<std::pair<Key, Value>>;
+                std::mutex mutex;
+                Entries_t entries; //most recently used first
+                std::unordered_map<Key, typename Entries_t::iterator, Hash> index;
+            };
+            std::vector<std::unique_ptr<Shard>> shards;
+            std::size_t per_shard;
+            Hash hasher;
+            std::atomic<std::uint64_t> hit_count  {0};
+            std::atomic<std::uint64_t> miss_count {0};
+
+            Shard &shardOf(Key const &k)
+            {
+                //the low bits usually pick the bucket inside the shard, so use the high ones
+                std::uint64_t h = hasher(k);
+                h ^= h >> 29;
+                return *shards[(h * 0x9E3779B97F4A7C15ULL >> 40) % shards.size()];
+            }
+
+        public:
+            LruCache(std::size_t capacity, std::size_t shard_count = 16)
+            : per_shard{(capacity + shard_count - 1)/(shard_count? shard_count : 1)}
+            {
+                if(shard_count == 0)
+                {
+                    shard_count = 1;
+                }
+                if(per_shard == 0)
+                {
+                    per_shard = 1;
+                }
+                for(std::size_t i = 0; i < shard_count; ++i)
+                {
+                    shards.emplace_back(new Shard);
+                }
+            }
+            LruCache(LruCache const &) = delete;
+            LruCache &operator=(LruCache const &) = delete;
+
+            //Copies the value into out and marks it recently used, if present
+            bool find(Key const &k, Value &out)
+            {
+                Shard &s = shardOf(k);
+                std::lock_guard<std::mutex> lock {s.mutex};
+                auto it = s.index.find(k);
+                if(it == s.index.end())
+                {
+                    ++miss_count;
+                    return false;
+                }
+                s.entries.splice(s.entries.begin(), s.entries, it->second);
+                out = it->second->second;
+                ++hit_count;
+                return true;
+            }
+
+            //Inserts or replaces, evicting the least recently used entry of the shard if full
+            void insert(Key const &k, Value v)
+            {
+                Shard &s = shardOf(k);
+                std::lock_guard<std::mutex> lock {s.mutex};
+                auto it = s.index.find(k);
+                if(it != s.index.end())
+                {
+                    it->second->second = std::move(v);
+                    s.entries.splice(s.entries.begin(), s.entries, it->second);
+                    return;
+                }
+                if(s.entries.size() >= per_shard)
+                {
+                    s.index.erase(s.entries.back().first);
+                    s.entries.pop_back();
+                }
+                s.entries.emplace_front(k, std::move(v));
+                s.index.emplace(k, s.entries.begin());
+            }
+
+            void clear()
+            {
+                for(auto &s : shards)
+                {
+                    std::lock_guard<std::mutex> lock {s->mutex};
+                    s->entries.clear();
+                    s->index.clear();
+                }
+            }
+
+            std::size_t size()
+            {
+                std::size_t n = 0;
+                for(auto &s : shards)
+                {
+                    std::lock_guard<std::mutex> lock {s->mutex};
+                    n += s->entries.size();
+                }
+                return n;
+            }
+            std::uint64_t hits()   const noexcept { return hit_count.load();  }
+            std::uint64_t misses() const noexcept { return miss_count.load(); }
+        };
+    }
+}
+
+#endif
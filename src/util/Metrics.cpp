@@ -0,0 +1,180 @@
+#include "Metrics.hpp"
+
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace chesspp
+{
+    namespace util
+    {
+        namespace
+        {
+            //Samples as Prometheus reads them, without locale or stream state getting in the way
+            static std::string number(double v)
+            {
+                std::ostringstream os;
+                os.imbue(std::locale::classic());
+                os << std::setprecision(12) << v;
+                return os.str();
+            }
+            static std::vector<std::uint64_t> sorted(std::vector<std::uint64_t> b)
+            {
+                std::sort(b.begin(), b.end());
+                b.erase(std::unique(b.begin(), b.end()), b.end());
+                return b;
+            }
+            //The first element of storage on a cache line boundary
+            static std::atomic<std::uint64_t> *aligned(std::atomic<std::uint64_t> *storage) noexcept
+            {
+                auto const address = reinterpret_cast<std::uintptr_t>(storage);
+                return storage + (64 - address%64)%64/sizeof(std::uint64_t);
+            }
+            static void header(std::ostream &os, Metrics::Metric const &m, char const *type)
+            {
+                os << "# HELP " << m.name << " " << m.help << "\n"
+                   << "# TYPE " << m.name << " " << type << "\n";
+            }
+        }
+
+        Metrics::Metric::Metric(std::string const &n, std::string const &h)
+        : name{n}
+        , help{h}
+        {
+        }
+
+        Metrics::Counter::Counter(std::string const &n, std::string const &h)
+        : Metric{n, h}
+        , shards{aligned(storage.data())}
+        {
+            for(auto &s : storage)
+            {
+                s.store(0, std::memory_order_relaxed);
+            }
+        }
+        std::uint64_t Metrics::Counter::value() const noexcept
+        {
+            std::uint64_t sum = 0;
+            for(std::size_t s = 0; s < Shards; ++s)
+            {
+                sum += shards[s*Stride].load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+        void Metrics::Counter::write(std::ostream &os) const
+        {
+            header(os, *this, "counter");
+            os << name << " " << value() << "\n";
+        }
+
+        void Metrics::Gauge::write(std::ostream &os) const
+        {
+            header(os, *this, "gauge");
+            os << name << " " << value() << "\n";
+        }
+
+        Metrics::Histogram::Histogram(std::string const &n, std::string const &h, std::vector<std::uint64_t> b, double s)
+        : Metric{n, h}
+        , bounds{sorted(std::move(b))}
+        , scale{s}
+        , shards{new util::Histogram[Shards]}
+        {
+        }
+        void Metrics::Histogram::snapshot(util::Histogram &into) const noexcept
+        {
+            for(std::size_t s = 0; s < Shards; ++s)
+            {
+                into.merge(shards[s]);
+            }
+        }
+        void Metrics::Histogram::write(std::ostream &os) const
+        {
+            util::Histogram merged;
+            snapshot(merged);
+            header(os, *this, "histogram");
+            for(auto const b : bounds)
+            {
+                os << name << "_bucket{le=\"" << number(b*scale) << "\"} " << merged.atMost(b) << "\n";
+            }
+            //from the buckets rather than count(), which concurrent records may have got to first
+            auto const count = merged.atMost(std::numeric_limits<util::Histogram::Value_t>::max());
+            os << name << "_bucket{le=\"+Inf\"} " << count << "\n"
+               << name << "_sum " << number(merged.total()*scale) << "\n"
+               << name << "_count " << count << "\n";
+        }
+
+        std::size_t Metrics::shard() noexcept
+        {
+            static std::atomic<std::size_t> next {0};
+            thread_local std::size_t const mine = next.fetch_add(1, std::memory_order_relaxed) % Shards;
+            return mine;
+        }
+
+        Metrics &Metrics::global()
+        {
+            static Metrics registry;
+            return registry;
+        }
+
+        template<typename MetricT, typename... Args>
+        MetricT &Metrics::add(std::string const &name, std::string const &help, Args &&... args)
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            auto it = std::lower_bound(metrics.begin(), metrics.end(), name, [](std::unique_ptr<Metric> const &m, std::string const &n)
+            {
+                return m->name < n;
+            });
+            if(it != metrics.end() && (*it)->name == name)
+            {
+                if(auto m = dynamic_cast<MetricT *>(it->get()))
+                {
+                    return *m;
+                }
+                throw Exception("Metric \"" + name + "\" is already registered with another type");
+            }
+            std::unique_ptr<MetricT> m {new MetricT(name, help, std::forward<Args>(args)...)};
+            auto &registered = *m;
+            metrics.emplace(it, std::move(m));
+            return registered;
+        }
+
+        auto Metrics::counter(std::string const &name, std::string const &help) noexcept(false)
+        -> Counter &
+        {
+            return add<Counter>(name, help);
+        }
+        auto Metrics::gauge(std::string const &name, std::string const &help) noexcept(false)
+        -> Gauge &
+        {
+            return add<Gauge>(name, help);
+        }
+        auto Metrics::histogram(std::string const &name, std::string const &help, std::vector<std::uint64_t> bounds, double scale) noexcept(false)
+        -> Histogram &
+        {
+            return add<Histogram>(name, help, std::move(bounds), scale);
+        }
+
+        void Metrics::write(std::ostream &os)
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            for(auto const &m : metrics)
+            {
+                m->write(os);
+            }
+        }
+
+        std::vector<std::uint64_t> Metrics::exponential(std::uint64_t first, double factor, std::size_t count)
+        {
+            std::vector<std::uint64_t> bounds;
+            double b = static_cast<double>(std::max<std::uint64_t>(first, 1));
+            for(std::size_t i = 0; i < count; ++i, b *= factor)
+            {
+                bounds.push_back(static_cast<std::uint64_t>(b + 0.5));
+            }
+            return bounds;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#ifndef ChessPlusPlus_Util_MetricsRegistryClass_HeaderPlusPlus
+#define ChessPlusPlus_Util_MetricsRegistryClass_HeaderPlusPlus
+
+#include "Histogram.hpp"
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chesspp
+{
+    namespace util
+    {
+        /**
+         * Counters, gauges and histograms kept by the code being measured and
+         * written out in the Prometheus text format, e.g. by a MetricsExporter.
+         *
+         * Counters and histograms are split into Shards parts on cache lines
+         * of their own, and each thread only adds to its own part, so
+         * recording is relaxed atomic adds that threads don't contend for.
+         * Reading sums the parts.
+         *
+         * Metrics are registered once by name, usually into global(), and
+         * live as long as the registry; registering a name again returns the
+         * same metric.
+         */
+        class Metrics
+        {
+        public:
+            static constexpr std::size_t Shards = 16;
+
+            class Metric
+            {
+            public:
+                std::string const name, help;
+
+                Metric(std::string const &name, std::string const &help);
+                Metric(Metric const &) = delete;
+                Metric &operator=(Metric const &) = delete;
+                virtual ~Metric() = default;
+
+                //Writes the HELP, TYPE and sample lines
+                virtual void write(std::ostream &os) const = 0;
+            };
+
+            //Only ever goes up
+            class Counter : public Metric
+            {
+                static constexpr std::size_t Stride = 64/sizeof(std::uint64_t); //a cache line per shard
+                //new doesn't align past alignof(std::max_align_t) before C++17, so shards start from the first boundary
+                std::array<std::atomic<std::uint64_t>, (Shards + 1)*Stride> storage;
+                std::atomic<std::uint64_t> *shards;
+
+            public:
+                Counter(std::string const &name, std::string const &help);
+
+                void add(std::uint64_t n = 1) noexcept
+                {
+                    shards[shard()*Stride].fetch_add(n, std::memory_order_relaxed);
+                }
+                std::uint64_t value() const noexcept;
+
+                void write(std::ostream &os) const override;
+            };
+
+            //Goes up and down, set from anywhere
+            class Gauge : public Metric
+            {
+                std::atomic<std::int64_t> current {0};
+
+            public:
+                using Metric::Metric;
+
+                void set(std::int64_t v) noexcept
+                {
+                    current.store(v, std::memory_order_relaxed);
+                }
+                void add(std::int64_t n) noexcept
+                {
+                    current.fetch_add(n, std::memory_order_relaxed);
+                }
+                std::int64_t value() const noexcept
+                {
+                    return current.load(std::memory_order_relaxed);
+                }
+
+                void write(std::ostream &os) const override;
+            };
+
+            /**
+             * Integer samples, e.g. nanoseconds, kept in a util::Histogram per
+             * shard and written out as cumulative buckets with the given upper
+             * bounds, multiplied by scale, e.g. 1e-9 to have nanoseconds read
+             * as seconds.
+             */
+            class Histogram : public Metric
+            {
+                std::vector<std::uint64_t> const bounds;
+                double const scale;
+                std::unique_ptr<util::Histogram[]> shards; //each far bigger than a cache line, so they don't share one
+
+            public:
+                Histogram(std::string const &name, std::string const &help, std::vector<std::uint64_t> bounds, double scale = 1.0);
+
+                void record(std::uint64_t v) noexcept
+                {
+                    shards[shard()].record(v);
+                }
+                //Merges every shard into the given histogram, e.g. for percentiles
+                void snapshot(util::Histogram &into) const noexcept;
+
+                void write(std::ostream &os) const override;
+            };
+
+        private:
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Metric>> metrics; //sorted by name
+
+            template<typename MetricT, typename... Args>
+            MetricT &add(std::string const &name, std::string const &help, Args &&... args);
+
+            //The shard of the calling thread, threads take turns at them
+            static std::size_t shard() noexcept;
+
+        public:
+            Metrics() = default;
+            Metrics(Metrics const &) = delete;
+            Metrics &operator=(Metrics const &) = delete;
+
+            //The registry the game and the tools record into
+            static Metrics &global();
+
+            //Registering a name again with a different type throws
+            Counter &counter(std::string const &name, std::string const &help) noexcept(false);
+            Gauge &gauge(std::string const &name, std::string const &help) noexcept(false);
+            Histogram &histogram(std::string const &name, std::string const &help, std::vector<std::uint64_t> bounds, double scale = 1.0) noexcept(false);
+
+            //Every metric in the Prometheus text exposition format, in name order
+            void write(std::ostream &os);
+
+            //Bounds from first up, each factor times the one before
+            static std::vector<std::uint64_t> exponential(std::uint64_t first, double factor, std::size_t count);
+        };
+    }
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "Utilities.hpp"
 
 #include <tuple>
+#include <utility>
 #include <ostream>
 #include <cstdint>
 
@@ -68,6 +69,28 @@ namespace chesspp
             }
             return d;
         }
+        /**
+         * Returns the x and y steps of a direction, with
+         * north being towards lower y.
+         * \param d the direction.
+         * \return the steps as (x, y), (0, 0) for Direction::None.
+         */
+        inline std::pair<signed, signed> Offset(Direction d) noexcept
+        {
+            using D = Direction;
+            switch(d)
+            {
+            case D::North:     return { 0, -1};
+            case D::NorthEast: return { 1, -1};
+            case D::East:      return { 1,  0};
+            case D::SouthEast: return { 1,  1};
+            case D::South:     return { 0,  1};
+            case D::SouthWest: return {-1,  1};
+            case D::West:      return {-1,  0};
+            case D::NorthWest: return {-1, -1};
+            default:           return { 0,  0};
+            }
+        }
         /**
          * Serializes a direction to a stream in string format.
          * \param os The stream to serialize to.